@@ -63,6 +63,8 @@ http::RequestManager g_DownloadManager;
 Config g_Config;
 
 static bool jitForcedOff;
+// The core the user picked before we forced jit off, so we save the same value back.
+static int jitForcedOffCore;
 
 // Not in Config.h because it's #included a lot.
 struct ConfigPrivate {
@@ -301,6 +303,8 @@ static const ConfigSetting cpuSettings[] = {
 	ConfigSetting("HideSlowWarnings", &g_Config.bHideSlowWarnings, false, CfgFlag::DEFAULT),
 	ConfigSetting("HideStateWarnings", &g_Config.bHideStateWarnings, false, CfgFlag::DEFAULT),
 	ConfigSetting("PreloadFunctions", &g_Config.bPreloadFunctions, false, CfgFlag::PER_GAME),
+	ConfigSetting("IRCache", &g_Config.bIRCache, true, CfgFlag::DONT_SAVE),  // Doesn't save. Ini-only.
+	ConfigSetting("IRTraces", &g_Config.bIRTraces, true, CfgFlag::DONT_SAVE),  // Doesn't save. Ini-only.
 	ConfigSetting("JitDisableFlags", &g_Config.uJitDisableFlags, (uint32_t)0, CfgFlag::PER_GAME),
 	ConfigSetting("CPUSpeed", &g_Config.iLockedCPUSpeed, 0, CfgFlag::PER_GAME | CfgFlag::REPORT),
 };
@@ -576,6 +580,7 @@ static const ConfigSetting graphicsSettings[] = {
 	ConfigSetting("VertexDecCache", &g_Config.bVertexCache, false, CfgFlag::PER_GAME | CfgFlag::REPORT),
 	ConfigSetting("TextureBackoffCache", &g_Config.bTextureBackoffCache, false, CfgFlag::PER_GAME | CfgFlag::REPORT),
 	ConfigSetting("VertexDecJit", &g_Config.bVertexDecoderJit, &DefaultCodeGen, CfgFlag::DONT_SAVE | CfgFlag::REPORT),
+	ConfigSetting("ParallelVertexDecodeMinVerts", &g_Config.iParallelVertexDecodeMinVerts, 16384, CfgFlag::DEFAULT),
 
 #ifndef MOBILE_DEVICE
 	ConfigSetting("FullScreen", &g_Config.bFullScreen, false, CfgFlag::DEFAULT),
@@ -602,6 +607,8 @@ static const ConfigSetting graphicsSettings[] = {
 	ConfigSetting("TexScalingType", &g_Config.iTexScalingType, 0, CfgFlag::PER_GAME | CfgFlag::REPORT),
 	ConfigSetting("TexDeposterize", &g_Config.bTexDeposterize, false, CfgFlag::PER_GAME | CfgFlag::REPORT),
 	ConfigSetting("TexHardwareScaling", &g_Config.bTexHardwareScaling, false, CfgFlag::PER_GAME | CfgFlag::REPORT),
+	ConfigSetting("TexScalingAsync", &g_Config.bTexScalingAsync, true, CfgFlag::PER_GAME | CfgFlag::REPORT),
+	ConfigSetting("TexGPUDecode", &g_Config.bTexGPUDecode, false, CfgFlag::PER_GAME | CfgFlag::REPORT),
 	ConfigSetting("VSyncInterval", &g_Config.bVSync, false, CfgFlag::PER_GAME),
 	ConfigSetting("BloomHack", &g_Config.iBloomHack, 0, CfgFlag::PER_GAME | CfgFlag::REPORT),
 
@@ -1299,8 +1306,9 @@ bool Config::Save(const char *saveReason) {
 
 void Config::PostLoadCleanup(bool gameSpecific) {
 	// Override ppsspp.ini JIT value to prevent crashing
-	jitForcedOff = DefaultCpuCore() != (int)CPUCore::JIT && g_Config.iCpuCore == (int)CPUCore::JIT;
+	jitForcedOff = DefaultCpuCore() != (int)CPUCore::JIT && (g_Config.iCpuCore == (int)CPUCore::JIT || g_Config.iCpuCore == (int)CPUCore::JIT_IR);
 	if (jitForcedOff) {
+		jitForcedOffCore = g_Config.iCpuCore;
 		g_Config.iCpuCore = (int)CPUCore::IR_JIT;
 	}
 
@@ -1330,16 +1338,16 @@ void Config::PostLoadCleanup(bool gameSpecific) {
 
 void Config::PreSaveCleanup(bool gameSpecific) {
 	if (jitForcedOff) {
-		// If we forced jit off and it's still set to IR, change it back to jit.
+		// If we forced jit off and it's still set to IR, change it back to what it was.
 		if (g_Config.iCpuCore == (int)CPUCore::IR_JIT)
-			g_Config.iCpuCore = (int)CPUCore::JIT;
+			g_Config.iCpuCore = jitForcedOffCore;
 	}
 }
 
 void Config::PostSaveCleanup(bool gameSpecific) {
 	if (jitForcedOff) {
 		// Force JIT off again just in case Config::Save() is called without exiting PPSSPP.
-		if (g_Config.iCpuCore == (int)CPUCore::JIT)
+		if (g_Config.iCpuCore == jitForcedOffCore)
 			g_Config.iCpuCore = (int)CPUCore::IR_JIT;
 	}
 }
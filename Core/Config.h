@@ -90,6 +90,8 @@ struct Config {
 	bool bHideSlowWarnings;
 	bool bHideStateWarnings;
 	bool bPreloadFunctions;
+	bool bIRCache;  // Hidden ini-only setting, keeps optimized IR between runs of a game.
+	bool bIRTraces;  // Hidden ini-only setting, lets hot IR blocks continue across branches.
 	uint32_t uJitDisableFlags;
 
 	bool bSeparateSASThread;
@@ -177,6 +179,7 @@ struct Config {
 	bool bVertexCache;
 	bool bTextureBackoffCache;
 	bool bVertexDecoderJit;
+	int iParallelVertexDecodeMinVerts;  // Draws with at least this many vertices are decoded on multiple threads. 0 = never.
 	bool bFullScreen;
 	bool bFullScreenMulti;
 	int iForceFullScreen = -1; // -1 = nope, 0 = force off, 1 = force on (not saved.)
@@ -191,6 +194,8 @@ struct Config {
 	int iTexScalingType; // 0 = xBRZ, 1 = Hybrid
 	bool bTexDeposterize;
 	bool bTexHardwareScaling;
+	bool bTexScalingAsync;
+	bool bTexGPUDecode;  // Experimental: decode CLUT textures in a compute shader (Vulkan only.)
 	int iFpsLimit1;
 	int iFpsLimit2;
 	int iAnalogFpsLimit;
@@ -133,3 +133,76 @@ IRUsage IRNextFPRUsage(int fpr, const IRSituation &info) {
 
 	return IRUsage::UNUSED;
 }
+
+static u32 CtrlStateForGPR(int reg) {
+	if (reg >= IRREG_VFPU_CTRL_BASE && reg < IRREG_VFPU_CTRL_BASE + 16)
+		return 1 << (reg - IRREG_VFPU_CTRL_BASE);
+	if (reg == IRREG_FPCOND)
+		return IRCTRL_FPCOND;
+	if (reg == IRREG_FCR31)
+		return IRCTRL_FCR31;
+	return 0;
+}
+
+void IRCtrlStateUsage(const IRInst &inst, u32 &reads, u32 &writes) {
+	reads = 0;
+	writes = 0;
+
+	const IRMeta *m = GetIRMeta(inst.op);
+	// Anything that leaves the block (or might) needs all of it to be right.
+	if ((m->flags & IRFLAG_EXIT) != 0 || inst.op == IROp::Interpret || inst.op == IROp::CallReplacement) {
+		reads = IRCTRL_ALL;
+		return;
+	}
+
+	const u32 ccBit = 1 << (IRREG_VFPU_CC - IRREG_VFPU_CTRL_BASE);
+	switch (inst.op) {
+	case IROp::FCmp:
+	case IROp::ZeroFpCond:
+		writes = IRCTRL_FPCOND;
+		break;
+	case IROp::FpCondToReg:
+		reads = IRCTRL_FPCOND;
+		break;
+	case IROp::FpCtrlFromReg:
+		writes = IRCTRL_FPCOND | IRCTRL_FCR31;
+		break;
+	case IROp::FpCtrlToReg:
+		reads = IRCTRL_FPCOND | IRCTRL_FCR31;
+		break;
+	case IROp::FCvtWS:
+	case IROp::RestoreRoundingMode:
+	case IROp::ApplyRoundingMode:
+	case IROp::UpdateRoundingMode:
+		// These depend on the rounding mode.
+		reads = IRCTRL_FCR31;
+		break;
+	case IROp::VfpuCtrlToReg:
+		reads = 1 << (inst.src1 & 0xF);
+		break;
+	case IROp::SetCtrlVFPU:
+	case IROp::SetCtrlVFPUReg:
+	case IROp::SetCtrlVFPUFReg:
+		writes = 1 << (inst.dest & 0xF);
+		break;
+	case IROp::FCmpVfpuBit:
+	case IROp::FCmpVfpuAggregate:
+		// These only change some bits, so they read the rest.
+	case IROp::FCmovVfpuCC:
+		reads = ccBit;
+		break;
+	default:
+		break;
+	}
+
+	// Regular ops can also get at this state through the special GPR numbers.
+	if (m->types[1] == 'G')
+		reads |= CtrlStateForGPR(inst.src1);
+	if (m->types[2] == 'G')
+		reads |= CtrlStateForGPR(inst.src2);
+	if ((m->flags & (IRFLAG_SRC3 | IRFLAG_SRC3DST)) != 0 && m->types[0] == 'G')
+		reads |= CtrlStateForGPR(inst.src3);
+	int dest = IRDestGPR(inst);
+	if (dest >= 0)
+		writes |= CtrlStateForGPR(dest) & ~reads;
+}
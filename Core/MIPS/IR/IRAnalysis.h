@@ -42,3 +42,14 @@ enum class IRUsage {
 
 IRUsage IRNextGPRUsage(int gpr, const IRSituation &info);
 IRUsage IRNextFPRUsage(int fpr, const IRSituation &info);
+
+// FPU and VFPU control state, as a bitmask.  One bit per VFPU control reg, then fpcond and fcr31.
+enum IRCtrlState : u32 {
+	IRCTRL_VFPU_CTRL = 0x0000FFFF,
+	IRCTRL_FPCOND = 0x00010000,
+	IRCTRL_FCR31 = 0x00020000,
+	IRCTRL_ALL = 0x0003FFFF,
+};
+
+// Which control state the instruction may read, and which it overwrites completely.
+void IRCtrlStateUsage(const IRInst &inst, u32 &reads, u32 &writes);
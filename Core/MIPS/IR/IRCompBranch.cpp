@@ -15,6 +15,8 @@
 // Official git repository and contact information can be found at
 // https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
 
+#include <algorithm>
+
 #include "Common/Data/Convert/SmallDataConvert.h"
 #include "Common/Profiler/Profiler.h"
 
@@ -54,6 +56,70 @@ using namespace MIPSAnalyst;
 namespace MIPSComp
 {
 
+// Traces only go forward, and only this far, so one block never covers too much code to invalidate.
+static const u32 MAX_TRACE_SPAN = 0x1000;
+static const int MAX_TRACE_CONTINUES = 8;
+static const int MAX_TRACE_INSTRUCTIONS = 300;
+
+bool IRFrontend::CanContinueTrace(u32 targetAddr) {
+	if (!traceMode_ || !js.compiling || js.cancel)
+		return false;
+	if (traceContinues_ >= MAX_TRACE_CONTINUES || js.numInstructions >= MAX_TRACE_INSTRUCTIONS)
+		return false;
+	if (targetAddr <= js.blockStart || targetAddr >= js.blockStart + MAX_TRACE_SPAN || !Memory::IsValidAddress(targetAddr))
+		return false;
+
+	// Don't compile anything twice, that'd just be unrolling a loop.
+	if (targetAddr >= traceSegmentStart_ && targetAddr < GetCompilerPC() + 8)
+		return false;
+	for (const auto &segment : traceSegments_) {
+		if (targetAddr >= segment.first && targetAddr < segment.second)
+			return false;
+	}
+	return true;
+}
+
+// Called at the end of a branch (after its delay slot) instead of exiting to targetAddr.
+bool IRFrontend::ContinueTrace(u32 targetAddr) {
+	if (!CanContinueTrace(targetAddr))
+		return false;
+
+	u32 segmentEnd = GetCompilerPC() + 8;
+	traceSegments_.push_back(std::make_pair(traceSegmentStart_, segmentEnd));
+	traceEnd_ = std::max(traceEnd_, segmentEnd);
+	traceSegmentStart_ = targetAddr;
+	traceContinues_++;
+
+	js.lastContinuedPC = GetCompilerPC();
+	// DoJit() will add 4 when we return.
+	js.compilerPC = targetAddr - 4;
+	return true;
+}
+
+bool IRFrontend::TraceFollows(u32 hotAddr, u32 coldAddr) const {
+	if (!traceMode_ || !blockExecutionCount_)
+		return false;
+	u64 hot = blockExecutionCount_(hotAddr);
+	u64 cold = blockExecutionCount_(coldAddr);
+	return hot != 0 && hot > cold * 2;
+}
+
+bool IRFrontend::TraceTaken(const BranchInfo &branchInfo, u32 targetAddr) {
+	if (branchInfo.delaySlotIsBranch || !TraceFollows(targetAddr, ResolveNotTakenTarget(branchInfo)))
+		return false;
+	return ContinueTrace(targetAddr);
+}
+
+// For a non-likely branch where the fall-through is hot, exits when taken instead and keeps going.
+bool IRFrontend::TraceNotTaken(const BranchInfo &branchInfo, IRComparison cc, u32 targetAddr, IRReg lhs, IRReg rhs) {
+	u32 notTakenAddr = GetCompilerPC() + 8;
+	if (branchInfo.likely || branchInfo.delaySlotIsBranch || !TraceFollows(notTakenAddr, targetAddr) || !CanContinueTrace(notTakenAddr))
+		return false;
+
+	ir.Write(ComparisonToExit(Invert(cc)), ir.AddConstant(targetAddr), lhs, rhs);
+	return ContinueTrace(notTakenAddr);
+}
+
 void IRFrontend::BranchRSRTComp(MIPSOpcode op, IRComparison cc, bool likely) {
 	if (js.inDelaySlot) {
 		ERROR_LOG_REPORT(JIT, "Branch in RSRTComp delay slot at %08x in block starting at %08x", GetCompilerPC(), js.blockStart);
@@ -100,6 +166,8 @@ void IRFrontend::BranchRSRTComp(MIPSOpcode op, IRComparison cc, bool likely) {
 	js.downcountAmount = 0;
 
 	FlushAll();
+	if (TraceNotTaken(branchInfo, cc, targetAddr, lhs, rhs))
+		return;
 	ir.Write(ComparisonToExit(cc), ir.AddConstant(ResolveNotTakenTarget(branchInfo)), lhs, rhs);
 	// This makes the block "impure" :(
 	if (likely && !branchInfo.delaySlotIsBranch)
@@ -114,6 +182,8 @@ void IRFrontend::BranchRSRTComp(MIPSOpcode op, IRComparison cc, bool likely) {
 	}
 
 	FlushAll();
+	if (TraceTaken(branchInfo, targetAddr))
+		return;
 	ir.Write(IROp::ExitToConst, ir.AddConstant(targetAddr));
 
 	// Account for the delay slot.
@@ -151,6 +221,8 @@ void IRFrontend::BranchRSZeroComp(MIPSOpcode op, IRComparison cc, bool andLink,
 	js.downcountAmount = 0;
 
 	FlushAll();
+	if (TraceNotTaken(branchInfo, cc, targetAddr, lhs, 0))
+		return;
 	ir.Write(ComparisonToExit(cc), ir.AddConstant(ResolveNotTakenTarget(branchInfo)), lhs);
 	if (likely && !branchInfo.delaySlotIsBranch)
 		CompileDelaySlot();
@@ -165,6 +237,8 @@ void IRFrontend::BranchRSZeroComp(MIPSOpcode op, IRComparison cc, bool andLink,
 
 	// Taken
 	FlushAll();
+	if (TraceTaken(branchInfo, targetAddr))
+		return;
 	ir.Write(IROp::ExitToConst, ir.AddConstant(targetAddr));
 
 	// Account for the delay slot.
@@ -229,6 +303,8 @@ void IRFrontend::BranchFPFlag(MIPSOpcode op, IRComparison cc, bool likely) {
 	js.downcountAmount = 0;
 
 	FlushAll();
+	if (TraceNotTaken(branchInfo, cc, targetAddr, IRTEMP_LHS, 0))
+		return;
 	// Not taken
 	ir.Write(ComparisonToExit(cc), ir.AddConstant(ResolveNotTakenTarget(branchInfo)), IRTEMP_LHS, 0);
 	// Taken
@@ -244,6 +320,8 @@ void IRFrontend::BranchFPFlag(MIPSOpcode op, IRComparison cc, bool likely) {
 	}
 
 	FlushAll();
+	if (TraceTaken(branchInfo, targetAddr))
+		return;
 	ir.Write(IROp::ExitToConst, ir.AddConstant(targetAddr));
 
 	// Account for the delay slot.
@@ -291,6 +369,8 @@ void IRFrontend::BranchVFPUFlag(MIPSOpcode op, IRComparison cc, bool likely) {
 
 	ir.Write(IROp::AndConst, IRTEMP_LHS, IRTEMP_LHS, ir.AddConstant(1 << imm3));
 	FlushAll();
+	if (TraceNotTaken(branchInfo, cc, targetAddr, IRTEMP_LHS, 0))
+		return;
 	ir.Write(ComparisonToExit(cc), ir.AddConstant(ResolveNotTakenTarget(branchInfo)), IRTEMP_LHS, 0);
 
 	if (likely && !branchInfo.delaySlotIsBranch)
@@ -306,6 +386,8 @@ void IRFrontend::BranchVFPUFlag(MIPSOpcode op, IRComparison cc, bool likely) {
 
 	// Taken
 	FlushAll();
+	if (TraceTaken(branchInfo, targetAddr))
+		return;
 	ir.Write(IROp::ExitToConst, ir.AddConstant(targetAddr));
 
 	// Account for the delay slot.
@@ -362,6 +444,8 @@ void IRFrontend::Comp_Jump(MIPSOpcode op) {
 	js.downcountAmount = 0;
 
 	FlushAll();
+	if (ContinueTrace(targetAddr))
+		return;
 	ir.Write(IROp::ExitToConst, ir.AddConstant(targetAddr));
 
 	// Account for the delay slot.
@@ -15,6 +15,8 @@
 // Official git repository and contact information can be found at
 // https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
 
+#include <algorithm>
+
 #include "Common/Log.h"
 #include "Common/Serialize/Serializer.h"
 #include "Common/Serialize/SerializeFuncs.h"
@@ -221,7 +223,7 @@ MIPSOpcode IRFrontend::GetOffsetInstruction(int offset) {
 	return Memory::Read_Instruction(GetCompilerPC() + 4 * offset);
 }
 
-void IRFrontend::DoJit(u32 em_address, std::vector<IRInst> &instructions, u32 &mipsBytes, bool preload) {
+void IRFrontend::DoJit(u32 em_address, std::vector<IRInst> &instructions, u32 &mipsBytes, bool preload, bool hot) {
 	js.cancel = false;
 	js.preloading = preload;
 	js.blockStart = em_address;
@@ -237,6 +239,12 @@ void IRFrontend::DoJit(u32 em_address, std::vector<IRInst> &instructions, u32 &m
 	js.PrefixStart();
 	ir.Clear();
 
+	traceMode_ = hot && !preload && opts.traces && blockExecutionCount_;
+	traceContinues_ = 0;
+	traceSegmentStart_ = em_address;
+	traceEnd_ = 0;
+	traceSegments_.clear();
+
 	js.numInstructions = 0;
 	while (js.compiling) {
 		// Jit breakpoints are quite fast, so let's do them in release too.
@@ -254,22 +262,40 @@ void IRFrontend::DoJit(u32 em_address, std::vector<IRInst> &instructions, u32 &m
 		ir.Clear();
 	}
 
-	mipsBytes = js.compilerPC - em_address;
+	// A trace may have jumped over code, so cover everything up to its furthest segment.
+	mipsBytes = std::max(js.compilerPC, traceEnd_) - em_address;
 
 	IRWriter simplified;
 	IRWriter *code = &ir;
 	if (!js.hadBreakpoints) {
-		static const IRPassFunc passes[] = {
+		// Most blocks run only a few times, so keep it cheap until IRJit tells us it's hot.
+		// Without tiering, nothing will tell us, so always use the full list.
+		static const IRPassFunc coldPasses[] = {
+			&ApplyMemoryValidation,
+			&RemoveLoadStoreLeftRight,
+			&PropagateConstants,
+			&PurgeTemps,
+			&MergeVec4Ops,
+			&RemoveDeadCtrlWrites,
+		};
+		static const IRPassFunc hotPasses[] = {
 			&ApplyMemoryValidation,
 			&RemoveLoadStoreLeftRight,
 			&OptimizeFPMoves,
 			&PropagateConstants,
 			&PurgeTemps,
-			// &ReorderLoadStore,
-			// &MergeLoadStore,
+			&MergeVec4Ops,
+			&RemoveDeadCtrlWrites,
+			&ReorderLoadStore,
+			&MergeLoadStore,
 			// &ThreeOpToTwoOp,
 		};
-		if (IRApplyPasses(passes, ARRAY_SIZE(passes), ir, simplified, opts))
+		bool changed;
+		if (hot || !opts.tieredPasses)
+			changed = IRApplyPasses(hotPasses, ARRAY_SIZE(hotPasses), ir, simplified, opts);
+		else
+			changed = IRApplyPasses(coldPasses, ARRAY_SIZE(coldPasses), ir, simplified, opts);
+		if (changed)
 			logBlocks = 1;
 		code = &simplified;
 		//if (ir.GetInstructions().size() >= 24)
@@ -281,7 +307,7 @@ void IRFrontend::DoJit(u32 em_address, std::vector<IRInst> &instructions, u32 &m
 	if (logBlocks > 0 && dontLogBlocks == 0) {
 		char temp2[256];
 		NOTICE_LOG(JIT, "=============== mips %08x ===============", em_address);
-		for (u32 cpc = em_address; cpc != GetCompilerPC(); cpc += 4) {
+		for (u32 cpc = em_address; cpc != em_address + mipsBytes; cpc += 4) {
 			temp2[0] = 0;
 			MIPSDisAsm(Memory::Read_Opcode_JIT(cpc), cpc, temp2, sizeof(temp2), true);
 			NOTICE_LOG(JIT, "M: %08x   %s", cpc, temp2);
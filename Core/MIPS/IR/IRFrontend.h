@@ -1,5 +1,9 @@
 #pragma once
 
+#include <functional>
+#include <utility>
+#include <vector>
+
 #include "Common/CommonTypes.h"
 #include "Core/MIPS/JitCommon/JitCommon.h"
 #include "Core/MIPS/JitCommon/JitState.h"
@@ -89,7 +93,13 @@ class IRFrontend : public MIPSFrontendInterface {
 	void DoState(PointerWrap &p);
 	bool CheckRounding(u32 blockAddress);  // returns true if we need a do-over
 
-	void DoJit(u32 em_address, std::vector<IRInst> &instructions, u32 &mipsBytes, bool preload);
+	// Hot blocks get the expensive passes, and follow hot branch paths (if there's a counter) instead of exiting at each branch.
+	void DoJit(u32 em_address, std::vector<IRInst> &instructions, u32 &mipsBytes, bool preload, bool hot = false);
+	// Used for hot blocks to pick which side of a branch to follow.  Returns 0 for unknown addresses.
+	// Leave unset to disable traces.
+	void SetBlockExecutionCounter(std::function<u32(u32)> counter) {
+		blockExecutionCount_ = counter;
+	}
 
 	void EatPrefix() override {
 		js.EatPrefix();
@@ -98,6 +108,26 @@ class IRFrontend : public MIPSFrontendInterface {
 	void SetOptions(const IROptions &o) {
 		opts = o;
 	}
+	// Whether blocks compiled now have rounding mode checks, and whether new blocks need them.
+	bool CompilesRoundingChecks() const {
+		return js.lastSetRounding != 0;
+	}
+	bool NeedsRoundingChecks() const {
+		return js.hasSetRounding != 0;
+	}
+	const IROptions &GetOptions() const {
+		return opts;
+	}
+	// Before compiling with a separate frontend (e.g. on another thread), gives it what we've detected so far.
+	void CopyDetectedState(const IRFrontend &other) {
+		js.hasSetRounding = other.js.hasSetRounding;
+		js.lastSetRounding = other.js.lastSetRounding;
+	}
+	// After compiling with a separate frontend (e.g. on another thread), picks up what it detected.
+	void MergeDetectedState(const IRFrontend &other) {
+		if (other.js.hasSetRounding)
+			js.hasSetRounding = other.js.hasSetRounding;
+	}
 
 private:
 	void RestoreRoundingMode(bool force = false);
@@ -121,6 +151,13 @@ class IRFrontend : public MIPSFrontendInterface {
 	void BranchRSZeroComp(MIPSOpcode op, IRComparison cc, bool andLink, bool likely);
 	void BranchRSRTComp(MIPSOpcode op, IRComparison cc, bool likely);
 
+	// Trace formation
+	bool CanContinueTrace(u32 targetAddr);
+	bool ContinueTrace(u32 targetAddr);
+	bool TraceFollows(u32 hotAddr, u32 coldAddr) const;
+	bool TraceTaken(const BranchInfo &branchInfo, u32 targetAddr);
+	bool TraceNotTaken(const BranchInfo &branchInfo, IRComparison cc, u32 targetAddr, IRReg lhs, IRReg rhs);
+
 	// Utilities to reduce duplicated code
 	void CompShiftImm(MIPSOpcode op, IROp shiftType, int sa);
 	void CompShiftVar(MIPSOpcode op, IROp shiftType);
@@ -140,6 +177,14 @@ class IRFrontend : public MIPSFrontendInterface {
 
 	int dontLogBlocks = 0;
 	int logBlocks = 0;
+
+	// Trace state, reset by DoJit().
+	std::function<u32(u32)> blockExecutionCount_;
+	bool traceMode_ = false;
+	int traceContinues_ = 0;
+	u32 traceSegmentStart_ = 0;
+	u32 traceEnd_ = 0;
+	std::vector<std::pair<u32, u32>> traceSegments_;
 };
 
 }  // namespace
@@ -384,6 +384,11 @@ class IRWriter {
 struct IROptions {
 	uint32_t disableFlags;
 	bool unalignedLoadStore;
+	// Whether blocks start with the cheap passes and get recompiled once hot.
+	// Native backends don't count executions, so they need the full passes up front.
+	bool tieredPasses;
+	// Whether hot recompiles follow hot branches into a trace instead of exiting.
+	bool traces;
 };
 
 const IRMeta *GetIRMeta(IROp op);
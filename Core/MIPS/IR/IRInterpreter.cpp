@@ -367,6 +367,8 @@ u32 IRInterpret(MIPSState *mips, const IRInst *inst, int count) {
 		{
 #if defined(_M_SSE)
 			_mm_store_ps(&mips->f[inst->dest], _mm_div_ps(_mm_load_ps(&mips->f[inst->src1]), _mm_load_ps(&mips->f[inst->src2])));
+#elif PPSSPP_ARCH(ARM64_NEON)
+			vst1q_f32(&mips->f[inst->dest], vdivq_f32(vld1q_f32(&mips->f[inst->src1]), vld1q_f32(&mips->f[inst->src2])));
 #else
 			for (int i = 0; i < 4; i++)
 				mips->f[inst->dest + i] = mips->f[inst->src1 + i] / mips->f[inst->src2 + i];
@@ -378,6 +380,8 @@ u32 IRInterpret(MIPSState *mips, const IRInst *inst, int count) {
 		{
 #if defined(_M_SSE)
 			_mm_store_ps(&mips->f[inst->dest], _mm_mul_ps(_mm_load_ps(&mips->f[inst->src1]), _mm_set1_ps(mips->f[inst->src2])));
+#elif PPSSPP_ARCH(ARM64_NEON)
+			vst1q_f32(&mips->f[inst->dest], vmulq_n_f32(vld1q_f32(&mips->f[inst->src1]), mips->f[inst->src2]));
 #else
 			for (int i = 0; i < 4; i++)
 				mips->f[inst->dest + i] = mips->f[inst->src1 + i] * mips->f[inst->src2];
@@ -1129,3 +1133,269 @@ u32 IRInterpret(MIPSState *mips, const IRInst *inst, int count) {
 	// We hit count.  If this is a full block, it was badly constructed.
 	return 0;
 }
+
+// Threaded dispatch.  Each block is pre-decoded once into a compact handler index per op, with
+// common pairs fused into a single handler.  With GCC/Clang we jump straight between handlers
+// using computed goto, which gives each handler its own indirect branch to predict.  Anything
+// without a fast handler falls back to IRInterpret() one op at a time.
+
+#define IR_THREADED_HANDLERS(X) \
+	X(End) X(Generic) \
+	X(SetConst) X(SetConstF) X(Mov) \
+	X(Add) X(Sub) X(And) X(Or) X(Xor) \
+	X(AddConst) X(SubConst) X(AndConst) X(OrConst) X(XorConst) \
+	X(ShlImm) X(ShrImm) X(SarImm) \
+	X(Slt) X(SltU) X(SltConst) X(SltUConst) X(MovZ) X(MovNZ) \
+	X(Load8) X(Load8Ext) X(Load16) X(Load16Ext) X(Load32) X(LoadFloat) \
+	X(Store8) X(Store16) X(Store32) X(StoreFloat) \
+	X(FAdd) X(FSub) X(FMul) X(FMov) \
+	X(Downcount) X(SetPCConst) \
+	X(ExitToConst) X(ExitToReg) X(ExitToPC) \
+	X(ExitToConstIfEq) X(ExitToConstIfNeq) \
+	X(ExitToConstIfGtZ) X(ExitToConstIfGeZ) X(ExitToConstIfLtZ) X(ExitToConstIfLeZ) \
+	X(AddConst_Load32) X(Add_Load32) X(AddConst_Store32) X(Downcount_ExitToConst)
+
+enum class IRThreadedOp : u8 {
+#define IR_THREADED_ENUM(name) name,
+	IR_THREADED_HANDLERS(IR_THREADED_ENUM)
+#undef IR_THREADED_ENUM
+	COUNT,
+};
+
+static IRThreadedOp ThreadedOpFor(IROp op) {
+	switch (op) {
+#define IR_THREADED_SIMPLE(name) case IROp::name: return IRThreadedOp::name;
+	IR_THREADED_SIMPLE(SetConst) IR_THREADED_SIMPLE(SetConstF) IR_THREADED_SIMPLE(Mov)
+	IR_THREADED_SIMPLE(Add) IR_THREADED_SIMPLE(Sub) IR_THREADED_SIMPLE(And) IR_THREADED_SIMPLE(Or) IR_THREADED_SIMPLE(Xor)
+	IR_THREADED_SIMPLE(AddConst) IR_THREADED_SIMPLE(SubConst) IR_THREADED_SIMPLE(AndConst) IR_THREADED_SIMPLE(OrConst) IR_THREADED_SIMPLE(XorConst)
+	IR_THREADED_SIMPLE(ShlImm) IR_THREADED_SIMPLE(ShrImm) IR_THREADED_SIMPLE(SarImm)
+	IR_THREADED_SIMPLE(Slt) IR_THREADED_SIMPLE(SltU) IR_THREADED_SIMPLE(SltConst) IR_THREADED_SIMPLE(SltUConst)
+	IR_THREADED_SIMPLE(MovZ) IR_THREADED_SIMPLE(MovNZ)
+	IR_THREADED_SIMPLE(Load8) IR_THREADED_SIMPLE(Load8Ext) IR_THREADED_SIMPLE(Load16) IR_THREADED_SIMPLE(Load16Ext)
+	IR_THREADED_SIMPLE(Load32) IR_THREADED_SIMPLE(LoadFloat)
+	IR_THREADED_SIMPLE(Store8) IR_THREADED_SIMPLE(Store16) IR_THREADED_SIMPLE(Store32) IR_THREADED_SIMPLE(StoreFloat)
+	IR_THREADED_SIMPLE(FAdd) IR_THREADED_SIMPLE(FSub) IR_THREADED_SIMPLE(FMul) IR_THREADED_SIMPLE(FMov)
+	IR_THREADED_SIMPLE(Downcount) IR_THREADED_SIMPLE(SetPCConst)
+	IR_THREADED_SIMPLE(ExitToConst) IR_THREADED_SIMPLE(ExitToReg) IR_THREADED_SIMPLE(ExitToPC)
+	IR_THREADED_SIMPLE(ExitToConstIfEq) IR_THREADED_SIMPLE(ExitToConstIfNeq)
+	IR_THREADED_SIMPLE(ExitToConstIfGtZ) IR_THREADED_SIMPLE(ExitToConstIfGeZ)
+	IR_THREADED_SIMPLE(ExitToConstIfLtZ) IR_THREADED_SIMPLE(ExitToConstIfLeZ)
+#undef IR_THREADED_SIMPLE
+	default:
+		return IRThreadedOp::Generic;
+	}
+}
+
+// Pairs that show up often enough to be worth a single dispatch.  The second op is left
+// in place, so the fused handler just reads both entries and skips two.
+static IRThreadedOp FusedOpFor(const IRInst &a, const IRInst &b) {
+	if (a.op == IROp::AddConst && b.op == IROp::Load32 && b.src1 == a.dest)
+		return IRThreadedOp::AddConst_Load32;
+	if (a.op == IROp::Add && b.op == IROp::Load32 && b.src1 == a.dest)
+		return IRThreadedOp::Add_Load32;
+	if (a.op == IROp::AddConst && b.op == IROp::Store32 && b.src1 == a.dest)
+		return IRThreadedOp::AddConst_Store32;
+	if (a.op == IROp::Downcount && b.op == IROp::ExitToConst)
+		return IRThreadedOp::Downcount_ExitToConst;
+	return IRThreadedOp::End;
+}
+
+void IRPredecodeThreaded(const IRInst *inst, int count, IRThreadedInst *code) {
+	for (int i = 0; i < count; ++i) {
+		IRThreadedInst &t = code[i];
+		t.handler = (u8)ThreadedOpFor(inst[i].op);
+		t.dest = inst[i].dest;
+		t.src1 = inst[i].src1;
+		t.src2 = inst[i].src2;
+		t.constant = inst[i].constant;
+	}
+	for (int i = 0; i + 1 < count; ++i) {
+		IRThreadedOp fused = FusedOpFor(inst[i], inst[i + 1]);
+		if (fused != IRThreadedOp::End) {
+			code[i].handler = (u8)fused;
+			// Don't let the second half start another pair.
+			++i;
+		}
+	}
+	// The End sentinel handles running off the end of a block.
+	code[count] = IRThreadedInst{ (u8)IRThreadedOp::End, 0, 0, 0, 0 };
+}
+
+#if defined(__GNUC__) || defined(__clang__)
+#define IR_THREADED_COMPUTED_GOTO
+#endif
+
+u32 IRInterpretThreaded(MIPSState *mips, const IRThreadedInst *code, const IRInst *inst) {
+	const IRThreadedInst *const start = code;
+	const IRThreadedInst *ip = code;
+
+#ifdef IR_THREADED_COMPUTED_GOTO
+	static const void *const labels[] = {
+#define IR_THREADED_LABEL(name) &&op_##name,
+		IR_THREADED_HANDLERS(IR_THREADED_LABEL)
+#undef IR_THREADED_LABEL
+	};
+	static_assert(ARRAY_SIZE(labels) == (size_t)IRThreadedOp::COUNT, "Threaded label table out of sync");
+#define HANDLER(name) op_##name:
+#define DISPATCH() goto *labels[ip->handler]
+	DISPATCH();
+	{
+#else
+#define HANDLER(name) case IRThreadedOp::name:
+#define DISPATCH() continue
+	while (true) {
+		switch ((IRThreadedOp)ip->handler) {
+#endif
+
+	HANDLER(End)
+		// We hit count.  If this is a full block, it was badly constructed.
+		return 0;
+
+	HANDLER(Generic)
+	{
+		u32 exitPC = IRInterpret(mips, inst + (ip - start), 1);
+		if (exitPC != 0)
+			return exitPC;
+		ip++;
+		DISPATCH();
+	}
+
+	HANDLER(SetConst) mips->r[ip->dest] = ip->constant; ip++; DISPATCH();
+	HANDLER(SetConstF) memcpy(&mips->f[ip->dest], &ip->constant, 4); ip++; DISPATCH();
+	HANDLER(Mov) mips->r[ip->dest] = mips->r[ip->src1]; ip++; DISPATCH();
+
+	HANDLER(Add) mips->r[ip->dest] = mips->r[ip->src1] + mips->r[ip->src2]; ip++; DISPATCH();
+	HANDLER(Sub) mips->r[ip->dest] = mips->r[ip->src1] - mips->r[ip->src2]; ip++; DISPATCH();
+	HANDLER(And) mips->r[ip->dest] = mips->r[ip->src1] & mips->r[ip->src2]; ip++; DISPATCH();
+	HANDLER(Or) mips->r[ip->dest] = mips->r[ip->src1] | mips->r[ip->src2]; ip++; DISPATCH();
+	HANDLER(Xor) mips->r[ip->dest] = mips->r[ip->src1] ^ mips->r[ip->src2]; ip++; DISPATCH();
+
+	HANDLER(AddConst) mips->r[ip->dest] = mips->r[ip->src1] + ip->constant; ip++; DISPATCH();
+	HANDLER(SubConst) mips->r[ip->dest] = mips->r[ip->src1] - ip->constant; ip++; DISPATCH();
+	HANDLER(AndConst) mips->r[ip->dest] = mips->r[ip->src1] & ip->constant; ip++; DISPATCH();
+	HANDLER(OrConst) mips->r[ip->dest] = mips->r[ip->src1] | ip->constant; ip++; DISPATCH();
+	HANDLER(XorConst) mips->r[ip->dest] = mips->r[ip->src1] ^ ip->constant; ip++; DISPATCH();
+
+	HANDLER(ShlImm) mips->r[ip->dest] = mips->r[ip->src1] << (int)ip->src2; ip++; DISPATCH();
+	HANDLER(ShrImm) mips->r[ip->dest] = mips->r[ip->src1] >> (int)ip->src2; ip++; DISPATCH();
+	HANDLER(SarImm) mips->r[ip->dest] = (s32)mips->r[ip->src1] >> (int)ip->src2; ip++; DISPATCH();
+
+	HANDLER(Slt) mips->r[ip->dest] = (s32)mips->r[ip->src1] < (s32)mips->r[ip->src2]; ip++; DISPATCH();
+	HANDLER(SltU) mips->r[ip->dest] = mips->r[ip->src1] < mips->r[ip->src2]; ip++; DISPATCH();
+	HANDLER(SltConst) mips->r[ip->dest] = (s32)mips->r[ip->src1] < (s32)ip->constant; ip++; DISPATCH();
+	HANDLER(SltUConst) mips->r[ip->dest] = mips->r[ip->src1] < ip->constant; ip++; DISPATCH();
+	HANDLER(MovZ)
+		if (mips->r[ip->src1] == 0)
+			mips->r[ip->dest] = mips->r[ip->src2];
+		ip++;
+		DISPATCH();
+	HANDLER(MovNZ)
+		if (mips->r[ip->src1] != 0)
+			mips->r[ip->dest] = mips->r[ip->src2];
+		ip++;
+		DISPATCH();
+
+	HANDLER(Load8) mips->r[ip->dest] = Memory::ReadUnchecked_U8(mips->r[ip->src1] + ip->constant); ip++; DISPATCH();
+	HANDLER(Load8Ext) mips->r[ip->dest] = SignExtend8ToU32(Memory::ReadUnchecked_U8(mips->r[ip->src1] + ip->constant)); ip++; DISPATCH();
+	HANDLER(Load16) mips->r[ip->dest] = Memory::ReadUnchecked_U16(mips->r[ip->src1] + ip->constant); ip++; DISPATCH();
+	HANDLER(Load16Ext) mips->r[ip->dest] = SignExtend16ToU32(Memory::ReadUnchecked_U16(mips->r[ip->src1] + ip->constant)); ip++; DISPATCH();
+	HANDLER(Load32) mips->r[ip->dest] = Memory::ReadUnchecked_U32(mips->r[ip->src1] + ip->constant); ip++; DISPATCH();
+	HANDLER(LoadFloat) mips->f[ip->dest] = Memory::ReadUnchecked_Float(mips->r[ip->src1] + ip->constant); ip++; DISPATCH();
+
+	// Note: dest doubles as src3 for stores.
+	HANDLER(Store8) Memory::WriteUnchecked_U8(mips->r[ip->dest], mips->r[ip->src1] + ip->constant); ip++; DISPATCH();
+	HANDLER(Store16) Memory::WriteUnchecked_U16(mips->r[ip->dest], mips->r[ip->src1] + ip->constant); ip++; DISPATCH();
+	HANDLER(Store32) Memory::WriteUnchecked_U32(mips->r[ip->dest], mips->r[ip->src1] + ip->constant); ip++; DISPATCH();
+	HANDLER(StoreFloat) Memory::WriteUnchecked_Float(mips->f[ip->dest], mips->r[ip->src1] + ip->constant); ip++; DISPATCH();
+
+	HANDLER(FAdd) mips->f[ip->dest] = mips->f[ip->src1] + mips->f[ip->src2]; ip++; DISPATCH();
+	HANDLER(FSub) mips->f[ip->dest] = mips->f[ip->src1] - mips->f[ip->src2]; ip++; DISPATCH();
+	HANDLER(FMul)
+		if ((my_isinf(mips->f[ip->src1]) && mips->f[ip->src2] == 0.0f) || (my_isinf(mips->f[ip->src2]) && mips->f[ip->src1] == 0.0f)) {
+			mips->fi[ip->dest] = 0x7fc00000;
+		} else {
+			mips->f[ip->dest] = mips->f[ip->src1] * mips->f[ip->src2];
+		}
+		ip++;
+		DISPATCH();
+	HANDLER(FMov) mips->f[ip->dest] = mips->f[ip->src1]; ip++; DISPATCH();
+
+	HANDLER(Downcount) mips->downcount -= ip->constant; ip++; DISPATCH();
+	HANDLER(SetPCConst) mips->pc = ip->constant; ip++; DISPATCH();
+
+	HANDLER(ExitToConst) return ip->constant;
+	HANDLER(ExitToReg) return mips->r[ip->src1];
+	HANDLER(ExitToPC) return mips->pc;
+
+	HANDLER(ExitToConstIfEq)
+		if (mips->r[ip->src1] == mips->r[ip->src2])
+			return ip->constant;
+		ip++;
+		DISPATCH();
+	HANDLER(ExitToConstIfNeq)
+		if (mips->r[ip->src1] != mips->r[ip->src2])
+			return ip->constant;
+		ip++;
+		DISPATCH();
+	HANDLER(ExitToConstIfGtZ)
+		if ((s32)mips->r[ip->src1] > 0)
+			return ip->constant;
+		ip++;
+		DISPATCH();
+	HANDLER(ExitToConstIfGeZ)
+		if ((s32)mips->r[ip->src1] >= 0)
+			return ip->constant;
+		ip++;
+		DISPATCH();
+	HANDLER(ExitToConstIfLtZ)
+		if ((s32)mips->r[ip->src1] < 0)
+			return ip->constant;
+		ip++;
+		DISPATCH();
+	HANDLER(ExitToConstIfLeZ)
+		if ((s32)mips->r[ip->src1] <= 0)
+			return ip->constant;
+		ip++;
+		DISPATCH();
+
+	HANDLER(AddConst_Load32)
+	{
+		u32 addr = mips->r[ip[0].src1] + ip[0].constant;
+		mips->r[ip[0].dest] = addr;
+		mips->r[ip[1].dest] = Memory::ReadUnchecked_U32(addr + ip[1].constant);
+		ip += 2;
+		DISPATCH();
+	}
+	HANDLER(Add_Load32)
+	{
+		u32 addr = mips->r[ip[0].src1] + mips->r[ip[0].src2];
+		mips->r[ip[0].dest] = addr;
+		mips->r[ip[1].dest] = Memory::ReadUnchecked_U32(addr + ip[1].constant);
+		ip += 2;
+		DISPATCH();
+	}
+	HANDLER(AddConst_Store32)
+	{
+		u32 addr = mips->r[ip[0].src1] + ip[0].constant;
+		mips->r[ip[0].dest] = addr;
+		// Read the value after the add, in case the store writes back the new address.
+		Memory::WriteUnchecked_U32(mips->r[ip[1].dest], addr + ip[1].constant);
+		ip += 2;
+		DISPATCH();
+	}
+	HANDLER(Downcount_ExitToConst)
+		mips->downcount -= ip[0].constant;
+		return ip[1].constant;
+
+#ifdef IR_THREADED_COMPUTED_GOTO
+	}
+#else
+		default:
+			Crash();
+		}
+	}
+#endif
+#undef HANDLER
+#undef DISPATCH
+	return 0;
+}
@@ -21,3 +21,21 @@ inline static u32 ReverseBits32(u32 v) {
 }
 
 u32 IRInterpret(MIPSState *ms, const IRInst *inst, int count);
+
+// Pre-decoded form of an IRInst for IRInterpretThreaded().  Same layout as IRInst, but
+// op is replaced with a handler index, which may cover this op and the next.
+struct IRThreadedInst {
+	u8 handler;
+	union {
+		u8 dest;
+		u8 src3;
+	};
+	u8 src1;
+	u8 src2;
+	u32 constant;
+};
+
+// Writes count + 1 entries to code (the last is an end sentinel.)
+void IRPredecodeThreaded(const IRInst *inst, int count, IRThreadedInst *code);
+// inst must be the array the code was decoded from, and is used for ops without a fast handler.
+u32 IRInterpretThreaded(MIPSState *ms, const IRThreadedInst *code, const IRInst *inst);
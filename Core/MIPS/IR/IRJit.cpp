@@ -16,11 +16,16 @@
 // https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
 
 #include "ppsspp_config.h"
+#include <memory>
+#include <mutex>
 #include <set>
 
 #include "ext/xxhash.h"
 #include "Common/Profiler/Profiler.h"
+#include "Common/Thread/ParallelLoop.h"
+#include "Common/Thread/ThreadManager.h"
 
+#include "Common/File/FileUtil.h"
 #include "Common/Log.h"
 #include "Common/Serialize/Serializer.h"
 #include "Common/StringUtils.h"
@@ -28,6 +33,8 @@
 #include "Core/Config.h"
 #include "Core/Core.h"
 #include "Core/CoreTiming.h"
+#include "Core/Debugger/Breakpoints.h"
+#include "Core/ELF/ParamSFO.h"
 #include "Core/HLE/sceKernelMemory.h"
 #include "Core/MemMap.h"
 #include "Core/MIPS/MIPS.h"
@@ -39,9 +46,12 @@
 #include "Core/MIPS/IR/IRInterpreter.h"
 #include "Core/MIPS/JitCommon/JitCommon.h"
 #include "Core/Reporting.h"
+#include "Core/System.h"
 
 namespace MIPSComp {
 
+u64 irInstructionsExecuted = 0;
+
 IRJit::IRJit(MIPSState *mipsState) : frontend_(mipsState->HasDefaultPrefix()), mips_(mipsState) {
 	// u32 size = 128 * 1024;
 	// blTrampolines_ = kernelMemory.Alloc(size, true, "trampoline");
@@ -53,10 +63,21 @@ IRJit::IRJit(MIPSState *mipsState) : frontend_(mipsState->HasDefaultPrefix()), m
 #if !PPSSPP_ARCH(RISCV64)
 	opts.unalignedLoadStore = (opts.disableFlags & (uint32_t)JitDisable::LSU_UNALIGNED) == 0;
 #endif
+	opts.tieredPasses = true;
+	opts.traces = g_Config.bIRTraces;
 	frontend_.SetOptions(opts);
+	if (opts.traces) {
+		frontend_.SetBlockExecutionCounter([this](u32 addr) -> u32 {
+			const IRBlock *b = blocks_.GetBlock(blocks_.GetBlockNumberFromStartAddress(addr));
+			return b ? b->GetExecutionCount() : 0;
+		});
+	}
+
+	useDiskCache_ = g_Config.bIRCache;
 }
 
 IRJit::~IRJit() {
+	SaveDiskCache();
 }
 
 void IRJit::DoState(PointerWrap &p) {
@@ -68,9 +89,17 @@ void IRJit::UpdateFCR31() {
 
 void IRJit::ClearCache() {
 	INFO_LOG(JIT, "IRJit: Clearing the cache!");
+	if (keepBlocksOnClear_)
+		KeepBlocksForDiskCache();
 	blocks_.Clear();
 }
 
+void IRJit::ClearCacheForRounding() {
+	keepBlocksOnClear_ = false;
+	ClearCache();
+	keepBlocksOnClear_ = true;
+}
+
 void IRJit::InvalidateCacheAt(u32 em_address, int length) {
 	blocks_.InvalidateICache(em_address, length);
 }
@@ -88,6 +117,7 @@ void IRJit::Compile(u32 em_address) {
 			b->Finalize(cookie);
 			if (b->IsValid()) {
 				// Success, we're done.
+				FinalizeTargetBlock(b, block_num);
 				return;
 			}
 		}
@@ -104,13 +134,22 @@ void IRJit::Compile(u32 em_address) {
 
 	if (frontend_.CheckRounding(em_address)) {
 		// Our assumptions are all wrong so it's clean-slate time.
-		ClearCache();
+		ClearCacheForRounding();
 		CompileBlock(em_address, instructions, mipsBytes, false);
 	}
 }
 
 bool IRJit::CompileBlock(u32 em_address, std::vector<IRInst> &instructions, u32 &mipsBytes, bool preload) {
-	frontend_.DoJit(em_address, instructions, mipsBytes, preload);
+	GenerateBlockIR(frontend_, em_address, instructions, mipsBytes, preload);
+	return InstallBlock(em_address, instructions, mipsBytes, preload);
+}
+
+void IRJit::GenerateBlockIR(IRFrontend &frontend, u32 em_address, std::vector<IRInst> &instructions, u32 &mipsBytes, bool preload) {
+	if (!FindDiskCacheBlock(em_address, instructions, mipsBytes))
+		frontend.DoJit(em_address, instructions, mipsBytes, preload);
+}
+
+bool IRJit::InstallBlock(u32 em_address, const std::vector<IRInst> &instructions, u32 mipsBytes, bool preload) {
 	if (instructions.empty()) {
 		_dbg_assert_(preload);
 		// We return true when preloading so it doesn't abort.
@@ -123,25 +162,116 @@ bool IRJit::CompileBlock(u32 em_address, std::vector<IRInst> &instructions, u32
 		return false;
 	}
 
+	blocks_.SetBlockInstructions(block_num, instructions);
 	IRBlock *b = blocks_.GetBlock(block_num);
-	b->SetInstructions(instructions);
 	b->SetOriginalSize(mipsBytes);
-	if (preload) {
+	if (preload || useDiskCache_) {
 		// Hash, then only update page stats, don't link yet.
-		// TODO: Should we always hash?  Then we can reuse blocks.
+		// The disk cache needs the hash of the code as it was when compiled, too.
 		b->UpdateHash();
 	}
 	if (!CompileTargetBlock(b, block_num, preload))
 		return false;
 	// Overwrites the first instruction, and also updates stats.
 	blocks_.FinalizeBlock(block_num, preload);
+	if (!preload)
+		FinalizeTargetBlock(b, block_num);
 
 	return true;
 }
 
+void IRJit::RecompileHotBlock(u32 em_address, int block_num) {
+	PROFILE_THIS_SCOPE("jitc");
+
+	// A syscall in the block may have invalidated or cleared it already, and after a clear
+	// the number may even belong to a different block now.
+	const IRBlock *oldBlock = blocks_.GetBlock(block_num);
+	if (!oldBlock || !oldBlock->IsValid())
+		return;
+	u32 oldStart, oldSize;
+	oldBlock->GetRange(oldStart, oldSize);
+	if (oldStart != em_address)
+		return;
+	u32 execCount = oldBlock->GetExecutionCount();
+
+	std::vector<IRInst> instructions;
+	u32 mipsBytes;
+	// Skips the disk cache on purpose, it'd likely give us back the same cold block.
+	frontend_.DoJit(em_address, instructions, mipsBytes, false, true);
+	if (instructions.empty())
+		return;
+
+	blocks_.DestroyBlock(block_num);
+	if (!InstallBlock(em_address, instructions, mipsBytes, false)) {
+		// Out of block numbers, the next Compile() will start over.
+		ClearCache();
+		return;
+	}
+	// Keep the count, so the new block doesn't hit the threshold again.
+	IRBlock *b = blocks_.GetBlock(blocks_.GetNumBlocks() - 1);
+	b->SetExecutionCount(execCount);
+	b->SetHot();
+
+	if (frontend_.CheckRounding(em_address)) {
+		// Our assumptions are all wrong so it's clean-slate time.
+		ClearCacheForRounding();
+	}
+}
+
 void IRJit::CompileFunction(u32 start_address, u32 length) {
 	PROFILE_THIS_SCOPE("jitc");
 
+	std::vector<PrecompiledBlock> blocks;
+	GenerateFunctionBlocks(frontend_, start_address, length, blocks);
+	InstallFunctionBlocks(blocks);
+}
+
+void IRJit::CompileFunctions(const std::vector<std::pair<u32, u32>> &functions) {
+	PROFILE_THIS_SCOPE("jitc");
+
+	// Workers only read the disk cache, so load it first.
+	if (useDiskCache_ && !diskCacheLoaded_)
+		LoadDiskCache();
+
+	int numChunks = std::min((int)functions.size(), g_threadManager.GetNumLooperThreads());
+	if (numChunks <= 1) {
+		for (const auto &func : functions)
+			CompileFunction(func.first, func.second);
+		return;
+	}
+
+	// Each chunk gets its own frontend, since it keeps state while compiling.
+	// Create them here, as the constructor resets debugger state.
+	std::vector<std::unique_ptr<IRFrontend>> frontends;
+	for (int i = 0; i < numChunks; ++i) {
+		frontends.push_back(std::make_unique<IRFrontend>(mips_->HasDefaultPrefix()));
+		frontends.back()->SetOptions(frontend_.GetOptions());
+		// Otherwise blocks would be compiled without rounding mode checks the game already needs.
+		frontends.back()->CopyDetectedState(frontend_);
+	}
+
+	// The frontend and passes only read emulated memory and blocks_, which nothing changes until we install.
+	std::vector<std::vector<PrecompiledBlock>> results(functions.size());
+	ParallelRangeLoop(&g_threadManager, [&](int l, int h) {
+		for (int chunk = l; chunk < h; ++chunk) {
+			// Interleave so large modules with functions of similar sizes together still balance.
+			for (size_t i = chunk; i < functions.size(); i += numChunks) {
+				GenerateFunctionBlocks(*frontends[chunk], functions[i].first, functions[i].second, results[i]);
+			}
+		}
+	}, 0, numChunks, 1);
+
+	for (const auto &frontend : frontends)
+		frontend_.MergeDetectedState(*frontend);
+
+	// Installing allocates block numbers and may emit target code, so it stays on this thread.
+	for (const auto &blocks : results) {
+		if (!InstallFunctionBlocks(blocks))
+			break;
+	}
+}
+
+void IRJit::GenerateFunctionBlocks(IRFrontend &frontend, u32 start_address, u32 length, std::vector<PrecompiledBlock> &blocks) {
 	// Note: we don't actually write emuhacks yet, so we can validate hashes.
 	// This way, if the game changes the code afterward, we'll catch even without icache invalidation.
 
@@ -160,18 +290,12 @@ void IRJit::CompileFunction(u32 start_address, u32 length) {
 			continue;
 		}
 
-		std::vector<IRInst> instructions;
-		u32 mipsBytes;
-		if (!CompileBlock(em_address, instructions, mipsBytes, true)) {
-			// Ran out of block numbers - let's hope there's no more code it needs to run.
-			// Will flush when actually compiling.
-			ERROR_LOG(JIT, "Ran out of block numbers while compiling function");
-			return;
-		}
-
+		PrecompiledBlock block;
+		block.em_address = em_address;
+		GenerateBlockIR(frontend, em_address, block.instructions, block.mipsBytes, true);
 		doneAddresses.insert(em_address);
 
-		for (const IRInst &inst : instructions) {
+		for (const IRInst &inst : block.instructions) {
 			u32 exit = 0;
 
 			switch (inst.op) {
@@ -206,12 +330,27 @@ void IRJit::CompileFunction(u32 start_address, u32 length) {
 		}
 
 		// Also include after the block for jal returns.
-		if (em_address + mipsBytes < start_address + length) {
-			pendingAddresses.push_back(em_address + mipsBytes);
+		if (em_address + block.mipsBytes < start_address + length) {
+			pendingAddresses.push_back(em_address + block.mipsBytes);
 		}
+
+		if (!block.instructions.empty())
+			blocks.push_back(std::move(block));
 	}
 }
 
+bool IRJit::InstallFunctionBlocks(const std::vector<PrecompiledBlock> &blocks) {
+	for (const PrecompiledBlock &block : blocks) {
+		if (!InstallBlock(block.em_address, block.instructions, block.mipsBytes, true)) {
+			// Ran out of block numbers - let's hope there's no more code it needs to run.
+			// Will flush when actually compiling.
+			ERROR_LOG(JIT, "Ran out of block numbers while compiling function");
+			return false;
+		}
+	}
+	return true;
+}
+
 void IRJit::RunLoopUntil(u64 globalticks) {
 	PROFILE_THIS_SCOPE("jit");
 
@@ -225,6 +364,8 @@ void IRJit::RunLoopUntil(u64 globalticks) {
 		if (coreState != 0) {
 			break;
 		}
+		// No block is running here, so storage moved by compiles or invalidation can go.
+		blocks_.ReleaseRetiredStorage();
 		while (mips_->downcount >= 0) {
 			u32 inst = Memory::ReadUnchecked_U32(mips_->pc);
 			u32 opcode = inst & 0xFF000000;
@@ -232,12 +373,23 @@ void IRJit::RunLoopUntil(u64 globalticks) {
 				u32 data = inst & 0xFFFFFF;
 				IRBlock *block = blocks_.GetBlock(data);
 				u32 startPC = mips_->pc;
-				mips_->pc = IRInterpret(mips_, block->GetInstructions(), block->GetNumInstructions());
+				bool becameHot = block->CountExecution();
+				// Counts whole blocks, so a taken early exit overcounts slightly.  Good enough for benchmarks.
+				// Note that block may move during a syscall, so don't touch it after running.
+				if (coreCollectDebugStats)
+					irInstructionsExecuted += block->GetNumInstructions();
+				const IRInst *instPtr = blocks_.GetBlockInstructionPtr(*block);
+				if (jo.irThreadedDispatch)
+					mips_->pc = IRInterpretThreaded(mips_, blocks_.GetBlockThreadedPtr(*block), instPtr);
+				else
+					mips_->pc = IRInterpret(mips_, instPtr, block->GetNumInstructions());
 				// Note: this will "jump to zero" on a badly constructed block missing exits.
 				if (!Memory::IsValidAddress(mips_->pc) || (mips_->pc & 3) != 0) {
 					Core_ExecException(mips_->pc, startPC, ExecExceptionType::JUMP);
 					break;
 				}
+				if (becameHot)
+					RecompileHotBlock(startPC, data);
 			} else {
 				// RestoreRoundingMode(true);
 				Compile(mips_->pc);
@@ -262,6 +414,130 @@ void IRJit::UnlinkBlock(u8 *checkedEntry, u32 originalAddress) {
 	Crash();
 }
 
+IRBlockIndex::Table::Table(u32 capacity) : slots(new std::atomic<u64>[capacity]), mask(capacity - 1) {
+	for (u32 i = 0; i < capacity; ++i)
+		slots[i].store(0, std::memory_order_relaxed);
+}
+
+IRBlockIndex::Table::~Table() {
+	delete[] slots;
+}
+
+IRBlockIndex::IRBlockIndex() : table_(new Table(1024)) {
+}
+
+IRBlockIndex::~IRBlockIndex() {
+	for (Table *old : retired_)
+		delete old;
+	delete table_.load();
+}
+
+// A removed entry.  Probes continue past it, unlike an empty (zero) slot.
+static const u64 TOMBSTONE = 0xFFFFFFFF;
+
+int IRBlockIndex::Find(u32 addr) const {
+	// Announce ourselves before loading the table, so ReleaseRetired() won't free it under us.
+	readers_++;
+	const Table *table = table_.load();
+	int result = -1;
+	for (u32 pos = Hash(addr) & table->mask; ; pos = (pos + 1) & table->mask) {
+		u64 slot = table->slots[pos].load(std::memory_order_acquire);
+		if (slot == 0)
+			break;
+		if ((u32)(slot >> 32) == addr) {
+			result = (int)(u32)slot;
+			break;
+		}
+	}
+	readers_--;
+	return result;
+}
+
+void IRBlockIndex::Add(u32 addr, int blockNum) {
+	Table *table = table_.load(std::memory_order_relaxed);
+	// Keep it under 3/4 full, counting tombstones since they lengthen probes too.
+	if ((used_ + tombstones_ + 1) * 4 > (table->mask + 1) * 3) {
+		u32 capacity = table->mask + 1;
+		Rebuild((used_ + 1) * 2 > capacity ? capacity * 2 : capacity);
+		table = table_.load(std::memory_order_relaxed);
+	}
+
+	const u64 value = ((u64)addr << 32) | (u32)blockNum;
+	u32 reuse = (u32)-1;
+	for (u32 pos = Hash(addr) & table->mask; ; pos = (pos + 1) & table->mask) {
+		u64 slot = table->slots[pos].load(std::memory_order_relaxed);
+		if (slot != 0 && slot != TOMBSTONE && (u32)(slot >> 32) == addr) {
+			table->slots[pos].store(value, std::memory_order_release);
+			return;
+		}
+		if (slot == TOMBSTONE && reuse == (u32)-1)
+			reuse = pos;
+		if (slot == 0) {
+			if (reuse != (u32)-1) {
+				tombstones_--;
+				pos = reuse;
+			}
+			table->slots[pos].store(value, std::memory_order_release);
+			used_++;
+			return;
+		}
+	}
+}
+
+void IRBlockIndex::Remove(u32 addr, int blockNum) {
+	Table *table = table_.load(std::memory_order_relaxed);
+	const u64 value = ((u64)addr << 32) | (u32)blockNum;
+	for (u32 pos = Hash(addr) & table->mask; ; pos = (pos + 1) & table->mask) {
+		u64 slot = table->slots[pos].load(std::memory_order_relaxed);
+		if (slot == 0)
+			return;
+		if (slot == value) {
+			table->slots[pos].store(TOMBSTONE, std::memory_order_release);
+			used_--;
+			tombstones_++;
+			return;
+		}
+	}
+}
+
+void IRBlockIndex::Rebuild(u32 capacity) {
+	Table *oldTable = table_.load(std::memory_order_relaxed);
+	Table *newTable = new Table(capacity);
+	for (u32 i = 0; i <= oldTable->mask; ++i) {
+		u64 slot = oldTable->slots[i].load(std::memory_order_relaxed);
+		if (slot == 0 || slot == TOMBSTONE)
+			continue;
+		u32 pos = Hash((u32)(slot >> 32)) & newTable->mask;
+		while (newTable->slots[pos].load(std::memory_order_relaxed) != 0)
+			pos = (pos + 1) & newTable->mask;
+		newTable->slots[pos].store(slot, std::memory_order_relaxed);
+	}
+	// Readers see either the old table (still valid until released) or the complete new one.
+	table_.store(newTable);
+	retired_.push_back(oldTable);
+	tombstones_ = 0;
+}
+
+void IRBlockIndex::Clear() {
+	Table *table = table_.load(std::memory_order_relaxed);
+	for (u32 i = 0; i <= table->mask; ++i)
+		table->slots[i].store(0, std::memory_order_relaxed);
+	used_ = 0;
+	tombstones_ = 0;
+	ReleaseRetired();
+}
+
+void IRBlockIndex::ReleaseRetired() {
+	if (retired_.empty())
+		return;
+	// Any Find() starting after this loads the current table, so once none are running the old ones are unreachable.
+	if (readers_ != 0)
+		return;
+	for (Table *old : retired_)
+		delete old;
+	retired_.clear();
+}
+
 void IRBlockCache::Clear() {
 	for (int i = 0; i < (int)blocks_.size(); ++i) {
 		int cookie = blocks_[i].GetTargetOffset() < 0 ? i : blocks_[i].GetTargetOffset();
@@ -269,26 +545,90 @@ void IRBlockCache::Clear() {
 	}
 	blocks_.clear();
 	byPage_.clear();
+	byStartAddress_.Clear();
+	arena_.Reset(0);
+	threadedArena_.Reset(0);
+	deadInstructions_ = 0;
 }
 
-void IRBlockCache::InvalidateICache(u32 address, u32 length) {
+std::vector<int> IRBlockCache::InvalidateICache(u32 address, u32 length) {
 	u32 startPage = AddressToPage(address);
 	u32 endPage = AddressToPage(address + length);
 
+	std::vector<int> found;
 	for (u32 page = startPage; page <= endPage; ++page) {
 		const auto iter = byPage_.find(page);
 		if (iter == byPage_.end())
 			continue;
 
-		const std::vector<int> &blocksInPage = iter->second;
+		// Drop destroyed blocks as we go, so pages don't build up with recompiles of the same code.
+		std::vector<int> &blocksInPage = iter->second;
+		size_t kept = 0;
 		for (int i : blocksInPage) {
 			if (blocks_[i].OverlapsRange(address, length)) {
-				// Not removing from the page, hopefully doesn't build up with small recompiles.
-				int cookie = blocks_[i].GetTargetOffset() < 0 ? i : blocks_[i].GetTargetOffset();
-				blocks_[i].Destroy(cookie);
+				DestroyBlock(i);
+				found.push_back(i);
 			}
+			if (!blocks_[i].IsDestroyed())
+				blocksInPage[kept++] = i;
 		}
+		blocksInPage.resize(kept);
 	}
+
+	// Once most of the arena is garbage, it's worth copying out the live blocks.
+	if (deadInstructions_ >= 4096 && deadInstructions_ > arena_.Size() / 2)
+		Compact();
+
+	return found;
+}
+
+void IRBlockCache::DestroyBlock(int i) {
+	int cookie = blocks_[i].GetTargetOffset() < 0 ? i : blocks_[i].GetTargetOffset();
+	if (!blocks_[i].IsDestroyed()) {
+		u32 startAddr, size;
+		blocks_[i].GetRange(startAddr, size);
+		byStartAddress_.Remove(startAddr, i);
+		deadInstructions_ += blocks_[i].GetNumInstructions();
+	}
+	blocks_[i].Destroy(cookie);
+}
+
+void IRBlockCache::SetBlockInstructions(int i, const std::vector<IRInst> &inst) {
+	u32 offset = arena_.Alloc((u32)inst.size());
+	if (!inst.empty())
+		memcpy(arena_.Ptr(offset), &inst[0], sizeof(IRInst) * inst.size());
+	blocks_[i].SetInstructionRange(offset, (int)inst.size());
+}
+
+const IRThreadedInst *IRBlockCache::GetBlockThreadedPtr(IRBlock &block) {
+	if (block.GetThreadedOffset() < 0) {
+		int count = block.GetNumInstructions();
+		u32 offset = threadedArena_.Alloc(count + 1);
+		IRPredecodeThreaded(arena_.Ptr(block.GetInstructionOffset()), count, threadedArena_.Ptr(offset));
+		block.SetThreadedOffset((int)offset);
+	}
+	return threadedArena_.Ptr(block.GetThreadedOffset());
+}
+
+void IRBlockCache::Compact() {
+	// The old buffer stays alive until ReleaseRetiredStorage(), so we can copy from it directly.
+	const IRInst *oldArena = arena_.Ptr(0);
+	arena_.Reset(arena_.Size() - deadInstructions_);
+	// Cheaper to decode again than to track which threaded blocks are live.
+	threadedArena_.Reset(0);
+
+	for (IRBlock &b : blocks_) {
+		if (b.IsDestroyed()) {
+			b.SetInstructionRange(0, 0);
+			continue;
+		}
+		int count = b.GetNumInstructions();
+		u32 offset = arena_.Alloc(count);
+		if (count != 0)
+			memcpy(arena_.Ptr(offset), oldArena + b.GetInstructionOffset(), sizeof(IRInst) * count);
+		b.SetInstructionRange(offset, count);
+	}
+	deadInstructions_ = 0;
 }
 
 void IRBlockCache::FinalizeBlock(int i, bool preload) {
@@ -306,6 +646,7 @@ void IRBlockCache::FinalizeBlock(int i, bool preload) {
 	for (u32 page = startPage; page <= endPage; ++page) {
 		byPage_[page].push_back(i);
 	}
+	byStartAddress_.Add(startAddr, i);
 }
 
 u32 IRBlockCache::AddressToPage(u32 addr) const {
@@ -314,23 +655,9 @@ u32 IRBlockCache::AddressToPage(u32 addr) const {
 }
 
 int IRBlockCache::FindPreloadBlock(u32 em_address) {
-	u32 page = AddressToPage(em_address);
-	auto iter = byPage_.find(page);
-	if (iter == byPage_.end())
-		return -1;
-
-	const std::vector<int> &blocksInPage = iter->second;
-	for (int i : blocksInPage) {
-		u32 start, mipsBytes;
-		blocks_[i].GetRange(start, mipsBytes);
-
-		if (start == em_address) {
-			if (blocks_[i].HashMatches()) {
-				return i;
-			}
-		}
-	}
-
+	int i = byStartAddress_.Find(em_address);
+	if (i >= 0 && blocks_[i].HashMatches())
+		return i;
 	return -1;
 }
 
@@ -397,8 +724,9 @@ JitBlockDebugInfo IRBlockCache::GetBlockDebugInfo(int blockNum) const {
 		debugInfo.origDisasm.push_back(mipsDis);
 	}
 
+	const IRInst *instructions = GetBlockInstructionPtr(ir);
 	for (int i = 0; i < ir.GetNumInstructions(); i++) {
-		IRInst inst = ir.GetInstructions()[i];
+		IRInst inst = instructions[i];
 		char buffer[256];
 		DisassembleIR(buffer, sizeof(buffer), inst);
 		debugInfo.irDisasm.push_back(buffer);
@@ -411,6 +739,13 @@ void IRBlockCache::ComputeStats(BlockCacheStats &bcStats) const {
 	double maxBloat = 0.0;
 	double minBloat = 1000000000.0;
 	for (const auto &b : blocks_) {
+		if (b.IsHot()) {
+			bcStats.numHotBlocks++;
+			bcStats.hotExecutions += b.GetExecutionCount();
+		} else {
+			bcStats.coldExecutions += b.GetExecutionCount();
+		}
+
 		double codeSize = (double)b.GetNumInstructions() * sizeof(IRInst);
 		if (codeSize == 0)
 			continue;
@@ -431,31 +766,17 @@ void IRBlockCache::ComputeStats(BlockCacheStats &bcStats) const {
 		bcStats.bloatMap[bloat] = origAddr;
 	}
 	bcStats.numBlocks = (int)blocks_.size();
+	bcStats.hotThreshold = IRBlock::HOT_THRESHOLD;
 	bcStats.minBloat = minBloat;
 	bcStats.maxBloat = maxBloat;
 	bcStats.avgBloat = totalBloat / (double)blocks_.size();
+	bcStats.codeMemoryUsed = (arena_.Size() - deadInstructions_) * sizeof(IRInst) + threadedArena_.Size() * sizeof(IRThreadedInst);
+	bcStats.codeMemoryAllocated = arena_.Capacity() * sizeof(IRInst) + threadedArena_.Capacity() * sizeof(IRThreadedInst);
 }
 
 int IRBlockCache::GetBlockNumberFromStartAddress(u32 em_address, bool realBlocksOnly) const {
-	u32 page = AddressToPage(em_address);
-
-	const auto iter = byPage_.find(page);
-	if (iter == byPage_.end())
-		return -1;
-
-	const std::vector<int> &blocksInPage = iter->second;
-	int best = -1;
-	for (int i : blocksInPage) {
-		uint32_t start, size;
-		blocks_[i].GetRange(start, size);
-		if (start == em_address) {
-			best = i;
-			if (blocks_[i].IsValid()) {
-				return i;
-			}
-		}
-	}
-	return best;
+	// Only live blocks are indexed, and there's at most one per address.
+	return byStartAddress_.Find(em_address);
 }
 
 bool IRBlock::HasOriginalFirstOp() const {
@@ -492,19 +813,19 @@ void IRBlock::Destroy(int cookie) {
 	}
 }
 
-u64 IRBlock::CalculateHash() const {
-	if (origAddr_) {
+u64 IRBlock::CalculateHash(u32 origAddr, u32 origSize) {
+	if (origAddr && origSize != 0) {
 		// This is unfortunate.  In case of emuhacks, we have to make a copy.
 		std::vector<u32> buffer;
-		buffer.resize(origSize_ / 4);
+		buffer.resize(origSize / 4);
 		size_t pos = 0;
-		for (u32 off = 0; off < origSize_; off += 4) {
+		for (u32 off = 0; off < origSize; off += 4) {
 			// Let's actually hash the replacement, if any.
-			MIPSOpcode instr = Memory::ReadUnchecked_Instruction(origAddr_ + off, false);
+			MIPSOpcode instr = Memory::ReadUnchecked_Instruction(origAddr + off, false);
 			buffer[pos++] = instr.encoding;
 		}
 
-		return XXH3_64bits(&buffer[0], origSize_);
+		return XXH3_64bits(&buffer[0], origSize);
 	}
 
 	return 0;
@@ -516,6 +837,238 @@ bool IRBlock::OverlapsRange(u32 addr, u32 size) const {
 	return addr + size > origAddr && addr < origAddr + origSize_;
 }
 
+static const u32 IR_CACHE_HEADER_MAGIC = 0x43524950;  // 'PIRC'
+static const u32 IR_CACHE_VERSION = 2;
+
+struct IRCacheHeader {
+	u32 magic;
+	u32 version;
+	u64 optionsHash;
+	u32 numBlocks;
+	u32 numInstructions;
+};
+
+// Writes the IR cache file on an I/O thread, so shutdown doesn't wait for it.
+class SaveIRCacheTask : public Task {
+public:
+	SaveIRCacheTask(const Path &path, std::vector<u8> &&data) : path_(path), data_(std::move(data)) {}
+
+	TaskType Type() const override { return TaskType::IO_BLOCKING; }
+	TaskPriority Priority() const override { return TaskPriority::LOW; }
+
+	void Run() override {
+		// Only one at a time, in case a quick restart saves the same file again.
+		std::lock_guard<std::mutex> guard(saveLock_);
+
+		// Write next to it first, so a jit loading the file meanwhile never sees it half written.
+		Path tempPath = path_.WithExtraExtension(".tmp");
+		FILE *f = File::OpenCFile(tempPath, "wb");
+		if (!f)
+			return;
+		bool success = fwrite(data_.data(), 1, data_.size(), f) == data_.size();
+		success = fclose(f) == 0 && success;
+
+		if (success) {
+			File::Delete(path_);
+			success = File::Rename(tempPath, path_);
+		}
+		if (!success) {
+			ERROR_LOG(JIT, "Failed to write IR cache");
+			File::Delete(tempPath);
+		}
+	}
+
+private:
+	static std::mutex saveLock_;
+	Path path_;
+	std::vector<u8> data_;
+};
+
+std::mutex SaveIRCacheTask::saveLock_;
+
+u64 IRJit::DiskCacheOptionsHash() const {
+	// Anything that changes the IR generated for the same MIPS code should go in here.
+	// The IROp numbering itself may change between builds.
+	const IROptions &opts = frontend_.GetOptions();
+	std::string key = StringFromFormat("%s %08x %d %d %d %d", PPSSPP_GIT_VERSION, opts.disableFlags, (int)opts.unalignedLoadStore, (int)opts.tieredPasses, (int)opts.traces, (int)g_Config.bFastMemory);
+	return XXH3_64bits(key.data(), key.size());
+}
+
+bool IRJit::FindDiskCacheBlock(u32 em_address, std::vector<IRInst> &instructions, u32 &mipsBytes) {
+	if (!useDiskCache_)
+		return false;
+	if (!diskCacheLoaded_)
+		LoadDiskCache();
+	// Breakpoints and memchecks change the IR, so don't skip the frontend.
+	if (CBreakPoints::HasBreakPoints() || CBreakPoints::HasMemChecks())
+		return false;
+
+	auto iter = diskCacheBlocks_.find(em_address);
+	if (iter == diskCacheBlocks_.end())
+		return false;
+
+	const bool needRounding = frontend_.NeedsRoundingChecks();
+	for (const DiskCacheBlock &cached : iter->second) {
+		// Blocks compiled before rounding mode use was detected would ignore the mode.
+		if (needRounding && (cached.flags & DISK_CACHE_ROUNDING) == 0)
+			continue;
+		if (!Memory::IsValidRange(em_address, cached.origSize))
+			continue;
+		if (IRBlock::CalculateHash(em_address, cached.origSize) != cached.hash)
+			continue;
+
+		const IRInst *start = &diskCacheInstructions_[cached.instOffset];
+		instructions.assign(start, start + cached.numInstructions);
+		mipsBytes = cached.origSize;
+		return true;
+	}
+	return false;
+}
+
+void IRJit::KeepBlocksForDiskCache() {
+	if (!useDiskCache_ || !diskCacheLoaded_)
+		return;
+	// Blocks may have been compiled with breakpoint checks.
+	if (CBreakPoints::HasBreakPoints() || CBreakPoints::HasMemChecks())
+		return;
+
+	// Only set once blocks were rebuilt after detecting rounding mode use, so all live blocks have checks.
+	const u32 flags = frontend_.CompilesRoundingChecks() ? DISK_CACHE_ROUNDING : 0;
+	for (int i = 0; i < blocks_.GetNumBlocks(); ++i) {
+		const IRBlock *b = blocks_.GetBlock(i);
+		u32 origAddr, origSize;
+		b->GetRange(origAddr, origSize);
+		if (b->IsDestroyed() || b->GetHash() == 0 || b->GetNumInstructions() == 0)
+			continue;
+
+		if (diskCacheInstructions_.size() + b->GetNumInstructions() > MAX_DISK_CACHE_INSTRUCTIONS)
+			break;
+
+		std::vector<DiskCacheBlock> &cached = diskCacheBlocks_[origAddr];
+		bool found = false;
+		for (DiskCacheBlock &c : cached) {
+			if (c.hash == b->GetHash() && c.origSize == origSize) {
+				found = true;
+				// Prefer a version with rounding checks, it works either way.
+				if (flags > c.flags) {
+					c.instOffset = (u32)diskCacheInstructions_.size();
+					c.numInstructions = (u32)b->GetNumInstructions();
+					c.flags = flags;
+					const IRInst *instructions = blocks_.GetBlockInstructionPtr(*b);
+					diskCacheInstructions_.insert(diskCacheInstructions_.end(), instructions, instructions + c.numInstructions);
+				}
+			}
+		}
+		if (found || cached.size() >= MAX_DISK_CACHE_VERSIONS)
+			continue;
+
+		const IRInst *instructions = blocks_.GetBlockInstructionPtr(*b);
+		DiskCacheBlock entry;
+		entry.origAddr = origAddr;
+		entry.origSize = origSize;
+		entry.hash = b->GetHash();
+		entry.instOffset = (u32)diskCacheInstructions_.size();
+		entry.numInstructions = (u32)b->GetNumInstructions();
+		entry.flags = flags;
+		entry.unused = 0;
+		diskCacheInstructions_.insert(diskCacheInstructions_.end(), instructions, instructions + entry.numInstructions);
+		cached.push_back(entry);
+	}
+}
+
+void IRJit::LoadDiskCache() {
+	diskCacheLoaded_ = true;
+
+	// We're created before the game is loaded, so figure out the filename on first compile.
+	std::string discID = g_paramSFO.GetDiscID();
+	if (discID.empty()) {
+		useDiskCache_ = false;
+		return;
+	}
+	File::CreateFullPath(GetSysDirectory(DIRECTORY_APP_CACHE));
+	// Each backend runs different passes, so keep a file per backend rather than overwrite each other's.
+	diskCachePath_ = GetSysDirectory(DIRECTORY_APP_CACHE) / (discID + "." + DiskCacheBackendName() + ".ircache");
+
+	FILE *f = File::OpenCFile(diskCachePath_, "rb");
+	if (!f)
+		return;
+
+	IRCacheHeader header{};
+	bool success = fread(&header, sizeof(header), 1, f) == 1;
+	if (!success || header.magic != IR_CACHE_HEADER_MAGIC || header.version != IR_CACHE_VERSION) {
+		WARN_LOG(JIT, "IR cache version mismatch, ignoring");
+		fclose(f);
+		return;
+	}
+	if (header.optionsHash != DiskCacheOptionsHash()) {
+		// Different build or settings.  We'll overwrite it on exit.
+		INFO_LOG(JIT, "IR cache was made with different options, ignoring");
+		fclose(f);
+		return;
+	}
+
+	if (header.numInstructions > MAX_DISK_CACHE_INSTRUCTIONS || header.numBlocks > header.numInstructions) {
+		WARN_LOG(JIT, "IR cache too large, ignoring");
+		fclose(f);
+		return;
+	}
+
+	std::vector<DiskCacheBlock> blocks;
+	blocks.resize(header.numBlocks);
+	diskCacheInstructions_.resize(header.numInstructions);
+	success = header.numBlocks == 0 || fread(&blocks[0], sizeof(DiskCacheBlock), header.numBlocks, f) == header.numBlocks;
+	success = success && (header.numInstructions == 0 || fread(&diskCacheInstructions_[0], sizeof(IRInst), header.numInstructions, f) == header.numInstructions);
+	fclose(f);
+
+	for (const DiskCacheBlock &b : blocks) {
+		if (!success)
+			break;
+		if (b.instOffset > header.numInstructions || b.numInstructions > header.numInstructions - b.instOffset || (b.origSize & 3) != 0) {
+			success = false;
+			break;
+		}
+		diskCacheBlocks_[b.origAddr].push_back(b);
+	}
+
+	if (!success) {
+		ERROR_LOG(JIT, "IR cache truncated or corrupt, deleting");
+		diskCacheBlocks_.clear();
+		diskCacheInstructions_.clear();
+		File::Delete(diskCachePath_);
+		return;
+	}
+	INFO_LOG(JIT, "Loaded IR cache: %d blocks", (int)header.numBlocks);
+}
+
+void IRJit::SaveDiskCache() {
+	if (!useDiskCache_ || !diskCacheLoaded_)
+		return;
+	KeepBlocksForDiskCache();
+
+	std::vector<DiskCacheBlock> blocks;
+	for (const auto &iter : diskCacheBlocks_)
+		blocks.insert(blocks.end(), iter.second.begin(), iter.second.end());
+
+	IRCacheHeader header{};
+	header.magic = IR_CACHE_HEADER_MAGIC;
+	header.version = IR_CACHE_VERSION;
+	header.optionsHash = DiskCacheOptionsHash();
+	header.numBlocks = (u32)blocks.size();
+	header.numInstructions = (u32)diskCacheInstructions_.size();
+
+	const size_t blocksSize = blocks.size() * sizeof(DiskCacheBlock);
+	const size_t instructionsSize = diskCacheInstructions_.size() * sizeof(IRInst);
+	std::vector<u8> data(sizeof(header) + blocksSize + instructionsSize);
+	memcpy(&data[0], &header, sizeof(header));
+	if (blocksSize != 0)
+		memcpy(&data[sizeof(header)], &blocks[0], blocksSize);
+	if (instructionsSize != 0)
+		memcpy(&data[sizeof(header) + blocksSize], &diskCacheInstructions_[0], instructionsSize);
+
+	INFO_LOG(JIT, "Saving IR cache: %d blocks", (int)blocks.size());
+	g_threadManager.EnqueueTask(new SaveIRCacheTask(diskCachePath_, std::move(data)));
+}
+
 MIPSOpcode IRJit::GetOriginalOp(MIPSOpcode op) {
 	IRBlock *b = blocks_.GetBlock(blocks_.FindByCookie(op.encoding & 0xFFFFFF));
 	if (b) {
@@ -17,15 +17,19 @@
 
 #pragma once
 
+#include <algorithm>
+#include <atomic>
 #include <cstring>
 #include <unordered_map>
 
 #include "Common/CommonTypes.h"
 #include "Common/CPUDetect.h"
+#include "Common/File/Path.h"
 #include "Core/MIPS/JitCommon/JitBlockCache.h"
 #include "Core/MIPS/JitCommon/JitCommon.h"
 #include "Core/MIPS/IR/IRRegCache.h"
 #include "Core/MIPS/IR/IRInst.h"
+#include "Core/MIPS/IR/IRInterpreter.h"
 #include "Core/MIPS/IR/IRFrontend.h"
 #include "Core/MIPS/MIPSVFPUUtils.h"
 
@@ -35,40 +39,132 @@
 
 namespace MIPSComp {
 
-// TODO : Use arena allocators. For now let's just malloc.
+// IR instructions run by IRJit::RunLoopUntil() while collecting debug stats, for benchmarking.  Never reset by the jit.
+extern u64 irInstructionsExecuted;
+
+// Growable storage for block data, addressed by offset.  When the storage moves (growth or
+// compaction), the old buffer is kept until ReleaseRetired(), since a block may be running from it.
+template <typename T>
+class IRArena {
+public:
+	IRArena() {}
+	IRArena(const IRArena &) = delete;
+	~IRArena() {
+		delete[] data_;
+		ReleaseRetired();
+	}
+
+	u32 Alloc(u32 count) {
+		if (size_ + count > capacity_)
+			Grow(size_ + count);
+		u32 offset = size_;
+		size_ += count;
+		return offset;
+	}
+	// Discards everything, leaving room for capacity entries.
+	void Reset(u32 capacity) {
+		Retire();
+		if (capacity != 0)
+			data_ = new T[capacity];
+		capacity_ = capacity;
+		size_ = 0;
+	}
+	void ReleaseRetired() {
+		for (T *p : retired_)
+			delete[] p;
+		retired_.clear();
+	}
+
+	T *Ptr(u32 offset) { return data_ + offset; }
+	const T *Ptr(u32 offset) const { return data_ + offset; }
+	u32 Size() const { return size_; }
+	u32 Capacity() const { return capacity_; }
+
+private:
+	void Grow(u32 needed) {
+		u32 newCapacity = std::max(needed, std::max(capacity_ * 2, (u32)4096));
+		T *newData = new T[newCapacity];
+		if (size_ != 0)
+			memcpy(newData, data_, sizeof(T) * size_);
+		Retire();
+		data_ = newData;
+		capacity_ = newCapacity;
+	}
+	void Retire() {
+		if (data_)
+			retired_.push_back(data_);
+		data_ = nullptr;
+	}
+
+	T *data_ = nullptr;
+	u32 size_ = 0;
+	u32 capacity_ = 0;
+	std::vector<T *> retired_;
+};
+
+// Open-addressed map from block start address to block number.  Find() takes no locks, so
+// other threads (like the debugger) may look up blocks while the jit thread adds and removes them.
+// Only one thread may modify it at a time.
+class IRBlockIndex {
+public:
+	IRBlockIndex();
+	IRBlockIndex(const IRBlockIndex &) = delete;
+	~IRBlockIndex();
+
+	// Returns -1 if no block starts at addr.
+	int Find(u32 addr) const;
+	// Replaces any previous block at the same address.
+	void Add(u32 addr, int blockNum);
+	// Only removes the entry if it's still blockNum.
+	void Remove(u32 addr, int blockNum);
+	void Clear();
+	// Frees tables replaced by growth, unless a Find() is in progress and might still be probing one.
+	void ReleaseRetired();
+
+private:
+	struct Table {
+		explicit Table(u32 capacity);
+		~Table();
+		// Address in the upper 32 bits, block number in the lower.  Zero is empty.
+		std::atomic<u64> *slots;
+		u32 mask;
+	};
+
+	static u32 Hash(u32 addr) {
+		return (u32)(((u64)(addr >> 2) * 0x9E3779B97F4A7C15ULL) >> 32);
+	}
+	void Rebuild(u32 capacity);
+
+	std::atomic<Table *> table_;
+	// Replaced tables, kept until no reader could still be probing them.
+	std::vector<Table *> retired_;
+	// Count of Find() calls in progress, on any thread.
+	mutable std::atomic<int> readers_{ 0 };
+	u32 used_ = 0;
+	u32 tombstones_ = 0;
+};
+
+// The instructions themselves live in IRBlockCache's arena.
 class IRBlock {
 public:
 	IRBlock() {}
 	IRBlock(u32 emAddr) : origAddr_(emAddr) {}
-	IRBlock(IRBlock &&b) {
-		instr_ = b.instr_;
-		hash_ = b.hash_;
-		origAddr_ = b.origAddr_;
-		origSize_ = b.origSize_;
-		origFirstOpcode_ = b.origFirstOpcode_;
-		targetOffset_ = b.targetOffset_;
-		numInstructions_ = b.numInstructions_;
-		b.instr_ = nullptr;
-	}
-
-	~IRBlock() {
-		delete[] instr_;
-	}
-
-	void SetInstructions(const std::vector<IRInst> &inst) {
-		instr_ = new IRInst[inst.size()];
-		numInstructions_ = (u16)inst.size();
-		if (!inst.empty()) {
-			memcpy(instr_, &inst[0], sizeof(IRInst) * inst.size());
-		}
+
+	void SetInstructionRange(u32 offset, int count) {
+		instOffset_ = offset;
+		numInstructions_ = (u16)count;
+		threadedOffset_ = -1;
 	}
+	u32 GetInstructionOffset() const { return instOffset_; }
+	int GetThreadedOffset() const { return threadedOffset_; }
+	void SetThreadedOffset(int offset) { threadedOffset_ = offset; }
 
-	const IRInst *GetInstructions() const { return instr_; }
 	int GetNumInstructions() const { return numInstructions_; }
 	MIPSOpcode GetOriginalFirstOp() const { return origFirstOpcode_; }
 	bool HasOriginalFirstOp() const;
 	bool RestoreOriginalFirstOp(int number);
 	bool IsValid() const { return origAddr_ != 0 && origFirstOpcode_.encoding != 0x68FFFFFF; }
+	bool IsDestroyed() const { return origAddr_ == 0; }
 	void SetOriginalSize(u32 size) {
 		origSize_ = size;
 	}
@@ -81,11 +177,27 @@ class IRBlock {
 	void UpdateHash() {
 		hash_ = CalculateHash();
 	}
+	u64 GetHash() const {
+		return hash_;
+	}
 	bool HashMatches() const {
 		return origAddr_ && hash_ == CalculateHash();
 	}
 	bool OverlapsRange(u32 addr, u32 size) const;
 
+	// Returns true once, when the block has run often enough to be worth recompiling as hot.
+	bool CountExecution() {
+		return ++execCount_ == HOT_THRESHOLD;
+	}
+	u32 GetExecutionCount() const {
+		return execCount_;
+	}
+	void SetExecutionCount(u32 count) {
+		execCount_ = count;
+	}
+	bool IsHot() const { return hot_; }
+	void SetHot() { hot_ = true; }
+
 	void GetRange(u32 &start, u32 &size) const {
 		start = origAddr_;
 		size = origSize_;
@@ -94,24 +206,36 @@ class IRBlock {
 	void Finalize(int number);
 	void Destroy(int number);
 
+	static u64 CalculateHash(u32 origAddr, u32 origSize);
+
+	static const u32 HOT_THRESHOLD = 1000;
+
 private:
-	u64 CalculateHash() const;
+	u64 CalculateHash() const {
+		return CalculateHash(origAddr_, origSize_);
+	}
 
-	IRInst *instr_ = nullptr;
+	u32 instOffset_ = 0;
+	// Offset in the threaded arena, or -1 until first run.
+	int threadedOffset_ = -1;
 	u64 hash_ = 0;
 	u32 origAddr_ = 0;
 	u32 origSize_ = 0;
 	MIPSOpcode origFirstOpcode_ = MIPSOpcode(0x68FFFFFF);
 	int targetOffset_ = -1;
+	u32 execCount_ = 0;
 	u16 numInstructions_ = 0;
+	bool hot_ = false;
 };
 
 class IRBlockCache : public JitBlockCacheDebugInterface {
 public:
 	IRBlockCache() {}
 	void Clear();
-	void InvalidateICache(u32 address, u32 length);
+	// Returns the numbers of the blocks that were destroyed.
+	std::vector<int> InvalidateICache(u32 address, u32 length);
 	void FinalizeBlock(int i, bool preload = false);
+	void DestroyBlock(int i);
 	int GetNumBlocks() const override { return (int)blocks_.size(); }
 	int AllocateBlock(int emAddr) {
 		blocks_.push_back(IRBlock(emAddr));
@@ -124,6 +248,26 @@ class IRBlockCache : public JitBlockCacheDebugInterface {
 			return nullptr;
 		}
 	}
+	const IRBlock *GetBlock(int i) const {
+		if (i >= 0 && i < (int)blocks_.size()) {
+			return &blocks_[i];
+		} else {
+			return nullptr;
+		}
+	}
+
+	void SetBlockInstructions(int i, const std::vector<IRInst> &inst);
+	const IRInst *GetBlockInstructionPtr(const IRBlock &block) const {
+		return arena_.Ptr(block.GetInstructionOffset());
+	}
+	// Decoded on first use, since many blocks only ever run once.
+	const IRThreadedInst *GetBlockThreadedPtr(IRBlock &block);
+	// Call when no block is running, to free storage left behind by growth or compaction.
+	void ReleaseRetiredStorage() {
+		arena_.ReleaseRetired();
+		threadedArena_.ReleaseRetired();
+		byStartAddress_.ReleaseRetired();
+	}
 
 	int FindPreloadBlock(u32 em_address);
 	int FindByCookie(int cookie);
@@ -137,9 +281,15 @@ class IRBlockCache : public JitBlockCacheDebugInterface {
 
 private:
 	u32 AddressToPage(u32 addr) const;
+	void Compact();
 
 	std::vector<IRBlock> blocks_;
 	std::unordered_map<u32, std::vector<int>> byPage_;
+	IRBlockIndex byStartAddress_;
+	IRArena<IRInst> arena_;
+	IRArena<IRThreadedInst> threadedArena_;
+	// Instructions in arena_ that belong to destroyed blocks.
+	u32 deadInstructions_ = 0;
 };
 
 class IRJit : public JitInterface {
@@ -155,6 +305,7 @@ class IRJit : public JitInterface {
 
 	void Compile(u32 em_address) override;	// Compiles a block at current MIPS PC
 	void CompileFunction(u32 start_address, u32 length) override;
+	void CompileFunctions(const std::vector<std::pair<u32, u32>> &functions) override;
 
 	bool DescribeCodePtr(const u8 *ptr, std::string &name) override;
 	// Not using a regular block cache.
@@ -181,7 +332,50 @@ class IRJit : public JitInterface {
 
 protected:
 	virtual bool CompileBlock(u32 em_address, std::vector<IRInst> &instructions, u32 &mipsBytes, bool preload);
+	// Runs the frontend and passes (or the disk cache.)  Doesn't touch blocks_, so may run on any thread.
+	void GenerateBlockIR(IRFrontend &frontend, u32 em_address, std::vector<IRInst> &instructions, u32 &mipsBytes, bool preload);
+	bool InstallBlock(u32 em_address, const std::vector<IRInst> &instructions, u32 mipsBytes, bool preload);
+	// Replaces a hot block with one compiled using all passes, following its hot branches if traces are on.
+	void RecompileHotBlock(u32 em_address, int block_num);
+
+	struct PrecompiledBlock {
+		u32 em_address;
+		u32 mipsBytes;
+		std::vector<IRInst> instructions;
+	};
+	void GenerateFunctionBlocks(IRFrontend &frontend, u32 start_address, u32 length, std::vector<PrecompiledBlock> &blocks);
+	bool InstallFunctionBlocks(const std::vector<PrecompiledBlock> &blocks);
+
+	// Optimized IR from previous runs of this game, keyed by address and checked by hash.
+	struct DiskCacheBlock {
+		u32 origAddr;
+		u32 origSize;
+		u64 hash;
+		u32 instOffset;
+		u32 numInstructions;
+		u32 flags;
+		u32 unused;
+	};
+	enum {
+		DISK_CACHE_ROUNDING = 1,
+	};
+	// About 16 MB of IR, should be plenty for any game.
+	static constexpr u32 MAX_DISK_CACHE_INSTRUCTIONS = 2 * 1024 * 1024;
+	// Self-modifying code can make many versions of a block, only keep a few.
+	static constexpr size_t MAX_DISK_CACHE_VERSIONS = 4;
+	bool FindDiskCacheBlock(u32 em_address, std::vector<IRInst> &instructions, u32 &mipsBytes);
+	void LoadDiskCache();
+	void SaveDiskCache();
+	// Copies the current live blocks into the disk cache tables, before they're cleared.
+	void KeepBlocksForDiskCache();
+	// Clears the cache after rounding mode use was detected, without keeping blocks that lack checks.
+	void ClearCacheForRounding();
+	u64 DiskCacheOptionsHash() const;
+	// Part of the cache filename, since backends generate different IR for the same code.
+	virtual const char *DiskCacheBackendName() const { return "ir"; }
 	virtual bool CompileTargetBlock(IRBlock *block, int block_num, bool preload) { return true; }
+	// Called once a block has been finalized and can be entered (and linked to.)
+	virtual void FinalizeTargetBlock(IRBlock *block, int block_num) {}
 
 	JitOptions jo;
 
@@ -190,6 +384,13 @@ class IRJit : public JitInterface {
 
 	MIPSState *mips_;
 
+	bool useDiskCache_ = false;
+	bool diskCacheLoaded_ = false;
+	bool keepBlocksOnClear_ = true;
+	Path diskCachePath_;
+	std::unordered_map<u32, std::vector<DiskCacheBlock>> diskCacheBlocks_;
+	std::vector<IRInst> diskCacheInstructions_;
+
 	// where to write branch-likely trampolines. not used atm
 	// u32 blTrampolines_;
 	// int blTrampolineCount_;
@@ -6,6 +6,7 @@
 #include "Common/Data/Convert/SmallDataConvert.h"
 #include "Common/Log.h"
 #include "Core/Config.h"
+#include "Core/MIPS/JitCommon/JitState.h"
 #include "Core/MIPS/IR/IRAnalysis.h"
 #include "Core/MIPS/IR/IRInterpreter.h"
 #include "Core/MIPS/IR/IRPassSimplify.h"
@@ -1403,7 +1404,7 @@ bool MergeLoadStore(const IRWriter &in, IRWriter &out, const IROptions &opts) {
 			break;
 
 		case IROp::Load32:
-			if (prev.src1 == inst.src1 && prev.src2 == inst.src2) {
+			if (prev.src1 == inst.src1 && prev.constant == inst.constant) {
 				// A store and then an immediate load.  This is sadly common in minis.
 				if (prev.op == IROp::Store32 && prev.src3 == inst.dest) {
 					// Even the same reg, a volatile variable?  Skip it.
@@ -1427,7 +1428,7 @@ bool MergeLoadStore(const IRWriter &in, IRWriter &out, const IROptions &opts) {
 			break;
 
 		case IROp::LoadFloat:
-			if (prev.src1 == inst.src1 && prev.src2 == inst.src2) {
+			if (prev.src1 == inst.src1 && prev.constant == inst.constant) {
 				// A store and then an immediate load, of a float.
 				if (prev.op == IROp::StoreFloat && prev.src3 == inst.dest) {
 					// Volatile float, I suppose?
@@ -1458,6 +1459,112 @@ bool MergeLoadStore(const IRWriter &in, IRWriter &out, const IROptions &opts) {
 	return logBlocks;
 }
 
+static IROp ScalarToVec4(IROp op) {
+	switch (op) {
+	case IROp::FAdd: return IROp::Vec4Add;
+	case IROp::FSub: return IROp::Vec4Sub;
+	// Not FMul: it maps inf * 0 to the PSP's NaN, while Vec4Mul and Vec4Scale are plain multiplies.
+	case IROp::FDiv: return IROp::Vec4Div;
+	case IROp::FMov: return IROp::Vec4Mov;
+	case IROp::FNeg: return IROp::Vec4Neg;
+	case IROp::FAbs: return IROp::Vec4Abs;
+	default: return IROp::Nop;
+	}
+}
+
+// Checks if four scalar ops are the lanes of one Vec4 op, in any order.
+static bool MatchVec4Group(const IRInst *group, IRInst &merged) {
+	const IROp op = group[0].op;
+	const bool binary = op == IROp::FAdd || op == IROp::FSub || op == IROp::FDiv;
+
+	const int d = group[0].dest & ~3;
+	const int firstLane = group[0].dest & 3;
+	const int s = group[0].src1 - firstLane;
+	const int t = group[0].src2 - firstLane;
+	// Vec4 ops need aligned quads.  Since both are aligned, they either match or don't overlap at all,
+	// so reading all lanes before writing any gives the same result as the scalar ops in order.
+	if (s < 0 || (s & 3) != 0)
+		return false;
+	if (binary && (t < 0 || (t & 3) != 0))
+		return false;
+
+	u8 lanesSeen = 0;
+	for (int i = 0; i < 4; ++i) {
+		const IRInst &inst = group[i];
+		int lane = inst.dest - d;
+		if (inst.op != op || lane < 0 || lane >= 4 || (lanesSeen & (1 << lane)) != 0)
+			return false;
+		lanesSeen |= 1 << lane;
+		if (inst.src1 != s + lane)
+			return false;
+		if (binary && inst.src2 != t + lane)
+			return false;
+	}
+
+	merged = { ScalarToVec4(op), { (u8)d }, (u8)s, binary ? (u8)t : (u8)0, 0 };
+	return true;
+}
+
+bool MergeVec4Ops(const IRWriter &in, IRWriter &out, const IROptions &opts) {
+	CONDITIONAL_DISABLE;
+	if (opts.disableFlags & (uint32_t)MIPSComp::JitDisable::SIMD)
+		DISABLE;
+
+	// The VFPU frontend goes scalar for columns, prefixes, and other non-quad cases, but
+	// often the result (after prefix temps) is still four lanes of a quad.
+	const std::vector<IRInst> &insts = in.GetInstructions();
+	for (int i = 0, n = (int)insts.size(); i < n; ++i) {
+		IRInst merged;
+		if (i + 4 <= n && ScalarToVec4(insts[i].op) != IROp::Nop && MatchVec4Group(&insts[i], merged)) {
+			out.Write(merged);
+			i += 3;
+			continue;
+		}
+		out.Write(insts[i]);
+	}
+	return false;
+}
+
+bool RemoveDeadCtrlWrites(const IRWriter &in, IRWriter &out, const IROptions &opts) {
+	CONDITIONAL_DISABLE;
+
+	const std::vector<IRInst> &insts = in.GetInstructions();
+	std::vector<bool> dead(insts.size(), false);
+
+	// Walk backwards tracking what's still going to be read.  Everything is, after the block.
+	u32 live = IRCTRL_ALL;
+	for (int i = (int)insts.size() - 1; i >= 0; --i) {
+		const IRInst &inst = insts[i];
+		u32 reads, writes;
+		IRCtrlStateUsage(inst, reads, writes);
+
+		switch (inst.op) {
+		case IROp::FCmp:
+		case IROp::ZeroFpCond:
+		case IROp::FpCtrlFromReg:
+		case IROp::SetCtrlVFPU:
+		case IROp::SetCtrlVFPUReg:
+		case IROp::SetCtrlVFPUFReg:
+			// These do nothing else, so can go if all they write is overwritten before being read.
+			if ((writes & live) == 0) {
+				dead[i] = true;
+				continue;
+			}
+			break;
+		default:
+			break;
+		}
+
+		live = (live & ~writes) | reads;
+	}
+
+	for (size_t i = 0; i < insts.size(); ++i) {
+		if (!dead[i])
+			out.Write(insts[i]);
+	}
+	return false;
+}
+
 bool ApplyMemoryValidation(const IRWriter &in, IRWriter &out, const IROptions &opts) {
 	CONDITIONAL_DISABLE;
 	if (g_Config.bFastMemory)
@@ -43,6 +43,15 @@ struct BlockCacheStats {
 	float maxBloat;
 	u32 maxBloatBlock;
 	std::map<float, u32> bloatMap;
+	// Storage for block code or IR, when the cache tracks it.
+	size_t codeMemoryUsed = 0;
+	size_t codeMemoryAllocated = 0;
+	// For caches that recompile blocks with more optimization once they've run hotThreshold times.
+	u32 hotThreshold = 0;
+	int numHotBlocks = 0;
+	// Counted while the block was current (a hot block includes its runs before recompiling.)
+	u64 hotExecutions = 0;
+	u64 coldExecutions = 0;
 };
 
 enum class DestroyType {
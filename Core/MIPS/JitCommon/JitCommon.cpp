@@ -43,6 +43,9 @@
 #include "../ARM64/Arm64Jit.h"
 #elif PPSSPP_ARCH(X86) || PPSSPP_ARCH(AMD64)
 #include "../x86/Jit.h"
+#if PPSSPP_ARCH(AMD64)
+#include "../x86/X64IRJit.h"
+#endif
 #elif PPSSPP_ARCH(MIPS)
 #include "../MIPS/MipsJit.h"
 #elif PPSSPP_ARCH(RISCV64)
@@ -101,12 +104,16 @@ namespace MIPSComp {
 		return notTakenTarget;
 }
 
-	JitInterface *CreateNativeJit(MIPSState *mipsState) {
+	JitInterface *CreateNativeJit(MIPSState *mipsState, bool useIR) {
 #if PPSSPP_ARCH(ARM)
 		return new MIPSComp::ArmJit(mipsState);
 #elif PPSSPP_ARCH(ARM64)
 		return new MIPSComp::Arm64Jit(mipsState);
 #elif PPSSPP_ARCH(X86) || PPSSPP_ARCH(AMD64)
+#if PPSSPP_ARCH(AMD64)
+		if (useIR)
+			return new MIPSComp::X64IRJit(mipsState);
+#endif
 		return new MIPSComp::Jit(mipsState);
 #elif PPSSPP_ARCH(MIPS)
 		return new MIPSComp::MipsJit(mipsState);
@@ -137,6 +137,11 @@ namespace MIPSComp {
 		virtual void RunLoopUntil(u64 globalticks) = 0;
 		virtual void Compile(u32 em_address) = 0;
 		virtual void CompileFunction(u32 start_address, u32 length) { }
+		// Pairs of start address and length.  May be done in parallel where supported.
+		virtual void CompileFunctions(const std::vector<std::pair<u32, u32>> &functions) {
+			for (const auto &func : functions)
+				CompileFunction(func.first, func.second);
+		}
 		virtual void ClearCache() = 0;
 		virtual void UpdateFCR31() = 0;
 		virtual MIPSOpcode GetOriginalOp(MIPSOpcode op) = 0;
@@ -177,5 +182,5 @@ namespace MIPSComp {
 
 	void DoDummyJitState(PointerWrap &p);
 
-	JitInterface *CreateNativeJit(MIPSState *mipsState);
+	JitInterface *CreateNativeJit(MIPSState *mipsState, bool useIR = false);
 }
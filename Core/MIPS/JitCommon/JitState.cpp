@@ -44,6 +44,9 @@ namespace MIPSComp {
 		//ARM64
 		useASIMDVFPU = false;  // !Disabled(JitDisable::SIMD);
 
+		// IR interpreter
+		irThreadedDispatch = !Disabled(JitDisable::IR_THREADED);
+
 		// Common
 
 		// We can get block linking to work with W^X by doing even more unprotect/re-protect, but let's try without first.
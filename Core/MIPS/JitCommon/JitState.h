@@ -209,8 +209,9 @@ namespace MIPSComp {
 		VFPU_MTX_VMMOV = 0x08000000,
 		VFPU_MTX_VMMUL = 0x10000000,
 		VFPU_MTX_VMSCL = 0x20000000,
+		IR_THREADED = 0x40000000,  // IR interpreter only: use the switch instead of threaded dispatch.
 
-		ALL_FLAGS = 0x3FFFFFFF,
+		ALL_FLAGS = 0x7FFFFFFF,
 	};
 
 	struct JitOptions {
@@ -236,6 +237,9 @@ namespace MIPSComp {
 		bool useStaticAlloc;
 		bool enablePointerify;
 
+		// IR interpreter
+		bool irThreadedDispatch;
+
 		// Common
 		bool enableBlocklink;
 		bool immBranches;
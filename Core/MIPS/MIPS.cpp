@@ -211,8 +211,8 @@ void MIPSState::Init() {
 	downcount = 0;
 
 	std::lock_guard<std::recursive_mutex> guard(MIPSComp::jitLock);
-	if (PSP_CoreParameter().cpuCore == CPUCore::JIT) {
-		MIPSComp::jit = MIPSComp::CreateNativeJit(this);
+	if (PSP_CoreParameter().cpuCore == CPUCore::JIT || PSP_CoreParameter().cpuCore == CPUCore::JIT_IR) {
+		MIPSComp::jit = MIPSComp::CreateNativeJit(this, PSP_CoreParameter().cpuCore == CPUCore::JIT_IR);
 	} else if (PSP_CoreParameter().cpuCore == CPUCore::IR_JIT) {
 		MIPSComp::jit = new MIPSComp::IRJit(this);
 	} else {
@@ -235,13 +235,14 @@ void MIPSState::UpdateCore(CPUCore desired) {
 
 	switch (PSP_CoreParameter().cpuCore) {
 	case CPUCore::JIT:
-		INFO_LOG(CPU, "Switching to JIT");
+	case CPUCore::JIT_IR:
+		INFO_LOG(CPU, "Switching to JIT%s", PSP_CoreParameter().cpuCore == CPUCore::JIT_IR ? " using IR" : "");
 		if (oldjit) {
 			std::lock_guard<std::recursive_mutex> guard(MIPSComp::jitLock);
 			MIPSComp::jit = nullptr;
 			delete oldjit;
 		}
-		newjit = MIPSComp::CreateNativeJit(this);
+		newjit = MIPSComp::CreateNativeJit(this, PSP_CoreParameter().cpuCore == CPUCore::JIT_IR);
 		break;
 
 	case CPUCore::IR_JIT:
@@ -333,6 +334,7 @@ int MIPSState::RunLoopUntil(u64 globalTicks) {
 	switch (PSP_CoreParameter().cpuCore) {
 	case CPUCore::JIT:
 	case CPUCore::IR_JIT:
+	case CPUCore::JIT_IR:
 		while (inDelaySlot) {
 			// We must get out of the delay slot before going into jit.
 			SingleStep();
@@ -921,10 +921,18 @@ namespace MIPSAnalyst {
 		// TODO: Load from cache file if available instead.
 
 		double st = time_now_d();
+		std::vector<std::pair<u32, u32>> ranges;
+		ranges.reserve(functions.size());
 		for (auto iter = functions.begin(), end = functions.end(); iter != end; iter++) {
 			const AnalyzedFunction &f = *iter;
+			ranges.emplace_back(f.start, f.end - f.start + 4);
+		}
 
-			PrecompileFunction(f.start, f.end - f.start + 4);
+		{
+			std::lock_guard<std::recursive_mutex> guard(MIPSComp::jitLock);
+			if (MIPSComp::jit) {
+				MIPSComp::jit->CompileFunctions(ranges);
+			}
 		}
 		double et = time_now_d();
 
@@ -84,6 +84,12 @@ RiscVJit::RiscVJit(MIPSState *mipsState)
 	gpr.Init(this);
 	fpr.Init(this);
 
+	// Our dispatcher doesn't count block executions, so hot recompiles never happen.
+	IROptions opts = frontend_.GetOptions();
+	opts.tieredPasses = false;
+	opts.traces = false;
+	frontend_.SetOptions(opts);
+
 	GenerateFixedCode(jo);
 }
 
@@ -96,6 +102,8 @@ void RiscVJit::RunLoopUntil(u64 globalticks) {
 	}
 
 	PROFILE_THIS_SCOPE("jit");
+	// Native code doesn't read the IR, so nothing can be running from old storage.
+	blocks_.ReleaseRetiredStorage();
 	((void (*)())enterDispatcher_)();
 }
 
@@ -116,11 +124,12 @@ bool RiscVJit::CompileTargetBlock(IRBlock *block, int block_num, bool preload) {
 
 	// TODO: Block linking, checked entries and such.
 
-	gpr.Start(block);
-	fpr.Start(block);
+	gpr.Start(&blocks_, block_num);
+	fpr.Start(&blocks_, block_num);
 
+	const IRInst *instructions = blocks_.GetBlockInstructionPtr(*block);
 	for (int i = 0; i < block->GetNumInstructions(); ++i) {
-		const IRInst &inst = block->GetInstructions()[i];
+		const IRInst &inst = instructions[i];
 		gpr.SetIRIndex(i);
 		fpr.SetIRIndex(i);
 
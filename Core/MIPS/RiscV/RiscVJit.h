@@ -64,6 +64,7 @@ class RiscVJit : public RiscVGen::RiscVCodeBlock, public IRJit {
 
 protected:
 	bool CompileTargetBlock(IRBlock *block, int block_num, bool preload) override;
+	const char *DiskCacheBackendName() const override { return "riscv"; }
 
 	void CompileIRInst(IRInst inst);
 
@@ -37,7 +37,7 @@ void RiscVRegCache::Init(RiscVEmitter *emitter) {
 	emit_ = emitter;
 }
 
-void RiscVRegCache::Start(MIPSComp::IRBlock *irBlock) {
+void RiscVRegCache::Start(MIPSComp::IRBlockCache *irBlockCache, int blockNum) {
 	if (!initialReady_) {
 		SetupInitialRegs();
 		initialReady_ = true;
@@ -58,7 +58,8 @@ void RiscVRegCache::Start(MIPSComp::IRBlock *irBlock) {
 		mr[statics[i].mr].spillLock = true;
 	}
 
-	irBlock_ = irBlock;
+	irBlockCache_ = irBlockCache;
+	irBlockNum_ = blockNum;
 	irIndex_ = 0;
 }
 
@@ -397,8 +398,9 @@ RiscVReg RiscVRegCache::FindBestToSpill(bool unusedOnly, bool *clobbered) {
 	IRSituation info;
 	info.lookaheadCount = UNUSED_LOOKAHEAD_OPS;
 	info.currentIndex = irIndex_;
-	info.instructions = irBlock_->GetInstructions();
-	info.numInstructions = irBlock_->GetNumInstructions();
+	const MIPSComp::IRBlock *irBlock = irBlockCache_->GetBlock(irBlockNum_);
+	info.instructions = irBlockCache_->GetBlockInstructionPtr(*irBlock);
+	info.numInstructions = irBlock->GetNumInstructions();
 
 	*clobbered = false;
 	for (int i = 0; i < allocCount; i++) {
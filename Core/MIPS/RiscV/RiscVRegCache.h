@@ -102,7 +102,7 @@ class RiscVRegCache {
 	~RiscVRegCache() {}
 
 	void Init(RiscVGen::RiscVEmitter *emitter);
-	void Start(MIPSComp::IRBlock *irBlock);
+	void Start(MIPSComp::IRBlockCache *irBlockCache, int blockNum);
 	void SetIRIndex(int index) {
 		irIndex_ = index;
 	}
@@ -179,7 +179,8 @@ class RiscVRegCache {
 	MIPSState *mips_;
 	RiscVGen::RiscVEmitter *emit_ = nullptr;
 	MIPSComp::JitOptions *jo_;
-	MIPSComp::IRBlock *irBlock_ = nullptr;
+	MIPSComp::IRBlockCache *irBlockCache_ = nullptr;
+	int irBlockNum_ = 0;
 	int irIndex_ = 0;
 
 	enum {
@@ -36,7 +36,7 @@ void RiscVRegCacheFPU::Init(RiscVEmitter *emitter) {
 	emit_ = emitter;
 }
 
-void RiscVRegCacheFPU::Start(MIPSComp::IRBlock *irBlock) {
+void RiscVRegCacheFPU::Start(MIPSComp::IRBlockCache *irBlockCache, int blockNum) {
 	if (!initialReady_) {
 		SetupInitialRegs();
 		initialReady_ = true;
@@ -46,7 +46,8 @@ void RiscVRegCacheFPU::Start(MIPSComp::IRBlock *irBlock) {
 	memcpy(mr, mrInitial_, sizeof(mr));
 	pendingFlush_ = false;
 
-	irBlock_ = irBlock;
+	irBlockCache_ = irBlockCache;
+	irBlockNum_ = blockNum;
 	irIndex_ = 0;
 }
 
@@ -166,8 +167,9 @@ RiscVReg RiscVRegCacheFPU::FindBestToSpill(bool unusedOnly, bool *clobbered) {
 	IRSituation info;
 	info.lookaheadCount = UNUSED_LOOKAHEAD_OPS;
 	info.currentIndex = irIndex_;
-	info.instructions = irBlock_->GetInstructions();
-	info.numInstructions = irBlock_->GetNumInstructions();
+	const MIPSComp::IRBlock *irBlock = irBlockCache_->GetBlock(irBlockNum_);
+	info.instructions = irBlockCache_->GetBlockInstructionPtr(*irBlock);
+	info.numInstructions = irBlock->GetNumInstructions();
 
 	*clobbered = false;
 	for (int i = 0; i < allocCount; i++) {
@@ -46,7 +46,7 @@ class RiscVRegCacheFPU {
 	~RiscVRegCacheFPU() {}
 
 	void Init(RiscVGen::RiscVEmitter *emitter);
-	void Start(MIPSComp::IRBlock *irBlock);
+	void Start(MIPSComp::IRBlockCache *irBlockCache, int blockNum);
 	void SetIRIndex(int index) {
 		irIndex_ = index;
 	}
@@ -91,7 +91,8 @@ class RiscVRegCacheFPU {
 	MIPSState *mips_;
 	RiscVGen::RiscVEmitter *emit_ = nullptr;
 	MIPSComp::JitOptions *jo_;
-	MIPSComp::IRBlock *irBlock_ = nullptr;
+	MIPSComp::IRBlockCache *irBlockCache_ = nullptr;
+	int irBlockNum_ = 0;
 	int irIndex_ = 0;
 
 	enum {
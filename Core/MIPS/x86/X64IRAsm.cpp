@@ -0,0 +1,208 @@
+// Copyright (c) 2023- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+#include "ppsspp_config.h"
+#if PPSSPP_ARCH(AMD64)
+
+#include "Common/ABI.h"
+#include "Common/Log.h"
+#include "Core/CoreTiming.h"
+#include "Core/MemMap.h"
+#include "Core/MIPS/x86/X64IRJit.h"
+#include "Core/MIPS/x86/X64IRRegCache.h"
+#include "Core/MIPS/JitCommon/JitCommon.h"
+#include "Core/MIPS/JitCommon/JitState.h"
+#include "Core/System.h"
+
+namespace MIPSComp {
+
+using namespace Gen;
+using namespace X64IRJitConstants;
+
+static const bool enableDebug = false;
+static const bool enableDisasm = false;
+
+static void ShowPC(void *membase, void *jitbase) {
+	static int count = 0;
+	if (currentMIPS) {
+		ERROR_LOG(JIT, "[%08x] ShowPC  Downcount : %08x %d %p %p", currentMIPS->pc, currentMIPS->downcount, count, membase, jitbase);
+	} else {
+		ERROR_LOG(JIT, "Universe corrupt?");
+	}
+	count++;
+}
+
+void X64IRJit::GenerateFixedCode(const JitOptions &jo) {
+	BeginWrite(GetMemoryProtectPageSize());
+	const u8 *start = AlignCodePage();
+
+	restoreRoundingMode_ = AlignCode16();
+	{
+		STMXCSR(MIPSSTATE_VAR(temp));
+		// Clear the rounding mode and flush-to-zero bits back to 0.
+		AND(32, MIPSSTATE_VAR(temp), Imm32(~(7 << 13)));
+		LDMXCSR(MIPSSTATE_VAR(temp));
+		RET();
+	}
+
+	applyRoundingMode_ = AlignCode16();
+	{
+		MOV(32, R(SCRATCH1), MIPSSTATE_VAR(fcr31));
+		AND(32, R(SCRATCH1), Imm32(0x01000003));
+
+		// If it's 0 (nearest + no flush0), we don't actually bother setting - we cleared the rounding
+		// mode out in restoreRoundingMode anyway. This is the most common.
+		FixupBranch skip = J_CC(CC_Z);
+		STMXCSR(MIPSSTATE_VAR(temp));
+
+		// The MIPS bits don't correspond exactly, so we have to adjust.
+		// 0 -> 0 (skip2), 1 -> 3, 2 -> 2 (skip2), 3 -> 1
+		TEST(8, R(SCRATCH1), Imm8(1));
+		FixupBranch skip2 = J_CC(CC_Z);
+		XOR(32, R(SCRATCH1), Imm8(2));
+		SetJumpTarget(skip2);
+
+		// Adjustment complete, now reconstruct MXCSR.
+		SHL(32, R(SCRATCH1), Imm8(13));
+		// Before setting new bits, we must clear the old ones.
+		// Clearing bits 13-14 (rounding mode) and 15 (flush to zero.)
+		AND(32, MIPSSTATE_VAR(temp), Imm32(~(7 << 13)));
+		OR(32, MIPSSTATE_VAR(temp), R(SCRATCH1));
+
+		TEST(32, MIPSSTATE_VAR(fcr31), Imm32(1 << 24));
+		FixupBranch skip3 = J_CC(CC_Z);
+		OR(32, MIPSSTATE_VAR(temp), Imm32(1 << 15));
+		SetJumpTarget(skip3);
+
+		LDMXCSR(MIPSSTATE_VAR(temp));
+		SetJumpTarget(skip);
+		RET();
+	}
+
+	enterDispatcher_ = AlignCode16();
+	ABI_PushAllCalleeSavedRegsAndAdjustStack();
+
+	// Fixed registers, these are always kept when in Jit context.
+	MOV(64, R(MEMBASEREG), ImmPtr(Memory::base));
+	MOV(64, R(JITBASEREG), ImmPtr(GetBasePtr()));
+	// From the start of the FP reg, a single byte offset can reach all GPR + all FPR (but not VFPU.)
+	MOV(PTRBITS, R(CTXREG), ImmPtr(&mips_->f[0]));
+
+	outerLoop_ = GetCodePtr();
+	RestoreRoundingMode(true);
+	ABI_CallFunction(reinterpret_cast<void *>(&CoreTiming::Advance));
+	ApplyRoundingMode(true);
+
+	dispatcherCheckCoreState_ = GetCodePtr();
+	if (RipAccessible((const void *)&coreState)) {
+		CMP(32, M(&coreState), Imm32(0));  // rip accessible
+	} else {
+		MOV(PTRBITS, R(SCRATCH1), ImmPtr((const void *)&coreState));
+		CMP(32, MatR(SCRATCH1), Imm32(0));
+	}
+	FixupBranch badCoreState = J_CC(CC_NZ, true);
+
+	// We just checked coreState, so go to advance if downcount is negative.
+	CMP(32, MIPSSTATE_VAR(downcount), Imm8(0));
+	J_CC(CC_S, outerLoop_, true);
+	FixupBranch skipToRealDispatch = J();
+
+	dispatcherPCInSCRATCH1_ = GetCodePtr();
+	MOV(32, MIPSSTATE_VAR(pc), R(SCRATCH1));
+
+	dispatcher_ = GetCodePtr();
+	CMP(32, MIPSSTATE_VAR(downcount), Imm8(0));
+	FixupBranch bail = J_CC(CC_S, true);
+	SetJumpTarget(skipToRealDispatch);
+
+	dispatcherNoCheck_ = GetCodePtr();
+
+	// Debug
+	if (enableDebug) {
+		MOV(64, R(ABI_PARAM1), R(MEMBASEREG));
+		MOV(64, R(ABI_PARAM2), R(JITBASEREG));
+		ABI_CallFunction(reinterpret_cast<void *>(&ShowPC));
+	}
+
+	MOV(32, R(SCRATCH1), MIPSSTATE_VAR(pc));
+#ifdef MASKED_PSP_MEMORY
+	AND(32, R(SCRATCH1), Imm32(Memory::MEMVIEW32_MASK));
+#endif
+	dispatcherFetch_ = GetCodePtr();
+	MOV(32, R(SCRATCH1), MComplex(MEMBASEREG, SCRATCH1, SCALE_1, 0));
+	MOV(32, R(SCRATCH2), R(SCRATCH1));
+	_assert_msg_(MIPS_JITBLOCK_MASK == 0xFF000000, "Hardcoded assumption of emuhack mask");
+	SHR(32, R(SCRATCH2), Imm8(24));
+	CMP(32, R(SCRATCH2), Imm8(MIPS_EMUHACK_OPCODE >> 24));
+	FixupBranch needsCompile = J_CC(CC_NE);
+	// The block offset is in the lower 24 bits.
+	AND(32, R(SCRATCH1), Imm32(MIPS_EMUHACK_VALUE_MASK));
+	ADD(64, R(SCRATCH1), R(JITBASEREG));
+	JMPptr(R(SCRATCH1));
+	SetJumpTarget(needsCompile);
+
+	// No block found, let's jit.  We don't need to save any regs, they're all flushed.
+	RestoreRoundingMode(true);
+	ABI_CallFunction(&MIPSComp::JitAt);
+	ApplyRoundingMode(true);
+
+	// Try again, the block index should be set now.
+	JMP(dispatcherNoCheck_, true);
+
+	SetJumpTarget(bail);
+
+	if (RipAccessible((const void *)&coreState)) {
+		CMP(32, M(&coreState), Imm32(0));  // rip accessible
+	} else {
+		MOV(PTRBITS, R(SCRATCH1), ImmPtr((const void *)&coreState));
+		CMP(32, MatR(SCRATCH1), Imm32(0));
+	}
+	J_CC(CC_Z, outerLoop_, true);
+
+	const u8 *quitLoop = GetCodePtr();
+	SetJumpTarget(badCoreState);
+
+	RestoreRoundingMode(true);
+	ABI_PopAllCalleeSavedRegsAndAdjustStack();
+	RET();
+
+	crashHandler_ = GetCodePtr();
+	if (RipAccessible((const void *)&coreState)) {
+		MOV(32, M(&coreState), Imm32(CORE_RUNTIME_ERROR));
+	} else {
+		MOV(PTRBITS, R(SCRATCH1), ImmPtr((const void *)&coreState));
+		MOV(32, MatR(SCRATCH1), Imm32(CORE_RUNTIME_ERROR));
+	}
+	JMP(quitLoop, true);
+
+	// Leave this at the end, add more stuff above.
+	if (enableDisasm) {
+		std::vector<std::string> lines = DisassembleX86(start, (int)(GetCodePtr() - start));
+		for (auto s : lines) {
+			INFO_LOG(JIT, "%s", s.c_str());
+		}
+	}
+
+	// Let's spare the pre-generated code from unprotect-reprotect.
+	AlignCodePage();
+	jitStartOffset_ = (int)(GetCodePtr() - start);
+	EndWrite();
+}
+
+} // namespace MIPSComp
+
+#endif
@@ -0,0 +1,571 @@
+// Copyright (c) 2023- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+#include "ppsspp_config.h"
+#if PPSSPP_ARCH(AMD64)
+
+#include "Common/CPUDetect.h"
+#include "Core/MemMap.h"
+#include "Core/MIPS/x86/X64IRJit.h"
+#include "Core/MIPS/x86/X64IRRegCache.h"
+
+// This file contains compilation for integer / arithmetic / logic related instructions.
+//
+// All functions should have CONDITIONAL_DISABLE, so we can narrow things down to a file quickly.
+// Currently known non working ones should have DISABLE.  No flags because that's in IR already.
+
+// #define CONDITIONAL_DISABLE { CompIR_Generic(inst); return; }
+#define CONDITIONAL_DISABLE {}
+#define DISABLE { CompIR_Generic(inst); return; }
+#define INVALIDOP { _assert_msg_(false, "Invalid IR inst %d", (int)inst.op); CompIR_Generic(inst); return; }
+
+namespace MIPSComp {
+
+using namespace Gen;
+using namespace X64IRJitConstants;
+
+void X64IRJit::CompIR_Arith(IRInst inst) {
+	CONDITIONAL_DISABLE;
+
+	switch (inst.op) {
+	case IROp::Add:
+		gpr.MapDirtyInIn(inst.dest, inst.src1, inst.src2);
+		if (inst.dest == inst.src1) {
+			ADD(32, gpr.R(inst.dest), gpr.R(inst.src2));
+		} else if (inst.dest == inst.src2) {
+			ADD(32, gpr.R(inst.dest), gpr.R(inst.src1));
+		} else {
+			LEA(32, gpr.RX(inst.dest), MRegSum(gpr.RX(inst.src1), gpr.RX(inst.src2)));
+		}
+		break;
+
+	case IROp::Sub:
+		gpr.MapDirtyInIn(inst.dest, inst.src1, inst.src2);
+		if (inst.src1 == inst.src2) {
+			XOR(32, gpr.R(inst.dest), gpr.R(inst.dest));
+		} else if (inst.dest == inst.src2) {
+			// Two operand form, so flip the subtraction around.
+			NEG(32, gpr.R(inst.dest));
+			ADD(32, gpr.R(inst.dest), gpr.R(inst.src1));
+		} else {
+			if (inst.dest != inst.src1)
+				MOV(32, gpr.R(inst.dest), gpr.R(inst.src1));
+			SUB(32, gpr.R(inst.dest), gpr.R(inst.src2));
+		}
+		break;
+
+	case IROp::AddConst:
+	case IROp::SubConst:
+	{
+		s32 imm = inst.op == IROp::SubConst ? -(s32)inst.constant : (s32)inst.constant;
+		if (gpr.IsImm(inst.src1)) {
+			gpr.SetImm(inst.dest, gpr.GetImm(inst.src1) + (u32)imm);
+		} else {
+			gpr.MapDirtyIn(inst.dest, inst.src1);
+			if (inst.dest == inst.src1) {
+				ADD(32, gpr.R(inst.dest), Imm32(imm));
+			} else {
+				// Typical of stack pointer updates, LEA avoids the extra move.
+				LEA(32, gpr.RX(inst.dest), MDisp(gpr.RX(inst.src1), imm));
+			}
+		}
+		break;
+	}
+
+	case IROp::Neg:
+		gpr.MapDirtyIn(inst.dest, inst.src1);
+		if (inst.dest != inst.src1)
+			MOV(32, gpr.R(inst.dest), gpr.R(inst.src1));
+		NEG(32, gpr.R(inst.dest));
+		break;
+
+	default:
+		INVALIDOP;
+		break;
+	}
+}
+
+void X64IRJit::CompIR_Logic(IRInst inst) {
+	CONDITIONAL_DISABLE;
+
+	auto commutativeOp = [&](void (XEmitter::*op)(int, const OpArg &, const OpArg &)) {
+		gpr.MapDirtyInIn(inst.dest, inst.src1, inst.src2);
+		if (inst.dest == inst.src1) {
+			(this->*op)(32, gpr.R(inst.dest), gpr.R(inst.src2));
+		} else if (inst.dest == inst.src2) {
+			(this->*op)(32, gpr.R(inst.dest), gpr.R(inst.src1));
+		} else {
+			MOV(32, gpr.R(inst.dest), gpr.R(inst.src1));
+			(this->*op)(32, gpr.R(inst.dest), gpr.R(inst.src2));
+		}
+	};
+
+	auto constOp = [&](void (XEmitter::*op)(int, const OpArg &, const OpArg &)) {
+		gpr.MapDirtyIn(inst.dest, inst.src1);
+		if (inst.dest != inst.src1)
+			MOV(32, gpr.R(inst.dest), gpr.R(inst.src1));
+		(this->*op)(32, gpr.R(inst.dest), Imm32(inst.constant));
+	};
+
+	switch (inst.op) {
+	case IROp::And:
+		if (inst.src1 != inst.src2) {
+			commutativeOp(&XEmitter::AND);
+		} else if (inst.src1 != inst.dest) {
+			gpr.MapDirtyIn(inst.dest, inst.src1);
+			MOV(32, gpr.R(inst.dest), gpr.R(inst.src1));
+		}
+		break;
+
+	case IROp::Or:
+		if (inst.src1 != inst.src2) {
+			commutativeOp(&XEmitter::OR);
+		} else if (inst.src1 != inst.dest) {
+			gpr.MapDirtyIn(inst.dest, inst.src1);
+			MOV(32, gpr.R(inst.dest), gpr.R(inst.src1));
+		}
+		break;
+
+	case IROp::Xor:
+		if (inst.src1 == inst.src2) {
+			gpr.SetImm(inst.dest, 0);
+		} else {
+			commutativeOp(&XEmitter::XOR);
+		}
+		break;
+
+	case IROp::AndConst:
+		if (gpr.IsImm(inst.src1)) {
+			gpr.SetImm(inst.dest, gpr.GetImm(inst.src1) & inst.constant);
+		} else if (inst.constant == 0xFFFF && inst.dest != inst.src1) {
+			gpr.MapDirtyIn(inst.dest, inst.src1);
+			MOVZX(32, 16, gpr.RX(inst.dest), gpr.R(inst.src1));
+		} else if (inst.constant == 0xFF && inst.dest != inst.src1) {
+			gpr.MapDirtyIn(inst.dest, inst.src1);
+			MOVZX(32, 8, gpr.RX(inst.dest), gpr.R(inst.src1));
+		} else {
+			constOp(&XEmitter::AND);
+		}
+		break;
+
+	case IROp::OrConst:
+		if (gpr.IsImm(inst.src1)) {
+			gpr.SetImm(inst.dest, gpr.GetImm(inst.src1) | inst.constant);
+		} else {
+			constOp(&XEmitter::OR);
+		}
+		break;
+
+	case IROp::XorConst:
+		if (gpr.IsImm(inst.src1)) {
+			gpr.SetImm(inst.dest, gpr.GetImm(inst.src1) ^ inst.constant);
+		} else {
+			constOp(&XEmitter::XOR);
+		}
+		break;
+
+	case IROp::Not:
+		gpr.MapDirtyIn(inst.dest, inst.src1);
+		if (inst.dest != inst.src1)
+			MOV(32, gpr.R(inst.dest), gpr.R(inst.src1));
+		NOT(32, gpr.R(inst.dest));
+		break;
+
+	default:
+		INVALIDOP;
+		break;
+	}
+}
+
+void X64IRJit::CompIR_Assign(IRInst inst) {
+	CONDITIONAL_DISABLE;
+
+	switch (inst.op) {
+	case IROp::Mov:
+		if (inst.dest != inst.src1) {
+			if (gpr.IsImm(inst.src1)) {
+				gpr.SetImm(inst.dest, gpr.GetImm(inst.src1));
+			} else {
+				gpr.MapDirtyIn(inst.dest, inst.src1);
+				MOV(32, gpr.R(inst.dest), gpr.R(inst.src1));
+			}
+		}
+		break;
+
+	case IROp::Ext8to32:
+		gpr.MapDirtyIn(inst.dest, inst.src1);
+		MOVSX(32, 8, gpr.RX(inst.dest), gpr.R(inst.src1));
+		break;
+
+	case IROp::Ext16to32:
+		gpr.MapDirtyIn(inst.dest, inst.src1);
+		MOVSX(32, 16, gpr.RX(inst.dest), gpr.R(inst.src1));
+		break;
+
+	default:
+		INVALIDOP;
+		break;
+	}
+}
+
+void X64IRJit::CompIR_Bits(IRInst inst) {
+	CONDITIONAL_DISABLE;
+
+	switch (inst.op) {
+	case IROp::BSwap32:
+		gpr.MapDirtyIn(inst.dest, inst.src1);
+		if (inst.dest != inst.src1)
+			MOV(32, gpr.R(inst.dest), gpr.R(inst.src1));
+		BSWAP(32, gpr.RX(inst.dest));
+		break;
+
+	case IROp::BSwap16:
+		gpr.MapDirtyIn(inst.dest, inst.src1);
+		if (inst.dest != inst.src1)
+			MOV(32, gpr.R(inst.dest), gpr.R(inst.src1));
+		// Swap all four bytes, then swap the halves back into place.
+		BSWAP(32, gpr.RX(inst.dest));
+		ROR(32, gpr.R(inst.dest), Imm8(16));
+		break;
+
+	case IROp::Clz:
+		gpr.MapDirtyIn(inst.dest, inst.src1);
+		if (cpu_info.bLZCNT) {
+			LZCNT(32, gpr.RX(inst.dest), gpr.R(inst.src1));
+		} else {
+			// BSR leaves the destination undefined for zero, so use 63 (which becomes 32.)
+			MOV(32, R(SCRATCH2), Imm32(63));
+			BSR(32, SCRATCH1, gpr.R(inst.src1));
+			CMOVcc(32, SCRATCH1, R(SCRATCH2), CC_Z);
+			XOR(32, R(SCRATCH1), Imm8(31));
+			MOV(32, gpr.R(inst.dest), R(SCRATCH1));
+		}
+		break;
+
+	case IROp::ReverseBits:
+		CompIR_Generic(inst);
+		break;
+
+	default:
+		INVALIDOP;
+		break;
+	}
+}
+
+void X64IRJit::CompIR_Shift(IRInst inst) {
+	CONDITIONAL_DISABLE;
+
+	auto variableShift = [&](void (XEmitter::*op)(int, OpArg, OpArg)) {
+		gpr.MapDirtyInIn(inst.dest, inst.src1, inst.src2);
+		// x86 masks the shift amount with 31 for 32-bit shifts, just like the IR.
+		MOV(32, R(SCRATCH3), gpr.R(inst.src2));
+		if (inst.dest != inst.src1)
+			MOV(32, gpr.R(inst.dest), gpr.R(inst.src1));
+		(this->*op)(32, gpr.R(inst.dest), R(CL));
+	};
+
+	auto immShift = [&](void (XEmitter::*op)(int, OpArg, OpArg)) {
+		gpr.MapDirtyIn(inst.dest, inst.src1);
+		if (inst.dest != inst.src1)
+			MOV(32, gpr.R(inst.dest), gpr.R(inst.src1));
+		if ((inst.src2 & 31) != 0)
+			(this->*op)(32, gpr.R(inst.dest), Imm8(inst.src2 & 31));
+	};
+
+	switch (inst.op) {
+	case IROp::Shl:
+		variableShift(&XEmitter::SHL);
+		break;
+
+	case IROp::Shr:
+		variableShift(&XEmitter::SHR);
+		break;
+
+	case IROp::Sar:
+		variableShift(&XEmitter::SAR);
+		break;
+
+	case IROp::Ror:
+		variableShift(&XEmitter::ROR);
+		break;
+
+	case IROp::ShlImm:
+		if (gpr.IsImm(inst.src1)) {
+			gpr.SetImm(inst.dest, gpr.GetImm(inst.src1) << (inst.src2 & 31));
+		} else {
+			immShift(&XEmitter::SHL);
+		}
+		break;
+
+	case IROp::ShrImm:
+		if (gpr.IsImm(inst.src1)) {
+			gpr.SetImm(inst.dest, gpr.GetImm(inst.src1) >> (inst.src2 & 31));
+		} else {
+			immShift(&XEmitter::SHR);
+		}
+		break;
+
+	case IROp::SarImm:
+		immShift(&XEmitter::SAR);
+		break;
+
+	case IROp::RorImm:
+		immShift(&XEmitter::ROR);
+		break;
+
+	default:
+		INVALIDOP;
+		break;
+	}
+}
+
+void X64IRJit::CompIR_Compare(IRInst inst) {
+	CONDITIONAL_DISABLE;
+
+	auto setCC = [&](const OpArg &arg, CCFlags cc) {
+		// Zero first, since SETcc only writes the low byte and XOR would clobber flags.
+		XOR(32, R(SCRATCH1), R(SCRATCH1));
+		CMP(32, gpr.R(inst.src1), arg);
+		SETcc(cc, R(SCRATCH1));
+		MOV(32, gpr.R(inst.dest), R(SCRATCH1));
+	};
+
+	switch (inst.op) {
+	case IROp::Slt:
+		gpr.MapDirtyInIn(inst.dest, inst.src1, inst.src2);
+		setCC(gpr.R(inst.src2), CC_L);
+		break;
+
+	case IROp::SltConst:
+		if (inst.constant == 0) {
+			// Basically, getting the sign bit.
+			gpr.MapDirtyIn(inst.dest, inst.src1);
+			if (inst.dest != inst.src1)
+				MOV(32, gpr.R(inst.dest), gpr.R(inst.src1));
+			SHR(32, gpr.R(inst.dest), Imm8(31));
+		} else {
+			gpr.MapDirtyIn(inst.dest, inst.src1);
+			setCC(Imm32(inst.constant), CC_L);
+		}
+		break;
+
+	case IROp::SltU:
+		gpr.MapDirtyInIn(inst.dest, inst.src1, inst.src2);
+		setCC(gpr.R(inst.src2), CC_B);
+		break;
+
+	case IROp::SltUConst:
+		if (inst.constant == 0) {
+			gpr.SetImm(inst.dest, 0);
+		} else {
+			gpr.MapDirtyIn(inst.dest, inst.src1);
+			setCC(Imm32(inst.constant), CC_B);
+		}
+		break;
+
+	default:
+		INVALIDOP;
+		break;
+	}
+}
+
+void X64IRJit::CompIR_CondAssign(IRInst inst) {
+	CONDITIONAL_DISABLE;
+
+	switch (inst.op) {
+	case IROp::MovZ:
+	case IROp::MovNZ:
+		if (inst.dest == inst.src2)
+			return;
+		// We need to load dest, since it may be kept as is.
+		gpr.MapDirtyInIn(inst.dest, inst.src1, inst.src2, MapType::ALWAYS_LOAD);
+		TEST(32, gpr.R(inst.src1), gpr.R(inst.src1));
+		CMOVcc(32, gpr.RX(inst.dest), gpr.R(inst.src2), inst.op == IROp::MovZ ? CC_Z : CC_NZ);
+		break;
+
+	case IROp::Max:
+	case IROp::Min:
+		if (inst.src1 != inst.src2) {
+			gpr.MapDirtyInIn(inst.dest, inst.src1, inst.src2);
+			// Both are commutative, so pick whichever source isn't already in dest.
+			IRRegIndex other = inst.dest == inst.src2 ? inst.src1 : inst.src2;
+			if (inst.dest != inst.src1 && inst.dest != inst.src2)
+				MOV(32, gpr.R(inst.dest), gpr.R(inst.src1));
+			CMP(32, gpr.R(inst.dest), gpr.R(other));
+			CMOVcc(32, gpr.RX(inst.dest), gpr.R(other), inst.op == IROp::Max ? CC_L : CC_G);
+		} else if (inst.dest != inst.src1) {
+			gpr.MapDirtyIn(inst.dest, inst.src1);
+			MOV(32, gpr.R(inst.dest), gpr.R(inst.src1));
+		}
+		break;
+
+	default:
+		INVALIDOP;
+		break;
+	}
+}
+
+void X64IRJit::CompIR_HiLo(IRInst inst) {
+	CONDITIONAL_DISABLE;
+
+	switch (inst.op) {
+	case IROp::MtLo:
+		gpr.MapDirtyIn(IRREG_LO, inst.src1);
+		MOV(32, gpr.R(IRREG_LO), gpr.R(inst.src1));
+		break;
+
+	case IROp::MtHi:
+		gpr.MapDirtyIn(IRREG_HI, inst.src1);
+		MOV(32, gpr.R(IRREG_HI), gpr.R(inst.src1));
+		break;
+
+	case IROp::MfLo:
+		gpr.MapDirtyIn(inst.dest, IRREG_LO);
+		MOV(32, gpr.R(inst.dest), gpr.R(IRREG_LO));
+		break;
+
+	case IROp::MfHi:
+		gpr.MapDirtyIn(inst.dest, IRREG_HI);
+		MOV(32, gpr.R(inst.dest), gpr.R(IRREG_HI));
+		break;
+
+	default:
+		INVALIDOP;
+		break;
+	}
+}
+
+void X64IRJit::CompIR_Mult(IRInst inst) {
+	CONDITIONAL_DISABLE;
+
+	// MUL/IMUL leave the 64-bit result in EDX:EAX, which are both scratch regs.
+	auto multiply = [&](bool isSigned) {
+		MOV(32, R(SCRATCH1), gpr.R(inst.src1));
+		if (isSigned)
+			IMUL(32, gpr.R(inst.src2));
+		else
+			MUL(32, gpr.R(inst.src2));
+	};
+
+	switch (inst.op) {
+	case IROp::Mult:
+	case IROp::MultU:
+		gpr.MapDirtyDirtyInIn(IRREG_LO, IRREG_HI, inst.src1, inst.src2);
+		multiply(inst.op == IROp::Mult);
+		MOV(32, gpr.R(IRREG_LO), R(SCRATCH1));
+		MOV(32, gpr.R(IRREG_HI), R(SCRATCH2));
+		break;
+
+	case IROp::Madd:
+	case IROp::MaddU:
+		gpr.MapDirtyDirtyInIn(IRREG_LO, IRREG_HI, inst.src1, inst.src2, MapType::ALWAYS_LOAD);
+		multiply(inst.op == IROp::Madd);
+		ADD(32, gpr.R(IRREG_LO), R(SCRATCH1));
+		ADC(32, gpr.R(IRREG_HI), R(SCRATCH2));
+		break;
+
+	case IROp::Msub:
+	case IROp::MsubU:
+		gpr.MapDirtyDirtyInIn(IRREG_LO, IRREG_HI, inst.src1, inst.src2, MapType::ALWAYS_LOAD);
+		multiply(inst.op == IROp::Msub);
+		SUB(32, gpr.R(IRREG_LO), R(SCRATCH1));
+		SBB(32, gpr.R(IRREG_HI), R(SCRATCH2));
+		break;
+
+	default:
+		INVALIDOP;
+		break;
+	}
+}
+
+void X64IRJit::CompIR_Div(IRInst inst) {
+	CONDITIONAL_DISABLE;
+
+	switch (inst.op) {
+	case IROp::Div:
+	{
+		gpr.MapDirtyDirtyInIn(IRREG_LO, IRREG_HI, inst.src1, inst.src2);
+		TEST(32, gpr.R(inst.src2), gpr.R(inst.src2));
+		FixupBranch divideByZero = J_CC(CC_E);
+
+		// INT_MIN / -1 would trap, but the PSP gives a defined result.
+		CMP(32, gpr.R(inst.src1), Imm32(0x80000000));
+		FixupBranch notOverflow1 = J_CC(CC_NE);
+		CMP(32, gpr.R(inst.src2), Imm32(-1));
+		FixupBranch notOverflow2 = J_CC(CC_NE);
+		MOV(32, gpr.R(IRREG_LO), Imm32(0x80000000));
+		MOV(32, gpr.R(IRREG_HI), Imm32(-1));
+		FixupBranch skip1 = J();
+
+		SetJumpTarget(notOverflow1);
+		SetJumpTarget(notOverflow2);
+		MOV(32, R(SCRATCH1), gpr.R(inst.src1));
+		CDQ();
+		IDIV(32, gpr.R(inst.src2));
+		MOV(32, gpr.R(IRREG_LO), R(SCRATCH1));
+		MOV(32, gpr.R(IRREG_HI), R(SCRATCH2));
+		FixupBranch skip2 = J();
+
+		// Dividing by zero gives 1 for negative numerators, -1 otherwise.
+		SetJumpTarget(divideByZero);
+		MOV(32, R(SCRATCH1), gpr.R(inst.src1));
+		SAR(32, R(SCRATCH1), Imm8(31));
+		OR(32, R(SCRATCH1), Imm8(1));
+		NEG(32, R(SCRATCH1));
+		MOV(32, gpr.R(IRREG_LO), R(SCRATCH1));
+		MOV(32, gpr.R(IRREG_HI), gpr.R(inst.src1));
+
+		SetJumpTarget(skip1);
+		SetJumpTarget(skip2);
+		break;
+	}
+
+	case IROp::DivU:
+	{
+		gpr.MapDirtyDirtyInIn(IRREG_LO, IRREG_HI, inst.src1, inst.src2);
+		TEST(32, gpr.R(inst.src2), gpr.R(inst.src2));
+		FixupBranch divideByZero = J_CC(CC_E);
+
+		MOV(32, R(SCRATCH1), gpr.R(inst.src1));
+		XOR(32, R(SCRATCH2), R(SCRATCH2));
+		DIV(32, gpr.R(inst.src2));
+		MOV(32, gpr.R(IRREG_LO), R(SCRATCH1));
+		MOV(32, gpr.R(IRREG_HI), R(SCRATCH2));
+		FixupBranch skip = J();
+
+		// Dividing by zero gives 0xFFFF for small numerators, -1 otherwise.
+		SetJumpTarget(divideByZero);
+		MOV(32, R(SCRATCH1), Imm32(-1));
+		MOV(32, R(SCRATCH2), Imm32(0xFFFF));
+		CMP(32, gpr.R(inst.src1), Imm32(0x10000));
+		CMOVcc(32, SCRATCH1, R(SCRATCH2), CC_B);
+		MOV(32, gpr.R(IRREG_LO), R(SCRATCH1));
+		MOV(32, gpr.R(IRREG_HI), gpr.R(inst.src1));
+
+		SetJumpTarget(skip);
+		break;
+	}
+
+	default:
+		INVALIDOP;
+		break;
+	}
+}
+
+} // namespace MIPSComp
+
+#endif
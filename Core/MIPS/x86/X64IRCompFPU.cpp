@@ -0,0 +1,399 @@
+// Copyright (c) 2023- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+#include "ppsspp_config.h"
+#if PPSSPP_ARCH(AMD64)
+
+#include "Core/MIPS/x86/X64IRJit.h"
+#include "Core/MIPS/x86/X64IRRegCache.h"
+
+// This file contains compilation for floating point related instructions.
+//
+// All functions should have CONDITIONAL_DISABLE, so we can narrow things down to a file quickly.
+// Currently known non working ones should have DISABLE.  No flags because that's in IR already.
+
+// #define CONDITIONAL_DISABLE { CompIR_Generic(inst); return; }
+#define CONDITIONAL_DISABLE {}
+#define DISABLE { CompIR_Generic(inst); return; }
+#define INVALIDOP { _assert_msg_(false, "Invalid IR inst %d", (int)inst.op); CompIR_Generic(inst); return; }
+
+namespace MIPSComp {
+
+using namespace Gen;
+using namespace X64IRJitConstants;
+
+alignas(16) static const u32 simdSignBits[4] = { 0x80000000, 0x80000000, 0x80000000, 0x80000000 };
+alignas(16) static const u32 simdNoSignBits[4] = { 0x7FFFFFFF, 0x7FFFFFFF, 0x7FFFFFFF, 0x7FFFFFFF };
+alignas(16) static const u32 simdReverseQNAN[4] = { 0x803FFFFF, 0x803FFFFF, 0x803FFFFF, 0x803FFFFF };
+
+static OpArg ConstantArg(XCodeBlock *emit, const void *ptr) {
+	if (emit->RipAccessible(ptr))
+		return M(ptr);  // rip accessible
+	emit->MOV(PTRBITS, R(SCRATCH1), ImmPtr(ptr));
+	return MatR(SCRATCH1);
+}
+
+void X64IRJit::CompIR_FArith(IRInst inst) {
+	CONDITIONAL_DISABLE;
+
+	auto triArith = [&](void (XEmitter::*op)(X64Reg, OpArg), bool orderMatters) {
+		fpr.MapDirtyInIn(inst.dest, inst.src1, inst.src2);
+		if (inst.dest == inst.src1) {
+			(this->*op)(fpr.RX(inst.dest), fpr.R(inst.src2));
+		} else if (inst.dest == inst.src2 && !orderMatters) {
+			(this->*op)(fpr.RX(inst.dest), fpr.R(inst.src1));
+		} else if (inst.dest != inst.src2) {
+			MOVAPS(fpr.RX(inst.dest), fpr.R(inst.src1));
+			(this->*op)(fpr.RX(inst.dest), fpr.R(inst.src2));
+		} else {
+			MOVAPS(XMMSCRATCH1, fpr.R(inst.src1));
+			(this->*op)(XMMSCRATCH1, fpr.R(inst.src2));
+			MOVAPS(fpr.RX(inst.dest), R(XMMSCRATCH1));
+		}
+	};
+
+	switch (inst.op) {
+	case IROp::FAdd:
+		triArith(&XEmitter::ADDSS, false);
+		break;
+
+	case IROp::FSub:
+		triArith(&XEmitter::SUBSS, true);
+		break;
+
+	case IROp::FMul:
+		// XMMSCRATCH2 = !my_isnan(src1) && !my_isnan(src2)
+		fpr.MapDirtyInIn(inst.dest, inst.src1, inst.src2);
+		MOVAPS(XMMSCRATCH2, fpr.R(inst.src1));
+		CMPORDSS(XMMSCRATCH2, fpr.R(inst.src2));
+		triArith(&XEmitter::MULSS, false);
+
+		// The PSP gives a positive NAN for inf * 0, but x86 gives a negative one.
+		// dest = my_isnan(dest) && !my_isnan(src1) && !my_isnan(src2)
+		MOVAPS(XMMSCRATCH1, fpr.R(inst.dest));
+		CMPUNORDSS(fpr.RX(inst.dest), fpr.R(inst.dest));
+		ANDPS(fpr.RX(inst.dest), R(XMMSCRATCH2));
+		// At this point dest = FFFFFFFF if non-NAN inputs produced a NAN output.
+		ANDPS(fpr.RX(inst.dest), ConstantArg(this, &simdReverseQNAN));
+		// ANDN is backwards, which is why we saved XMMSCRATCH1 to start.
+		ANDNPS(fpr.RX(inst.dest), R(XMMSCRATCH1));
+		break;
+
+	case IROp::FDiv:
+		triArith(&XEmitter::DIVSS, true);
+		break;
+
+	case IROp::FSqrt:
+		fpr.MapDirtyIn(inst.dest, inst.src1);
+		SQRTSS(fpr.RX(inst.dest), fpr.R(inst.src1));
+		break;
+
+	case IROp::FNeg:
+		fpr.MapDirtyIn(inst.dest, inst.src1);
+		if (inst.dest != inst.src1)
+			MOVAPS(fpr.RX(inst.dest), fpr.R(inst.src1));
+		XORPS(fpr.RX(inst.dest), ConstantArg(this, &simdSignBits));
+		break;
+
+	default:
+		INVALIDOP;
+		break;
+	}
+}
+
+void X64IRJit::CompIR_FCondAssign(IRInst inst) {
+	CONDITIONAL_DISABLE;
+
+	switch (inst.op) {
+	case IROp::FMin:
+	case IROp::FMax:
+		// These have special NAN handling, based on the integer value.
+		CompIR_Generic(inst);
+		break;
+
+	default:
+		INVALIDOP;
+		break;
+	}
+}
+
+void X64IRJit::CompIR_FAssign(IRInst inst) {
+	CONDITIONAL_DISABLE;
+
+	switch (inst.op) {
+	case IROp::FMov:
+		if (inst.dest != inst.src1) {
+			fpr.MapDirtyIn(inst.dest, inst.src1);
+			MOVAPS(fpr.RX(inst.dest), fpr.R(inst.src1));
+		}
+		break;
+
+	case IROp::FAbs:
+		fpr.MapDirtyIn(inst.dest, inst.src1);
+		if (inst.dest != inst.src1)
+			MOVAPS(fpr.RX(inst.dest), fpr.R(inst.src1));
+		ANDPS(fpr.RX(inst.dest), ConstantArg(this, &simdNoSignBits));
+		break;
+
+	case IROp::FSign:
+		CompIR_Generic(inst);
+		break;
+
+	default:
+		INVALIDOP;
+		break;
+	}
+}
+
+void X64IRJit::CompIR_FRound(IRInst inst) {
+	CONDITIONAL_DISABLE;
+
+	// Pass -1 to use the current rounding mode, otherwise an MXCSR rounding mode.
+	auto execRounding = [&](void (XEmitter::*conv)(X64Reg, OpArg), int setMXCSR) {
+		fpr.MapDirtyIn(inst.dest, inst.src1);
+		if (setMXCSR != -1) {
+			STMXCSR(MIPSSTATE_VAR(mxcsrTemp));
+			MOV(32, R(SCRATCH1), MIPSSTATE_VAR(mxcsrTemp));
+			AND(32, R(SCRATCH1), Imm32(~(3 << 13)));
+			OR(32, R(SCRATCH1), Imm32(setMXCSR << 13));
+			MOV(32, MIPSSTATE_VAR(temp), R(SCRATCH1));
+			LDMXCSR(MIPSSTATE_VAR(temp));
+		}
+
+		(this->*conv)(SCRATCH1, fpr.R(inst.src1));
+
+		// Did we get an indefinite integer value?
+		CMP(32, R(SCRATCH1), Imm32(0x80000000));
+		FixupBranch skip = J_CC(CC_NE);
+		if (inst.dest != inst.src1)
+			MOVAPS(fpr.RX(inst.dest), fpr.R(inst.src1));
+		XORPS(XMMSCRATCH2, R(XMMSCRATCH2));
+		CMPSS(fpr.RX(inst.dest), R(XMMSCRATCH2), CMP_LT);
+
+		// At this point, -inf = 0xffffffff, inf/nan = 0x00000000.
+		// We want -inf to be 0x80000000 inf/nan to be 0x7fffffff, so we flip those bits.
+		MOVD_xmm(R(SCRATCH1), fpr.RX(inst.dest));
+		XOR(32, R(SCRATCH1), Imm32(0x7fffffff));
+
+		SetJumpTarget(skip);
+		MOVD_xmm(fpr.RX(inst.dest), R(SCRATCH1));
+
+		if (setMXCSR != -1)
+			LDMXCSR(MIPSSTATE_VAR(mxcsrTemp));
+	};
+
+	switch (inst.op) {
+	case IROp::FRound:
+		execRounding(&XEmitter::CVTSS2SI, 0);
+		break;
+
+	case IROp::FTrunc:
+		execRounding(&XEmitter::CVTTSS2SI, -1);
+		break;
+
+	case IROp::FCeil:
+		execRounding(&XEmitter::CVTSS2SI, 2);
+		break;
+
+	case IROp::FFloor:
+		execRounding(&XEmitter::CVTSS2SI, 1);
+		break;
+
+	default:
+		INVALIDOP;
+		break;
+	}
+}
+
+void X64IRJit::CompIR_FCvt(IRInst inst) {
+	CONDITIONAL_DISABLE;
+
+	switch (inst.op) {
+	case IROp::FCvtWS:
+	{
+		// Uses the current rounding mode, which ApplyRoundingMode() put into MXCSR.
+		fpr.MapDirtyIn(inst.dest, inst.src1);
+		CVTSS2SI(SCRATCH1, fpr.R(inst.src1));
+
+		CMP(32, R(SCRATCH1), Imm32(0x80000000));
+		FixupBranch skip = J_CC(CC_NE);
+		if (inst.dest != inst.src1)
+			MOVAPS(fpr.RX(inst.dest), fpr.R(inst.src1));
+		XORPS(XMMSCRATCH2, R(XMMSCRATCH2));
+		CMPSS(fpr.RX(inst.dest), R(XMMSCRATCH2), CMP_LT);
+		MOVD_xmm(R(SCRATCH1), fpr.RX(inst.dest));
+		XOR(32, R(SCRATCH1), Imm32(0x7fffffff));
+
+		SetJumpTarget(skip);
+		MOVD_xmm(fpr.RX(inst.dest), R(SCRATCH1));
+		break;
+	}
+
+	case IROp::FCvtSW:
+		fpr.MapDirtyIn(inst.dest, inst.src1);
+		CVTDQ2PS(fpr.RX(inst.dest), fpr.R(inst.src1));
+		break;
+
+	case IROp::FCvtScaledWS:
+	case IROp::FCvtScaledSW:
+		CompIR_Generic(inst);
+		break;
+
+	default:
+		INVALIDOP;
+		break;
+	}
+}
+
+void X64IRJit::CompIR_FSat(IRInst inst) {
+	CONDITIONAL_DISABLE;
+
+	switch (inst.op) {
+	case IROp::FSat0_1:
+	case IROp::FSatMinus1_1:
+		// These need care for NAN and -0.0f, see vfpu_clamp().
+		CompIR_Generic(inst);
+		break;
+
+	default:
+		INVALIDOP;
+		break;
+	}
+}
+
+void X64IRJit::CompIR_FCompare(IRInst inst) {
+	CONDITIONAL_DISABLE;
+
+	// UCOMISS sets ZF, PF, and CF all to 1 for unordered.
+	auto compareToFpCond = [&](IRRegIndex lhs, IRRegIndex rhs, CCFlags cc) {
+		fpr.MapInIn(lhs, rhs);
+		X64Reg fpcondReg = gpr.MapReg(IRREG_FPCOND, MIPSMap::NOINIT);
+		// Zero first, since SETcc only writes the low byte.
+		XOR(32, R(fpcondReg), R(fpcondReg));
+		UCOMISS(fpr.RX(lhs), fpr.R(rhs));
+		SETcc(cc, R(fpcondReg));
+	};
+
+	switch (inst.op) {
+	case IROp::FCmp:
+		switch (inst.dest) {
+		case IRFpCompareMode::False:
+			gpr.SetImm(IRREG_FPCOND, 0);
+			break;
+
+		case IRFpCompareMode::EitherUnordered:
+			compareToFpCond(inst.src1, inst.src2, CC_P);
+			break;
+
+		case IRFpCompareMode::EqualOrdered:
+		{
+			fpr.MapInIn(inst.src1, inst.src2);
+			X64Reg fpcondReg = gpr.MapReg(IRREG_FPCOND, MIPSMap::NOINIT);
+			XOR(32, R(fpcondReg), R(fpcondReg));
+			XOR(32, R(SCRATCH1), R(SCRATCH1));
+			UCOMISS(fpr.RX(inst.src1), fpr.R(inst.src2));
+			SETcc(CC_E, R(fpcondReg));
+			SETcc(CC_NP, R(SCRATCH1));
+			AND(32, R(fpcondReg), R(SCRATCH1));
+			break;
+		}
+
+		case IRFpCompareMode::EqualUnordered:
+			compareToFpCond(inst.src1, inst.src2, CC_E);
+			break;
+
+		case IRFpCompareMode::LessEqualOrdered:
+			// Swap the operands: src2 >= src1 is false for unordered.
+			compareToFpCond(inst.src2, inst.src1, CC_AE);
+			break;
+
+		case IRFpCompareMode::LessEqualUnordered:
+			compareToFpCond(inst.src1, inst.src2, CC_BE);
+			break;
+
+		case IRFpCompareMode::LessOrdered:
+			compareToFpCond(inst.src2, inst.src1, CC_A);
+			break;
+
+		case IRFpCompareMode::LessUnordered:
+			compareToFpCond(inst.src1, inst.src2, CC_B);
+			break;
+
+		default:
+			INVALIDOP;
+			break;
+		}
+		break;
+
+	case IROp::FCmovVfpuCC:
+	case IROp::FCmpVfpuBit:
+	case IROp::FCmpVfpuAggregate:
+		CompIR_Generic(inst);
+		break;
+
+	default:
+		INVALIDOP;
+		break;
+	}
+}
+
+void X64IRJit::CompIR_RoundingMode(IRInst inst) {
+	CONDITIONAL_DISABLE;
+
+	switch (inst.op) {
+	case IROp::RestoreRoundingMode:
+		RestoreRoundingMode();
+		break;
+
+	case IROp::ApplyRoundingMode:
+		ApplyRoundingMode();
+		break;
+
+	case IROp::UpdateRoundingMode:
+		// Unlike RISC-V, MXCSR must be updated.  Apply skips mode 0, so clear first.
+		RestoreRoundingMode();
+		ApplyRoundingMode();
+		break;
+
+	default:
+		INVALIDOP;
+		break;
+	}
+}
+
+void X64IRJit::CompIR_FSpecial(IRInst inst) {
+	CONDITIONAL_DISABLE;
+
+	switch (inst.op) {
+	case IROp::FSin:
+	case IROp::FCos:
+	case IROp::FRSqrt:
+	case IROp::FRecip:
+	case IROp::FAsin:
+		// These need to match the VFPU tables, so just call the interpreter.
+		CompIR_Generic(inst);
+		break;
+
+	default:
+		INVALIDOP;
+		break;
+	}
+}
+
+} // namespace MIPSComp
+
+#endif
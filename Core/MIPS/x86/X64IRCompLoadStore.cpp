@@ -0,0 +1,268 @@
+// Copyright (c) 2023- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+#include "ppsspp_config.h"
+#if PPSSPP_ARCH(AMD64)
+
+#include "Core/MemMap.h"
+#include "Core/MIPS/x86/X64IRJit.h"
+#include "Core/MIPS/x86/X64IRRegCache.h"
+
+// This file contains compilation for load/store instructions.
+//
+// All functions should have CONDITIONAL_DISABLE, so we can narrow things down to a file quickly.
+// Currently known non working ones should have DISABLE.  No flags because that's in IR already.
+
+// #define CONDITIONAL_DISABLE { CompIR_Generic(inst); return; }
+#define CONDITIONAL_DISABLE {}
+#define DISABLE { CompIR_Generic(inst); return; }
+#define INVALIDOP { _assert_msg_(false, "Invalid IR inst %d", (int)inst.op); CompIR_Generic(inst); return; }
+
+namespace MIPSComp {
+
+using namespace Gen;
+using namespace X64IRJitConstants;
+
+// Note: accesses should stay plain MOV/MOVZX/MOVSX/MOVSS so the fault handler can analyze them.
+
+void X64IRJit::CompIR_Load(IRInst inst) {
+	CONDITIONAL_DISABLE;
+
+	if (inst.dest == MIPS_REG_ZERO && inst.op != IROp::Load32Linked)
+		return;
+
+	gpr.SpillLock(inst.dest, inst.src1);
+	OpArg addrArg = PrepareSrc1Address(inst);
+	// The address is already computed, so it's fine if dest == src1.
+	X64Reg destReg = INVALID_REG;
+	if (inst.dest != MIPS_REG_ZERO)
+		destReg = gpr.MapReg(inst.dest, MIPSMap::NOINIT);
+
+	// TODO: Safe memory?  Or enough to have crash handler + validate?
+
+	switch (inst.op) {
+	case IROp::Load8:
+		MOVZX(32, 8, destReg, addrArg);
+		break;
+
+	case IROp::Load8Ext:
+		MOVSX(32, 8, destReg, addrArg);
+		break;
+
+	case IROp::Load16:
+		MOVZX(32, 16, destReg, addrArg);
+		break;
+
+	case IROp::Load16Ext:
+		MOVSX(32, 16, destReg, addrArg);
+		break;
+
+	case IROp::Load32:
+		MOV(32, R(destReg), addrArg);
+		break;
+
+	case IROp::Load32Linked:
+		if (inst.dest != MIPS_REG_ZERO)
+			MOV(32, R(destReg), addrArg);
+		MOV(32, MIPSSTATE_VAR(llBit), Imm32(1));
+		break;
+
+	default:
+		INVALIDOP;
+		break;
+	}
+}
+
+void X64IRJit::CompIR_LoadShift(IRInst inst) {
+	CONDITIONAL_DISABLE;
+
+	switch (inst.op) {
+	case IROp::Load32Left:
+	case IROp::Load32Right:
+		// Should not happen if the pass to split is active.
+		DISABLE;
+		break;
+
+	default:
+		INVALIDOP;
+		break;
+	}
+}
+
+void X64IRJit::CompIR_FLoad(IRInst inst) {
+	CONDITIONAL_DISABLE;
+
+	gpr.SpillLock(inst.src1);
+	OpArg addrArg = PrepareSrc1Address(inst);
+
+	switch (inst.op) {
+	case IROp::LoadFloat:
+		MOVSS(fpr.MapReg(inst.dest, MIPSMap::NOINIT), addrArg);
+		break;
+
+	default:
+		INVALIDOP;
+		break;
+	}
+}
+
+void X64IRJit::CompIR_VecLoad(IRInst inst) {
+	CONDITIONAL_DISABLE;
+
+	switch (inst.op) {
+	case IROp::LoadVec4:
+		// Each lane is its own scalar register, so load them one at a time.
+		gpr.SpillLock(inst.src1);
+		for (int i = 0; i < 4; ++i)
+			fpr.SpillLock(inst.dest + i);
+		for (int i = 0; i < 4; ++i) {
+			IRInst laneInst = inst;
+			laneInst.constant += 4 * i;
+			OpArg addrArg = PrepareSrc1Address(laneInst);
+			MOVSS(fpr.MapReg(inst.dest + i, MIPSMap::NOINIT), addrArg);
+		}
+		break;
+
+	default:
+		INVALIDOP;
+		break;
+	}
+}
+
+void X64IRJit::CompIR_Store(IRInst inst) {
+	CONDITIONAL_DISABLE;
+
+	gpr.SpillLock(inst.src3, inst.src1);
+	OpArg addrArg = PrepareSrc1Address(inst);
+
+	OpArg valueArg;
+	if (gpr.IsImm(inst.src3)) {
+		u32 imm = gpr.GetImm(inst.src3);
+		switch (inst.op) {
+		case IROp::Store8: valueArg = Imm8((u8)imm); break;
+		case IROp::Store16: valueArg = Imm16((u16)imm); break;
+		default: valueArg = Imm32(imm); break;
+		}
+	} else {
+		valueArg = R(gpr.MapReg(inst.src3));
+	}
+
+	// TODO: Safe memory?  Or enough to have crash handler + validate?
+
+	switch (inst.op) {
+	case IROp::Store8:
+		MOV(8, addrArg, valueArg);
+		break;
+
+	case IROp::Store16:
+		MOV(16, addrArg, valueArg);
+		break;
+
+	case IROp::Store32:
+		MOV(32, addrArg, valueArg);
+		break;
+
+	default:
+		INVALIDOP;
+		break;
+	}
+}
+
+void X64IRJit::CompIR_CondStore(IRInst inst) {
+	CONDITIONAL_DISABLE;
+	if (inst.op != IROp::Store32Conditional)
+		INVALIDOP;
+
+	// Note that dest and src3 are the same register here.
+	gpr.SpillLock(inst.src3, inst.src1);
+	OpArg addrArg = PrepareSrc1Address(inst);
+	gpr.MapReg(inst.src3, inst.dest == MIPS_REG_ZERO ? MIPSMap::INIT : MIPSMap::DIRTY);
+
+	CMP(32, MIPSSTATE_VAR(llBit), Imm8(0));
+	FixupBranch condFailed = J_CC(CC_E);
+	MOV(32, addrArg, gpr.R(inst.src3));
+
+	if (inst.dest != MIPS_REG_ZERO) {
+		MOV(32, gpr.R(inst.dest), Imm32(1));
+		FixupBranch finish = J();
+
+		SetJumpTarget(condFailed);
+		XOR(32, gpr.R(inst.dest), gpr.R(inst.dest));
+		SetJumpTarget(finish);
+	} else {
+		SetJumpTarget(condFailed);
+	}
+}
+
+void X64IRJit::CompIR_StoreShift(IRInst inst) {
+	CONDITIONAL_DISABLE;
+
+	switch (inst.op) {
+	case IROp::Store32Left:
+	case IROp::Store32Right:
+		// Should not happen if the pass to split is active.
+		DISABLE;
+		break;
+
+	default:
+		INVALIDOP;
+		break;
+	}
+}
+
+void X64IRJit::CompIR_FStore(IRInst inst) {
+	CONDITIONAL_DISABLE;
+
+	gpr.SpillLock(inst.src1);
+	OpArg addrArg = PrepareSrc1Address(inst);
+
+	switch (inst.op) {
+	case IROp::StoreFloat:
+		MOVSS(addrArg, fpr.MapReg(inst.src3));
+		break;
+
+	default:
+		INVALIDOP;
+		break;
+	}
+}
+
+void X64IRJit::CompIR_VecStore(IRInst inst) {
+	CONDITIONAL_DISABLE;
+
+	switch (inst.op) {
+	case IROp::StoreVec4:
+		gpr.SpillLock(inst.src1);
+		for (int i = 0; i < 4; ++i)
+			fpr.SpillLock(inst.src3 + i);
+		for (int i = 0; i < 4; ++i) {
+			IRInst laneInst = inst;
+			laneInst.constant += 4 * i;
+			OpArg addrArg = PrepareSrc1Address(laneInst);
+			MOVSS(addrArg, fpr.MapReg(inst.src3 + i));
+		}
+		break;
+
+	default:
+		INVALIDOP;
+		break;
+	}
+}
+
+} // namespace MIPSComp
+
+#endif
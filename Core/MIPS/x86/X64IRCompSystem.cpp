@@ -0,0 +1,248 @@
+// Copyright (c) 2023- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+#include "ppsspp_config.h"
+#if PPSSPP_ARCH(AMD64)
+
+#include "Common/Profiler/Profiler.h"
+#include "Core/Core.h"
+#include "Core/HLE/HLE.h"
+#include "Core/HLE/ReplaceTables.h"
+#include "Core/MemMap.h"
+#include "Core/MIPS/x86/X64IRJit.h"
+#include "Core/MIPS/x86/X64IRRegCache.h"
+
+// This file contains compilation for basic PC/downcount accounting, syscalls, debug funcs, etc.
+//
+// All functions should have CONDITIONAL_DISABLE, so we can narrow things down to a file quickly.
+// Currently known non working ones should have DISABLE.  No flags because that's in IR already.
+
+// #define CONDITIONAL_DISABLE { CompIR_Generic(inst); return; }
+#define CONDITIONAL_DISABLE {}
+#define DISABLE { CompIR_Generic(inst); return; }
+#define INVALIDOP { _assert_msg_(false, "Invalid IR inst %d", (int)inst.op); CompIR_Generic(inst); return; }
+
+namespace MIPSComp {
+
+using namespace Gen;
+using namespace X64IRJitConstants;
+
+void X64IRJit::CompIR_Basic(IRInst inst) {
+	CONDITIONAL_DISABLE;
+
+	switch (inst.op) {
+	case IROp::SetConst:
+		gpr.SetImm(inst.dest, inst.constant);
+		break;
+
+	case IROp::SetConstF:
+		fpr.MapReg(inst.dest, MIPSMap::NOINIT);
+		if (inst.constant == 0) {
+			XORPS(fpr.RX(inst.dest), fpr.R(inst.dest));
+		} else {
+			MOV(32, R(SCRATCH1), Imm32(inst.constant));
+			MOVD_xmm(fpr.RX(inst.dest), R(SCRATCH1));
+		}
+		break;
+
+	case IROp::Downcount:
+		SUB(32, MIPSSTATE_VAR(downcount), Imm32(inst.constant));
+		break;
+
+	case IROp::SetPC:
+		gpr.MapIn(inst.src1);
+		MOV(32, MIPSSTATE_VAR(pc), gpr.R(inst.src1));
+		break;
+
+	case IROp::SetPCConst:
+		MOV(32, MIPSSTATE_VAR(pc), Imm32(inst.constant));
+		break;
+
+	default:
+		INVALIDOP;
+		break;
+	}
+}
+
+void X64IRJit::CompIR_Transfer(IRInst inst) {
+	CONDITIONAL_DISABLE;
+
+	switch (inst.op) {
+	case IROp::SetCtrlVFPU:
+		gpr.SetImm(IRREG_VFPU_CTRL_BASE + inst.dest, inst.constant);
+		break;
+
+	case IROp::SetCtrlVFPUReg:
+		gpr.MapDirtyIn(IRREG_VFPU_CTRL_BASE + inst.dest, inst.src1);
+		MOV(32, gpr.R(IRREG_VFPU_CTRL_BASE + inst.dest), gpr.R(inst.src1));
+		break;
+
+	case IROp::SetCtrlVFPUFReg:
+		gpr.MapReg(IRREG_VFPU_CTRL_BASE + inst.dest, MIPSMap::NOINIT);
+		fpr.MapReg(inst.src1);
+		MOVD_xmm(gpr.R(IRREG_VFPU_CTRL_BASE + inst.dest), fpr.RX(inst.src1));
+		break;
+
+	case IROp::FpCondToReg:
+		gpr.MapDirtyIn(inst.dest, IRREG_FPCOND);
+		MOV(32, gpr.R(inst.dest), gpr.R(IRREG_FPCOND));
+		break;
+
+	case IROp::ZeroFpCond:
+		gpr.SetImm(IRREG_FPCOND, 0);
+		break;
+
+	case IROp::FpCtrlFromReg:
+		gpr.MapDirtyIn(IRREG_FPCOND, inst.src1);
+		MOV(32, R(SCRATCH1), gpr.R(inst.src1));
+		AND(32, R(SCRATCH1), Imm32(0x0181FFFF));
+		MOV(32, MIPSSTATE_VAR(fcr31), R(SCRATCH1));
+		// Extract the new fpcond value.
+		SHR(32, R(SCRATCH1), Imm8(23));
+		AND(32, R(SCRATCH1), Imm8(1));
+		MOV(32, gpr.R(IRREG_FPCOND), R(SCRATCH1));
+		break;
+
+	case IROp::FpCtrlToReg:
+		gpr.MapDirtyIn(inst.dest, IRREG_FPCOND);
+		// Load fcr31 and clear the fpcond bit.
+		MOV(32, R(SCRATCH1), MIPSSTATE_VAR(fcr31));
+		AND(32, R(SCRATCH1), Imm32(~(1 << 23)));
+
+		// Now get the correct fpcond bit.
+		MOV(32, R(SCRATCH2), gpr.R(IRREG_FPCOND));
+		AND(32, R(SCRATCH2), Imm8(1));
+		SHL(32, R(SCRATCH2), Imm8(23));
+		OR(32, R(SCRATCH1), R(SCRATCH2));
+		MOV(32, gpr.R(inst.dest), R(SCRATCH1));
+
+		// Also update mips->fcr31 while we're here.
+		MOV(32, MIPSSTATE_VAR(fcr31), R(SCRATCH1));
+		break;
+
+	case IROp::VfpuCtrlToReg:
+		gpr.MapDirtyIn(inst.dest, IRREG_VFPU_CTRL_BASE + inst.src1);
+		MOV(32, gpr.R(inst.dest), gpr.R(IRREG_VFPU_CTRL_BASE + inst.src1));
+		break;
+
+	case IROp::FMovFromGPR:
+		fpr.MapReg(inst.dest, MIPSMap::NOINIT);
+		if (gpr.IsImm(inst.src1) && gpr.GetImm(inst.src1) == 0) {
+			XORPS(fpr.RX(inst.dest), fpr.R(inst.dest));
+		} else {
+			gpr.MapReg(inst.src1);
+			MOVD_xmm(fpr.RX(inst.dest), gpr.R(inst.src1));
+		}
+		break;
+
+	case IROp::FMovToGPR:
+		gpr.MapReg(inst.dest, MIPSMap::NOINIT);
+		fpr.MapReg(inst.src1);
+		MOVD_xmm(gpr.R(inst.dest), fpr.RX(inst.src1));
+		break;
+
+	default:
+		INVALIDOP;
+		break;
+	}
+}
+
+void X64IRJit::CompIR_System(IRInst inst) {
+	CONDITIONAL_DISABLE;
+
+	switch (inst.op) {
+	case IROp::Syscall:
+		FlushAll();
+
+#ifdef USE_PROFILER
+		// When profiling, we can't skip CallSyscall, since it times syscalls.
+		ABI_CallFunctionC((const void *)&CallSyscall, inst.constant);
+#else
+		// Skip the CallSyscall where possible.
+		{
+			MIPSOpcode op(inst.constant);
+			void *quickFunc = GetQuickSyscallFunc(op);
+			if (quickFunc) {
+				ABI_CallFunctionP(quickFunc, (void *)GetSyscallFuncPointer(op));
+			} else {
+				ABI_CallFunctionC((const void *)&CallSyscall, inst.constant);
+			}
+		}
+#endif
+
+		// This is always followed by an ExitToPC, where we check coreState.
+		break;
+
+	case IROp::CallReplacement:
+		FlushAll();
+		ABI_CallFunction(GetReplacementFunc(inst.constant)->replaceFunc);
+		// The function returns the number of cycles it took in EAX.
+		SUB(32, MIPSSTATE_VAR(downcount), R(EAX));
+		break;
+
+	case IROp::Break:
+		FlushAll();
+		// This doesn't naturally have restore/apply around it.
+		RestoreRoundingMode(true);
+		ABI_CallFunctionA((const void *)&Core_Break, MIPSSTATE_VAR(pc));
+		ApplyRoundingMode(true);
+		MOV(32, R(SCRATCH1), MIPSSTATE_VAR(pc));
+		ADD(32, R(SCRATCH1), Imm8(4));
+		JMP(dispatcherPCInSCRATCH1_, true);
+		break;
+
+	default:
+		INVALIDOP;
+		break;
+	}
+}
+
+void X64IRJit::CompIR_Breakpoint(IRInst inst) {
+	CONDITIONAL_DISABLE;
+
+	switch (inst.op) {
+	case IROp::Breakpoint:
+	case IROp::MemoryCheck:
+		CompIR_Generic(inst);
+		break;
+
+	default:
+		INVALIDOP;
+		break;
+	}
+}
+
+void X64IRJit::CompIR_ValidateAddress(IRInst inst) {
+	CONDITIONAL_DISABLE;
+
+	switch (inst.op) {
+	case IROp::ValidateAddress8:
+	case IROp::ValidateAddress16:
+	case IROp::ValidateAddress32:
+	case IROp::ValidateAddress128:
+		CompIR_Generic(inst);
+		break;
+
+	default:
+		INVALIDOP;
+		break;
+	}
+}
+
+} // namespace MIPSComp
+
+#endif
@@ -0,0 +1,258 @@
+// Copyright (c) 2023- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+#include "ppsspp_config.h"
+#if PPSSPP_ARCH(AMD64)
+
+#include "Core/MIPS/x86/X64IRJit.h"
+#include "Core/MIPS/x86/X64IRRegCache.h"
+
+// This file contains compilation for vector instructions.
+//
+// All functions should have CONDITIONAL_DISABLE, so we can narrow things down to a file quickly.
+// Currently known non working ones should have DISABLE.  No flags because that's in IR already.
+
+// #define CONDITIONAL_DISABLE { CompIR_Generic(inst); return; }
+#define CONDITIONAL_DISABLE {}
+#define DISABLE { CompIR_Generic(inst); return; }
+#define INVALIDOP { _assert_msg_(false, "Invalid IR inst %d", (int)inst.op); CompIR_Generic(inst); return; }
+
+namespace MIPSComp {
+
+using namespace Gen;
+using namespace X64IRJitConstants;
+
+// The FPU cache keeps each lane in its own XMM reg, so vectors are handled per lane.
+// Lanes are processed in order, which is only safe if dest and src are the same or don't overlap.
+static bool OverlapsPartially(int dest, int src) {
+	return dest != src && dest < src + 4 && dest + 4 > src;
+}
+
+alignas(16) static const u32 vecSignBits[4] = { 0x80000000, 0x80000000, 0x80000000, 0x80000000 };
+alignas(16) static const u32 vecNoSignBits[4] = { 0x7FFFFFFF, 0x7FFFFFFF, 0x7FFFFFFF, 0x7FFFFFFF };
+
+void X64IRJit::CompIR_VecAssign(IRInst inst) {
+	CONDITIONAL_DISABLE;
+
+	switch (inst.op) {
+	case IROp::Vec4Init:
+	{
+		for (int i = 0; i < 4; ++i)
+			fpr.SpillLock(inst.dest + i);
+		for (int i = 0; i < 4; ++i)
+			fpr.MapReg(inst.dest + i, MIPSMap::NOINIT);
+		for (int i = 0; i < 4; ++i)
+			fpr.ReleaseSpillLock(inst.dest + i);
+
+		// Figure out the value of each lane, then set them.
+		u32 lanes[4]{};
+		switch ((Vec4Init)inst.src1) {
+		case Vec4Init::AllZERO: break;
+		case Vec4Init::AllONE: lanes[0] = lanes[1] = lanes[2] = lanes[3] = 0x3F800000; break;
+		case Vec4Init::AllMinusONE: lanes[0] = lanes[1] = lanes[2] = lanes[3] = 0xBF800000; break;
+		case Vec4Init::Set_1000: lanes[0] = 0x3F800000; break;
+		case Vec4Init::Set_0100: lanes[1] = 0x3F800000; break;
+		case Vec4Init::Set_0010: lanes[2] = 0x3F800000; break;
+		case Vec4Init::Set_0001: lanes[3] = 0x3F800000; break;
+		}
+
+		for (int i = 0; i < 4; ++i) {
+			if (lanes[i] == 0) {
+				XORPS(fpr.RX(inst.dest + i), fpr.R(inst.dest + i));
+			} else {
+				MOV(32, R(SCRATCH1), Imm32(lanes[i]));
+				MOVD_xmm(fpr.RX(inst.dest + i), R(SCRATCH1));
+			}
+		}
+		break;
+	}
+
+	case IROp::Vec4Shuffle:
+		if (inst.dest == inst.src1 || OverlapsPartially(inst.dest, inst.src1)) {
+			// Lanes would be clobbered before they're read.
+			DISABLE;
+		}
+		fpr.Map4DirtyIn(inst.dest, inst.src1);
+		for (int i = 0; i < 4; ++i) {
+			int lane = (inst.src2 >> (i * 2)) & 3;
+			MOVAPS(fpr.RX(inst.dest + i), fpr.R(inst.src1 + lane));
+		}
+		break;
+
+	case IROp::Vec4Mov:
+		if (OverlapsPartially(inst.dest, inst.src1))
+			DISABLE;
+		if (inst.dest == inst.src1)
+			break;
+		fpr.Map4DirtyIn(inst.dest, inst.src1);
+		for (int i = 0; i < 4; ++i)
+			MOVAPS(fpr.RX(inst.dest + i), fpr.R(inst.src1 + i));
+		break;
+
+	default:
+		INVALIDOP;
+		break;
+	}
+}
+
+void X64IRJit::CompIR_VecArith(IRInst inst) {
+	CONDITIONAL_DISABLE;
+
+	auto laneArith = [&](void (XEmitter::*op)(X64Reg, OpArg), bool orderMatters) {
+		if (OverlapsPartially(inst.dest, inst.src1) || OverlapsPartially(inst.dest, inst.src2)) {
+			CompIR_Generic(inst);
+			return;
+		}
+
+		fpr.Map4DirtyInIn(inst.dest, inst.src1, inst.src2);
+		for (int i = 0; i < 4; ++i) {
+			X64Reg destReg = fpr.RX(inst.dest + i);
+			if (inst.dest == inst.src1) {
+				(this->*op)(destReg, fpr.R(inst.src2 + i));
+			} else if (inst.dest == inst.src2 && !orderMatters) {
+				(this->*op)(destReg, fpr.R(inst.src1 + i));
+			} else if (inst.dest != inst.src2) {
+				MOVAPS(destReg, fpr.R(inst.src1 + i));
+				(this->*op)(destReg, fpr.R(inst.src2 + i));
+			} else {
+				MOVAPS(XMMSCRATCH1, fpr.R(inst.src1 + i));
+				(this->*op)(XMMSCRATCH1, fpr.R(inst.src2 + i));
+				MOVAPS(destReg, R(XMMSCRATCH1));
+			}
+		}
+	};
+
+	auto laneBitwise = [&](const void *mask, void (XEmitter::*op)(X64Reg, OpArg)) {
+		if (OverlapsPartially(inst.dest, inst.src1)) {
+			CompIR_Generic(inst);
+			return;
+		}
+
+		fpr.Map4DirtyIn(inst.dest, inst.src1);
+		if (RipAccessible(mask)) {
+			MOVAPS(XMMSCRATCH1, M(mask));  // rip accessible
+		} else {
+			MOV(PTRBITS, R(SCRATCH1), ImmPtr(mask));
+			MOVAPS(XMMSCRATCH1, MatR(SCRATCH1));
+		}
+		for (int i = 0; i < 4; ++i) {
+			if (inst.dest != inst.src1)
+				MOVAPS(fpr.RX(inst.dest + i), fpr.R(inst.src1 + i));
+			(this->*op)(fpr.RX(inst.dest + i), R(XMMSCRATCH1));
+		}
+	};
+
+	switch (inst.op) {
+	case IROp::Vec4Add:
+		laneArith(&XEmitter::ADDSS, false);
+		break;
+
+	case IROp::Vec4Sub:
+		laneArith(&XEmitter::SUBSS, true);
+		break;
+
+	case IROp::Vec4Mul:
+		laneArith(&XEmitter::MULSS, false);
+		break;
+
+	case IROp::Vec4Div:
+		laneArith(&XEmitter::DIVSS, true);
+		break;
+
+	case IROp::Vec4Scale:
+		if (OverlapsPartially(inst.dest, inst.src1) || (inst.src2 >= inst.dest && inst.src2 < inst.dest + 4)) {
+			DISABLE;
+		}
+		fpr.SpillLock(inst.src2);
+		fpr.MapReg(inst.src2);
+		fpr.Map4DirtyIn(inst.dest, inst.src1);
+		fpr.ReleaseSpillLock(inst.src2);
+		for (int i = 0; i < 4; ++i) {
+			if (inst.dest != inst.src1)
+				MOVAPS(fpr.RX(inst.dest + i), fpr.R(inst.src1 + i));
+			MULSS(fpr.RX(inst.dest + i), fpr.R(inst.src2));
+		}
+		break;
+
+	case IROp::Vec4Neg:
+		laneBitwise(&vecSignBits, &XEmitter::XORPS);
+		break;
+
+	case IROp::Vec4Abs:
+		laneBitwise(&vecNoSignBits, &XEmitter::ANDPS);
+		break;
+
+	default:
+		INVALIDOP;
+		break;
+	}
+}
+
+void X64IRJit::CompIR_VecHoriz(IRInst inst) {
+	CONDITIONAL_DISABLE;
+
+	switch (inst.op) {
+	case IROp::Vec4Dot:
+		// The summation order matters for accuracy, so leave this to the interpreter.
+		CompIR_Generic(inst);
+		break;
+
+	default:
+		INVALIDOP;
+		break;
+	}
+}
+
+void X64IRJit::CompIR_VecPack(IRInst inst) {
+	CONDITIONAL_DISABLE;
+
+	switch (inst.op) {
+	case IROp::Vec2Unpack16To31:
+	case IROp::Vec2Unpack16To32:
+	case IROp::Vec4Unpack8To32:
+	case IROp::Vec4DuplicateUpperBitsAndShift1:
+	case IROp::Vec4Pack31To8:
+	case IROp::Vec4Pack32To8:
+	case IROp::Vec2Pack31To16:
+	case IROp::Vec2Pack32To16:
+		CompIR_Generic(inst);
+		break;
+
+	default:
+		INVALIDOP;
+		break;
+	}
+}
+
+void X64IRJit::CompIR_VecClamp(IRInst inst) {
+	CONDITIONAL_DISABLE;
+
+	switch (inst.op) {
+	case IROp::Vec4ClampToZero:
+	case IROp::Vec2ClampToZero:
+		CompIR_Generic(inst);
+		break;
+
+	default:
+		INVALIDOP;
+		break;
+	}
+}
+
+} // namespace MIPSComp
+
+#endif
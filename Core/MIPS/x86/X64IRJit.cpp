@@ -0,0 +1,800 @@
+// Copyright (c) 2023- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+#include "ppsspp_config.h"
+#if PPSSPP_ARCH(AMD64)
+
+#include <algorithm>
+#include <cstddef>
+#include <map>
+#include "Common/ABI.h"
+#include "Common/MemoryUtil.h"
+#include "Common/StringUtils.h"
+#include "Common/TimeUtil.h"
+#include "Core/MemMap.h"
+#include "Core/MIPS/MIPSTables.h"
+#include "Core/MIPS/x86/X64IRJit.h"
+#include "Core/MIPS/x86/X64IRRegCache.h"
+#include "Common/Profiler/Profiler.h"
+
+namespace MIPSComp {
+
+using namespace Gen;
+using namespace X64IRJitConstants;
+
+static constexpr bool enableDebug = false;
+
+static std::map<uint8_t, int> debugSeenNotCompiledIR;
+static std::map<const char *, int> debugSeenNotCompiled;
+static double lastDebugLog = 0.0;
+
+static void LogDebugNotCompiled() {
+	if (!enableDebug)
+		return;
+
+	double now = time_now_d();
+	if (now < lastDebugLog + 1.0)
+		return;
+	lastDebugLog = now;
+
+	int worstIROp = -1;
+	int worstIRVal = 0;
+	for (auto it : debugSeenNotCompiledIR) {
+		if (it.second > worstIRVal) {
+			worstIRVal = it.second;
+			worstIROp = it.first;
+		}
+	}
+	debugSeenNotCompiledIR.clear();
+
+	const char *worstName = nullptr;
+	int worstVal = 0;
+	for (auto it : debugSeenNotCompiled) {
+		if (it.second > worstVal) {
+			worstVal = it.second;
+			worstName = it.first;
+		}
+	}
+	debugSeenNotCompiled.clear();
+
+	if (worstIROp != -1)
+		WARN_LOG(JIT, "Most not compiled IR op: %s (%d)", GetIRMeta((IROp)worstIROp)->name, worstIRVal);
+	if (worstName != nullptr)
+		WARN_LOG(JIT, "Most not compiled op: %s (%d)", worstName, worstVal);
+}
+
+X64IRJit::X64IRJit(MIPSState *mipsState)
+	: IRJit(mipsState), gpr(mipsState, &jo), fpr(mipsState, &jo), debugInterface_(blocks_, *this) {
+	// Since we store the offset, this is as big as it can be.
+	AllocCodeSpace(1024 * 1024 * 16);
+
+	gpr.Init(this);
+	fpr.Init(this);
+
+	// Our dispatcher doesn't count block executions, so hot recompiles never happen.
+	IROptions opts = frontend_.GetOptions();
+	opts.tieredPasses = false;
+	opts.traces = false;
+	frontend_.SetOptions(opts);
+
+	GenerateFixedCode(jo);
+}
+
+X64IRJit::~X64IRJit() {
+}
+
+void X64IRJit::RunLoopUntil(u64 globalticks) {
+	if constexpr (enableDebug) {
+		LogDebugNotCompiled();
+	}
+
+	PROFILE_THIS_SCOPE("jit");
+	// Native code doesn't read the IR, so nothing can be running from old storage.
+	blocks_.ReleaseRetiredStorage();
+	((void (*)())enterDispatcher_)();
+}
+
+JitBlockCacheDebugInterface *X64IRJit::GetBlockCacheDebugInterface() {
+	return &debugInterface_;
+}
+
+static void NoBlockExits() {
+	_assert_msg_(false, "Never exited block, invalid IR?");
+}
+
+bool X64IRJit::CompileTargetBlock(IRBlock *block, int block_num, bool preload) {
+	if (GetSpaceLeft() < 0x800)
+		return false;
+
+	BeginWrite(std::min(GetSpaceLeft(), (size_t)block->GetNumInstructions() * 32));
+
+	// Don't worry, the codespace isn't large enough to overflow offsets.
+	const u8 *blockStart = GetCodePtr();
+	block->SetTargetOffset((int)GetOffset(blockStart));
+
+	// This is the checked entry, which linked blocks jump to.  The PC is already set by the exit.
+	// Note that UnlinkBlock() overwrites this with a jump, so it must stay at least 5 bytes.
+	CMP(32, MIPSSTATE_VAR(downcount), Imm8(0));
+	J_CC(CC_S, outerLoop_, true);
+	_dbg_assert_(GetCodePtr() - blockStart >= 5);
+
+	gpr.Start(&blocks_, block_num);
+	fpr.Start(&blocks_, block_num);
+	pendingExits_.clear();
+
+	const IRInst *instructions = blocks_.GetBlockInstructionPtr(*block);
+	for (int i = 0; i < block->GetNumInstructions(); ++i) {
+		const IRInst &inst = instructions[i];
+		gpr.SetIRIndex(i);
+		fpr.SetIRIndex(i);
+
+		CompileIRInst(inst);
+
+		if (jo.Disabled(JitDisable::REGALLOC_GPR))
+			gpr.FlushAll();
+		if (jo.Disabled(JitDisable::REGALLOC_FPR))
+			fpr.FlushAll();
+		gpr.ReleaseSpillLocksAndDiscardTemps();
+		fpr.ReleaseSpillLocksAndDiscardTemps();
+
+		// Safety check, in case we get a bunch of really large jit ops without a lot of branching.
+		if (GetSpaceLeft() < 0x800) {
+			EndWrite();
+			return false;
+		}
+	}
+
+	// We should've written an exit above.  If we didn't, bad things will happen.
+	if (enableDebug) {
+		ABI_CallFunction(&NoBlockExits);
+		JMP(crashHandler_, true);
+	}
+
+	EndWrite();
+
+	for (const auto &exit : pendingExits_)
+		exitsTo_[exit.first].push_back(exit.second);
+	if (!pendingExits_.empty())
+		blockExits_[block_num] = std::move(pendingExits_);
+	pendingExits_.clear();
+	return true;
+}
+
+void X64IRJit::ForgetBlockExits(int block_num) {
+	auto blockIter = blockExits_.find(block_num);
+	if (blockIter == blockExits_.end())
+		return;
+
+	for (const auto &exit : blockIter->second) {
+		auto iter = exitsTo_.find(exit.first);
+		if (iter == exitsTo_.end())
+			continue;
+		std::vector<int> &offsets = iter->second;
+		offsets.erase(std::remove(offsets.begin(), offsets.end(), exit.second), offsets.end());
+		if (offsets.empty())
+			exitsTo_.erase(iter);
+	}
+	blockExits_.erase(blockIter);
+}
+
+void X64IRJit::FinalizeTargetBlock(IRBlock *block, int block_num) {
+	if (!jo.enableBlocklink)
+		return;
+
+	u32 startPC, size;
+	block->GetRange(startPC, size);
+	auto iter = exitsTo_.find(startPC);
+	if (iter == exitsTo_.end())
+		return;
+
+	const u8 *checkedEntry = GetBasePtr() + block->GetTargetOffset();
+	for (int exitOffset : iter->second) {
+		LinkBlock(GetBasePtr() + exitOffset, checkedEntry);
+	}
+}
+
+void X64IRJit::CompileIRInst(IRInst inst) {
+	switch (inst.op) {
+	case IROp::Nop:
+		break;
+
+	case IROp::SetConst:
+	case IROp::SetConstF:
+	case IROp::Downcount:
+	case IROp::SetPC:
+	case IROp::SetPCConst:
+		CompIR_Basic(inst);
+		break;
+
+	case IROp::Add:
+	case IROp::Sub:
+	case IROp::AddConst:
+	case IROp::SubConst:
+	case IROp::Neg:
+		CompIR_Arith(inst);
+		break;
+
+	case IROp::And:
+	case IROp::Or:
+	case IROp::Xor:
+	case IROp::AndConst:
+	case IROp::OrConst:
+	case IROp::XorConst:
+	case IROp::Not:
+		CompIR_Logic(inst);
+		break;
+
+	case IROp::Mov:
+	case IROp::Ext8to32:
+	case IROp::Ext16to32:
+		CompIR_Assign(inst);
+		break;
+
+	case IROp::ReverseBits:
+	case IROp::BSwap16:
+	case IROp::BSwap32:
+	case IROp::Clz:
+		CompIR_Bits(inst);
+		break;
+
+	case IROp::Shl:
+	case IROp::Shr:
+	case IROp::Sar:
+	case IROp::Ror:
+	case IROp::ShlImm:
+	case IROp::ShrImm:
+	case IROp::SarImm:
+	case IROp::RorImm:
+		CompIR_Shift(inst);
+		break;
+
+	case IROp::Slt:
+	case IROp::SltConst:
+	case IROp::SltU:
+	case IROp::SltUConst:
+		CompIR_Compare(inst);
+		break;
+
+	case IROp::MovZ:
+	case IROp::MovNZ:
+	case IROp::Max:
+	case IROp::Min:
+		CompIR_CondAssign(inst);
+		break;
+
+	case IROp::MtLo:
+	case IROp::MtHi:
+	case IROp::MfLo:
+	case IROp::MfHi:
+		CompIR_HiLo(inst);
+		break;
+
+	case IROp::Mult:
+	case IROp::MultU:
+	case IROp::Madd:
+	case IROp::MaddU:
+	case IROp::Msub:
+	case IROp::MsubU:
+		CompIR_Mult(inst);
+		break;
+
+	case IROp::Div:
+	case IROp::DivU:
+		CompIR_Div(inst);
+		break;
+
+	case IROp::Load8:
+	case IROp::Load8Ext:
+	case IROp::Load16:
+	case IROp::Load16Ext:
+	case IROp::Load32:
+	case IROp::Load32Linked:
+		CompIR_Load(inst);
+		break;
+
+	case IROp::Load32Left:
+	case IROp::Load32Right:
+		CompIR_LoadShift(inst);
+		break;
+
+	case IROp::LoadFloat:
+		CompIR_FLoad(inst);
+		break;
+
+	case IROp::LoadVec4:
+		CompIR_VecLoad(inst);
+		break;
+
+	case IROp::Store8:
+	case IROp::Store16:
+	case IROp::Store32:
+		CompIR_Store(inst);
+		break;
+
+	case IROp::Store32Conditional:
+		CompIR_CondStore(inst);
+		break;
+
+	case IROp::Store32Left:
+	case IROp::Store32Right:
+		CompIR_StoreShift(inst);
+		break;
+
+	case IROp::StoreFloat:
+		CompIR_FStore(inst);
+		break;
+
+	case IROp::StoreVec4:
+		CompIR_VecStore(inst);
+		break;
+
+	case IROp::FAdd:
+	case IROp::FSub:
+	case IROp::FMul:
+	case IROp::FDiv:
+	case IROp::FSqrt:
+	case IROp::FNeg:
+		CompIR_FArith(inst);
+		break;
+
+	case IROp::FMin:
+	case IROp::FMax:
+		CompIR_FCondAssign(inst);
+		break;
+
+	case IROp::FMov:
+	case IROp::FAbs:
+	case IROp::FSign:
+		CompIR_FAssign(inst);
+		break;
+
+	case IROp::FRound:
+	case IROp::FTrunc:
+	case IROp::FCeil:
+	case IROp::FFloor:
+		CompIR_FRound(inst);
+		break;
+
+	case IROp::FCvtWS:
+	case IROp::FCvtSW:
+	case IROp::FCvtScaledWS:
+	case IROp::FCvtScaledSW:
+		CompIR_FCvt(inst);
+		break;
+
+	case IROp::FSat0_1:
+	case IROp::FSatMinus1_1:
+		CompIR_FSat(inst);
+		break;
+
+	case IROp::FCmp:
+	case IROp::FCmovVfpuCC:
+	case IROp::FCmpVfpuBit:
+	case IROp::FCmpVfpuAggregate:
+		CompIR_FCompare(inst);
+		break;
+
+	case IROp::RestoreRoundingMode:
+	case IROp::ApplyRoundingMode:
+	case IROp::UpdateRoundingMode:
+		CompIR_RoundingMode(inst);
+		break;
+
+	case IROp::SetCtrlVFPU:
+	case IROp::SetCtrlVFPUReg:
+	case IROp::SetCtrlVFPUFReg:
+	case IROp::FpCondToReg:
+	case IROp::ZeroFpCond:
+	case IROp::FpCtrlFromReg:
+	case IROp::FpCtrlToReg:
+	case IROp::VfpuCtrlToReg:
+	case IROp::FMovFromGPR:
+	case IROp::FMovToGPR:
+		CompIR_Transfer(inst);
+		break;
+
+	case IROp::Vec4Init:
+	case IROp::Vec4Shuffle:
+	case IROp::Vec4Mov:
+		CompIR_VecAssign(inst);
+		break;
+
+	case IROp::Vec4Add:
+	case IROp::Vec4Sub:
+	case IROp::Vec4Mul:
+	case IROp::Vec4Div:
+	case IROp::Vec4Scale:
+	case IROp::Vec4Neg:
+	case IROp::Vec4Abs:
+		CompIR_VecArith(inst);
+		break;
+
+	case IROp::Vec4Dot:
+		CompIR_VecHoriz(inst);
+		break;
+
+	case IROp::Vec2Unpack16To31:
+	case IROp::Vec2Unpack16To32:
+	case IROp::Vec4Unpack8To32:
+	case IROp::Vec4DuplicateUpperBitsAndShift1:
+	case IROp::Vec4Pack31To8:
+	case IROp::Vec4Pack32To8:
+	case IROp::Vec2Pack31To16:
+	case IROp::Vec2Pack32To16:
+		CompIR_VecPack(inst);
+		break;
+
+	case IROp::Vec4ClampToZero:
+	case IROp::Vec2ClampToZero:
+		CompIR_VecClamp(inst);
+		break;
+
+	case IROp::FSin:
+	case IROp::FCos:
+	case IROp::FRSqrt:
+	case IROp::FRecip:
+	case IROp::FAsin:
+		CompIR_FSpecial(inst);
+		break;
+
+	case IROp::Interpret:
+		CompIR_Interpret(inst);
+		break;
+
+	case IROp::Syscall:
+	case IROp::CallReplacement:
+	case IROp::Break:
+		CompIR_System(inst);
+		break;
+
+	case IROp::Breakpoint:
+	case IROp::MemoryCheck:
+		CompIR_Breakpoint(inst);
+		break;
+
+	case IROp::ValidateAddress8:
+	case IROp::ValidateAddress16:
+	case IROp::ValidateAddress32:
+	case IROp::ValidateAddress128:
+		CompIR_ValidateAddress(inst);
+		break;
+
+	case IROp::ExitToConst:
+	case IROp::ExitToReg:
+	case IROp::ExitToPC:
+		CompIR_Exit(inst);
+		break;
+
+	case IROp::ExitToConstIfEq:
+	case IROp::ExitToConstIfNeq:
+	case IROp::ExitToConstIfGtZ:
+	case IROp::ExitToConstIfGeZ:
+	case IROp::ExitToConstIfLtZ:
+	case IROp::ExitToConstIfLeZ:
+	case IROp::ExitToConstIfFpTrue:
+	case IROp::ExitToConstIfFpFalse:
+		CompIR_ExitIf(inst);
+		break;
+
+	default:
+		_assert_msg_(false, "Unexpected IR op %d", (int)inst.op);
+		CompIR_Generic(inst);
+		break;
+	}
+}
+
+static u32 DoIRInst(uint64_t value) {
+	IRInst inst;
+	memcpy(&inst, &value, sizeof(inst));
+
+	if constexpr (enableDebug)
+		debugSeenNotCompiledIR[(uint8_t)inst.op]++;
+
+	return IRInterpret(currentMIPS, &inst, 1);
+}
+
+void X64IRJit::CompIR_Generic(IRInst inst) {
+	// If we got here, we're going the slow way.
+	uint64_t value;
+	memcpy(&value, &inst, sizeof(inst));
+
+	FlushAll();
+	MOV(64, R(ABI_PARAM1), Imm64(value));
+	ABI_CallFunction((const void *)&DoIRInst);
+
+	// We only need to check the return value if it's a potential exit.
+	if ((GetIRMeta(inst.op)->flags & IRFLAG_EXIT) != 0) {
+		// Result is in EAX aka SCRATCH1.
+		_assert_(RAX == SCRATCH1);
+		TEST(32, R(SCRATCH1), R(SCRATCH1));
+		J_CC(CC_NZ, dispatcherPCInSCRATCH1_, true);
+	}
+}
+
+static void DebugInterpretHit(const char *name) {
+	if (enableDebug)
+		debugSeenNotCompiled[name]++;
+}
+
+void X64IRJit::CompIR_Interpret(IRInst inst) {
+	MIPSOpcode op(inst.constant);
+
+	// IR protects us against this being a branching instruction (well, hopefully.)
+	FlushAll();
+	if (enableDebug) {
+		ABI_CallFunctionP((const void *)&DebugInterpretHit, (void *)MIPSGetName(op));
+	}
+	ABI_CallFunctionC((const void *)MIPSGetInterpretFunc(op), inst.constant);
+}
+
+void X64IRJit::FlushAll() {
+	gpr.FlushAll();
+	fpr.FlushAll();
+}
+
+void X64IRJit::WriteConstExit(u32 pc) {
+	// Always store the PC, so the dispatcher (and unlinked blocks) can find it.
+	MOV(32, MIPSSTATE_VAR(pc), Imm32(pc));
+
+	const u8 *exitPoint = GetCodePtr();
+	const u8 *target = dispatcher_;
+	if (jo.enableBlocklink) {
+		// If the target is already compiled, we can go there directly.
+		u32 op = Memory::IsValidAddress(pc) ? Memory::ReadUnchecked_U32(pc) : 0;
+		if (MIPS_IS_RUNBLOCK(op)) {
+			target = GetBasePtr() + (op & MIPS_EMUHACK_VALUE_MASK);
+		}
+		// Even if it's linked now, the block might be invalidated and recompiled later.
+		pendingExits_.push_back(std::make_pair(pc, (int)GetOffset(exitPoint)));
+	}
+	JMP(target, true);
+}
+
+void X64IRJit::LinkBlock(u8 *exitPoint, const u8 *checkedEntry) {
+	if (PlatformIsWXExclusive()) {
+		ProtectMemoryPages(exitPoint, 8, MEM_PROT_READ | MEM_PROT_WRITE);
+	}
+	XEmitter emit(exitPoint);
+	emit.JMP(checkedEntry, true);
+	if (PlatformIsWXExclusive()) {
+		ProtectMemoryPages(exitPoint, 8, MEM_PROT_READ | MEM_PROT_EXEC);
+	}
+}
+
+void X64IRJit::UnlinkBlock(u8 *checkedEntry, u32 originalAddress) {
+	if (PlatformIsWXExclusive()) {
+		ProtectMemoryPages(checkedEntry, 8, MEM_PROT_READ | MEM_PROT_WRITE);
+	}
+	// Every exit stores the PC before jumping, so we only need to bounce to the dispatcher.
+	// It'll find the first op restored, and compile the block again.
+	XEmitter emit(checkedEntry);
+	emit.JMP(dispatcher_, true);
+	if (PlatformIsWXExclusive()) {
+		ProtectMemoryPages(checkedEntry, 8, MEM_PROT_READ | MEM_PROT_EXEC);
+	}
+}
+
+void X64IRJit::InvalidateCacheAt(u32 em_address, int length) {
+	std::vector<int> numbers = blocks_.InvalidateICache(em_address, length);
+	for (int block_num : numbers) {
+		ForgetBlockExits(block_num);
+		IRBlock *block = blocks_.GetBlock(block_num);
+		if (block->GetTargetOffset() >= 0) {
+			// Other blocks may still be linked to this one, so send them back to the dispatcher.
+			UnlinkBlock(GetBasePtr() + block->GetTargetOffset(), 0);
+		}
+	}
+}
+
+bool X64IRJit::DescribeCodePtr(const u8 *ptr, std::string &name) {
+	// Used in disassembly viewer.
+	if (ptr == dispatcher_) {
+		name = "dispatcher";
+	} else if (ptr == dispatcherPCInSCRATCH1_) {
+		name = "dispatcher (PC in SCRATCH1)";
+	} else if (ptr == dispatcherNoCheck_) {
+		name = "dispatcherNoCheck";
+	} else if (ptr == dispatcherCheckCoreState_) {
+		name = "dispatcherCheckCoreState";
+	} else if (ptr == enterDispatcher_) {
+		name = "enterDispatcher";
+	} else if (ptr == restoreRoundingMode_) {
+		name = "restoreRoundingMode";
+	} else if (ptr == applyRoundingMode_) {
+		name = "applyRoundingMode";
+	} else if (ptr == crashHandler_) {
+		name = "crashHandler";
+	} else if (!IsInSpace(ptr)) {
+		return false;
+	} else {
+		int offset = (int)GetOffset(ptr);
+		int block_num = -1;
+		for (int i = 0; i < blocks_.GetNumBlocks(); ++i) {
+			const auto &b = blocks_.GetBlock(i);
+			// We allocate linearly.
+			if (b->GetTargetOffset() <= offset)
+				block_num = i;
+			if (b->GetTargetOffset() > offset)
+				break;
+		}
+
+		if (block_num == -1) {
+			name = "(unknown or deleted block)";
+			return true;
+		}
+
+		const IRBlock *block = blocks_.GetBlock(block_num);
+		if (block) {
+			u32 start = 0, size = 0;
+			block->GetRange(start, size);
+			name = StringFromFormat("(block %d at %08x)", block_num, start);
+			return true;
+		}
+		return false;
+	}
+	return true;
+}
+
+bool X64IRJit::CodeInRange(const u8 *ptr) const {
+	return IsInSpace(ptr);
+}
+
+bool X64IRJit::IsAtDispatchFetch(const u8 *ptr) const {
+	return ptr == dispatcherFetch_;
+}
+
+const u8 *X64IRJit::GetDispatcher() const {
+	return dispatcher_;
+}
+
+const u8 *X64IRJit::GetCrashHandler() const {
+	return crashHandler_;
+}
+
+void X64IRJit::ClearCache() {
+	IRJit::ClearCache();
+	exitsTo_.clear();
+	blockExits_.clear();
+
+	ClearCodeSpace(jitStartOffset_);
+}
+
+void X64IRJit::RestoreRoundingMode(bool force) {
+	CALL(restoreRoundingMode_);
+}
+
+void X64IRJit::ApplyRoundingMode(bool force) {
+	CALL(applyRoundingMode_);
+}
+
+Gen::OpArg X64IRJit::PrepareSrc1Address(IRInst inst) {
+	[[maybe_unused]] const IRMeta *m = GetIRMeta(inst.op);
+	_dbg_assert_(m->types[1] == 'G' || m->types[1] == 'C');
+
+	if (gpr.IsImm(inst.src1)) {
+		u32 addr = gpr.GetImm(inst.src1) + inst.constant;
+#ifdef MASKED_PSP_MEMORY
+		addr &= Memory::MEMVIEW32_MASK;
+#endif
+		// The memory base may not be within 2GB, so use the base register with an offset.
+		if (addr < 0x80000000) {
+			return MDisp(MEMBASEREG, (int)addr);
+		}
+		MOV(32, R(SCRATCH1), Imm32(addr));
+		return MRegSum(MEMBASEREG, SCRATCH1);
+	}
+
+	gpr.MapReg(inst.src1);
+#ifdef MASKED_PSP_MEMORY
+	LEA(32, SCRATCH1, MDisp(gpr.RX(inst.src1), (int)inst.constant));
+	AND(32, R(SCRATCH1), Imm32(Memory::MEMVIEW32_MASK));
+	return MRegSum(MEMBASEREG, SCRATCH1);
+#else
+	// Registers are always zero extended, but the constant is signed.  Wrapping past zero won't be valid anyway.
+	return MComplex(MEMBASEREG, gpr.RX(inst.src1), SCALE_1, (int)inst.constant);
+#endif
+}
+
+X64IRBlockCacheDebugInterface::X64IRBlockCacheDebugInterface(IRBlockCache &irBlocks, X64IRJit &jit)
+	: irBlocks_(irBlocks), jit_(jit) {}
+
+int X64IRBlockCacheDebugInterface::GetNumBlocks() const {
+	return irBlocks_.GetNumBlocks();
+}
+
+int X64IRBlockCacheDebugInterface::GetBlockNumberFromStartAddress(u32 em_address, bool realBlocksOnly) const {
+	return irBlocks_.GetBlockNumberFromStartAddress(em_address, realBlocksOnly);
+}
+
+void X64IRBlockCacheDebugInterface::GetBlockCodeRange(int blockNum, int *startOffset, int *size) const {
+	int blockOffset = irBlocks_.GetBlock(blockNum)->GetTargetOffset();
+	int endOffset;
+	// We assume linear allocation.  Maybe a bit dangerous, should always be right.
+	if (blockNum + 1 >= GetNumBlocks()) {
+		// Last block, get from current code pointer.
+		endOffset = (int)jit_.GetOffset(jit_.GetCodePtr());
+	} else {
+		endOffset = irBlocks_.GetBlock(blockNum + 1)->GetTargetOffset();
+		_assert_msg_(endOffset >= blockOffset, "Next block not sequential, block=%d/%08x, next=%d/%08x", blockNum, blockOffset, blockNum + 1, endOffset);
+	}
+
+	*startOffset = blockOffset;
+	*size = endOffset - blockOffset;
+}
+
+JitBlockDebugInfo X64IRBlockCacheDebugInterface::GetBlockDebugInfo(int blockNum) const {
+	JitBlockDebugInfo debugInfo = irBlocks_.GetBlockDebugInfo(blockNum);
+
+	int blockOffset, codeSize;
+	GetBlockCodeRange(blockNum, &blockOffset, &codeSize);
+	debugInfo.targetDisasm = DisassembleX86(jit_.GetBasePtr() + blockOffset, codeSize);
+	return debugInfo;
+}
+
+void X64IRBlockCacheDebugInterface::ComputeStats(BlockCacheStats &bcStats) const {
+	// Start from the IR stats for storage, then replace bloat with the native code size.
+	irBlocks_.ComputeStats(bcStats);
+	bcStats.bloatMap.clear();
+	bcStats.minBloatBlock = 0;
+	bcStats.maxBloatBlock = 0;
+	// Native blocks are compiled once with the full passes, there are no tiers to report.
+	bcStats.hotThreshold = 0;
+
+	size_t codeUsed = jit_.GetOffset(jit_.GetCodePtr());
+	bcStats.codeMemoryUsed += codeUsed;
+	bcStats.codeMemoryAllocated += codeUsed + jit_.GetSpaceLeft();
+
+	double totalBloat = 0.0;
+	double maxBloat = 0.0;
+	double minBloat = 1000000000.0;
+	int numBlocks = GetNumBlocks();
+	for (int i = 0; i < numBlocks; ++i) {
+		const IRBlock &b = *irBlocks_.GetBlock(i);
+
+		// x64 (jit) size.
+		int blockOffset, codeSize;
+		GetBlockCodeRange(i, &blockOffset, &codeSize);
+		if (codeSize == 0)
+			continue;
+
+		// MIPS (PSP) size.
+		u32 origAddr, mipsBytes;
+		b.GetRange(origAddr, mipsBytes);
+		if (mipsBytes == 0)
+			continue;
+
+		double bloat = (double)codeSize / (double)mipsBytes;
+		if (bloat < minBloat) {
+			minBloat = bloat;
+			bcStats.minBloatBlock = origAddr;
+		}
+		if (bloat > maxBloat) {
+			maxBloat = bloat;
+			bcStats.maxBloatBlock = origAddr;
+		}
+		totalBloat += bloat;
+		bcStats.bloatMap[bloat] = origAddr;
+	}
+	bcStats.numBlocks = numBlocks;
+	bcStats.minBloat = minBloat;
+	bcStats.maxBloat = maxBloat;
+	bcStats.avgBloat = totalBloat / (double)numBlocks;
+}
+
+} // namespace MIPSComp
+
+#endif
@@ -0,0 +1,163 @@
+// Copyright (c) 2023- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "Common/x64Emitter.h"
+#include "Core/MIPS/IR/IRJit.h"
+#include "Core/MIPS/JitCommon/JitState.h"
+#include "Core/MIPS/JitCommon/JitCommon.h"
+#include "Core/MIPS/x86/X64IRRegCache.h"
+#include "Core/MIPS/x86/X64IRRegCacheFPU.h"
+
+namespace MIPSComp {
+
+class X64IRJit;
+
+class X64IRBlockCacheDebugInterface : public JitBlockCacheDebugInterface {
+public:
+	X64IRBlockCacheDebugInterface(IRBlockCache &irBlocks, X64IRJit &jit);
+	int GetNumBlocks() const;
+	int GetBlockNumberFromStartAddress(u32 em_address, bool realBlocksOnly = true) const;
+	JitBlockDebugInfo GetBlockDebugInfo(int blockNum) const;
+	void ComputeStats(BlockCacheStats &bcStats) const;
+
+private:
+	void GetBlockCodeRange(int blockNum, int *startOffset, int *size) const;
+
+	IRBlockCache &irBlocks_;
+	X64IRJit &jit_;
+};
+
+class X64IRJit : public Gen::XCodeBlock, public IRJit {
+public:
+	X64IRJit(MIPSState *mipsState);
+	~X64IRJit();
+
+	void RunLoopUntil(u64 globalticks) override;
+
+	bool DescribeCodePtr(const u8 *ptr, std::string &name) override;
+	bool CodeInRange(const u8 *ptr) const override;
+	bool IsAtDispatchFetch(const u8 *ptr) const override;
+	const u8 *GetDispatcher() const override;
+	const u8 *GetCrashHandler() const override;
+
+	void ClearCache() override;
+	void InvalidateCacheAt(u32 em_address, int length = 4) override;
+
+	void LinkBlock(u8 *exitPoint, const u8 *checkedEntry) override;
+	void UnlinkBlock(u8 *checkedEntry, u32 originalAddress) override;
+
+	JitBlockCacheDebugInterface *GetBlockCacheDebugInterface() override;
+
+protected:
+	bool CompileTargetBlock(IRBlock *block, int block_num, bool preload) override;
+	void FinalizeTargetBlock(IRBlock *block, int block_num) override;
+	const char *DiskCacheBackendName() const override { return "x64"; }
+
+	void CompileIRInst(IRInst inst);
+
+private:
+	void GenerateFixedCode(const JitOptions &jo);
+
+	void RestoreRoundingMode(bool force = false);
+	void ApplyRoundingMode(bool force = false);
+
+	// Note: destroys SCRATCH1.
+	void FlushAll();
+	// Writes an exit to a constant PC, linked directly to the block there if possible.
+	void WriteConstExit(u32 pc);
+	// Stops linking exits inside this block, once its code is dead.
+	void ForgetBlockExits(int block_num);
+
+	void CompIR_Arith(IRInst inst);
+	void CompIR_Assign(IRInst inst);
+	void CompIR_Basic(IRInst inst);
+	void CompIR_Bits(IRInst inst);
+	void CompIR_Breakpoint(IRInst inst);
+	void CompIR_Compare(IRInst inst);
+	void CompIR_CondAssign(IRInst inst);
+	void CompIR_CondStore(IRInst inst);
+	void CompIR_Div(IRInst inst);
+	void CompIR_Exit(IRInst inst);
+	void CompIR_ExitIf(IRInst inst);
+	void CompIR_FArith(IRInst inst);
+	void CompIR_FAssign(IRInst inst);
+	void CompIR_FCompare(IRInst inst);
+	void CompIR_FCondAssign(IRInst inst);
+	void CompIR_FCvt(IRInst inst);
+	void CompIR_FLoad(IRInst inst);
+	void CompIR_FRound(IRInst inst);
+	void CompIR_FSat(IRInst inst);
+	void CompIR_FSpecial(IRInst inst);
+	void CompIR_FStore(IRInst inst);
+	void CompIR_Generic(IRInst inst);
+	void CompIR_HiLo(IRInst inst);
+	void CompIR_Interpret(IRInst inst);
+	void CompIR_Load(IRInst inst);
+	void CompIR_LoadShift(IRInst inst);
+	void CompIR_Logic(IRInst inst);
+	void CompIR_Mult(IRInst inst);
+	void CompIR_RoundingMode(IRInst inst);
+	void CompIR_Shift(IRInst inst);
+	void CompIR_Store(IRInst inst);
+	void CompIR_StoreShift(IRInst inst);
+	void CompIR_System(IRInst inst);
+	void CompIR_Transfer(IRInst inst);
+	void CompIR_VecArith(IRInst inst);
+	void CompIR_VecAssign(IRInst inst);
+	void CompIR_VecClamp(IRInst inst);
+	void CompIR_VecHoriz(IRInst inst);
+	void CompIR_VecLoad(IRInst inst);
+	void CompIR_VecPack(IRInst inst);
+	void CompIR_VecStore(IRInst inst);
+	void CompIR_ValidateAddress(IRInst inst);
+
+	// Returns a memory operand for src1 + constant, may use SCRATCH1.
+	Gen::OpArg PrepareSrc1Address(IRInst inst);
+
+	X64IRRegCache gpr;
+	X64IRRegCacheFPU fpr;
+	X64IRBlockCacheDebugInterface debugInterface_;
+
+	// Offsets of exits to each constant PC, so they can be linked when that block appears.
+	std::unordered_map<u32, std::vector<int>> exitsTo_;
+	// Exits (target PC, offset) in each block, so they can be removed from exitsTo_ again.
+	std::unordered_map<int, std::vector<std::pair<u32, int>>> blockExits_;
+	// Exits written by the block being compiled, only added once it's complete.
+	std::vector<std::pair<u32, int>> pendingExits_;
+
+	const u8 *enterDispatcher_ = nullptr;
+
+	const u8 *outerLoop_ = nullptr;
+	const u8 *dispatcherCheckCoreState_ = nullptr;
+	const u8 *dispatcherPCInSCRATCH1_ = nullptr;
+	const u8 *dispatcher_ = nullptr;
+	const u8 *dispatcherNoCheck_ = nullptr;
+	const u8 *dispatcherFetch_ = nullptr;
+	const u8 *restoreRoundingMode_ = nullptr;
+	const u8 *applyRoundingMode_ = nullptr;
+
+	const u8 *crashHandler_ = nullptr;
+
+	int jitStartOffset_ = 0;
+};
+
+} // namespace MIPSComp
@@ -0,0 +1,624 @@
+// Copyright (c) 2023- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+#include "ppsspp_config.h"
+#if PPSSPP_ARCH(AMD64)
+
+#ifndef offsetof
+#include <cstddef>
+#endif
+
+#include "Core/MIPS/IR/IRInst.h"
+#include "Core/MIPS/IR/IRAnalysis.h"
+#include "Core/MIPS/x86/X64IRRegCache.h"
+#include "Core/MIPS/JitCommon/JitState.h"
+#include "Core/Reporting.h"
+
+using namespace Gen;
+using namespace X64IRJitConstants;
+
+X64IRRegCache::X64IRRegCache(MIPSState *mipsState, MIPSComp::JitOptions *jo)
+	: mips_(mipsState), jo_(jo) {
+}
+
+void X64IRRegCache::Init(XEmitter *emitter) {
+	emit_ = emitter;
+}
+
+void X64IRRegCache::Start(MIPSComp::IRBlockCache *irBlockCache, int blockNum) {
+	if (!initialReady_) {
+		SetupInitialRegs();
+		initialReady_ = true;
+	}
+
+	memcpy(ar, arInitial_, sizeof(ar));
+	memcpy(mr, mrInitial_, sizeof(mr));
+	pendingUnlock_ = false;
+
+	irBlockCache_ = irBlockCache;
+	irBlockNum_ = blockNum;
+	irIndex_ = 0;
+}
+
+void X64IRRegCache::SetupInitialRegs() {
+	for (int i = 0; i < NUM_X64REG; i++) {
+		arInitial_[i].mipsReg = IRREG_INVALID;
+		arInitial_[i].isDirty = false;
+		arInitial_[i].tempLocked = false;
+	}
+	for (int i = 0; i < NUM_MIPSREG; i++) {
+		mrInitial_[i].loc = MIPSLoc::MEM;
+		mrInitial_[i].reg = INVALID_REG;
+		mrInitial_[i].imm = -1;
+		mrInitial_[i].spillLock = false;
+	}
+
+	// Zero is always known, and never needs to be written back.
+	mrInitial_[MIPS_REG_ZERO].loc = MIPSLoc::IMM;
+	mrInitial_[MIPS_REG_ZERO].imm = 0;
+}
+
+const X64Reg *X64IRRegCache::GetMIPSAllocationOrder(int &count) {
+	// RAX, RCX, and RDX are scratch.  RBX, R14, and R15 are fixed (see RegCache.h.)
+	// Callee saved regs first, so calls are less likely to need to flush.
+	static const X64Reg allocationOrder[] = {
+#ifdef _WIN32
+		RSI, RDI, R12, R13, RBP, R8, R9, R10, R11,
+#else
+		R12, R13, RBP, RSI, RDI, R8, R9, R10, R11,
+#endif
+	};
+
+	count = ARRAY_SIZE(allocationOrder);
+	return allocationOrder;
+}
+
+void X64IRRegCache::FlushBeforeCall() {
+	// These registers are not preserved by function calls.
+#ifdef _WIN32
+	static const X64Reg callerSaved[] = { R8, R9, R10, R11 };
+#else
+	static const X64Reg callerSaved[] = { RSI, RDI, R8, R9, R10, R11 };
+#endif
+	for (X64Reg r : callerSaved) {
+		FlushX64Reg(r);
+	}
+}
+
+bool X64IRRegCache::IsInRAM(IRRegIndex reg) {
+	_dbg_assert_(IsValidReg(reg));
+	return mr[reg].loc == MIPSLoc::MEM;
+}
+
+bool X64IRRegCache::IsMapped(IRRegIndex mipsReg) {
+	_dbg_assert_(IsValidReg(mipsReg));
+	return mr[mipsReg].loc == MIPSLoc::REG || mr[mipsReg].loc == MIPSLoc::REG_IMM;
+}
+
+void X64IRRegCache::MarkDirty(X64Reg reg) {
+	_dbg_assert_(reg < NUM_X64REG);
+	ar[reg].isDirty = true;
+	if (ar[reg].mipsReg != IRREG_INVALID) {
+		RegStatusMIPSX64 &m = mr[ar[reg].mipsReg];
+		if (m.loc == MIPSLoc::REG_IMM) {
+			m.loc = MIPSLoc::REG;
+			m.imm = -1;
+		}
+		_dbg_assert_(m.loc == MIPSLoc::REG);
+	}
+}
+
+void X64IRRegCache::SetRegImm(X64Reg reg, u32 imm) {
+	_dbg_assert_(reg < NUM_X64REG);
+	if (imm == 0)
+		emit_->XOR(32, ::R(reg), ::R(reg));
+	else
+		emit_->MOV(32, ::R(reg), Imm32(imm));
+}
+
+void X64IRRegCache::MapRegTo(X64Reg reg, IRRegIndex mipsReg, MIPSMap mapFlags) {
+	_dbg_assert_(reg < NUM_X64REG);
+	_dbg_assert_(IsValidReg(mipsReg));
+	ar[reg].isDirty = (mapFlags & MIPSMap::DIRTY) == MIPSMap::DIRTY;
+	if ((mapFlags & MIPSMap::NOINIT) != MIPSMap::NOINIT) {
+		switch (mr[mipsReg].loc) {
+		case MIPSLoc::MEM:
+			emit_->MOV(32, ::R(reg), MipsRegLocation(mipsReg));
+			mr[mipsReg].loc = MIPSLoc::REG;
+			break;
+		case MIPSLoc::IMM:
+			SetRegImm(reg, mr[mipsReg].imm);
+			// IMM is always dirty, unless it's zero (which never needs writing.)
+			if (mipsReg != MIPS_REG_ZERO)
+				ar[reg].isDirty = true;
+
+			// If we are mapping dirty, it means we're gonna overwrite.
+			// So the imm value is no longer valid.
+			if ((mapFlags & MIPSMap::DIRTY) == MIPSMap::DIRTY)
+				mr[mipsReg].loc = MIPSLoc::REG;
+			else
+				mr[mipsReg].loc = MIPSLoc::REG_IMM;
+			break;
+		default:
+			mr[mipsReg].loc = MIPSLoc::REG;
+			break;
+		}
+	} else {
+		_dbg_assert_(mipsReg != MIPS_REG_ZERO);
+		_dbg_assert_(ar[reg].isDirty);
+		mr[mipsReg].loc = MIPSLoc::REG;
+	}
+	ar[reg].mipsReg = mipsReg;
+	mr[mipsReg].reg = reg;
+}
+
+X64Reg X64IRRegCache::AllocateReg() {
+	int allocCount;
+	const X64Reg *allocOrder = GetMIPSAllocationOrder(allocCount);
+
+allocate:
+	for (int i = 0; i < allocCount; i++) {
+		X64Reg reg = allocOrder[i];
+
+		if (ar[reg].mipsReg == IRREG_INVALID && !ar[reg].tempLocked) {
+			return reg;
+		}
+	}
+
+	// Still nothing. Let's spill a reg and goto 10.
+	bool clobbered;
+	X64Reg bestToSpill = FindBestToSpill(true, &clobbered);
+	if (bestToSpill == INVALID_REG) {
+		bestToSpill = FindBestToSpill(false, &clobbered);
+	}
+
+	if (bestToSpill != INVALID_REG) {
+		if (clobbered) {
+			DiscardR(ar[bestToSpill].mipsReg);
+		} else {
+			FlushX64Reg(bestToSpill);
+		}
+		// Now one must be free.
+		goto allocate;
+	}
+
+	// Uh oh, we have all of them spilllocked....
+	ERROR_LOG_REPORT(JIT, "Out of spillable registers near PC %08x", mips_->pc);
+	_assert_(bestToSpill != INVALID_REG);
+	return INVALID_REG;
+}
+
+X64Reg X64IRRegCache::FindBestToSpill(bool unusedOnly, bool *clobbered) {
+	int allocCount;
+	const X64Reg *allocOrder = GetMIPSAllocationOrder(allocCount);
+
+	static const int UNUSED_LOOKAHEAD_OPS = 30;
+
+	IRSituation info;
+	info.lookaheadCount = UNUSED_LOOKAHEAD_OPS;
+	info.currentIndex = irIndex_;
+	const MIPSComp::IRBlock *irBlock = irBlockCache_->GetBlock(irBlockNum_);
+	info.instructions = irBlockCache_->GetBlockInstructionPtr(*irBlock);
+	info.numInstructions = irBlock->GetNumInstructions();
+
+	*clobbered = false;
+	for (int i = 0; i < allocCount; i++) {
+		X64Reg reg = allocOrder[i];
+		if (ar[reg].mipsReg != IRREG_INVALID && mr[ar[reg].mipsReg].spillLock)
+			continue;
+		if (ar[reg].tempLocked)
+			continue;
+
+		IRUsage usage = IRNextGPRUsage(ar[reg].mipsReg, info);
+
+		// Awesome, a clobbered reg.  Let's use it.
+		if (usage == IRUsage::CLOBBERED) {
+			*clobbered = true;
+			return reg;
+		}
+
+		// Not awesome.  A used reg.  Let's try to avoid spilling.
+		if (!unusedOnly || usage == IRUsage::UNUSED) {
+			// TODO: Use age or something to choose which register to spill?
+			return reg;
+		}
+	}
+
+	return INVALID_REG;
+}
+
+X64Reg X64IRRegCache::GetAndLockTempR() {
+	X64Reg reg = AllocateReg();
+	if (reg != INVALID_REG) {
+		ar[reg].tempLocked = true;
+		pendingUnlock_ = true;
+	}
+	return reg;
+}
+
+X64Reg X64IRRegCache::MapReg(IRRegIndex mipsReg, MIPSMap mapFlags) {
+	_dbg_assert_(IsValidReg(mipsReg));
+
+	if (mipsReg == IRREG_INVALID) {
+		ERROR_LOG(JIT, "Cannot map invalid register");
+		return INVALID_REG;
+	}
+
+	X64Reg x64Reg = mr[mipsReg].reg;
+
+	// Let's see if it's already mapped. If so we just need to update the dirty flag.
+	// We don't need to check for NOINIT because we assume that anyone who maps
+	// with that flag immediately writes a "known" value to the register.
+	if (mr[mipsReg].loc == MIPSLoc::REG || mr[mipsReg].loc == MIPSLoc::REG_IMM) {
+		_dbg_assert_(x64Reg != INVALID_REG && ar[x64Reg].mipsReg == mipsReg);
+		if (ar[x64Reg].mipsReg != mipsReg) {
+			ERROR_LOG_REPORT(JIT, "Register mapping out of sync! %i", mipsReg);
+		}
+		if ((mapFlags & MIPSMap::DIRTY) == MIPSMap::DIRTY) {
+			// Mapping dirty means the old imm value is invalid.
+			mr[mipsReg].loc = MIPSLoc::REG;
+			ar[x64Reg].isDirty = true;
+		}
+
+		return mr[mipsReg].reg;
+	}
+
+	// Okay, not mapped, so we need to allocate an x64 register.
+	X64Reg reg = AllocateReg();
+	if (reg != INVALID_REG) {
+		// Grab it, and load the value into it (if requested).
+		MapRegTo(reg, mipsReg, mapFlags);
+	}
+
+	return reg;
+}
+
+void X64IRRegCache::MapIn(IRRegIndex rs) {
+	MapReg(rs);
+}
+
+void X64IRRegCache::MapInIn(IRRegIndex rd, IRRegIndex rs) {
+	SpillLock(rd, rs);
+	MapReg(rd);
+	MapReg(rs);
+	ReleaseSpillLock(rd, rs);
+}
+
+void X64IRRegCache::MapDirtyIn(IRRegIndex rd, IRRegIndex rs, MapType type) {
+	SpillLock(rd, rs);
+	bool load = type == MapType::ALWAYS_LOAD || rd == rs;
+	MapReg(rd, load ? MIPSMap::DIRTY : MIPSMap::NOINIT);
+	MapReg(rs);
+	ReleaseSpillLock(rd, rs);
+}
+
+void X64IRRegCache::MapDirtyInIn(IRRegIndex rd, IRRegIndex rs, IRRegIndex rt, MapType type) {
+	SpillLock(rd, rs, rt);
+	bool load = type == MapType::ALWAYS_LOAD || (rd == rs || rd == rt);
+	MapReg(rd, load ? MIPSMap::DIRTY : MIPSMap::NOINIT);
+	MapReg(rt);
+	MapReg(rs);
+	ReleaseSpillLock(rd, rs, rt);
+}
+
+void X64IRRegCache::MapDirtyDirtyIn(IRRegIndex rd1, IRRegIndex rd2, IRRegIndex rs, MapType type) {
+	SpillLock(rd1, rd2, rs);
+	bool load1 = type == MapType::ALWAYS_LOAD || rd1 == rs;
+	bool load2 = type == MapType::ALWAYS_LOAD || rd2 == rs;
+	MapReg(rd1, load1 ? MIPSMap::DIRTY : MIPSMap::NOINIT);
+	MapReg(rd2, load2 ? MIPSMap::DIRTY : MIPSMap::NOINIT);
+	MapReg(rs);
+	ReleaseSpillLock(rd1, rd2, rs);
+}
+
+void X64IRRegCache::MapDirtyDirtyInIn(IRRegIndex rd1, IRRegIndex rd2, IRRegIndex rs, IRRegIndex rt, MapType type) {
+	SpillLock(rd1, rd2, rs, rt);
+	bool load1 = type == MapType::ALWAYS_LOAD || (rd1 == rs || rd1 == rt);
+	bool load2 = type == MapType::ALWAYS_LOAD || (rd2 == rs || rd2 == rt);
+	MapReg(rd1, load1 ? MIPSMap::DIRTY : MIPSMap::NOINIT);
+	MapReg(rd2, load2 ? MIPSMap::DIRTY : MIPSMap::NOINIT);
+	MapReg(rt);
+	MapReg(rs);
+	ReleaseSpillLock(rd1, rd2, rs, rt);
+}
+
+void X64IRRegCache::FlushX64Reg(X64Reg r) {
+	_dbg_assert_(r < NUM_X64REG);
+	if (r == INVALID_REG) {
+		ERROR_LOG(JIT, "FlushX64Reg called on invalid register %d", r);
+		return;
+	}
+	if (ar[r].mipsReg == IRREG_INVALID) {
+		// Nothing to do, reg not mapped.
+		_dbg_assert_(!ar[r].isDirty);
+		return;
+	}
+	auto &mreg = mr[ar[r].mipsReg];
+	if (mreg.loc == MIPSLoc::REG_IMM || ar[r].mipsReg == MIPS_REG_ZERO) {
+		// We know its immediate value, no need to store now.
+		mreg.loc = MIPSLoc::IMM;
+		mreg.reg = INVALID_REG;
+	} else {
+		if (ar[r].isDirty) {
+			emit_->MOV(32, MipsRegLocation(ar[r].mipsReg), ::R(r));
+		}
+		mreg.loc = MIPSLoc::MEM;
+		mreg.reg = INVALID_REG;
+		mreg.imm = -1;
+	}
+	ar[r].isDirty = false;
+	ar[r].mipsReg = IRREG_INVALID;
+}
+
+void X64IRRegCache::DiscardR(IRRegIndex mipsReg) {
+	_dbg_assert_(IsValidRegNoZero(mipsReg));
+	const MIPSLoc prevLoc = mr[mipsReg].loc;
+	if (prevLoc == MIPSLoc::REG || prevLoc == MIPSLoc::REG_IMM) {
+		X64Reg x64Reg = mr[mipsReg].reg;
+		_dbg_assert_(x64Reg != INVALID_REG);
+		ar[x64Reg].mipsReg = IRREG_INVALID;
+		ar[x64Reg].isDirty = false;
+		mr[mipsReg].reg = INVALID_REG;
+		mr[mipsReg].loc = MIPSLoc::MEM;
+		mr[mipsReg].imm = -1;
+	}
+	if (prevLoc == MIPSLoc::IMM && mipsReg != MIPS_REG_ZERO) {
+		mr[mipsReg].loc = MIPSLoc::MEM;
+		mr[mipsReg].imm = -1;
+	}
+}
+
+X64Reg X64IRRegCache::X64RegForFlush(IRRegIndex r) {
+	_dbg_assert_(IsValidReg(r));
+
+	switch (mr[r].loc) {
+	case MIPSLoc::IMM:
+		if (r == MIPS_REG_ZERO) {
+			return INVALID_REG;
+		}
+		// Could we get lucky?  Check for an exact match in another x64 reg.
+		for (int i = 0; i < NUM_MIPSREG; ++i) {
+			if (mr[i].loc == MIPSLoc::REG_IMM && mr[i].imm == mr[r].imm) {
+				// Awesome, let's just store this reg.
+				return mr[i].reg;
+			}
+		}
+		return INVALID_REG;
+
+	case MIPSLoc::REG:
+	case MIPSLoc::REG_IMM:
+		if (mr[r].reg == INVALID_REG) {
+			ERROR_LOG_REPORT(JIT, "X64RegForFlush: MipsReg %d had bad x64Reg", r);
+			return INVALID_REG;
+		}
+		// No need to flush if it's zero or not dirty.
+		if (r == MIPS_REG_ZERO || !ar[mr[r].reg].isDirty) {
+			return INVALID_REG;
+		}
+		return mr[r].reg;
+
+	case MIPSLoc::MEM:
+		return INVALID_REG;
+
+	default:
+		ERROR_LOG_REPORT(JIT, "X64RegForFlush: MipsReg %d with invalid location %d", r, (int)mr[r].loc);
+		return INVALID_REG;
+	}
+}
+
+void X64IRRegCache::FlushR(IRRegIndex r) {
+	_dbg_assert_(IsValidRegNoZero(r));
+
+	switch (mr[r].loc) {
+	case MIPSLoc::IMM:
+		// IMM is always "dirty".
+		if (r != MIPS_REG_ZERO) {
+			// Try to optimize using a different reg.
+			X64Reg storeReg = X64RegForFlush(r);
+			if (storeReg != INVALID_REG)
+				emit_->MOV(32, MipsRegLocation(r), ::R(storeReg));
+			else
+				emit_->MOV(32, MipsRegLocation(r), Imm32(mr[r].imm));
+		}
+		break;
+
+	case MIPSLoc::REG:
+	case MIPSLoc::REG_IMM:
+		if (ar[mr[r].reg].isDirty) {
+			X64Reg storeReg = X64RegForFlush(r);
+			if (storeReg != INVALID_REG) {
+				emit_->MOV(32, MipsRegLocation(r), ::R(storeReg));
+			}
+			ar[mr[r].reg].isDirty = false;
+		}
+		ar[mr[r].reg].mipsReg = IRREG_INVALID;
+		break;
+
+	case MIPSLoc::MEM:
+		// Already there, nothing to do.
+		break;
+
+	default:
+		ERROR_LOG_REPORT(JIT, "FlushR: MipsReg %d with invalid location %d", r, (int)mr[r].loc);
+		break;
+	}
+	mr[r].loc = MIPSLoc::MEM;
+	mr[r].reg = INVALID_REG;
+	mr[r].imm = -1;
+}
+
+void X64IRRegCache::FlushAll() {
+	// Note: make sure not to change the registers when flushing:
+	// Branching code expects the x64 reg to retain its value.
+	for (int i = 1; i < NUM_MIPSREG; i++) {
+		IRRegIndex mipsReg = IRRegIndex(i);
+		if (IsValidRegNoZero(mipsReg))
+			FlushR(mipsReg);
+	}
+
+	// Zero may have been mapped into a reg for convenience, just forget it.
+	if (mr[MIPS_REG_ZERO].loc == MIPSLoc::REG_IMM) {
+		ar[mr[MIPS_REG_ZERO].reg].mipsReg = IRREG_INVALID;
+		ar[mr[MIPS_REG_ZERO].reg].isDirty = false;
+	}
+	mr[MIPS_REG_ZERO].loc = MIPSLoc::IMM;
+	mr[MIPS_REG_ZERO].reg = INVALID_REG;
+	mr[MIPS_REG_ZERO].imm = 0;
+
+	// Sanity check
+	for (int i = 0; i < NUM_X64REG; i++) {
+		if (ar[i].mipsReg != IRREG_INVALID) {
+			ERROR_LOG_REPORT(JIT, "Flush fail: ar[%i].mipsReg=%i", i, ar[i].mipsReg);
+		}
+	}
+}
+
+void X64IRRegCache::SetImm(IRRegIndex r, u32 immVal) {
+	_dbg_assert_(IsValidReg(r));
+	if (r == MIPS_REG_ZERO && immVal != 0) {
+		ERROR_LOG_REPORT(JIT, "Trying to set immediate %08x to r0", immVal);
+		return;
+	}
+
+	if (mr[r].loc == MIPSLoc::REG_IMM && mr[r].imm == immVal) {
+		// Already have that value, let's keep it in the reg.
+		return;
+	}
+
+	// Zap existing value if cached in a reg
+	if (mr[r].reg != INVALID_REG) {
+		ar[mr[r].reg].mipsReg = IRREG_INVALID;
+		ar[mr[r].reg].isDirty = false;
+	}
+	mr[r].loc = MIPSLoc::IMM;
+	mr[r].imm = immVal;
+	mr[r].reg = INVALID_REG;
+}
+
+bool X64IRRegCache::IsImm(IRRegIndex r) const {
+	_dbg_assert_(IsValidReg(r));
+	if (r == MIPS_REG_ZERO)
+		return true;
+	else
+		return mr[r].loc == MIPSLoc::IMM || mr[r].loc == MIPSLoc::REG_IMM;
+}
+
+u32 X64IRRegCache::GetImm(IRRegIndex r) const {
+	_dbg_assert_(IsValidReg(r));
+	if (r == MIPS_REG_ZERO)
+		return 0;
+	if (mr[r].loc != MIPSLoc::IMM && mr[r].loc != MIPSLoc::REG_IMM) {
+		ERROR_LOG_REPORT(JIT, "Trying to get imm from non-imm register %i", r);
+	}
+	return mr[r].imm;
+}
+
+OpArg X64IRRegCache::MipsRegLocation(IRRegIndex r) {
+	_dbg_assert_(IsValidReg(r));
+	// CTXREG points at f[0], see MIPSSTATE_VAR().
+	return MDisp(CTXREG, (r - 32) * 4);
+}
+
+OpArg X64IRRegCache::ArgOrImm(IRRegIndex r) {
+	_dbg_assert_(IsValidReg(r));
+	switch (mr[r].loc) {
+	case MIPSLoc::IMM:
+		return Imm32(mr[r].imm);
+	case MIPSLoc::REG:
+	case MIPSLoc::REG_IMM:
+		return ::R(mr[r].reg);
+	case MIPSLoc::MEM:
+	default:
+		return MipsRegLocation(r);
+	}
+}
+
+bool X64IRRegCache::IsValidReg(IRRegIndex r) const {
+	if (r < 0 || r >= NUM_MIPSREG)
+		return false;
+
+	// See MIPSState for these offsets.
+
+	// Don't allow FPU or VFPU regs here.
+	if (r >= 32 && r < 32 + 32 + 128)
+		return false;
+	// Also disallow VFPU temps.
+	if (r >= 224 && r < 224 + 16)
+		return false;
+	// Don't allow nextPC, etc. since it's probably a mistake.
+	if (r > IRREG_FPCOND && r != IRREG_LLBIT)
+		return false;
+	// Don't allow PC either.
+	if (r == 241)
+		return false;
+
+	return true;
+}
+
+bool X64IRRegCache::IsValidRegNoZero(IRRegIndex r) const {
+	return IsValidReg(r) && r != MIPS_REG_ZERO;
+}
+
+void X64IRRegCache::SpillLock(IRRegIndex r1, IRRegIndex r2, IRRegIndex r3, IRRegIndex r4) {
+	_dbg_assert_(IsValidReg(r1));
+	_dbg_assert_(r2 == IRREG_INVALID || IsValidReg(r2));
+	_dbg_assert_(r3 == IRREG_INVALID || IsValidReg(r3));
+	_dbg_assert_(r4 == IRREG_INVALID || IsValidReg(r4));
+	mr[r1].spillLock = true;
+	if (r2 != IRREG_INVALID) mr[r2].spillLock = true;
+	if (r3 != IRREG_INVALID) mr[r3].spillLock = true;
+	if (r4 != IRREG_INVALID) mr[r4].spillLock = true;
+	pendingUnlock_ = true;
+}
+
+void X64IRRegCache::ReleaseSpillLocksAndDiscardTemps() {
+	if (!pendingUnlock_)
+		return;
+
+	for (int i = 0; i < NUM_MIPSREG; i++) {
+		mr[i].spillLock = false;
+	}
+	for (int i = 0; i < NUM_X64REG; i++) {
+		ar[i].tempLocked = false;
+	}
+
+	pendingUnlock_ = false;
+}
+
+void X64IRRegCache::ReleaseSpillLock(IRRegIndex r1, IRRegIndex r2, IRRegIndex r3, IRRegIndex r4) {
+	_dbg_assert_(IsValidReg(r1));
+	_dbg_assert_(r2 == IRREG_INVALID || IsValidReg(r2));
+	_dbg_assert_(r3 == IRREG_INVALID || IsValidReg(r3));
+	_dbg_assert_(r4 == IRREG_INVALID || IsValidReg(r4));
+	mr[r1].spillLock = false;
+	if (r2 != IRREG_INVALID) mr[r2].spillLock = false;
+	if (r3 != IRREG_INVALID) mr[r3].spillLock = false;
+	if (r4 != IRREG_INVALID) mr[r4].spillLock = false;
+}
+
+X64Reg X64IRRegCache::RX(IRRegIndex mipsReg) {
+	_dbg_assert_(IsValidReg(mipsReg));
+	_dbg_assert_(mr[mipsReg].loc == MIPSLoc::REG || mr[mipsReg].loc == MIPSLoc::REG_IMM);
+	if (mr[mipsReg].loc == MIPSLoc::REG || mr[mipsReg].loc == MIPSLoc::REG_IMM) {
+		return mr[mipsReg].reg;
+	} else {
+		ERROR_LOG_REPORT(JIT, "Reg %i not in x64 reg", mipsReg);
+		return INVALID_REG;  // BAAAD
+	}
+}
+
+#endif
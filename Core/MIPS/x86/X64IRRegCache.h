@@ -0,0 +1,182 @@
+// Copyright (c) 2023- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+#pragma once
+
+#include "ppsspp_config.h"
+#include "Common/x64Emitter.h"
+#include "Core/MIPS/MIPS.h"
+#include "Core/MIPS/IR/IRJit.h"
+#include "Core/MIPS/x86/RegCache.h"
+
+namespace X64IRJitConstants {
+
+// These are shared with the legacy x86 jit, see RegCache.h.
+using X64JitConstants::MEMBASEREG;
+using X64JitConstants::CTXREG;
+using X64JitConstants::JITBASEREG;
+
+// RAX and RDX are clobbered by MUL/DIV, and RCX is needed for variable shifts.
+// So we just never allocate them and use them as scratch instead.
+const Gen::X64Reg SCRATCH1 = Gen::RAX;
+const Gen::X64Reg SCRATCH2 = Gen::RDX;
+const Gen::X64Reg SCRATCH3 = Gen::RCX;
+// Two XMM regs are kept free for temporaries as well.
+const Gen::X64Reg XMMSCRATCH1 = Gen::XMM0;
+const Gen::X64Reg XMMSCRATCH2 = Gen::XMM1;
+
+// Have to account for all of them due to temps, etc.
+constexpr int TOTAL_MAPPABLE_MIPSREGS = 256;
+
+enum class MIPSLoc {
+	IMM,
+	REG,
+	// In a native reg, but also has a known immediate value.
+	REG_IMM,
+	MEM,
+};
+
+// Initing is the default so the flag is reversed.
+enum class MIPSMap {
+	INIT = 0,
+	DIRTY = 1,
+	NOINIT = 2 | DIRTY,
+};
+static inline MIPSMap operator |(const MIPSMap &lhs, const MIPSMap &rhs) {
+	return MIPSMap((int)lhs | (int)rhs);
+}
+static inline MIPSMap operator &(const MIPSMap &lhs, const MIPSMap &rhs) {
+	return MIPSMap((int)lhs & (int)rhs);
+}
+
+enum class MapType {
+	AVOID_LOAD,
+	ALWAYS_LOAD,
+};
+
+} // namespace X64IRJitConstants
+
+namespace MIPSComp {
+struct JitOptions;
+}
+
+// Not using IRReg since this can be -1.
+typedef int IRRegIndex;
+constexpr IRRegIndex IRREG_INVALID = -1;
+
+struct RegStatusX64 {
+	IRRegIndex mipsReg;  // if -1, no mipsreg attached.
+	bool isDirty;  // Should the register be written back?
+	bool tempLocked; // Reserved for a temp register.
+};
+
+struct RegStatusMIPSX64 {
+	// Where is this MIPS register?
+	X64IRJitConstants::MIPSLoc loc;
+	// Data (both or only one may be used, depending on loc.)
+	u32 imm;
+	Gen::X64Reg reg;  // reg index
+	bool spillLock;  // if true, this register cannot be spilled.
+	// If loc == ML_MEM, it's back in its location in the CPU context struct.
+};
+
+// Unlike RISC-V, x86-64 32-bit ops always zero the top half of the register.
+// So all values in here are always kept "normalized", and usable as an address index.
+class X64IRRegCache {
+public:
+	X64IRRegCache(MIPSState *mipsState, MIPSComp::JitOptions *jo);
+	~X64IRRegCache() {}
+
+	void Init(Gen::XEmitter *emitter);
+	void Start(MIPSComp::IRBlockCache *irBlockCache, int blockNum);
+	void SetIRIndex(int index) {
+		irIndex_ = index;
+	}
+
+	// Protect the x64 register containing a MIPS register from spilling, to ensure that
+	// it's being kept allocated.
+	void SpillLock(IRRegIndex reg, IRRegIndex reg2 = IRREG_INVALID, IRRegIndex reg3 = IRREG_INVALID, IRRegIndex reg4 = IRREG_INVALID);
+	void ReleaseSpillLock(IRRegIndex reg, IRRegIndex reg2 = IRREG_INVALID, IRRegIndex reg3 = IRREG_INVALID, IRRegIndex reg4 = IRREG_INVALID);
+	void ReleaseSpillLocksAndDiscardTemps();
+
+	void SetImm(IRRegIndex reg, u32 immVal);
+	bool IsImm(IRRegIndex reg) const;
+	u32 GetImm(IRRegIndex reg) const;
+
+	// Returns an x64 register containing the requested MIPS register.
+	Gen::X64Reg MapReg(IRRegIndex reg, X64IRJitConstants::MIPSMap mapFlags = X64IRJitConstants::MIPSMap::INIT);
+
+	bool IsMapped(IRRegIndex reg);
+	bool IsInRAM(IRRegIndex reg);
+
+	void MarkDirty(Gen::X64Reg reg);
+	void MapIn(IRRegIndex rs);
+	void MapInIn(IRRegIndex rd, IRRegIndex rs);
+	void MapDirtyIn(IRRegIndex rd, IRRegIndex rs, X64IRJitConstants::MapType type = X64IRJitConstants::MapType::AVOID_LOAD);
+	void MapDirtyInIn(IRRegIndex rd, IRRegIndex rs, IRRegIndex rt, X64IRJitConstants::MapType type = X64IRJitConstants::MapType::AVOID_LOAD);
+	void MapDirtyDirtyIn(IRRegIndex rd1, IRRegIndex rd2, IRRegIndex rs, X64IRJitConstants::MapType type = X64IRJitConstants::MapType::AVOID_LOAD);
+	void MapDirtyDirtyInIn(IRRegIndex rd1, IRRegIndex rd2, IRRegIndex rs, IRRegIndex rt, X64IRJitConstants::MapType type = X64IRJitConstants::MapType::AVOID_LOAD);
+	void FlushBeforeCall();
+	void FlushAll();
+	void FlushR(IRRegIndex r);
+	void FlushX64Reg(Gen::X64Reg r);
+	void DiscardR(IRRegIndex r);
+
+	Gen::X64Reg GetAndLockTempR();
+
+	// Returns a cached register.
+	Gen::X64Reg RX(IRRegIndex preg);
+	Gen::OpArg R(IRRegIndex preg) {
+		return Gen::R(RX(preg));
+	}
+	// Returns either an immediate, the native register, or the memory location.
+	Gen::OpArg ArgOrImm(IRRegIndex preg);
+
+private:
+	const Gen::X64Reg *GetMIPSAllocationOrder(int &count);
+	void MapRegTo(Gen::X64Reg reg, IRRegIndex mipsReg, X64IRJitConstants::MIPSMap mapFlags);
+	Gen::X64Reg AllocateReg();
+	Gen::X64Reg FindBestToSpill(bool unusedOnly, bool *clobbered);
+	Gen::X64Reg X64RegForFlush(IRRegIndex r);
+	void SetRegImm(Gen::X64Reg reg, u32 imm);
+	Gen::OpArg MipsRegLocation(IRRegIndex r);
+
+	bool IsValidReg(IRRegIndex r) const;
+	bool IsValidRegNoZero(IRRegIndex r) const;
+
+	void SetupInitialRegs();
+
+	MIPSState *mips_;
+	Gen::XEmitter *emit_ = nullptr;
+	MIPSComp::JitOptions *jo_;
+	MIPSComp::IRBlockCache *irBlockCache_ = nullptr;
+	int irBlockNum_ = 0;
+	int irIndex_ = 0;
+
+	enum {
+		NUM_X64REG = 16,
+		NUM_MIPSREG = X64IRJitConstants::TOTAL_MAPPABLE_MIPSREGS,
+	};
+
+	RegStatusX64 ar[NUM_X64REG]{};
+	RegStatusMIPSX64 mr[NUM_MIPSREG]{};
+
+	bool initialReady_ = false;
+	bool pendingUnlock_ = false;
+	RegStatusX64 arInitial_[NUM_X64REG];
+	RegStatusMIPSX64 mrInitial_[NUM_MIPSREG];
+};
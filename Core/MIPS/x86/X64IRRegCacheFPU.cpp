@@ -0,0 +1,430 @@
+// Copyright (c) 2023- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+#include "ppsspp_config.h"
+#if PPSSPP_ARCH(AMD64)
+
+#ifndef offsetof
+#include <cstddef>
+#endif
+
+#include "Core/MIPS/IR/IRInst.h"
+#include "Core/MIPS/IR/IRAnalysis.h"
+#include "Core/MIPS/x86/X64IRRegCacheFPU.h"
+#include "Core/MIPS/JitCommon/JitState.h"
+#include "Core/Reporting.h"
+
+using namespace Gen;
+using namespace X64IRJitConstants;
+
+X64IRRegCacheFPU::X64IRRegCacheFPU(MIPSState *mipsState, MIPSComp::JitOptions *jo)
+	: mips_(mipsState), jo_(jo) {}
+
+void X64IRRegCacheFPU::Init(XEmitter *emitter) {
+	emit_ = emitter;
+}
+
+void X64IRRegCacheFPU::Start(MIPSComp::IRBlockCache *irBlockCache, int blockNum) {
+	if (!initialReady_) {
+		SetupInitialRegs();
+		initialReady_ = true;
+	}
+
+	memcpy(ar, arInitial_, sizeof(ar));
+	memcpy(mr, mrInitial_, sizeof(mr));
+	pendingFlush_ = false;
+	pendingUnlock_ = false;
+
+	irBlockCache_ = irBlockCache;
+	irBlockNum_ = blockNum;
+	irIndex_ = 0;
+}
+
+void X64IRRegCacheFPU::SetupInitialRegs() {
+	for (int i = 0; i < NUM_X64FPUREG; i++) {
+		arInitial_[i].mipsReg = IRREG_INVALID;
+		arInitial_[i].isDirty = false;
+	}
+	for (int i = 0; i < NUM_MIPSFPUREG; i++) {
+		mrInitial_[i].loc = MIPSLoc::MEM;
+		mrInitial_[i].reg = (int)INVALID_REG;
+		mrInitial_[i].spillLock = false;
+	}
+}
+
+const X64Reg *X64IRRegCacheFPU::GetMIPSAllocationOrder(int &count) {
+	// XMM0 and XMM1 are scratch (see XMMSCRATCH1/2.)
+	static const X64Reg allocationOrder[] = {
+		XMM2, XMM3, XMM4, XMM5, XMM6, XMM7, XMM8, XMM9,
+		XMM10, XMM11, XMM12, XMM13, XMM14, XMM15,
+	};
+
+	count = ARRAY_SIZE(allocationOrder);
+	return allocationOrder;
+}
+
+bool X64IRRegCacheFPU::IsInRAM(IRRegIndex reg) {
+	_dbg_assert_(IsValidReg(reg));
+	return mr[reg].loc == MIPSLoc::MEM;
+}
+
+bool X64IRRegCacheFPU::IsMapped(IRRegIndex mipsReg) {
+	_dbg_assert_(IsValidReg(mipsReg));
+	return mr[mipsReg].loc == MIPSLoc::REG;
+}
+
+X64Reg X64IRRegCacheFPU::MapReg(IRRegIndex mipsReg, MIPSMap mapFlags) {
+	_dbg_assert_(IsValidReg(mipsReg));
+	_dbg_assert_(mr[mipsReg].loc == MIPSLoc::MEM || mr[mipsReg].loc == MIPSLoc::REG);
+
+	pendingFlush_ = true;
+
+	// Let's see if it's already mapped. If so we just need to update the dirty flag.
+	// We don't need to check for NOINIT because we assume that anyone who maps
+	// with that flag immediately writes a "known" value to the register.
+	if (mr[mipsReg].loc == MIPSLoc::REG) {
+		_assert_msg_(ar[mr[mipsReg].reg].mipsReg == mipsReg, "FPU mapping out of sync, IR=%i", mipsReg);
+		if ((mapFlags & MIPSMap::DIRTY) == MIPSMap::DIRTY) {
+			ar[mr[mipsReg].reg].isDirty = true;
+		}
+		return (X64Reg)mr[mipsReg].reg;
+	}
+
+	// Okay, not mapped, so we need to allocate an XMM register.
+	X64Reg reg = AllocateReg();
+	if (reg != INVALID_REG) {
+		// That means it's free. Grab it, and load the value into it (if requested).
+		ar[reg].isDirty = (mapFlags & MIPSMap::DIRTY) == MIPSMap::DIRTY;
+		if ((mapFlags & MIPSMap::NOINIT) != MIPSMap::NOINIT) {
+			if (mr[mipsReg].loc == MIPSLoc::MEM) {
+				emit_->MOVSS(reg, MipsRegLocation(mipsReg));
+			}
+		}
+		ar[reg].mipsReg = mipsReg;
+		mr[mipsReg].loc = MIPSLoc::REG;
+		mr[mipsReg].reg = (int)reg;
+		return reg;
+	}
+
+	return reg;
+}
+
+X64Reg X64IRRegCacheFPU::AllocateReg() {
+	int allocCount = 0;
+	const X64Reg *allocOrder = GetMIPSAllocationOrder(allocCount);
+
+allocate:
+	for (int i = 0; i < allocCount; i++) {
+		X64Reg reg = allocOrder[i];
+
+		if (ar[reg].mipsReg == IRREG_INVALID) {
+			return reg;
+		}
+	}
+
+	// Still nothing. Let's spill a reg and goto 10.
+	bool clobbered;
+	X64Reg bestToSpill = FindBestToSpill(true, &clobbered);
+	if (bestToSpill == INVALID_REG) {
+		bestToSpill = FindBestToSpill(false, &clobbered);
+	}
+
+	if (bestToSpill != INVALID_REG) {
+		if (clobbered) {
+			DiscardR(ar[bestToSpill].mipsReg);
+		} else {
+			FlushX64Reg(bestToSpill);
+		}
+		// Now one must be free.
+		goto allocate;
+	}
+
+	// Uh oh, we have all of them spilllocked....
+	ERROR_LOG_REPORT(JIT, "Out of spillable registers near PC %08x", mips_->pc);
+	_assert_(bestToSpill != INVALID_REG);
+	return INVALID_REG;
+}
+
+X64Reg X64IRRegCacheFPU::FindBestToSpill(bool unusedOnly, bool *clobbered) {
+	int allocCount = 0;
+	const X64Reg *allocOrder = GetMIPSAllocationOrder(allocCount);
+
+	static const int UNUSED_LOOKAHEAD_OPS = 30;
+
+	IRSituation info;
+	info.lookaheadCount = UNUSED_LOOKAHEAD_OPS;
+	info.currentIndex = irIndex_;
+	const MIPSComp::IRBlock *irBlock = irBlockCache_->GetBlock(irBlockNum_);
+	info.instructions = irBlockCache_->GetBlockInstructionPtr(*irBlock);
+	info.numInstructions = irBlock->GetNumInstructions();
+
+	*clobbered = false;
+	for (int i = 0; i < allocCount; i++) {
+		X64Reg reg = allocOrder[i];
+		if (ar[reg].mipsReg != IRREG_INVALID && mr[ar[reg].mipsReg].spillLock)
+			continue;
+
+		IRUsage usage = IRNextFPRUsage(ar[reg].mipsReg, info);
+
+		// Awesome, a clobbered reg.  Let's use it.
+		if (usage == IRUsage::CLOBBERED) {
+			*clobbered = true;
+			return reg;
+		}
+
+		// Not awesome.  A used reg.  Let's try to avoid spilling.
+		if (!unusedOnly || usage == IRUsage::UNUSED) {
+			// TODO: Use age or something to choose which register to spill?
+			return reg;
+		}
+	}
+
+	return INVALID_REG;
+}
+
+void X64IRRegCacheFPU::MapInIn(IRRegIndex rd, IRRegIndex rs) {
+	SpillLock(rd, rs);
+	MapReg(rd);
+	MapReg(rs);
+	ReleaseSpillLock(rd, rs);
+}
+
+void X64IRRegCacheFPU::MapDirtyIn(IRRegIndex rd, IRRegIndex rs, bool avoidLoad) {
+	SpillLock(rd, rs);
+	bool load = !avoidLoad || rd == rs;
+	MapReg(rd, load ? MIPSMap::DIRTY : MIPSMap::NOINIT);
+	MapReg(rs);
+	ReleaseSpillLock(rd, rs);
+}
+
+void X64IRRegCacheFPU::MapDirtyInIn(IRRegIndex rd, IRRegIndex rs, IRRegIndex rt, bool avoidLoad) {
+	SpillLock(rd, rs, rt);
+	bool load = !avoidLoad || (rd == rs || rd == rt);
+	MapReg(rd, load ? MIPSMap::DIRTY : MIPSMap::NOINIT);
+	MapReg(rt);
+	MapReg(rs);
+	ReleaseSpillLock(rd, rs, rt);
+}
+
+void X64IRRegCacheFPU::Map4DirtyIn(IRRegIndex rdbase, IRRegIndex rsbase, bool avoidLoad) {
+	for (int i = 0; i < 4; ++i)
+		SpillLock(rdbase + i, rsbase + i);
+	bool load = !avoidLoad || (rdbase < rsbase + 4 && rdbase + 4 > rsbase);
+	for (int i = 0; i < 4; ++i)
+		MapReg(rdbase + i, load ? MIPSMap::DIRTY : MIPSMap::NOINIT);
+	for (int i = 0; i < 4; ++i)
+		MapReg(rsbase + i);
+	for (int i = 0; i < 4; ++i)
+		ReleaseSpillLock(rdbase + i, rsbase + i);
+}
+
+void X64IRRegCacheFPU::Map4DirtyInIn(IRRegIndex rdbase, IRRegIndex rsbase, IRRegIndex rtbase, bool avoidLoad) {
+	for (int i = 0; i < 4; ++i)
+		SpillLock(rdbase + i, rsbase + i, rtbase + i);
+	bool load = !avoidLoad || (rdbase < rsbase + 4 && rdbase + 4 > rsbase) || (rdbase < rtbase + 4 && rdbase + 4 > rtbase);
+	for (int i = 0; i < 4; ++i)
+		MapReg(rdbase + i, load ? MIPSMap::DIRTY : MIPSMap::NOINIT);
+	for (int i = 0; i < 4; ++i)
+		MapReg(rsbase + i);
+	for (int i = 0; i < 4; ++i)
+		MapReg(rtbase + i);
+	for (int i = 0; i < 4; ++i)
+		ReleaseSpillLock(rdbase + i, rsbase + i, rtbase + i);
+}
+
+void X64IRRegCacheFPU::FlushX64Reg(X64Reg r) {
+	_dbg_assert_(r >= XMM0 && r <= XMM15);
+	if (ar[r].mipsReg == IRREG_INVALID) {
+		// Nothing to do, reg not mapped.
+		return;
+	}
+	if (ar[r].isDirty && mr[ar[r].mipsReg].loc == MIPSLoc::REG) {
+		emit_->MOVSS(MipsRegLocation(ar[r].mipsReg), r);
+	}
+	mr[ar[r].mipsReg].loc = MIPSLoc::MEM;
+	mr[ar[r].mipsReg].reg = (int)INVALID_REG;
+	ar[r].mipsReg = IRREG_INVALID;
+	ar[r].isDirty = false;
+}
+
+void X64IRRegCacheFPU::FlushR(IRRegIndex r) {
+	_dbg_assert_(IsValidReg(r));
+	X64Reg reg = X64RegForFlush(r);
+	if (reg != INVALID_REG)
+		FlushX64Reg(reg);
+}
+
+X64Reg X64IRRegCacheFPU::X64RegForFlush(IRRegIndex r) {
+	_dbg_assert_(IsValidReg(r));
+	switch (mr[r].loc) {
+	case MIPSLoc::REG:
+		_assert_msg_(mr[r].reg != (int)INVALID_REG, "X64RegForFlush: IR %d had bad X64Reg", r);
+		if (mr[r].reg == (int)INVALID_REG) {
+			return INVALID_REG;
+		}
+		return (X64Reg)mr[r].reg;
+
+	case MIPSLoc::MEM:
+		return INVALID_REG;
+
+	default:
+		_assert_(false);
+		return INVALID_REG;
+	}
+}
+
+void X64IRRegCacheFPU::FlushBeforeCall() {
+	// No XMM registers are preserved by calls on System V, so just flush them all.
+	// On Windows, XMM6-XMM15 are preserved, but it's simpler to treat them the same.
+	FlushAll();
+}
+
+void X64IRRegCacheFPU::FlushAll() {
+	if (!pendingFlush_) {
+		// Nothing allocated.  FPU regs are not nearly as common as GPR.
+		return;
+	}
+
+	int numX64Regs = 0;
+	const X64Reg *order = GetMIPSAllocationOrder(numX64Regs);
+
+	for (int i = 0; i < numX64Regs; i++) {
+		int a = order[i];
+		int m = ar[a].mipsReg;
+
+		if (ar[a].isDirty) {
+			_assert_(m != MIPS_REG_INVALID);
+			emit_->MOVSS(MipsRegLocation(m), order[i]);
+
+			mr[m].loc = MIPSLoc::MEM;
+			mr[m].reg = (int)INVALID_REG;
+			ar[a].mipsReg = IRREG_INVALID;
+			ar[a].isDirty = false;
+		} else {
+			if (m != IRREG_INVALID) {
+				mr[m].loc = MIPSLoc::MEM;
+				mr[m].reg = (int)INVALID_REG;
+			}
+			ar[a].mipsReg = IRREG_INVALID;
+		}
+	}
+
+	pendingFlush_ = false;
+}
+
+void X64IRRegCacheFPU::DiscardR(IRRegIndex r) {
+	_dbg_assert_(IsValidReg(r));
+	switch (mr[r].loc) {
+	case MIPSLoc::REG:
+		_assert_(mr[r].reg != (int)INVALID_REG);
+		if (mr[r].reg != (int)INVALID_REG) {
+			// Note that we DO NOT write it back here. That's the whole point of Discard.
+			ar[mr[r].reg].isDirty = false;
+			ar[mr[r].reg].mipsReg = IRREG_INVALID;
+		}
+		break;
+
+	case MIPSLoc::MEM:
+		// Already there, nothing to do.
+		break;
+
+	default:
+		_assert_(false);
+		break;
+	}
+	mr[r].loc = MIPSLoc::MEM;
+	mr[r].reg = (int)INVALID_REG;
+	mr[r].spillLock = false;
+}
+
+OpArg X64IRRegCacheFPU::MipsRegLocation(IRRegIndex r) {
+	_assert_(IsValidReg(r));
+	// IR gives us an index that is already 32 after the state index (skipping GPRs.)
+	// Since CTXREG points at f[0], that makes it a direct offset.
+	return MDisp(CTXREG, r * 4);
+}
+
+void X64IRRegCacheFPU::SpillLock(IRRegIndex r1, IRRegIndex r2, IRRegIndex r3, IRRegIndex r4) {
+	_dbg_assert_(IsValidReg(r1));
+	_dbg_assert_(r2 == IRREG_INVALID || IsValidReg(r2));
+	_dbg_assert_(r3 == IRREG_INVALID || IsValidReg(r3));
+	_dbg_assert_(r4 == IRREG_INVALID || IsValidReg(r4));
+	mr[r1].spillLock = true;
+	if (r2 != IRREG_INVALID)
+		mr[r2].spillLock = true;
+	if (r3 != IRREG_INVALID)
+		mr[r3].spillLock = true;
+	if (r4 != IRREG_INVALID)
+		mr[r4].spillLock = true;
+	pendingUnlock_ = true;
+}
+
+void X64IRRegCacheFPU::ReleaseSpillLocksAndDiscardTemps() {
+	if (!pendingUnlock_)
+		return;
+
+	for (int i = 0; i < NUM_MIPSFPUREG; i++) {
+		mr[i].spillLock = false;
+	}
+
+	pendingUnlock_ = false;
+}
+
+void X64IRRegCacheFPU::ReleaseSpillLock(IRRegIndex r1, IRRegIndex r2, IRRegIndex r3, IRRegIndex r4) {
+	_dbg_assert_(IsValidReg(r1));
+	_dbg_assert_(r2 == IRREG_INVALID || IsValidReg(r2));
+	_dbg_assert_(r3 == IRREG_INVALID || IsValidReg(r3));
+	_dbg_assert_(r4 == IRREG_INVALID || IsValidReg(r4));
+	mr[r1].spillLock = false;
+	if (r2 != IRREG_INVALID)
+		mr[r2].spillLock = false;
+	if (r3 != IRREG_INVALID)
+		mr[r3].spillLock = false;
+	if (r4 != IRREG_INVALID)
+		mr[r4].spillLock = false;
+}
+
+X64Reg X64IRRegCacheFPU::RX(IRRegIndex mipsReg) {
+	_dbg_assert_(IsValidReg(mipsReg));
+	_dbg_assert_(mr[mipsReg].loc == MIPSLoc::REG);
+	if (mr[mipsReg].loc == MIPSLoc::REG) {
+		return (X64Reg)mr[mipsReg].reg;
+	} else {
+		ERROR_LOG_REPORT(JIT, "Reg %i not in xmm reg", mipsReg);
+		return INVALID_REG;  // BAAAD
+	}
+}
+
+bool X64IRRegCacheFPU::IsValidReg(IRRegIndex r) const {
+	if (r < 0 || r >= NUM_MIPSFPUREG)
+		return false;
+
+	// See MIPSState for these offsets.
+	int index = r + 32;
+
+	// Allow FPU or VFPU regs here.
+	if (index >= 32 && index < 32 + 32 + 128)
+		return true;
+	// Also allow VFPU temps.
+	if (index >= 224 && index < 224 + 16)
+		return true;
+
+	// Nothing else is allowed for the FPU side cache.
+	return false;
+}
+
+#endif
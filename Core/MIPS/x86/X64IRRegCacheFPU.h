@@ -0,0 +1,116 @@
+// Copyright (c) 2023- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+#pragma once
+
+#include "Common/x64Emitter.h"
+#include "Core/MIPS/MIPS.h"
+#include "Core/MIPS/x86/X64IRRegCache.h"
+
+struct FPURegStatusX64 {
+	int mipsReg;  // if -1, no mipsreg attached.
+	bool isDirty;  // Should the register be written back?
+};
+
+struct FPURegStatusMIPSX64 {
+	// Where is this MIPS register?
+	X64IRJitConstants::MIPSLoc loc;
+	// XMM register index.
+	int reg;
+
+	bool spillLock;  // if true, this register cannot be spilled.
+	// If loc == ML_MEM, it's back in its location in the CPU context struct.
+};
+
+namespace MIPSComp {
+struct JitOptions;
+}
+
+// Each MIPS FPU/VFPU register is kept in the lowest lane of an XMM register.
+class X64IRRegCacheFPU {
+public:
+	X64IRRegCacheFPU(MIPSState *mipsState, MIPSComp::JitOptions *jo);
+	~X64IRRegCacheFPU() {}
+
+	void Init(Gen::XEmitter *emitter);
+	void Start(MIPSComp::IRBlockCache *irBlockCache, int blockNum);
+	void SetIRIndex(int index) {
+		irIndex_ = index;
+	}
+
+	// Protect the XMM register containing a MIPS register from spilling, to ensure that
+	// it's being kept allocated.
+	void SpillLock(IRRegIndex reg, IRRegIndex reg2 = IRREG_INVALID, IRRegIndex reg3 = IRREG_INVALID, IRRegIndex reg4 = IRREG_INVALID);
+	void ReleaseSpillLock(IRRegIndex reg, IRRegIndex reg2 = IRREG_INVALID, IRRegIndex reg3 = IRREG_INVALID, IRRegIndex reg4 = IRREG_INVALID);
+	void ReleaseSpillLocksAndDiscardTemps();
+
+	// Returns an XMM register containing the requested MIPS register.
+	Gen::X64Reg MapReg(IRRegIndex reg, X64IRJitConstants::MIPSMap mapFlags = X64IRJitConstants::MIPSMap::INIT);
+
+	bool IsMapped(IRRegIndex r);
+	bool IsInRAM(IRRegIndex r);
+
+	void MapInIn(IRRegIndex rd, IRRegIndex rs);
+	void MapDirtyIn(IRRegIndex rd, IRRegIndex rs, bool avoidLoad = true);
+	void MapDirtyInIn(IRRegIndex rd, IRRegIndex rs, IRRegIndex rt, bool avoidLoad = true);
+	void Map4DirtyIn(IRRegIndex rdbase, IRRegIndex rsbase, bool avoidLoad = true);
+	void Map4DirtyInIn(IRRegIndex rdbase, IRRegIndex rsbase, IRRegIndex rtbase, bool avoidLoad = true);
+	void FlushBeforeCall();
+	void FlushAll();
+	void FlushR(IRRegIndex r);
+	void FlushX64Reg(Gen::X64Reg r);
+	void DiscardR(IRRegIndex r);
+
+	Gen::X64Reg RX(IRRegIndex preg); // Returns a cached register
+	Gen::OpArg R(IRRegIndex preg) {
+		return Gen::R(RX(preg));
+	}
+
+	// Memory location of the register, relative to CTXREG.
+	Gen::OpArg MipsRegLocation(IRRegIndex r);
+
+private:
+	const Gen::X64Reg *GetMIPSAllocationOrder(int &count);
+	Gen::X64Reg AllocateReg();
+	Gen::X64Reg FindBestToSpill(bool unusedOnly, bool *clobbered);
+	Gen::X64Reg X64RegForFlush(IRRegIndex r);
+
+	bool IsValidReg(IRRegIndex r) const;
+
+	void SetupInitialRegs();
+
+	MIPSState *mips_;
+	Gen::XEmitter *emit_ = nullptr;
+	MIPSComp::JitOptions *jo_;
+	MIPSComp::IRBlockCache *irBlockCache_ = nullptr;
+	int irBlockNum_ = 0;
+	int irIndex_ = 0;
+
+	enum {
+		NUM_X64FPUREG = 16,
+		NUM_MIPSFPUREG = X64IRJitConstants::TOTAL_MAPPABLE_MIPSREGS - 32,
+	};
+
+	FPURegStatusX64 ar[NUM_X64FPUREG];
+	FPURegStatusMIPSX64 mr[NUM_MIPSFPUREG];
+
+	bool pendingFlush_ = false;
+	bool pendingUnlock_ = false;
+	bool initialReady_ = false;
+	FPURegStatusX64 arInitial_[NUM_X64FPUREG];
+	FPURegStatusMIPSX64 mrInitial_[NUM_MIPSFPUREG];
+};
@@ -22,6 +22,7 @@
 #include "Common/Profiler/Profiler.h"
 #include "Common/LogReporting.h"
 #include "Common/Math/lin/matrix4x4.h"
+#include "Common/Thread/ParallelLoop.h"
 #include "Core/Config.h"
 #include "GPU/Common/DrawEngineCommon.h"
 #include "GPU/Common/SplineCommon.h"
@@ -35,8 +36,19 @@ enum {
 	TRANSFORMED_VERTEX_BUFFER_SIZE = VERTEX_BUFFER_MAX * sizeof(TransformedVertex)
 };
 
-DrawEngineCommon::DrawEngineCommon() : decoderMap_(16) {
-	if (g_Config.bVertexDecoderJit && g_Config.iCpuCore == (int)CPUCore::JIT) {
+enum {
+	// Least recently used entries of the decoded vertex cache are evicted beyond this.
+	DECODED_VERTEX_CACHE_BUDGET_MB = 16,
+	// Decoding a handful of vertices is cheaper than hashing and copying them.
+	DECODED_VERTEX_CACHE_MIN_VERTS = 64,
+	// Entries whose contents keep changing are only tracked, never filled.
+	DECODED_VERTEX_CACHE_MAX_CHANGES = 8,
+	// Smallest range worth handing to a worker thread when decoding in parallel.
+	PARALLEL_DECODE_MIN_VERTS_PER_TASK = 1024,
+};
+
+DrawEngineCommon::DrawEngineCommon() : decoderMap_(16), decodedVertsCache_(256) {
+	if (g_Config.bVertexDecoderJit && (g_Config.iCpuCore == (int)CPUCore::JIT || g_Config.iCpuCore == (int)CPUCore::JIT_IR)) {
 		decJitCache_ = new VertexDecoderJitCache();
 	}
 	transformed_ = (TransformedVertex *)AllocateMemoryPages(TRANSFORMED_VERTEX_BUFFER_SIZE, MEM_PROT_READ | MEM_PROT_WRITE);
@@ -54,6 +66,7 @@ DrawEngineCommon::~DrawEngineCommon() {
 	decoderMap_.Iterate([&](const uint32_t vtype, VertexDecoder *decoder) {
 		delete decoder;
 	});
+	ClearDecodedVertexCache();
 	ClearSplineBezierWeights();
 }
 
@@ -170,6 +183,7 @@ void DrawEngineCommon::NotifyConfigChanged() {
 	});
 	decoderMap_.Clear();
 	ClearTrackedVertexArrays();
+	ClearDecodedVertexCache();
 
 	useHWTransform_ = g_Config.bHardwareTransform;
 	useHWTessellation_ = UpdateUseHWTessellation(g_Config.bHardwareTessellation);
@@ -626,7 +640,7 @@ void DrawEngineCommon::DecodeVertsStep(u8 *dest, int &i, int &decodedVerts, cons
 
 	if (dc.indexType == GE_VTYPE_IDX_NONE >> GE_VTYPE_IDX_SHIFT) {
 		// Decode the verts (and at the same time apply morphing/skinning). Simple.
-		dec_->DecodeVerts(dest + decodedVerts * (int)dec_->GetDecVtxFmt().stride,
+		DecodeVertsRange(dest + decodedVerts * (int)dec_->GetDecVtxFmt().stride,
 			dc.verts, uvScale, indexLowerBound, indexUpperBound);
 		decodedVerts += indexUpperBound - indexLowerBound + 1;
 		
@@ -693,7 +707,7 @@ void DrawEngineCommon::DecodeVertsStep(u8 *dest, int &i, int &decodedVerts, cons
 		}
 
 		// 3. Decode that range of vertex data.
-		dec_->DecodeVerts(dest + decodedVerts * (int)dec_->GetDecVtxFmt().stride,
+		DecodeVertsRange(dest + decodedVerts * (int)dec_->GetDecVtxFmt().stride,
 			dc.verts, uvScale, indexLowerBound, indexUpperBound);
 		decodedVerts += vertexCount;
 
@@ -703,6 +717,22 @@ void DrawEngineCommon::DecodeVertsStep(u8 *dest, int &i, int &decodedVerts, cons
 	}
 }
 
+void DrawEngineCommon::DecodeVertsRange(u8 *dest, const void *verts, const UVScale *uvScale, int indexLowerBound, int indexUpperBound) {
+	const int count = indexUpperBound - indexLowerBound + 1;
+	const int minVerts = g_Config.iParallelVertexDecodeMinVerts;
+	if (minVerts <= 0 || count < minVerts || !dec_->CanDecodeInParallel() || g_threadManager.GetNumLooperThreads() <= 1) {
+		dec_->DecodeVerts(dest, verts, uvScale, indexLowerBound, indexUpperBound);
+		return;
+	}
+
+	// Each vertex is decoded on its own, so the output doesn't depend on how the range is split.
+	const VertexDecoder *dec = dec_;
+	const int stride = dec->GetDecVtxFmt().stride;
+	ParallelRangeLoop(&g_threadManager, [=](int l, int h) {
+		dec->DecodeVerts(dest + (l - indexLowerBound) * stride, verts, uvScale, l, h - 1);
+	}, indexLowerBound, indexUpperBound + 1, std::max(minVerts / 8, (int)PARALLEL_DECODE_MIN_VERTS_PER_TASK), TaskPriority::HIGH);
+}
+
 inline u32 ComputeMiniHashRange(const void *ptr, size_t sz) {
 	// Switch to u32 units, and round up to avoid unaligned accesses.
 	// Probably doesn't matter if we skip the first few bytes in some cases.
@@ -750,7 +780,7 @@ u32 DrawEngineCommon::ComputeMiniHash() {
 
 uint64_t DrawEngineCommon::ComputeHash() {
 	uint64_t fullhash = 0;
-	const int vertexSize = dec_->GetDecVtxFmt().stride;
+	const int vertexSize = dec_->VertexSize();
 	const int indexSize = IndexSize(dec_->VertexType());
 
 	// TODO: Add some caps both for numDrawCalls_ and num verts to check?
@@ -766,17 +796,18 @@ uint64_t DrawEngineCommon::ComputeHash() {
 			while (j < numDrawCalls_) {
 				if (drawCalls_[j].verts != dc.verts)
 					break;
-				indexLowerBound = std::min(indexLowerBound, (int)dc.indexLowerBound);
-				indexUpperBound = std::max(indexUpperBound, (int)dc.indexUpperBound);
+				indexLowerBound = std::min(indexLowerBound, (int)drawCalls_[j].indexLowerBound);
+				indexUpperBound = std::max(indexUpperBound, (int)drawCalls_[j].indexUpperBound);
 				lastMatch = j;
 				j++;
 			}
 			// This could get seriously expensive with sparse indices. Need to combine hashing ranges the same way
 			// we do when drawing.
 			fullhash += XXH3_64bits((const char *)dc.verts + vertexSize * indexLowerBound,
-				vertexSize * (indexUpperBound - indexLowerBound));
-			// Hm, we will miss some indices when combining above, but meh, it should be fine.
-			fullhash += XXH3_64bits((const char *)dc.inds, indexSize * dc.vertexCount);
+				vertexSize * (indexUpperBound - indexLowerBound + 1));
+			for (int k = i; k <= lastMatch; k++) {
+				fullhash += XXH3_64bits((const char *)drawCalls_[k].inds, indexSize * drawCalls_[k].vertexCount);
+			}
 			i = lastMatch;
 		}
 	}
@@ -785,6 +816,137 @@ uint64_t DrawEngineCommon::ComputeHash() {
 	return fullhash;
 }
 
+void DrawEngineCommon::DecodeVertsWithCache(u8 *dest) {
+	// Morphing and skinning in the decoder depend on more than the vertex data, and anything already
+	// decoded at submit time (software skinning) would have to be merged in.
+	bool cacheable = g_Config.bVertexCache && decodeCounter_ == 0 && decodedVerts_ == 0 && vertexCountInDrawCalls_ >= DECODED_VERTEX_CACHE_MIN_VERTS;
+	if ((lastVType_ & GE_VTYPE_MORPHCOUNT_MASK) || (dec_->skinInDecode && (lastVType_ & GE_VTYPE_WEIGHT_MASK)))
+		cacheable = false;
+	if (!cacheable) {
+		DecodeVerts(dest);
+		return;
+	}
+
+	// Keyed by where the draws come from, so a draw whose data keeps changing finds its old entry.
+	const u32 key = ComputeDrawcallsHash() ^ lastVType_;
+	DecodedVertsEntry *entry = decodedVertsCache_.Get(key);
+	if (entry && entry->numChanges >= DECODED_VERTEX_CACHE_MAX_CHANGES) {
+		// Changes too often to ever be cached, don't waste time hashing it.
+		DecodeVerts(dest);
+		decodedVertsLRU_.splice(decodedVertsLRU_.begin(), decodedVertsLRU_, entry->lru);
+		gpuStats.numDecodedVertexCacheMisses++;
+		return;
+	}
+
+	uint64_t hash = ComputeHash();
+	// The winding of the generated indices depends on the cull state at flush time.
+	u8 flipped[MAX_DEFERRED_DRAW_CALLS];
+	for (int i = 0; i < numDrawCalls_; i++) {
+		flipped[i] = gstate.isCullEnabled() && gstate.getCullMode() != drawCalls_[i].cullMode;
+	}
+	hash ^= XXH3_64bits(flipped, numDrawCalls_);
+
+	if (entry && entry->hash == hash && entry->vertType == lastVType_ && !entry->verts.empty()) {
+		memcpy(dest, entry->verts.data(), entry->verts.size());
+		indexGen.Restore(entry->inds.data(), (int)entry->inds.size(), entry->maxIndex, entry->pureCount, entry->prim, entry->seenPrims);
+		decodedVerts_ = entry->numVerts;
+		decodeCounter_ = numDrawCalls_;
+
+		// Replay the side effects of decoding, too.
+		gstate_c.vertexFullAlpha = gstate_c.vertexFullAlpha && entry->fullAlpha;
+		gstate_c.vertBounds.minU = std::min(gstate_c.vertBounds.minU, entry->bounds.minU);
+		gstate_c.vertBounds.minV = std::min(gstate_c.vertBounds.minV, entry->bounds.minV);
+		gstate_c.vertBounds.maxU = std::max(gstate_c.vertBounds.maxU, entry->bounds.maxU);
+		gstate_c.vertBounds.maxV = std::max(gstate_c.vertBounds.maxV, entry->bounds.maxV);
+
+		decodedVertsLRU_.splice(decodedVertsLRU_.begin(), decodedVertsLRU_, entry->lru);
+		gpuStats.numDecodedVertexCacheHits++;
+		return;
+	}
+
+	// Decode with fresh bounds and alpha so we know what this draw alone contributes.
+	const KnownVertexBounds prevBounds = gstate_c.vertBounds;
+	const bool prevFullAlpha = gstate_c.vertexFullAlpha;
+	gstate_c.vertBounds.minU = 512;
+	gstate_c.vertBounds.minV = 512;
+	gstate_c.vertBounds.maxU = 0;
+	gstate_c.vertBounds.maxV = 0;
+	gstate_c.vertexFullAlpha = true;
+
+	DecodeVerts(dest);
+
+	const KnownVertexBounds bounds = gstate_c.vertBounds;
+	const bool fullAlpha = gstate_c.vertexFullAlpha;
+	gstate_c.vertexFullAlpha = prevFullAlpha && fullAlpha;
+	gstate_c.vertBounds.minU = std::min(prevBounds.minU, bounds.minU);
+	gstate_c.vertBounds.minV = std::min(prevBounds.minV, bounds.minV);
+	gstate_c.vertBounds.maxU = std::max(prevBounds.maxU, bounds.maxU);
+	gstate_c.vertBounds.maxV = std::max(prevBounds.maxV, bounds.maxV);
+	gpuStats.numDecodedVertexCacheMisses++;
+
+	if (!entry) {
+		// First time we see this draw. Only remember the hash, most draws never repeat.
+		entry = new DecodedVertsEntry{};
+		entry->key = key;
+		entry->vertType = lastVType_;
+		entry->hash = hash;
+		decodedVertsCache_.Insert(key, entry);
+		decodedVertsLRU_.push_front(entry);
+		entry->lru = decodedVertsLRU_.begin();
+		decodedVertsCacheBytes_ += sizeof(DecodedVertsEntry);
+	} else {
+		if (entry->hash != hash || entry->vertType != lastVType_) {
+			// Changed since last time, or a different draw with the same key. Start over.
+			decodedVertsCacheBytes_ -= entry->verts.size() + entry->inds.size() * sizeof(u16);
+			entry->verts.clear();
+			entry->verts.shrink_to_fit();
+			entry->inds.clear();
+			entry->inds.shrink_to_fit();
+			entry->vertType = lastVType_;
+			entry->hash = hash;
+			entry->numChanges++;
+		} else if (entry->numChanges < DECODED_VERTEX_CACHE_MAX_CHANGES) {
+			// Unchanged since last time, so probably static. Keep the result around.
+			const size_t vertBytes = decodedVerts_ * dec_->GetDecVtxFmt().stride;
+			const int numInds = indexGen.VertexCount();
+			if (vertBytes + numInds * sizeof(u16) <= DECODED_VERTEX_CACHE_BUDGET_MB * 1024 * 1024 / 8) {
+				entry->verts.assign(dest, dest + vertBytes);
+				entry->inds.assign(decIndex_, decIndex_ + numInds);
+				entry->numVerts = decodedVerts_;
+				entry->maxIndex = indexGen.MaxIndex();
+				entry->pureCount = indexGen.PureCount();
+				entry->seenPrims = indexGen.SeenPrims();
+				entry->prim = indexGen.Prim();
+				entry->bounds = bounds;
+				entry->fullAlpha = fullAlpha;
+				decodedVertsCacheBytes_ += vertBytes + numInds * sizeof(u16);
+			}
+		}
+		decodedVertsLRU_.splice(decodedVertsLRU_.begin(), decodedVertsLRU_, entry->lru);
+	}
+
+	while (decodedVertsCacheBytes_ > DECODED_VERTEX_CACHE_BUDGET_MB * 1024 * 1024 && decodedVertsLRU_.size() > 1) {
+		DecodedVertsEntry *oldest = decodedVertsLRU_.back();
+		decodedVertsLRU_.pop_back();
+		decodedVertsCache_.Remove(oldest->key);
+		decodedVertsCacheBytes_ -= sizeof(DecodedVertsEntry) + oldest->verts.size() + oldest->inds.size() * sizeof(u16);
+		delete oldest;
+	}
+	decodedVertsCache_.Maintain();
+
+	gpuStats.numDecodedVertexCacheEntries = (int)decodedVertsCache_.size();
+	gpuStats.decodedVertexCacheBytes = (int)decodedVertsCacheBytes_;
+}
+
+void DrawEngineCommon::ClearDecodedVertexCache() {
+	decodedVertsCache_.Iterate([&](u32 key, DecodedVertsEntry *entry) {
+		delete entry;
+	});
+	decodedVertsCache_.Clear();
+	decodedVertsLRU_.clear();
+	decodedVertsCacheBytes_ = 0;
+}
+
 // vertTypeID is the vertex type but with the UVGen mode smashed into the top bits.
 void DrawEngineCommon::SubmitPrim(const void *verts, const void *inds, GEPrimitiveType prim, int vertexCount, u32 vertTypeID, int cullMode, int *bytesRead) {
 	if (!indexGen.PrimCompatible(prevPrim_, prim) || numDrawCalls_ >= MAX_DEFERRED_DRAW_CALLS || vertexCountInDrawCalls_ + vertexCount > VERTEX_BUFFER_MAX) {
@@ -829,6 +991,10 @@ void DrawEngineCommon::SubmitPrim(const void *verts, const void *inds, GEPrimiti
 		dc.indexUpperBound = vertexCount - 1;
 	}
 
+	// Still batching after an ignored state change means we saved a flush, unless something else flushed anyway.
+	if (flushAvoided_ && numDrawCalls_ != 0)
+		gpuStats.numFlushesAvoided++;
+	flushAvoided_ = false;
 	numDrawCalls_++;
 	vertexCountInDrawCalls_ += vertexCount;
 
@@ -17,6 +17,7 @@
 
 #pragma once
 
+#include <list>
 #include <vector>
 
 #include "Common/CommonTypes.h"
@@ -132,6 +133,12 @@ class DrawEngineCommon {
 	int GetNumDrawCalls() const {
 		return numDrawCalls_;
 	}
+	// A state change that used to break the batch was ignored.  Counted once the next draw
+	// joins the same batch, since the old code flushed at most once between two draws.
+	void NoteFlushAvoided() {
+		if (numDrawCalls_ != 0)
+			flushAvoided_ = true;
+	}
 
 	VertexDecoder *GetVertexDecoder(u32 vtype);
 
@@ -143,6 +150,10 @@ class DrawEngineCommon {
 
 	int ComputeNumVertsToDecode() const;
 	void DecodeVerts(u8 *dest);
+	// Same as DecodeVerts, but draws that repeat unchanged (static geometry) are only decoded once,
+	// after that the decoded vertices and generated indices are copied out of the decoded vertex cache.
+	void DecodeVertsWithCache(u8 *dest);
+	void ClearDecodedVertexCache();
 
 	// Preprocessing for spline/bezier
 	u32 NormalizeVertices(u8 *outPtr, u8 *bufPtr, const u8 *inPtr, int lowerBound, int upperBound, u32 vertType, int *vertexSize = nullptr);
@@ -153,6 +164,8 @@ class DrawEngineCommon {
 
 	// Vertex decoding
 	void DecodeVertsStep(u8 *dest, int &i, int &decodedVerts, const UVScale *uvScale);
+	// Splits large ranges across worker threads, see iParallelVertexDecodeMinVerts.
+	void DecodeVertsRange(u8 *dest, const void *verts, const UVScale *uvScale, int indexLowerBound, int indexUpperBound);
 
 	void ApplyFramebufferRead(FBOTexState *fboTexState);
 
@@ -226,6 +239,7 @@ class DrawEngineCommon {
 	DeferredDrawCall drawCalls_[MAX_DEFERRED_DRAW_CALLS];
 	int numDrawCalls_ = 0;
 	int vertexCountInDrawCalls_ = 0;
+	bool flushAvoided_ = false;
 
 	int decimationCounter_ = 0;
 	int decodeCounter_ = 0;
@@ -235,6 +249,30 @@ class DrawEngineCommon {
 	int decodedVerts_ = 0;
 	GEPrimitiveType prevPrim_ = GE_PRIM_INVALID;
 
+	// Decoded vertex cache. Backend neutral, so it also covers the software transform paths and
+	// backends without a vertex buffer cache of their own. Keyed by the draw calls and the vertex
+	// type, verified against ComputeHash().
+	struct DecodedVertsEntry {
+		u32 key;
+		u32 vertType;
+		uint64_t hash;
+		int numChanges;
+		std::vector<u8> verts;
+		std::vector<u16> inds;
+		int numVerts;
+		int maxIndex;
+		int pureCount;
+		int seenPrims;
+		GEPrimitiveType prim;
+		KnownVertexBounds bounds;
+		bool fullAlpha;
+		std::list<DecodedVertsEntry *>::iterator lru;
+	};
+	PrehashMap<DecodedVertsEntry *, nullptr> decodedVertsCache_;
+	// Most recently used first.
+	std::list<DecodedVertsEntry *> decodedVertsLRU_;
+	size_t decodedVertsCacheBytes_ = 0;
+
 	// Shader blending state
 	bool fboTexBound_ = false;
 
@@ -18,6 +18,8 @@
 
 #pragma once
 
+#include <cstring>
+
 #include "Common/CommonTypes.h"
 #include "Common/Swap.h"
 #include "GPU/ge_constants.h"
@@ -66,6 +68,18 @@ class IndexGenerator {
 		index_ += numVerts;
 	}
 
+	// Replays a previously generated index list, as if the same prims had been added again.
+	// Used by the decoded vertex cache. Only valid right after Reset().
+	void Restore(const u16 *inds, int count, int index, int pureCount, GEPrimitiveType prim, int seenPrims) {
+		memcpy(indsBase_, inds, count * sizeof(u16));
+		inds_ = indsBase_ + count;
+		count_ = count;
+		index_ = index;
+		pureCount_ = pureCount;
+		prim_ = prim;
+		seenPrims_ = seenPrims;
+	}
+
 	void SetIndex(int ind) { index_ = ind; }
 	int MaxIndex() const { return index_; }  // Really NextIndex rather than MaxIndex, it's one more than the highest index generated
 	int VertexCount() const { return count_; }
@@ -19,6 +19,8 @@
 
 #include <algorithm>
 
+#include "ext/xxhash.h"
+
 #include "Common/Common.h"
 #include "Common/Data/Convert/ColorConv.h"
 #include "Common/Data/Collections/TinySet.h"
@@ -26,6 +28,7 @@
 #include "Common/LogReporting.h"
 #include "Common/MemoryUtil.h"
 #include "Common/StringUtils.h"
+#include "Common/Thread/ThreadManager.h"
 #include "Common/TimeUtil.h"
 #include "Common/Math/math_util.h"
 #include "Common/GPU/thin3d.h"
@@ -58,21 +61,21 @@
 // Videos should be updated every few frames, so we forget quickly.
 #define VIDEO_DECIMATE_AGE 4
 
-// If a texture hasn't been seen for this many frames, get rid of it.
+// If a texture hasn't been seen for this many frames, get rid of it even when under budget.
 #define TEXTURE_KILL_AGE 200
-#define TEXTURE_KILL_AGE_LOWMEM 60
 // Not used in lowmem mode.
 #define TEXTURE_SECOND_KILL_AGE 100
-// Used when there are multiple CLUT variants of a texture.
-#define TEXTURE_KILL_AGE_CLUT 6
+// Textures used this recently are never evicted, even when over budget, to avoid thrashing.
+#define TEXTURE_MIN_EVICT_AGE 2
 
 #define TEXTURE_CLUT_VARIANTS_MIN 6
 
 // Try to be prime to other decimation intervals.
 #define TEXCACHE_DECIMATION_INTERVAL 13
 
-#define TEXCACHE_MIN_PRESSURE 16 * 1024 * 1024  // Total in VRAM
-#define TEXCACHE_SECOND_MIN_PRESSURE 4 * 1024 * 1024
+#define TEXCACHE_BUDGET (32 * 1024 * 1024)  // Total in VRAM
+#define TEXCACHE_BUDGET_LOWMEM (16 * 1024 * 1024)
+#define TEXCACHE_SECOND_BUDGET (4 * 1024 * 1024)
 
 // Just for reference
 
@@ -353,16 +356,13 @@ void TextureCacheCommon::UpdateMaxSeenV(TexCacheEntry *entry, bool throughMode)
 	// If the texture is >= 512 pixels tall...
 	if (entry->dim >= 0x900) {
 		if (entry->cluthash != 0 && entry->maxSeenV == 0) {
-			const u64 cachekeyMin = (u64)(entry->addr & 0x3FFFFFFF) << 32;
-			const u64 cachekeyMax = cachekeyMin + (1ULL << 32);
-			for (auto it = cache_.lower_bound(cachekeyMin), end = cache_.upper_bound(cachekeyMax); it != end; ++it) {
+			cache_.ForEachAtAddress(entry->addr & 0x3FFFFFFF, [&](TexCacheEntry *other) {
 				// They should all be the same, just make sure we take any that has already increased.
 				// This is for a new texture.
-				if (it->second->maxSeenV != 0) {
-					entry->maxSeenV = it->second->maxSeenV;
-					break;
+				if (other->maxSeenV != 0 && entry->maxSeenV == 0) {
+					entry->maxSeenV = other->maxSeenV;
 				}
-			}
+			});
 		}
 
 		// Texture scale/offset and gen modes don't apply in through.
@@ -386,11 +386,9 @@ void TextureCacheCommon::UpdateMaxSeenV(TexCacheEntry *entry, bool throughMode)
 		// We need to keep all CLUT variants in sync so we detect changes properly.
 		// See HandleTextureChange / STATUS_CLUT_RECHECK.
 		if (entry->cluthash != 0) {
-			const u64 cachekeyMin = (u64)(entry->addr & 0x3FFFFFFF) << 32;
-			const u64 cachekeyMax = cachekeyMin + (1ULL << 32);
-			for (auto it = cache_.lower_bound(cachekeyMin), end = cache_.upper_bound(cachekeyMax); it != end; ++it) {
-				it->second->maxSeenV = entry->maxSeenV;
-			}
+			cache_.ForEachAtAddress(entry->addr & 0x3FFFFFFF, [&](TexCacheEntry *other) {
+				other->maxSeenV = entry->maxSeenV;
+			});
 		}
 	}
 }
@@ -447,17 +445,14 @@ TexCacheEntry *TextureCacheCommon::SetTexture() {
 
 	u32 minihash = MiniHash((const u32 *)Memory::GetPointerUnchecked(texaddr));
 
-	TexCache::iterator entryIter = cache_.find(cachekey);
-	TexCacheEntry *entry = nullptr;
+	TexCacheEntry *entry = cache_.Get(cachekey);
 
 	// Note: It's necessary to reset needshadertexclamp, for otherwise DIRTY_TEXCLAMP won't get set later.
 	// Should probably revisit how this works..
 	gstate_c.SetNeedShaderTexclamp(false);
 	gstate_c.skipDrawReason &= ~SKIPDRAW_BAD_FB_TEXTURE;
 
-	if (entryIter != cache_.end()) {
-		entry = entryIter->second.get();
-
+	if (entry) {
 		// Validate the texture still matches the cache entry.
 		bool match = entry->Matches(dim, texFormat, maxLevel);
 		const char *reason = "different params";
@@ -527,7 +522,7 @@ TexCacheEntry *TextureCacheCommon::SetTexture() {
 			}
 		}
 
-		if (match && (entry->status & TexCacheEntry::STATUS_TO_SCALE) && standardScaleFactor_ != 1 && texelsScaledThisFrame_ < TEXCACHE_MAX_TEXELS_SCALED) {
+		if (match && (entry->status & TexCacheEntry::STATUS_TO_SCALE) && standardScaleFactor_ != 1 && ReadyToScale(entry)) {
 			if ((entry->status & TexCacheEntry::STATUS_CHANGE_FREQUENT) == 0) {
 				// INFO_LOG(G3D, "Reloading texture to do the scaling we skipped..");
 				match = false;
@@ -611,8 +606,8 @@ TexCacheEntry *TextureCacheCommon::SetTexture() {
 	AttachCandidate bestCandidate;
 	if (GetBestFramebufferCandidate(def, 0, &bestCandidate)) {
 		// If we had a texture entry here, let's get rid of it.
-		if (entryIter != cache_.end()) {
-			DeleteTexture(entryIter);
+		if (entry) {
+			DeleteTexture(entry);
 		}
 
 		nextTexture_ = nullptr;
@@ -627,7 +622,7 @@ TexCacheEntry *TextureCacheCommon::SetTexture() {
 	if (!entry) {
 		VERBOSE_LOG(G3D, "No texture in cache for %08x, decoding...", texaddr);
 		entry = new TexCacheEntry{};
-		cache_[cachekey].reset(entry);
+		cache_.Insert(cachekey, entry);
 
 		if (PPGeIsFontTextureAddress(texaddr)) {
 			// It's the builtin font texture.
@@ -644,18 +639,15 @@ TexCacheEntry *TextureCacheCommon::SetTexture() {
 		}
 
 		if (hasClut && clutRenderAddress_ == 0xFFFFFFFF) {
-			const u64 cachekeyMin = (u64)(texaddr & 0x3FFFFFFF) << 32;
-			const u64 cachekeyMax = cachekeyMin + (1ULL << 32);
-
 			int found = 0;
-			for (auto it = cache_.lower_bound(cachekeyMin), end = cache_.upper_bound(cachekeyMax); it != end; ++it) {
+			cache_.ForEachAtAddress(texaddr & 0x3FFFFFFF, [&](TexCacheEntry *other) {
 				found++;
-			}
+			});
 
 			if (found >= TEXTURE_CLUT_VARIANTS_MIN) {
-				for (auto it = cache_.lower_bound(cachekeyMin), end = cache_.upper_bound(cachekeyMax); it != end; ++it) {
-					it->second->status |= TexCacheEntry::STATUS_CLUT_VARIANTS;
-				}
+				cache_.ForEachAtAddress(texaddr & 0x3FFFFFFF, [&](TexCacheEntry *other) {
+					other->status |= TexCacheEntry::STATUS_CLUT_VARIANTS;
+				});
 
 				entry->status |= TexCacheEntry::STATUS_CLUT_VARIANTS;
 			}
@@ -791,46 +783,69 @@ bool TextureCacheCommon::GetBestFramebufferCandidate(const TextureDefinition &en
 
 // Removes old textures.
 void TextureCacheCommon::Decimate(bool forcePressure) {
+	// Eviction only ever looks at the least recently used end of the cache, so it's cheap enough
+	// to enforce the budget every frame rather than every TEXCACHE_DECIMATION_INTERVAL.
+	const u32 budget = lowMemoryMode_ ? TEXCACHE_BUDGET_LOWMEM : TEXCACHE_BUDGET;
+	const u32 had = cacheSizeEstimate_;
+	bool forgotLast = false;
+	while (TexCacheEntry *entry = cache_.LeastRecentlyUsed()) {
+		if (entry->lastFrame + TEXTURE_MIN_EVICT_AGE >= gpuStats.numFlips) {
+			// Everything after this was used even more recently.
+			break;
+		}
+		bool overBudget = forcePressure || cacheSizeEstimate_ > budget;
+		if (!overBudget && entry->lastFrame + TEXTURE_KILL_AGE >= gpuStats.numFlips) {
+			break;
+		}
+		if (!forgotLast) {
+			ForgetLastTexture();
+			forgotLast = true;
+		}
+		DeleteTexture(entry);
+	}
+	if (forgotLast) {
+		VERBOSE_LOG(G3D, "Decimated texture cache, saved %d estimated bytes - now %d bytes", had - cacheSizeEstimate_, cacheSizeEstimate_);
+	}
+
 	if (--decimationCounter_ <= 0) {
 		decimationCounter_ = TEXCACHE_DECIMATION_INTERVAL;
 	} else {
 		return;
 	}
 
-	if (forcePressure || cacheSizeEstimate_ >= TEXCACHE_MIN_PRESSURE) {
-		const u32 had = cacheSizeEstimate_;
+	cache_.Maintain();
 
-		ForgetLastTexture();
-		int killAgeBase = lowMemoryMode_ ? TEXTURE_KILL_AGE_LOWMEM : TEXTURE_KILL_AGE;
-		for (TexCache::iterator iter = cache_.begin(); iter != cache_.end(); ) {
-			bool hasClut = (iter->second->status & TexCacheEntry::STATUS_CLUT_VARIANTS) != 0;
-			int killAge = hasClut ? TEXTURE_KILL_AGE_CLUT : killAgeBase;
-			if (iter->second->lastFrame + killAge < gpuStats.numFlips) {
-				DeleteTexture(iter++);
-			} else {
-				++iter;
-			}
+	for (auto it = asyncScales_.begin(); it != asyncScales_.end(); ) {
+		// Nobody picked the result up. If the texture is used again, it'll just be queued again.
+		if (it->second->done && it->first->lastFrame + TEXTURE_MIN_EVICT_AGE < gpuStats.numFlips) {
+			it = asyncScales_.erase(it);
+		} else {
+			++it;
 		}
-
-		VERBOSE_LOG(G3D, "Decimated texture cache, saved %d estimated bytes - now %d bytes", had - cacheSizeEstimate_, cacheSizeEstimate_);
 	}
 
 	// If enabled, we also need to clear the secondary cache.
-	if (PSP_CoreParameter().compat.flags().SecondaryTextureCache && (forcePressure || secondCacheSizeEstimate_ >= TEXCACHE_SECOND_MIN_PRESSURE)) {
-		const u32 had = secondCacheSizeEstimate_;
+	if (PSP_CoreParameter().compat.flags().SecondaryTextureCache) {
+		const u32 secondHad = secondCacheSizeEstimate_;
 
-		for (TexCache::iterator iter = secondCache_.begin(); iter != secondCache_.end(); ) {
+		while (TexCacheEntry *entry = secondCache_.LeastRecentlyUsed()) {
+			// Like the primary cache, don't evict what's still in use, or it just gets rehashed back in.
 			// In low memory mode, we kill them all since secondary cache is disabled.
-			if (lowMemoryMode_ || iter->second->lastFrame + TEXTURE_SECOND_KILL_AGE < gpuStats.numFlips) {
-				ReleaseTexture(iter->second.get(), true);
-				secondCacheSizeEstimate_ -= EstimateTexMemoryUsage(iter->second.get());
-				secondCache_.erase(iter++);
-			} else {
-				++iter;
+			if (!lowMemoryMode_ && entry->lastFrame + TEXTURE_MIN_EVICT_AGE >= gpuStats.numFlips) {
+				break;
+			}
+			bool overBudget = lowMemoryMode_ || forcePressure || secondCacheSizeEstimate_ > TEXCACHE_SECOND_BUDGET;
+			if (!overBudget && entry->lastFrame + TEXTURE_SECOND_KILL_AGE >= gpuStats.numFlips) {
+				break;
 			}
+			asyncScales_.erase(entry);
+			ReleaseTexture(entry, true);
+			secondCacheSizeEstimate_ -= EstimateTexMemoryUsage(entry);
+			secondCache_.Erase(entry);
 		}
+		secondCache_.Maintain();
 
-		VERBOSE_LOG(G3D, "Decimated second texture cache, saved %d estimated bytes - now %d bytes", had - secondCacheSizeEstimate_, secondCacheSizeEstimate_);
+		VERBOSE_LOG(G3D, "Decimated second texture cache, saved %d estimated bytes - now %d bytes", secondHad - secondCacheSizeEstimate_, secondCacheSizeEstimate_);
 	}
 
 	DecimateVideos();
@@ -860,6 +875,17 @@ bool TextureCacheCommon::IsVideo(u32 texaddr) const {
 	return false;
 }
 
+void TextureCacheCommon::MarkOtherClutsForRecheck(const TexCacheEntry *entry) {
+	// Mark any textures with the same address but different clut.  They need rechecking.
+	if (entry->cluthash != 0) {
+		cache_.ForEachAtAddress(entry->addr & 0x3FFFFFFF, [&](TexCacheEntry *other) {
+			if (other->cluthash != entry->cluthash) {
+				other->status |= TexCacheEntry::STATUS_CLUT_RECHECK;
+			}
+		});
+	}
+}
+
 void TextureCacheCommon::HandleTextureChange(TexCacheEntry *const entry, const char *reason, bool initialMatch, bool doDelete) {
 	cacheSizeEstimate_ -= EstimateTexMemoryUsage(entry);
 	entry->numInvalidated++;
@@ -876,16 +902,7 @@ void TextureCacheCommon::HandleTextureChange(TexCacheEntry *const entry, const c
 		entry->SetHashStatus(TexCacheEntry::STATUS_HASHING);
 	}
 
-	// Also, mark any textures with the same address but different clut.  They need rechecking.
-	if (entry->cluthash != 0) {
-		const u64 cachekeyMin = (u64)(entry->addr & 0x3FFFFFFF) << 32;
-		const u64 cachekeyMax = cachekeyMin + (1ULL << 32);
-		for (auto it = cache_.lower_bound(cachekeyMin), end = cache_.upper_bound(cachekeyMax); it != end; ++it) {
-			if (it->second->cluthash != entry->cluthash) {
-				it->second->status |= TexCacheEntry::STATUS_CLUT_RECHECK;
-			}
-		}
-	}
+	MarkOtherClutsForRecheck(entry);
 
 	if (entry->numFrames < TEXCACHE_FRAME_CHANGE_FREQUENT) {
 		if (entry->status & TexCacheEntry::STATUS_FREE_CHANGE) {
@@ -918,30 +935,20 @@ void TextureCacheCommon::NotifyFramebuffer(VirtualFramebuffer *framebuffer, Fram
 		// Try to match the new framebuffer to existing textures.
 		// Backwards from the "usual" texturing case so can't share a utility function.
 
-		u64 cacheKey = (u64)fb_addr << 32;
-		// If it has a clut, those are the low 32 bits, so it'll be inside this range.
-		// Also, if it's a subsample of the buffer, it'll also be within the FBO.
-		u64 cacheKeyEnd = (u64)fb_endAddr << 32;
+		auto markOverlap = [](TexCacheEntry *entry) {
+			entry->status |= TexCacheEntry::STATUS_FRAMEBUFFER_OVERLAP;
+			gpuStats.numTextureInvalidationsByFramebuffer++;
+		};
 
 		// Color - no need to look in the mirrors.
-		for (auto it = cache_.lower_bound(cacheKey), end = cache_.upper_bound(cacheKeyEnd); it != end; ++it) {
-			it->second->status |= TexCacheEntry::STATUS_FRAMEBUFFER_OVERLAP;
-			gpuStats.numTextureInvalidationsByFramebuffer++;
-		}
+		// If it's a subsample of the buffer, it'll also be within this range. CLUT variants share the address.
+		cache_.ForEachInRange(fb_addr, fb_endAddr, markOverlap);
 
 		if (z_stride != 0) {
 			// Depth. Just look at the range, but in each mirror (0x04200000 and 0x04600000).
 			// Games don't use 0x04400000 as far as I know - it has no swizzle effect so kinda useless.
-			cacheKey = (u64)z_addr << 32;
-			cacheKeyEnd = (u64)z_endAddr << 32;
-			for (auto it = cache_.lower_bound(cacheKey | 0x200000), end = cache_.upper_bound(cacheKeyEnd | 0x200000); it != end; ++it) {
-				it->second->status |= TexCacheEntry::STATUS_FRAMEBUFFER_OVERLAP;
-				gpuStats.numTextureInvalidationsByFramebuffer++;
-			}
-			for (auto it = cache_.lower_bound(cacheKey | 0x600000), end = cache_.upper_bound(cacheKeyEnd | 0x600000); it != end; ++it) {
-				it->second->status |= TexCacheEntry::STATUS_FRAMEBUFFER_OVERLAP;
-				gpuStats.numTextureInvalidationsByFramebuffer++;
-			}
+			cache_.ForEachInRange(z_addr | 0x200000, z_endAddr | 0x200000, markOverlap);
+			cache_.ForEachInRange(z_addr | 0x600000, z_endAddr | 0x600000, markOverlap);
 		}
 		break;
 	}
@@ -1883,14 +1890,13 @@ CheckAlphaResult TextureCacheCommon::DecodeTextureLevel(u8 *out, int outPitch, G
 					CopyAndSumMask16((u16 *)(out + outPitch * y), (u16 *)(texptr + bufw * sizeof(u16) * y), w, &alphaSum);
 				}
 			}
-		} /* else if (h >= 8 && bufw <= w && !expandTo32bit) {
-			// TODO: Handle alpha mask. This will require special versions of UnswizzleFromMem to keep the optimization.
-			// Note: this is always safe since h must be a power of 2, so a multiple of 8.
+		} else if ((h & 7) == 0 && bufw == w && !expandTo32bit && !reverseColors) {
+			// No conversion needed, so unswizzle straight into out (often a mapped upload buffer) instead of going
+			// through tmpTexBuf32_. Alpha doesn't depend on pixel order, so we check the source, which is cached RAM.
+			fullAlphaMask = TfmtRawToFullAlpha(format);
+			CheckMask16((const u16 *)texptr, bufw * h, &alphaSum);
 			UnswizzleFromMem((u32 *)out, outPitch, texptr, bufw, h, 2);
-			if (reverseColors) {
-				ReverseColors(out, out, format, h * outPitch / 2, useBGRA);
-			}
-		}*/ else {
+		} else {
 			// We don't have enough space for all rows in out, so use a temp buffer.
 			tmpTexBuf32_.resize(bufw * ((h + 7) & ~7));
 			UnswizzleFromMem(tmpTexBuf32_.data(), bufw * 2, texptr, bufw, h, 2);
@@ -1934,13 +1940,12 @@ CheckAlphaResult TextureCacheCommon::DecodeTextureLevel(u8 *out, int outPitch, G
 					CopyAndSumMask32((u32 *)(out + outPitch * y), (const u32 *)(texptr + bufw * sizeof(u32) * y), w, &alphaSum);
 				}
 			}
-		} /* else if (h >= 8 && bufw <= w) {
-			// TODO: Handle alpha mask
+		} else if ((h & 7) == 0 && bufw == w && !reverseColors) {
+			// Same as the 16-bit case above.
+			fullAlphaMask = TfmtRawToFullAlpha(format);
+			CheckMask32((const u32 *)texptr, bufw * h, &alphaSum);
 			UnswizzleFromMem((u32 *)out, outPitch, texptr, bufw, h, 4);
-			if (reverseColors) {
-				ReverseColors(out, out, format, h * outPitch / 4, useBGRA);
-			}
-		}*/ else {
+		} else {
 			tmpTexBuf32_.resize(bufw * ((h + 7) & ~7));
 			UnswizzleFromMem(tmpTexBuf32_.data(), bufw * 4, texptr, bufw, h, 4);
 			const u8 *unswizzled = (u8 *)tmpTexBuf32_.data();
@@ -2114,7 +2119,8 @@ void TextureCacheCommon::ApplyTexture() {
 			// Update the hash on the texture.
 			int w = gstate.getTextureWidth(0);
 			int h = gstate.getTextureHeight(0);
-			entry->fullhash = QuickTexHash(replacer_, entry->addr, entry->bufw, w, h, GETextureFormat(entry->format), entry);
+			int changedY0, changedY1;
+			entry->fullhash = HashTexture(entry, w, h, &changedY0, &changedY1);
 
 			// TODO: Here we could check the secondary cache; maybe the texture is in there?
 			// We would need to abort the build if so.
@@ -2127,9 +2133,14 @@ void TextureCacheCommon::ApplyTexture() {
 	} else if (nextNeedsRehash_) {
 		// Okay, this matched and didn't change - but let's check the hash.  Maybe it will change.
 		bool doDelete = true;
-		if (!CheckFullHash(entry, doDelete)) {
-			HandleTextureChange(entry, "hash fail", true, doDelete);
-			nextNeedsRebuild_ = true;
+		int changedY0, changedY1;
+		if (!CheckFullHash(entry, doDelete, &changedY0, &changedY1)) {
+			if (doDelete && !nextTexture_ && TryUpdateTextureRows(entry, changedY0, changedY1)) {
+				// Only some rows changed, and they've been re-uploaded in place.
+			} else {
+				HandleTextureChange(entry, "hash fail", true, doDelete);
+				nextNeedsRebuild_ = true;
+			}
 		} else if (nextTexture_ != nullptr) {
 			// The secondary cache may choose an entry from its storage by setting nextTexture_.
 			// This means we should set that, instead of our previous entry.
@@ -2142,6 +2153,10 @@ void TextureCacheCommon::ApplyTexture() {
 	// Okay, now actually rebuild the texture if needed.
 	if (nextNeedsRebuild_) {
 		_assert_(!entry->texturePtr);
+		if (!nextNeedsRehash_) {
+			// The data may have changed since the band hashes were taken, so they no longer describe the texture.
+			entry->bandHashes.clear();
+		}
 		BuildTexture(entry);
 		ForgetLastTexture();
 	}
@@ -2149,13 +2164,13 @@ void TextureCacheCommon::ApplyTexture() {
 	if (entry->status & TexCacheEntry::STATUS_CLUT_GPU) {
 		// Special process.
 		ApplyTextureDepal(entry);
-		entry->lastFrame = gpuStats.numFlips;
+		TouchEntry(entry);
 		gstate_c.SetTextureFullAlpha(false);
 		gstate_c.SetTextureIs3D(false);
 		gstate_c.SetTextureIsArray(false);
 		gstate_c.SetTextureIsBGRA(false);
 	} else {
-		entry->lastFrame = gpuStats.numFlips;
+		TouchEntry(entry);
 		BindTexture(entry);
 		gstate_c.SetTextureFullAlpha(entry->GetAlphaStatus() == TexCacheEntry::STATUS_ALPHA_FULL);
 		gstate_c.SetTextureIs3D((entry->status & TexCacheEntry::STATUS_3D) != 0);
@@ -2497,20 +2512,21 @@ void TextureCacheCommon::Clear(bool delete_them) {
 	textureShaderCache_->Clear();
 
 	ForgetLastTexture();
-	for (TexCache::iterator iter = cache_.begin(); iter != cache_.end(); ++iter) {
-		ReleaseTexture(iter->second.get(), delete_them);
-	}
+	cache_.ForEach([&](TexCacheEntry *entry) {
+		ReleaseTexture(entry, delete_them);
+	});
 	// In case the setting was changed, we ALWAYS clear the secondary cache (enabled or not.)
-	for (TexCache::iterator iter = secondCache_.begin(); iter != secondCache_.end(); ++iter) {
-		ReleaseTexture(iter->second.get(), delete_them);
-	}
+	secondCache_.ForEach([&](TexCacheEntry *entry) {
+		ReleaseTexture(entry, delete_them);
+	});
 	if (cache_.size() + secondCache_.size()) {
 		INFO_LOG(G3D, "Texture cached cleared from %i textures", (int)(cache_.size() + secondCache_.size()));
-		cache_.clear();
-		secondCache_.clear();
+		cache_.Clear();
+		secondCache_.Clear();
 		cacheSizeEstimate_ = 0;
 		secondCacheSizeEstimate_ = 0;
 	}
+	asyncScales_.clear();
 	videos_.clear();
 
 	if (dynamicClutFbo_) {
@@ -2523,28 +2539,120 @@ void TextureCacheCommon::Clear(bool delete_them) {
 	}
 }
 
-void TextureCacheCommon::DeleteTexture(TexCache::iterator it) {
-	ReleaseTexture(it->second.get(), true);
-	cacheSizeEstimate_ -= EstimateTexMemoryUsage(it->second.get());
-	cache_.erase(it);
+void TextureCacheCommon::DeleteTexture(TexCacheEntry *entry) {
+	asyncScales_.erase(entry);
+	ReleaseTexture(entry, true);
+	cacheSizeEstimate_ -= EstimateTexMemoryUsage(entry);
+	cache_.Erase(entry);
+}
+
+void TextureCacheCommon::TouchEntry(TexCacheEntry *entry) {
+	if (entry->lastFrame == gpuStats.numFlips) {
+		return;
+	}
+	entry->lastFrame = gpuStats.numFlips;
+	// This might be an entry we're using straight out of the secondary cache.
+	if (cache_.Contains(entry)) {
+		cache_.Touch(entry);
+	} else if (secondCache_.Contains(entry)) {
+		secondCache_.Touch(entry);
+	}
+}
+
+void TexCache::Insert(u64 key, TexCacheEntry *entry) {
+	_dbg_assert_(!entries_.Get(key));
+	entry->key = key;
+	entries_.Insert(key, entry);
+	buckets_[KeyAddress(key) >> BUCKET_SHIFT].push_back(entry);
+	LinkBack(entry);
+}
+
+void TexCache::Erase(TexCacheEntry *entry) {
+	entries_.Remove(entry->key);
+	auto bucket = buckets_.find(KeyAddress(entry->key) >> BUCKET_SHIFT);
+	if (bucket != buckets_.end()) {
+		std::vector<TexCacheEntry *> &list = bucket->second;
+		for (size_t i = 0; i < list.size(); ++i) {
+			if (list[i] == entry) {
+				list[i] = list.back();
+				list.pop_back();
+				break;
+			}
+		}
+		if (list.empty()) {
+			buckets_.erase(bucket);
+		}
+	}
+	Unlink(entry);
+	delete entry;
+}
+
+void TexCache::Clear() {
+	TexCacheEntry *entry = lruHead_;
+	while (entry) {
+		TexCacheEntry *next = entry->lruNext;
+		delete entry;
+		entry = next;
+	}
+	lruHead_ = nullptr;
+	lruTail_ = nullptr;
+	entries_.Clear();
+	buckets_.clear();
 }
 
-bool TextureCacheCommon::CheckFullHash(TexCacheEntry *entry, bool &doDelete) {
+void TexCache::Touch(TexCacheEntry *entry) {
+	if (entry == lruTail_) {
+		return;
+	}
+	Unlink(entry);
+	LinkBack(entry);
+}
+
+void TexCache::LinkBack(TexCacheEntry *entry) {
+	entry->lruPrev = lruTail_;
+	entry->lruNext = nullptr;
+	if (lruTail_) {
+		lruTail_->lruNext = entry;
+	} else {
+		lruHead_ = entry;
+	}
+	lruTail_ = entry;
+}
+
+void TexCache::Unlink(TexCacheEntry *entry) {
+	if (entry->lruPrev) {
+		entry->lruPrev->lruNext = entry->lruNext;
+	} else {
+		lruHead_ = entry->lruNext;
+	}
+	if (entry->lruNext) {
+		entry->lruNext->lruPrev = entry->lruPrev;
+	} else {
+		lruTail_ = entry->lruPrev;
+	}
+	entry->lruPrev = nullptr;
+	entry->lruNext = nullptr;
+}
+
+bool TextureCacheCommon::CheckFullHash(TexCacheEntry *entry, bool &doDelete, int *changedY0, int *changedY1) {
 	int w = gstate.getTextureWidth(0);
 	int h = gstate.getTextureHeight(0);
 	bool isVideo = IsVideo(entry->addr);
+	*changedY0 = 0;
+	*changedY1 = h;
 
 	// Don't even check the texture, just assume it has changed.
 	if (isVideo && g_Config.bTextureBackoffCache) {
 		// Attempt to ensure the hash doesn't incorrectly match in if the video stops.
 		entry->fullhash = (entry->fullhash + 0xA535A535) * 11 + (entry->fullhash & 4);
+		entry->bandHashes.clear();
 		return false;
 	}
 
 	u32 fullhash;
 	{
 		PROFILE_THIS_SCOPE("texhash");
-		fullhash = QuickTexHash(replacer_, entry->addr, entry->bufw, w, h, GETextureFormat(entry->format), entry);
+		fullhash = HashTexture(entry, w, h, changedY0, changedY1);
 	}
 
 	if (fullhash == entry->fullhash) {
@@ -2571,10 +2679,9 @@ bool TextureCacheCommon::CheckFullHash(TexCacheEntry *entry, bool &doDelete) {
 		if (entry->numInvalidated > 2 && entry->numInvalidated < 128 && !lowMemoryMode_) {
 			// We have a new hash: look for that hash in the secondary cache.
 			u64 secondKey = fullhash | (u64)entry->cluthash << 32;
-			TexCache::iterator secondIter = secondCache_.find(secondKey);
-			if (secondIter != secondCache_.end()) {
+			TexCacheEntry *secondEntry = secondCache_.Get(secondKey);
+			if (secondEntry) {
 				// Found it, but does it match our current params?  If not, abort.
-				TexCacheEntry *secondEntry = secondIter->second.get();
 				if (secondEntry->Matches(entry->dim, entry->format, entry->maxLevel)) {
 					// Reset the numInvalidated value lower, we got a match.
 					if (entry->numInvalidated > 8) {
@@ -2592,14 +2699,20 @@ bool TextureCacheCommon::CheckFullHash(TexCacheEntry *entry, bool &doDelete) {
 				secondCacheSizeEstimate_ += EstimateTexMemoryUsage(entry);
 
 				// If the entry already exists in the secondary texture cache, drop it nicely.
-				auto oldIter = secondCache_.find(secondKey);
-				if (oldIter != secondCache_.end()) {
-					ReleaseTexture(oldIter->second.get(), true);
+				TexCacheEntry *oldEntry = secondCache_.Get(secondKey);
+				if (oldEntry) {
+					asyncScales_.erase(oldEntry);
+					ReleaseTexture(oldEntry, true);
+					secondCache_.Erase(oldEntry);
 				}
 
 				// Archive the entire texture entry as is, since we'll use its params if it is seen again.
 				// We keep parameters on the current entry, since we are STILL building a new texture here.
-				secondCache_[secondKey].reset(new TexCacheEntry(*entry));
+				TexCacheEntry *archived = new TexCacheEntry(*entry);
+				// The band hashes were just updated to the new data, which the archived texture doesn't have.
+				archived->bandHashes.clear();
+				archived->status &= ~TexCacheEntry::STATUS_BANDS_DIRTY;
+				secondCache_.Insert(secondKey, archived);
 
 				// Make sure we don't delete the texture we just archived.
 				entry->texturePtr = nullptr;
@@ -2613,6 +2726,130 @@ bool TextureCacheCommon::CheckFullHash(TexCacheEntry *entry, bool &doDelete) {
 	return false;
 }
 
+// Large textures are hashed in bands of rows, and the full hash is a hash of those. This lets us report which
+// rows changed since the last hash, and if the texture was reliable until a ranged invalidation, we only need to
+// rehash the bands that were written. Smaller textures just use QuickTexHash() and report the whole texture.
+u32 TextureCacheCommon::HashTexture(TexCacheEntry *entry, int w, int h, int *changedY0, int *changedY1) {
+	*changedY0 = 0;
+	*changedY1 = h;
+
+	const bool onlyDirty = (entry->status & TexCacheEntry::STATUS_BANDS_DIRTY) != 0;
+	const u64 dirtyBands = entry->dirtyBands;
+	entry->status &= ~TexCacheEntry::STATUS_BANDS_DIRTY;
+	entry->dirtyBands = 0;
+
+	const GETextureFormat format = GETextureFormat(entry->format);
+	int hashRows = h;
+	if (h == 512 && entry->maxSeenV < 512 && entry->maxSeenV != 0) {
+		hashRows = (int)entry->maxSeenV;
+	}
+	const u32 rowBytes = (textureBitsPerPixel[format] * entry->bufw) / 8;
+	const u32 sizeInRAM = rowBytes * hashRows;
+
+	if (replacer_.Enabled() || sizeInRAM < TEXCACHE_BAND_MIN_SIZE || !Memory::IsValidRange(entry->addr, sizeInRAM)) {
+		entry->bandHashes.clear();
+		return QuickTexHash(replacer_, entry->addr, entry->bufw, w, h, format, entry);
+	}
+
+	// Whole blocks of 8 rows, so that a band is contiguous in RAM even when swizzled.
+	const int bandRows = std::max(8, ((hashRows + TEXCACHE_MAX_BANDS - 1) / TEXCACHE_MAX_BANDS + 7) & ~7);
+	const int numBands = (hashRows + bandRows - 1) / bandRows;
+	const u32 bandBytes = rowBytes * bandRows;
+
+	const bool sameLayout = (int)entry->bandHashes.size() == numBands && entry->bandRows == bandRows && entry->hashedRows == hashRows && entry->bandBytes == bandBytes;
+	if (!sameLayout) {
+		entry->bandHashes.assign(numBands, 0);
+		entry->bandRows = bandRows;
+		entry->hashedRows = hashRows;
+		entry->bandBytes = bandBytes;
+	}
+
+	const u8 *data = Memory::GetPointerUnchecked(entry->addr);
+	int firstChanged = numBands;
+	int lastChanged = -1;
+	for (int i = 0; i < numBands; ++i) {
+		if (sameLayout && onlyDirty && (dirtyBands & (1ULL << i)) == 0) {
+			continue;
+		}
+		const u32 bytes = std::min(bandBytes, sizeInRAM - i * bandBytes);
+		const u32 hash = StableQuickTexHash(data + i * bandBytes, bytes);
+		gpuStats.numTextureDataBytesHashed += bytes;
+		if (!sameLayout || hash != entry->bandHashes[i]) {
+			entry->bandHashes[i] = hash;
+			firstChanged = std::min(firstChanged, i);
+			lastChanged = i;
+		}
+	}
+
+	if (sameLayout) {
+		if (lastChanged < 0) {
+			*changedY0 = 0;
+			*changedY1 = 0;
+		} else {
+			*changedY0 = firstChanged * bandRows;
+			*changedY1 = lastChanged == numBands - 1 ? h : (lastChanged + 1) * bandRows;
+		}
+	}
+
+	return XXH32(entry->bandHashes.data(), numBands * sizeof(u32), 0xBA4D);
+}
+
+void TextureCacheCommon::MarkBandsDirty(TexCacheEntry *entry, u32 start, u32 end) {
+	if (entry->bandHashes.empty()) {
+		return;
+	}
+	const u32 texStart = entry->addr;
+	const u32 texEnd = texStart + entry->bandBytes * (u32)entry->bandHashes.size();
+	start = std::max(start, texStart);
+	end = std::min(end, texEnd);
+	if (start >= end) {
+		return;
+	}
+	const u32 first = (start - texStart) / entry->bandBytes;
+	const u32 last = (end - 1 - texStart) / entry->bandBytes;
+	for (u32 i = first; i <= last; ++i) {
+		entry->dirtyBands |= 1ULL << i;
+	}
+}
+
+bool TextureCacheCommon::TryUpdateTextureRows(TexCacheEntry *entry, int y0, int y1) {
+	const int h = gstate.getTextureHeight(0);
+	// An empty range means the hash was forced to fail, and a full range is just a rebuild.
+	if (y1 <= y0 || (y0 == 0 && y1 >= h)) {
+		return false;
+	}
+	// Updating in place would also change draws earlier this frame, which a rebuild doesn't.
+	if (entry->lastFrame == gpuStats.numFlips) {
+		return false;
+	}
+	const u32 unsupported = TexCacheEntry::STATUS_IS_SCALED_OR_REPLACED | TexCacheEntry::STATUS_TO_SCALE | TexCacheEntry::STATUS_TO_REPLACE |
+		TexCacheEntry::STATUS_3D | TexCacheEntry::STATUS_CLUT_GPU | TexCacheEntry::STATUS_FRAMEBUFFER_OVERLAP;
+	if ((entry->status & unsupported) != 0 || entry->maxLevel != 0 || replacer_.Enabled()) {
+		return false;
+	}
+	if (!UpdateTextureRows(entry, y0, y1)) {
+		return false;
+	}
+
+	// Same bookkeeping as HandleTextureChange(), but we keep the texture.
+	entry->numInvalidated++;
+	gpuStats.numTextureInvalidations++;
+	gpuStats.numTexturesPartiallyUpdated++;
+	if (entry->GetHashStatus() == TexCacheEntry::STATUS_RELIABLE) {
+		entry->SetHashStatus(TexCacheEntry::STATUS_HASHING);
+	}
+	MarkOtherClutsForRecheck(entry);
+	if (entry->numFrames < TEXCACHE_FRAME_CHANGE_FREQUENT) {
+		if (entry->status & TexCacheEntry::STATUS_FREE_CHANGE) {
+			entry->status &= ~TexCacheEntry::STATUS_FREE_CHANGE;
+		} else {
+			entry->status |= TexCacheEntry::STATUS_CHANGE_FREQUENT;
+		}
+	}
+	entry->numFrames = 0;
+	return true;
+}
+
 void TextureCacheCommon::Invalidate(u32 addr, int size, GPUInvalidationType type) {
 	// They could invalidate inside the texture, let's just give a bit of leeway.
 	// TODO: Keep track of the largest texture size in bytes, and use that instead of this
@@ -2640,19 +2877,23 @@ void TextureCacheCommon::Invalidate(u32 addr, int size, GPUInvalidationType type
 		return;
 	}
 
-	const u64 startKey = (u64)(addr - LARGEST_TEXTURE_SIZE) << 32;
-	u64 endKey = (u64)(addr + size + LARGEST_TEXTURE_SIZE) << 32;
-	if (endKey < startKey) {
-		endKey = (u64)-1;
-	}
+	const u32 startAddr = addr >= LARGEST_TEXTURE_SIZE ? addr - LARGEST_TEXTURE_SIZE : 0;
+	const u32 endAddr = addr_end + LARGEST_TEXTURE_SIZE;
 
-	for (TexCache::iterator iter = cache_.lower_bound(startKey), end = cache_.upper_bound(endKey); iter != end; ++iter) {
-		auto &entry = iter->second;
+	cache_.ForEachInRange(startAddr, endAddr, [&](TexCacheEntry *entry) {
 		u32 texAddr = entry->addr;
 		u32 texEnd = entry->addr + entry->sizeInRAM;
 
 		// Quick check for overlap. Yes the check is right.
 		if (addr < texEnd && addr_end > texAddr) {
+			// A reliable texture only changes where we're told, so we only need to rehash the bands written to.
+			const bool ranged = type == GPU_INVALIDATE_HINT || type == GPU_INVALIDATE_SAFE;
+			if (ranged && !entry->bandHashes.empty() && (entry->GetHashStatus() == TexCacheEntry::STATUS_RELIABLE || (entry->status & TexCacheEntry::STATUS_BANDS_DIRTY))) {
+				entry->status |= TexCacheEntry::STATUS_BANDS_DIRTY;
+				MarkBandsDirty(entry, addr, addr_end);
+			} else {
+				entry->status &= ~TexCacheEntry::STATUS_BANDS_DIRTY;
+			}
 			if (entry->GetHashStatus() == TexCacheEntry::STATUS_RELIABLE) {
 				entry->SetHashStatus(TexCacheEntry::STATUS_HASHING);
 			}
@@ -2660,6 +2901,7 @@ void TextureCacheCommon::Invalidate(u32 addr, int size, GPUInvalidationType type
 				// Just random values to force the hash not to match.
 				entry->fullhash = (entry->fullhash ^ 0x12345678) + 13;
 				entry->minihash = (entry->minihash ^ 0x89ABCDEF) + 89;
+				entry->bandHashes.clear();
 			}
 			if (type != GPU_INVALIDATE_ALL) {
 				gpuStats.numTextureInvalidations++;
@@ -2677,7 +2919,7 @@ void TextureCacheCommon::Invalidate(u32 addr, int size, GPUInvalidationType type
 				entry->invalidHint++;
 			}
 		}
-	}
+	});
 }
 
 void TextureCacheCommon::InvalidateAll(GPUInvalidationType /*unused*/) {
@@ -2691,12 +2933,13 @@ void TextureCacheCommon::InvalidateAll(GPUInvalidationType /*unused*/) {
 	}
 	timesInvalidatedAllThisFrame_++;
 
-	for (TexCache::iterator iter = cache_.begin(), end = cache_.end(); iter != end; ++iter) {
-		if (iter->second->GetHashStatus() == TexCacheEntry::STATUS_RELIABLE) {
-			iter->second->SetHashStatus(TexCacheEntry::STATUS_HASHING);
+	cache_.ForEach([](TexCacheEntry *entry) {
+		if (entry->GetHashStatus() == TexCacheEntry::STATUS_RELIABLE) {
+			entry->SetHashStatus(TexCacheEntry::STATUS_HASHING);
 		}
-		iter->second->invalidHint++;
-	}
+		entry->status &= ~TexCacheEntry::STATUS_BANDS_DIRTY;
+		entry->invalidHint++;
+	});
 }
 
 void TextureCacheCommon::ClearNextFrame() {
@@ -2813,13 +3056,44 @@ bool TextureCacheCommon::PrepareBuildTexture(BuildTexturePlan &plan, TexCacheEnt
 		plan.scaleFactor = 1;
 	}
 
+	plan.isVideo = IsVideo(entry->addr);
+
 	if ((entry->status & TexCacheEntry::STATUS_CHANGE_FREQUENT) != 0 && plan.scaleFactor != 1 && plan.slowScaler) {
 		// Remember for later that we /wanted/ to scale this texture.
 		entry->status |= TexCacheEntry::STATUS_TO_SCALE;
 		plan.scaleFactor = 1;
 	}
 
-	if (plan.scaleFactor != 1) {
+	entry->status &= ~TexCacheEntry::STATUS_SCALE_ASYNC;
+	if (plan.scaleFactor != 1 && CanScaleAsync(plan, entry)) {
+		auto it = asyncScales_.find(entry);
+		if (it != asyncScales_.end() && it->second->done) {
+			const AsyncTextureScale &scale = *it->second;
+			// Make sure it's still the same texture, and the setting didn't change.
+			if (scale.factor == plan.scaleFactor && scale.fullhash == entry->fullhash && scale.cluthash == entry->cluthash && scale.dim == entry->dim && scale.format == entry->format) {
+				plan.asyncScaled = it->second;
+			}
+			asyncScales_.erase(it);
+			it = asyncScales_.end();
+		}
+
+		if (plan.asyncScaled) {
+			entry->status &= ~TexCacheEntry::STATUS_TO_SCALE;
+			entry->status |= TexCacheEntry::STATUS_IS_SCALED_OR_REPLACED;
+		} else {
+			// Use it unscaled until a worker thread has scaled it.
+			if (it == asyncScales_.end() && asyncScales_.size() < TEXCACHE_MAX_ASYNC_SCALES) {
+				plan.queueScaleFactor = plan.scaleFactor;
+			}
+			entry->status |= TexCacheEntry::STATUS_TO_SCALE | TexCacheEntry::STATUS_SCALE_ASYNC;
+			plan.scaleFactor = 1;
+		}
+	} else {
+		// Not scaling this on a worker (anymore), so free up its slot.
+		asyncScales_.erase(entry);
+	}
+
+	if (plan.scaleFactor != 1 && !plan.asyncScaled) {
 		if (texelsScaledThisFrame_ >= TEXCACHE_MAX_TEXELS_SCALED && plan.slowScaler) {
 			entry->status |= TexCacheEntry::STATUS_TO_SCALE;
 			plan.scaleFactor = 1;
@@ -2830,8 +3104,6 @@ bool TextureCacheCommon::PrepareBuildTexture(BuildTexturePlan &plan, TexCacheEnt
 		}
 	}
 
-	plan.isVideo = IsVideo(entry->addr);
-
 	// TODO: Support reading actual mip levels for upscaled images, instead of just generating them.
 	// Maybe can just remove this check?
 	if (plan.scaleFactor > 1) {
@@ -2876,6 +3148,8 @@ bool TextureCacheCommon::PrepareBuildTexture(BuildTexturePlan &plan, TexCacheEnt
 	if (plan.doReplace) {
 		// We're replacing, so we won't scale.
 		plan.scaleFactor = 1;
+		plan.asyncScaled.reset();
+		plan.queueScaleFactor = 0;
 		// We're ignoring how many levels were specified - instead we just load all available from the replacer.
 		plan.levelsToLoad = plan.replaced->NumLevels();
 		plan.levelsToCreate = plan.levelsToLoad;  // Or more, if we wanted to generate.
@@ -2938,7 +3212,13 @@ void TextureCacheCommon::LoadTextureLevel(TexCacheEntry &entry, uint8_t *data, s
 		double replaceStart = time_now_d();
 		plan.replaced->CopyLevelTo(srcLevel, data, dataSize, stride);
 		replacementTimeThisFrame_ += time_now_d() - replaceStart;
+	} else if (CopyAsyncScaled(entry, plan, data, stride)) {
+		// Already scaled on a worker thread, nothing more to do.
 	} else {
+		if (plan.queueScaleFactor != 0 && srcLevel == 0) {
+			QueueAsyncScale(entry, plan, texDecFlags);
+		}
+
 		GETextureFormat tfmt = (GETextureFormat)entry.format;
 		GEPaletteFormat clutformat = gstate.getClutPaletteFormat();
 		u32 texaddr = gstate.getTextureAddress(srcLevel);
@@ -2999,6 +3279,99 @@ void TextureCacheCommon::LoadTextureLevel(TexCacheEntry &entry, uint8_t *data, s
 	}
 }
 
+// Scales a texture on the thread pool, see QueueAsyncScale().
+class TextureScaleTask : public Task {
+public:
+	TextureScaleTask(std::shared_ptr<AsyncTextureScale> scale) : scale_(scale) {}
+
+	// The scaler spreads its work over the compute threads with ParallelRangeLoop,
+	// so we shouldn't occupy one of those while waiting for it.
+	TaskType Type() const override { return TaskType::IO_BLOCKING; }
+
+	TaskPriority Priority() const override {
+		return TaskPriority::LOW;
+	}
+
+	void Run() override {
+		AsyncTextureScale &scale = *scale_;
+		// Can't share the texture cache's scaler, it has scratch buffers.
+		TextureScalerCommon scaler;
+		std::vector<u32> scaled((size_t)scale.w * scale.factor * scale.h * scale.factor);
+		scaler.ScaleAlways(scaled.data(), scale.pixels.data(), scale.w, scale.h, &scale.scaledW, &scale.scaledH, scale.factor);
+		scale.pixels = std::move(scaled);
+		scale.done = true;
+	}
+
+private:
+	std::shared_ptr<AsyncTextureScale> scale_;
+};
+
+// Render targets can overwrite textures behind our back and those get a cheap unscaled rebuild
+// anyway, so they stay synchronous. Same for anything not using the regular level 0 decode.
+bool TextureCacheCommon::CanScaleAsync(const BuildTexturePlan &plan, const TexCacheEntry *entry) {
+	if (!g_Config.bTexScalingAsync || !plan.slowScaler || plan.hardwareScaling || g_Config.bSaveNewTextures) {
+		return false;
+	}
+	if (plan.isVideo || plan.depth != 1 || IsFakeMipmapChange()) {
+		return false;
+	}
+	return (entry->status & (TexCacheEntry::STATUS_FRAMEBUFFER_OVERLAP | TexCacheEntry::STATUS_CLUT_GPU)) == 0;
+}
+
+void TextureCacheCommon::QueueAsyncScale(const TexCacheEntry &entry, const BuildTexturePlan &plan, TexDecodeFlags texDecFlags) {
+	if (asyncScales_.find(&entry) != asyncScales_.end()) {
+		return;
+	}
+
+	std::shared_ptr<AsyncTextureScale> scale = std::make_shared<AsyncTextureScale>();
+	scale->fullhash = entry.fullhash;
+	scale->cluthash = entry.cluthash;
+	scale->dim = entry.dim;
+	scale->format = entry.format;
+	scale->w = gstate.getTextureWidth(0);
+	scale->h = gstate.getTextureHeight(0);
+	scale->factor = plan.queueScaleFactor;
+
+	// Decode here, since the texture and CLUT in memory may change before the task gets to run.
+	GETextureFormat tfmt = (GETextureFormat)entry.format;
+	u32 texaddr = gstate.getTextureAddress(0);
+	int bufw = GetTextureBufw(0, texaddr, tfmt);
+	scale->pixels.resize(std::max(bufw, scale->w) * scale->h);
+	texDecFlags |= TexDecodeFlags::EXPAND32;
+	scale->alphaResult = DecodeTextureLevel((u8 *)scale->pixels.data(), scale->w * sizeof(u32), tfmt, gstate.getClutPaletteFormat(), texaddr, 0, bufw, texDecFlags);
+
+	asyncScales_[&entry] = scale;
+	g_threadManager.EnqueueTask(new TextureScaleTask(scale));
+}
+
+bool TextureCacheCommon::CopyAsyncScaled(TexCacheEntry &entry, const BuildTexturePlan &plan, uint8_t *data, int stride) {
+	if (!plan.asyncScaled) {
+		return false;
+	}
+
+	const AsyncTextureScale &scale = *plan.asyncScaled;
+	const int rowBytes = scale.scaledW * sizeof(u32);
+	const u8 *src = (const u8 *)scale.pixels.data();
+	for (int y = 0; y < scale.scaledH; ++y) {
+		memcpy(data + stride * y, src + rowBytes * y, rowBytes);
+	}
+	entry.SetAlphaStatus(scale.alphaResult, 0);
+	return true;
+}
+
+// Whether an entry waiting for scaling (STATUS_TO_SCALE) should be rebuilt now.
+bool TextureCacheCommon::ReadyToScale(const TexCacheEntry *entry) {
+	auto it = asyncScales_.find(entry);
+	if (it != asyncScales_.end()) {
+		return it->second->done;
+	}
+	if ((entry->status & TexCacheEntry::STATUS_SCALE_ASYNC) && asyncScales_.size() >= TEXCACHE_MAX_ASYNC_SCALES) {
+		// No point rebuilding unscaled again, wait for a slot.
+		return false;
+	}
+	return texelsScaledThisFrame_ < TEXCACHE_MAX_TEXELS_SCALED;
+}
+
 CheckAlphaResult TextureCacheCommon::CheckCLUTAlpha(const uint8_t *pixelData, GEPaletteFormat clutFormat, int w) {
 	switch (clutFormat) {
 	case GE_CMODE_16BIT_ABGR4444:
@@ -17,11 +17,14 @@
 
 #pragma once
 
+#include <atomic>
 #include <map>
+#include <unordered_map>
 #include <vector>
 #include <memory>
 
 #include "Common/CommonTypes.h"
+#include "Common/Data/Collections/Hashmaps.h"
 #include "Common/MemoryUtil.h"
 #include "Core/System.h"
 #include "GPU/GPU.h"
@@ -45,6 +48,13 @@ enum FramebufferNotification {
 #define TEXCACHE_FRAME_CHANGE_FREQUENT_REGAIN_TRUST 33
 
 #define TEXCACHE_MAX_TEXELS_SCALED (256*256)  // Per frame
+// Max number of textures being scaled on worker threads at once.
+#define TEXCACHE_MAX_ASYNC_SCALES 8
+
+// Textures at least this large (in RAM) are hashed in bands of rows, see HashTexture().
+#define TEXCACHE_BAND_MIN_SIZE (64 * 1024)
+// Must fit in TexCacheEntry::dirtyBands.
+#define TEXCACHE_MAX_BANDS 64
 
 struct VirtualFramebuffer;
 class TextureReplacer;
@@ -158,6 +168,12 @@ struct TexCacheEntry {
 
 		STATUS_VIDEO = 0x10000,
 		STATUS_BGRA = 0x20000,
+
+		// Was reliable before a ranged invalidation, so only dirtyBands need rehashing.
+		STATUS_BANDS_DIRTY = 0x40000,
+
+		// STATUS_TO_SCALE is waiting for a worker thread, rather than the per-frame scaling budget.
+		STATUS_SCALE_ASYNC = 0x80000,
 	};
 
 	// TexStatus enum flag combination.
@@ -188,6 +204,19 @@ struct TexCacheEntry {
 	u16 maxSeenV;
 	ReplacedTexture *replacedTexture;
 
+	// Large textures keep a hash per band of rows, so we can tell which rows changed and
+	// only rehash the parts that ranged invalidations touched. Empty if not tracked.
+	std::vector<u32> bandHashes;
+	u64 dirtyBands;
+	u16 bandRows;
+	u16 hashedRows;
+	u32 bandBytes;
+
+	// Maintained by TexCache. Note that in the secondary cache, key is not the same as CacheKey().
+	u64 key;
+	TexCacheEntry *lruPrev;
+	TexCacheEntry *lruNext;
+
 	TexStatus GetHashStatus() {
 		return TexStatus(status & STATUS_MASK);
 	}
@@ -219,9 +248,99 @@ struct TexCacheEntry {
 	static u64 CacheKey(u32 addr, u8 format, u16 dim, u32 cluthash);
 };
 
-// Can't be unordered_map, we use lower_bound ... although for some reason that (used to?) compiles on MSVC.
-// Would really like to replace this with DenseHashMap but can't as long as we need lower_bound.
-typedef std::map<u64, std::unique_ptr<TexCacheEntry>> TexCache;
+// Owns a set of TexCacheEntries. Lookups by key are hashed. Since the upper 32 bits of a CacheKey() are
+// the texture address, entries are also bucketed by that address so invalidation can look at a range
+// without walking the whole cache. Entries are also kept in least recently used order (see Touch()),
+// so decimation only needs to look at the cold end of the list.
+class TexCache {
+public:
+	TexCache() : entries_(512) {}
+	~TexCache() {
+		Clear();
+	}
+
+	TexCacheEntry *Get(u64 key) {
+		return entries_.Get(key);
+	}
+	bool Contains(TexCacheEntry *entry) {
+		return entries_.Get(entry->key) == entry;
+	}
+	// Takes ownership of the entry. The key must not already be in use.
+	void Insert(u64 key, TexCacheEntry *entry);
+	// Deletes the entry.
+	void Erase(TexCacheEntry *entry);
+	void Clear();
+	// Marks the entry as the most recently used.
+	void Touch(TexCacheEntry *entry);
+	// Call once in a while to clean up after removals.
+	void Maintain() {
+		entries_.Maintain();
+	}
+
+	TexCacheEntry *LeastRecentlyUsed() const {
+		return lruHead_;
+	}
+	size_t size() const {
+		return entries_.size();
+	}
+
+	// Calls func on every entry whose key address (upper 32 bits) is within [start, end).
+	// func must not add or remove entries.
+	template <typename F>
+	void ForEachInRange(u32 start, u32 end, F func) const {
+		if (start >= end)
+			return;
+		u32 firstBucket = start >> BUCKET_SHIFT;
+		u32 lastBucket = (end - 1) >> BUCKET_SHIFT;
+		if (lastBucket - firstBucket >= buckets_.size()) {
+			// Large range, cheaper to just look at the buckets that exist.
+			for (auto &bucket : buckets_) {
+				if (bucket.first >= firstBucket && bucket.first <= lastBucket)
+					ForEachInBucket(bucket.second, start, end, func);
+			}
+			return;
+		}
+		for (u32 b = firstBucket; b <= lastBucket; ++b) {
+			auto bucket = buckets_.find(b);
+			if (bucket != buckets_.end())
+				ForEachInBucket(bucket->second, start, end, func);
+		}
+	}
+	template <typename F>
+	void ForEachAtAddress(u32 addr, F func) const {
+		ForEachInRange(addr, addr + 1, func);
+	}
+	// Iterates from least to most recently used. func must not add or remove entries.
+	template <typename F>
+	void ForEach(F func) const {
+		for (TexCacheEntry *entry = lruHead_; entry; entry = entry->lruNext)
+			func(entry);
+	}
+
+private:
+	// 64KB granularity, so a bucket rarely holds more than a handful of textures.
+	enum { BUCKET_SHIFT = 16 };
+
+	static u32 KeyAddress(u64 key) {
+		return (u32)(key >> 32);
+	}
+	template <typename F>
+	static void ForEachInBucket(const std::vector<TexCacheEntry *> &bucket, u32 start, u32 end, F &func) {
+		for (TexCacheEntry *entry : bucket) {
+			u32 addr = KeyAddress(entry->key);
+			if (addr >= start && addr < end)
+				func(entry);
+		}
+	}
+
+	void LinkBack(TexCacheEntry *entry);
+	void Unlink(TexCacheEntry *entry);
+
+	DenseHashMap<u64, TexCacheEntry *, nullptr> entries_;
+	std::unordered_map<u32, std::vector<TexCacheEntry *>> buckets_;
+	TexCacheEntry *lruHead_ = nullptr;
+	TexCacheEntry *lruTail_ = nullptr;
+};
 
 // Urgh.
 #ifdef IGNORE
@@ -246,6 +365,26 @@ struct AttachCandidate {
 
 class FramebufferManagerCommon;
 
+// A texture upscaled on a worker thread while we keep drawing with the unscaled version.
+// Shared between the cache and the task, so it doesn't matter which lets go first.
+struct AsyncTextureScale {
+	// Identifies the texture contents it was decoded from.
+	u32 fullhash;
+	u32 cluthash;
+	u16 dim;
+	u8 format;
+
+	int w;
+	int h;
+	int factor;
+	int scaledW = 0;
+	int scaledH = 0;
+	CheckAlphaResult alphaResult;
+	// Decoded (always 32-bit) input, replaced by the scaled output when done.
+	std::vector<u32> pixels;
+	std::atomic<bool> done{};
+};
+
 struct BuildTexturePlan {
 	// Inputs
 	bool hardwareScaling = false;
@@ -299,6 +438,12 @@ struct BuildTexturePlan {
 	// TODO: Expand32 should probably also be decided in PrepareBuildTexture.
 	bool decodeToClut8;
 
+	// Level 0 was already scaled on a worker thread, just copy it in (see CopyAsyncScaled.)
+	std::shared_ptr<AsyncTextureScale> asyncScaled;
+	// If non-zero, we're building unscaled for now and the backend should call QueueAsyncScale
+	// with its decode flags to get it scaled by this factor later.
+	int queueScaleFactor = 0;
+
 	void GetMipSize(int level, int *w, int *h) const {
 		if (doReplace) {
 			replaced->GetSize(level, w, h);
@@ -373,16 +518,23 @@ class TextureCacheCommon {
 	virtual void BindTexture(TexCacheEntry *entry) = 0;
 	virtual void Unbind() = 0;
 	virtual void ReleaseTexture(TexCacheEntry *entry, bool delete_them) = 0;
-	void DeleteTexture(TexCache::iterator it);
+	void DeleteTexture(TexCacheEntry *entry);
+	void TouchEntry(TexCacheEntry *entry);
 	void Decimate(bool forcePressure = false);
 
 	void ApplyTextureFramebuffer(VirtualFramebuffer *framebuffer, GETextureFormat texFormat, RasterChannel channel);
 	void ApplyTextureDepal(TexCacheEntry *entry);
 
 	void HandleTextureChange(TexCacheEntry *const entry, const char *reason, bool initialMatch, bool doDelete);
+	void MarkOtherClutsForRecheck(const TexCacheEntry *entry);
 	virtual void BuildTexture(TexCacheEntry *const entry) = 0;
 	virtual void UpdateCurrentClut(GEPaletteFormat clutFormat, u32 clutBase, bool clutIndexIsSimple) = 0;
-	bool CheckFullHash(TexCacheEntry *entry, bool &doDelete);
+	bool CheckFullHash(TexCacheEntry *entry, bool &doDelete, int *changedY0, int *changedY1);
+	u32 HashTexture(TexCacheEntry *entry, int w, int h, int *changedY0, int *changedY1);
+	void MarkBandsDirty(TexCacheEntry *entry, u32 start, u32 end);
+	bool TryUpdateTextureRows(TexCacheEntry *entry, int y0, int y1);
+	// Re-uploads rows [y0, y1) of level 0 in place. Returns false if the backend can't, and the texture is rebuilt instead.
+	virtual bool UpdateTextureRows(TexCacheEntry *entry, int y0, int y1) { return false; }
 
 	virtual void BindAsClutTexture(Draw::Texture *tex, bool smooth) {}
 
@@ -395,6 +547,11 @@ class TextureCacheCommon {
 	// Return value is mapData normally, but could be another buffer allocated with AllocateAlignedMemory.
 	void LoadTextureLevel(TexCacheEntry &entry, uint8_t *mapData, size_t dataSize, int mapRowPitch, BuildTexturePlan &plan, int srcLevel, Draw::DataFormat dstFmt, TexDecodeFlags texDecFlags);
 
+	bool CanScaleAsync(const BuildTexturePlan &plan, const TexCacheEntry *entry);
+	void QueueAsyncScale(const TexCacheEntry &entry, const BuildTexturePlan &plan, TexDecodeFlags texDecFlags);
+	bool CopyAsyncScaled(TexCacheEntry &entry, const BuildTexturePlan &plan, uint8_t *data, int stride);
+	bool ReadyToScale(const TexCacheEntry *entry);
+
 	template <typename T>
 	inline const T *GetCurrentClut() {
 		return (const T *)clutBuf_;
@@ -475,6 +632,8 @@ class TextureCacheCommon {
 	TexCache secondCache_;
 	u32 secondCacheSizeEstimate_ = 0;
 
+	std::unordered_map<const TexCacheEntry *, std::shared_ptr<AsyncTextureScale>> asyncScales_;
+
 	struct VideoInfo {
 		u32 addr;
 		u32 size;
@@ -482,7 +641,7 @@ class TextureCacheCommon {
 	};
 	std::vector<VideoInfo> videos_;
 
-	AlignedVector<u32, 16> tmpTexBuf32_;
+	AlignedVector<u32, 32> tmpTexBuf32_;
 	AlignedVector<u32, 16> tmpTexBufRearrange_;
 
 	TexCacheEntry *nextTexture_ = nullptr;
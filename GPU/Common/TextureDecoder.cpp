@@ -31,6 +31,7 @@
 #ifdef _M_SSE
 #include <emmintrin.h>
 #include <smmintrin.h>
+#include <immintrin.h>
 #endif
 
 #if PPSSPP_ARCH(ARM_NEON)
@@ -352,11 +353,51 @@ void DoSwizzleTex16(const u32 *ysrcp, u8 *texptr, int bxc, int byc, u32 pitch) {
 	}
 }
 
+#if defined(_M_SSE)
+#if defined(__GNUC__) || defined(__clang__) || defined(__INTEL_COMPILER)
+[[gnu::target("avx2")]]
+#endif
+static void DoUnswizzleTex16AVX2(const u8 *texptr, u32 *ydestp, int bxc, int byc, u32 pitch) {
+	// Two neighbouring blocks make up 32 contiguous bytes of each destination row.
+	const __m128i *src = (const __m128i *)texptr;
+	for (int by = 0; by < byc; by++) {
+		u8 *xdest = (u8 *)ydestp;
+		int bx = 0;
+		for (; bx + 1 < bxc; bx += 2) {
+			u8 *dest = xdest;
+			for (int n = 0; n < 8; n++) {
+				__m256i row = _mm256_castsi128_si256(_mm_load_si128(src + n));
+				row = _mm256_inserti128_si256(row, _mm_load_si128(src + 8 + n), 1);
+				_mm256_store_si256((__m256i *)dest, row);
+				dest += pitch;
+			}
+			src += 16;
+			xdest += 32;
+		}
+		if (bx < bxc) {
+			u8 *dest = xdest;
+			for (int n = 0; n < 8; n++) {
+				_mm_store_si128((__m128i *)dest, _mm_load_si128(src + n));
+				dest += pitch;
+			}
+			src += 8;
+		}
+		ydestp += (pitch >> 2) * 8;
+	}
+}
+#endif
+
 void DoUnswizzleTex16(const u8 *texptr, u32 *ydestp, int bxc, int byc, u32 pitch) {
 	// ydestp is in 32-bits, so this is convenient.
 	const u32 pitchBy32 = pitch >> 2;
 
 #ifdef _M_SSE
+	// Unaligned 32-byte stores are slower than the SSE2 path below, so only take this when we can align them.
+	if (cpu_info.bAVX2 && bxc >= 2 && ((uintptr_t)ydestp & 0x1F) == 0 && (pitch & 0x1F) == 0) {
+		DoUnswizzleTex16AVX2(texptr, ydestp, bxc, byc, pitch);
+		return;
+	}
+
 	// This check is pretty much a given, right?
 	if (((uintptr_t)ydestp & 0xF) == 0 && (pitch & 0xF) == 0) {
 		const __m128i *src = (const __m128i *)texptr;
@@ -435,6 +476,372 @@ void DoUnswizzleTex16(const u8 *texptr, u32 *ydestp, int bxc, int byc, u32 pitch
 	}
 }
 
+// CLUT lookups. The 4-bit ones keep the 16 entries in registers as byte planes and look up with a byte shuffle,
+// the 8-bit ones use gathers. In all of them, the low nibble (or first byte) is the first pixel.
+
+#if defined(_M_SSE)
+// Splits 16 bytes of packed 4-bit indices into 32 byte-sized indices, in pixel order.
+static inline void SplitNibbles(__m128i packed, __m128i *idx0, __m128i *idx1) {
+	const __m128i nibbleMask = _mm_set1_epi8(0x0F);
+	__m128i lo = _mm_and_si128(packed, nibbleMask);
+	__m128i hi = _mm_and_si128(_mm_srli_epi16(packed, 4), nibbleMask);
+	*idx0 = _mm_unpacklo_epi8(lo, hi);
+	*idx1 = _mm_unpackhi_epi8(lo, hi);
+}
+
+#if defined(__GNUC__) || defined(__clang__) || defined(__INTEL_COMPILER)
+[[gnu::target("ssse3")]]
+#endif
+static inline void ClutPlanes16(const u16 *clut, __m128i *tableLo, __m128i *tableHi) {
+	const __m128i byteSplit = _mm_setr_epi8(0, 2, 4, 6, 8, 10, 12, 14, 1, 3, 5, 7, 9, 11, 13, 15);
+	__m128i s0 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)clut), byteSplit);
+	__m128i s1 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(clut + 8)), byteSplit);
+	*tableLo = _mm_unpacklo_epi64(s0, s1);
+	*tableHi = _mm_unpackhi_epi64(s0, s1);
+}
+
+#if defined(__GNUC__) || defined(__clang__) || defined(__INTEL_COMPILER)
+[[gnu::target("ssse3")]]
+#endif
+static inline void ClutPlanes32(const u32 *clut, __m128i planes[4]) {
+	const __m128i byteSplit = _mm_setr_epi8(0, 4, 8, 12, 1, 5, 9, 13, 2, 6, 10, 14, 3, 7, 11, 15);
+	__m128i s[4];
+	for (int i = 0; i < 4; ++i) {
+		s[i] = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(clut + i * 4)), byteSplit);
+	}
+	__m128i t0 = _mm_unpacklo_epi32(s[0], s[1]);
+	__m128i t1 = _mm_unpacklo_epi32(s[2], s[3]);
+	__m128i t2 = _mm_unpackhi_epi32(s[0], s[1]);
+	__m128i t3 = _mm_unpackhi_epi32(s[2], s[3]);
+	planes[0] = _mm_unpacklo_epi64(t0, t1);
+	planes[1] = _mm_unpackhi_epi64(t0, t1);
+	planes[2] = _mm_unpacklo_epi64(t2, t3);
+	planes[3] = _mm_unpackhi_epi64(t2, t3);
+}
+
+static inline u32 ReduceAnd16(__m128i v) {
+	v = _mm_and_si128(v, _mm_srli_si128(v, 8));
+	v = _mm_and_si128(v, _mm_srli_si128(v, 4));
+	v = _mm_and_si128(v, _mm_srli_si128(v, 2));
+	return (u32)_mm_cvtsi128_si32(v) & 0xFFFF;
+}
+
+static inline u32 ReduceAnd32(__m128i v) {
+	v = _mm_and_si128(v, _mm_srli_si128(v, 8));
+	v = _mm_and_si128(v, _mm_srli_si128(v, 4));
+	return (u32)_mm_cvtsi128_si32(v);
+}
+
+#if defined(__GNUC__) || defined(__clang__) || defined(__INTEL_COMPILER)
+[[gnu::target("ssse3")]]
+#endif
+static int DeIndexTexture4SSSE3(u16 *dest, const u8 *indexed, int length, const u16 *clut, u32 *outAlphaSum) {
+	__m128i tableLo, tableHi;
+	ClutPlanes16(clut, &tableLo, &tableHi);
+
+	__m128i alpha = _mm_set1_epi32(-1);
+	int done = 0;
+	for (; done + 32 <= length; done += 32) {
+		__m128i idx[2];
+		SplitNibbles(_mm_loadu_si128((const __m128i *)(indexed + done / 2)), &idx[0], &idx[1]);
+		for (int i = 0; i < 2; ++i) {
+			__m128i lo = _mm_shuffle_epi8(tableLo, idx[i]);
+			__m128i hi = _mm_shuffle_epi8(tableHi, idx[i]);
+			__m128i c0 = _mm_unpacklo_epi8(lo, hi);
+			__m128i c1 = _mm_unpackhi_epi8(lo, hi);
+			_mm_storeu_si128((__m128i *)(dest + done + i * 16), c0);
+			_mm_storeu_si128((__m128i *)(dest + done + i * 16 + 8), c1);
+			alpha = _mm_and_si128(alpha, _mm_and_si128(c0, c1));
+		}
+	}
+
+	*outAlphaSum &= ReduceAnd16(alpha);
+	return done;
+}
+
+#if defined(__GNUC__) || defined(__clang__) || defined(__INTEL_COMPILER)
+[[gnu::target("ssse3")]]
+#endif
+static int DeIndexTexture4SSSE3(u32 *dest, const u8 *indexed, int length, const u32 *clut, u32 *outAlphaSum) {
+	__m128i planes[4];
+	ClutPlanes32(clut, planes);
+
+	__m128i alpha = _mm_set1_epi32(-1);
+	int done = 0;
+	for (; done + 32 <= length; done += 32) {
+		__m128i idx[2];
+		SplitNibbles(_mm_loadu_si128((const __m128i *)(indexed + done / 2)), &idx[0], &idx[1]);
+		for (int i = 0; i < 2; ++i) {
+			__m128i b0 = _mm_shuffle_epi8(planes[0], idx[i]);
+			__m128i b1 = _mm_shuffle_epi8(planes[1], idx[i]);
+			__m128i b2 = _mm_shuffle_epi8(planes[2], idx[i]);
+			__m128i b3 = _mm_shuffle_epi8(planes[3], idx[i]);
+			__m128i b01lo = _mm_unpacklo_epi8(b0, b1);
+			__m128i b01hi = _mm_unpackhi_epi8(b0, b1);
+			__m128i b23lo = _mm_unpacklo_epi8(b2, b3);
+			__m128i b23hi = _mm_unpackhi_epi8(b2, b3);
+			__m128i c0 = _mm_unpacklo_epi16(b01lo, b23lo);
+			__m128i c1 = _mm_unpackhi_epi16(b01lo, b23lo);
+			__m128i c2 = _mm_unpacklo_epi16(b01hi, b23hi);
+			__m128i c3 = _mm_unpackhi_epi16(b01hi, b23hi);
+			u32 *d = dest + done + i * 16;
+			_mm_storeu_si128((__m128i *)(d + 0), c0);
+			_mm_storeu_si128((__m128i *)(d + 4), c1);
+			_mm_storeu_si128((__m128i *)(d + 8), c2);
+			_mm_storeu_si128((__m128i *)(d + 12), c3);
+			alpha = _mm_and_si128(alpha, _mm_and_si128(_mm_and_si128(c0, c1), _mm_and_si128(c2, c3)));
+		}
+	}
+
+	*outAlphaSum &= ReduceAnd32(alpha);
+	return done;
+}
+
+// The AVX2 versions do 32 pixels at a time, pixels 0-15 in the low lane and 16-31 in the high lane.
+// The in-lane unpacks then need a cross-lane permute before storing.
+
+#if defined(__GNUC__) || defined(__clang__) || defined(__INTEL_COMPILER)
+[[gnu::target("avx2")]]
+#endif
+static inline __m256i LoadNibbleIndices(const u8 *indexed) {
+	__m128i idx0, idx1;
+	SplitNibbles(_mm_loadu_si128((const __m128i *)indexed), &idx0, &idx1);
+	return _mm256_inserti128_si256(_mm256_castsi128_si256(idx0), idx1, 1);
+}
+
+#if defined(__GNUC__) || defined(__clang__) || defined(__INTEL_COMPILER)
+[[gnu::target("avx2")]]
+#endif
+static int DeIndexTexture4AVX2(u16 *dest, const u8 *indexed, int length, const u16 *clut, u32 *outAlphaSum) {
+	__m128i tableLo128, tableHi128;
+	ClutPlanes16(clut, &tableLo128, &tableHi128);
+	const __m256i tableLo = _mm256_broadcastsi128_si256(tableLo128);
+	const __m256i tableHi = _mm256_broadcastsi128_si256(tableHi128);
+
+	__m256i alpha = _mm256_set1_epi32(-1);
+	int done = 0;
+	for (; done + 32 <= length; done += 32) {
+		__m256i idx = LoadNibbleIndices(indexed + done / 2);
+		__m256i lo = _mm256_shuffle_epi8(tableLo, idx);
+		__m256i hi = _mm256_shuffle_epi8(tableHi, idx);
+		__m256i c0 = _mm256_unpacklo_epi8(lo, hi);
+		__m256i c1 = _mm256_unpackhi_epi8(lo, hi);
+		_mm256_storeu_si256((__m256i *)(dest + done), _mm256_permute2x128_si256(c0, c1, 0x20));
+		_mm256_storeu_si256((__m256i *)(dest + done + 16), _mm256_permute2x128_si256(c0, c1, 0x31));
+		alpha = _mm256_and_si256(alpha, _mm256_and_si256(c0, c1));
+	}
+
+	*outAlphaSum &= ReduceAnd16(_mm_and_si128(_mm256_castsi256_si128(alpha), _mm256_extracti128_si256(alpha, 1)));
+	return done;
+}
+
+#if defined(__GNUC__) || defined(__clang__) || defined(__INTEL_COMPILER)
+[[gnu::target("avx2")]]
+#endif
+static int DeIndexTexture4AVX2(u32 *dest, const u8 *indexed, int length, const u32 *clut, u32 *outAlphaSum) {
+	__m128i planes128[4];
+	ClutPlanes32(clut, planes128);
+	__m256i planes[4];
+	for (int i = 0; i < 4; ++i) {
+		planes[i] = _mm256_broadcastsi128_si256(planes128[i]);
+	}
+
+	__m256i alpha = _mm256_set1_epi32(-1);
+	int done = 0;
+	for (; done + 32 <= length; done += 32) {
+		__m256i idx = LoadNibbleIndices(indexed + done / 2);
+		__m256i b0 = _mm256_shuffle_epi8(planes[0], idx);
+		__m256i b1 = _mm256_shuffle_epi8(planes[1], idx);
+		__m256i b2 = _mm256_shuffle_epi8(planes[2], idx);
+		__m256i b3 = _mm256_shuffle_epi8(planes[3], idx);
+		__m256i b01lo = _mm256_unpacklo_epi8(b0, b1);
+		__m256i b01hi = _mm256_unpackhi_epi8(b0, b1);
+		__m256i b23lo = _mm256_unpacklo_epi8(b2, b3);
+		__m256i b23hi = _mm256_unpackhi_epi8(b2, b3);
+		// Pixels 0-3 | 16-19, 4-7 | 20-23, 8-11 | 24-27, 12-15 | 28-31.
+		__m256i c0 = _mm256_unpacklo_epi16(b01lo, b23lo);
+		__m256i c1 = _mm256_unpackhi_epi16(b01lo, b23lo);
+		__m256i c2 = _mm256_unpacklo_epi16(b01hi, b23hi);
+		__m256i c3 = _mm256_unpackhi_epi16(b01hi, b23hi);
+		u32 *d = dest + done;
+		_mm256_storeu_si256((__m256i *)(d + 0), _mm256_permute2x128_si256(c0, c1, 0x20));
+		_mm256_storeu_si256((__m256i *)(d + 8), _mm256_permute2x128_si256(c2, c3, 0x20));
+		_mm256_storeu_si256((__m256i *)(d + 16), _mm256_permute2x128_si256(c0, c1, 0x31));
+		_mm256_storeu_si256((__m256i *)(d + 24), _mm256_permute2x128_si256(c2, c3, 0x31));
+		alpha = _mm256_and_si256(alpha, _mm256_and_si256(_mm256_and_si256(c0, c1), _mm256_and_si256(c2, c3)));
+	}
+
+	*outAlphaSum &= ReduceAnd32(_mm_and_si128(_mm256_castsi256_si128(alpha), _mm256_extracti128_si256(alpha, 1)));
+	return done;
+}
+
+#if defined(__GNUC__) || defined(__clang__) || defined(__INTEL_COMPILER)
+[[gnu::target("avx2")]]
+#endif
+static int DeIndexTexture8AVX2(u16 *dest, const u8 *indexed, int length, const u16 *clut, u32 *outAlphaSum) {
+	// Gather whole aligned words so we never read outside the CLUT, then pick the right half.
+	const int *clutWords = (const int *)clut;
+	const __m256i one = _mm256_set1_epi32(1);
+	const __m256i lowHalf = _mm256_set1_epi32(0xFFFF);
+
+	__m256i alpha = _mm256_set1_epi32(-1);
+	int done = 0;
+	for (; done + 16 <= length; done += 16) {
+		__m128i idx8 = _mm_loadu_si128((const __m128i *)(indexed + done));
+		__m256i idx0 = _mm256_cvtepu8_epi32(idx8);
+		__m256i idx1 = _mm256_cvtepu8_epi32(_mm_srli_si128(idx8, 8));
+		__m256i c0 = _mm256_i32gather_epi32(clutWords, _mm256_srli_epi32(idx0, 1), 4);
+		__m256i c1 = _mm256_i32gather_epi32(clutWords, _mm256_srli_epi32(idx1, 1), 4);
+		c0 = _mm256_and_si256(_mm256_srlv_epi32(c0, _mm256_slli_epi32(_mm256_and_si256(idx0, one), 4)), lowHalf);
+		c1 = _mm256_and_si256(_mm256_srlv_epi32(c1, _mm256_slli_epi32(_mm256_and_si256(idx1, one), 4)), lowHalf);
+		// packus works in-lane, so this gives pixels 0-3, 8-11, 4-7, 12-15.
+		__m256i c = _mm256_permute4x64_epi64(_mm256_packus_epi32(c0, c1), 0xD8);
+		_mm256_storeu_si256((__m256i *)(dest + done), c);
+		alpha = _mm256_and_si256(alpha, c);
+	}
+
+	*outAlphaSum &= ReduceAnd16(_mm_and_si128(_mm256_castsi256_si128(alpha), _mm256_extracti128_si256(alpha, 1)));
+	return done;
+}
+
+#if defined(__GNUC__) || defined(__clang__) || defined(__INTEL_COMPILER)
+[[gnu::target("avx2")]]
+#endif
+static int DeIndexTexture8AVX2(u32 *dest, const u8 *indexed, int length, const u32 *clut, u32 *outAlphaSum) {
+	const int *clutWords = (const int *)clut;
+
+	__m256i alpha = _mm256_set1_epi32(-1);
+	int done = 0;
+	for (; done + 16 <= length; done += 16) {
+		__m128i idx8 = _mm_loadu_si128((const __m128i *)(indexed + done));
+		__m256i c0 = _mm256_i32gather_epi32(clutWords, _mm256_cvtepu8_epi32(idx8), 4);
+		__m256i c1 = _mm256_i32gather_epi32(clutWords, _mm256_cvtepu8_epi32(_mm_srli_si128(idx8, 8)), 4);
+		_mm256_storeu_si256((__m256i *)(dest + done), c0);
+		_mm256_storeu_si256((__m256i *)(dest + done + 8), c1);
+		alpha = _mm256_and_si256(alpha, _mm256_and_si256(c0, c1));
+	}
+
+	*outAlphaSum &= ReduceAnd32(_mm_and_si128(_mm256_castsi256_si128(alpha), _mm256_extracti128_si256(alpha, 1)));
+	return done;
+}
+#endif
+
+#if PPSSPP_ARCH(ARM64)
+static inline void SplitNibblesNEON(uint8x16_t packed, uint8x16_t *idx0, uint8x16_t *idx1) {
+	uint8x16_t lo = vandq_u8(packed, vdupq_n_u8(0x0F));
+	uint8x16_t hi = vshrq_n_u8(packed, 4);
+	*idx0 = vzip1q_u8(lo, hi);
+	*idx1 = vzip2q_u8(lo, hi);
+}
+
+static inline u32 ReduceAndBytes(uint8x16_t v) {
+	uint64x2_t v64 = vreinterpretq_u64_u8(v);
+	u64 r = vgetq_lane_u64(v64, 0) & vgetq_lane_u64(v64, 1);
+	r &= r >> 32;
+	r &= r >> 16;
+	r &= r >> 8;
+	return (u32)(r & 0xFF);
+}
+
+// The deinterleaving loads split the CLUT into byte planes, and the interleaving stores put them back together.
+static int DeIndexTexture4NEON(u16 *dest, const u8 *indexed, int length, const u16 *clut, u32 *outAlphaSum) {
+	const uint8x16x2_t planes = vld2q_u8((const u8 *)clut);
+
+	uint8x16_t alpha0 = vdupq_n_u8(0xFF);
+	uint8x16_t alpha1 = vdupq_n_u8(0xFF);
+	int done = 0;
+	for (; done + 32 <= length; done += 32) {
+		uint8x16_t idx[2];
+		SplitNibblesNEON(vld1q_u8(indexed + done / 2), &idx[0], &idx[1]);
+		for (int i = 0; i < 2; ++i) {
+			uint8x16x2_t c;
+			c.val[0] = vqtbl1q_u8(planes.val[0], idx[i]);
+			c.val[1] = vqtbl1q_u8(planes.val[1], idx[i]);
+			vst2q_u8((u8 *)(dest + done + i * 16), c);
+			alpha0 = vandq_u8(alpha0, c.val[0]);
+			alpha1 = vandq_u8(alpha1, c.val[1]);
+		}
+	}
+
+	*outAlphaSum &= ReduceAndBytes(alpha0) | (ReduceAndBytes(alpha1) << 8);
+	return done;
+}
+
+static int DeIndexTexture4NEON(u32 *dest, const u8 *indexed, int length, const u32 *clut, u32 *outAlphaSum) {
+	const uint8x16x4_t planes = vld4q_u8((const u8 *)clut);
+
+	uint8x16_t alpha[4];
+	for (int j = 0; j < 4; ++j) {
+		alpha[j] = vdupq_n_u8(0xFF);
+	}
+	int done = 0;
+	for (; done + 32 <= length; done += 32) {
+		uint8x16_t idx[2];
+		SplitNibblesNEON(vld1q_u8(indexed + done / 2), &idx[0], &idx[1]);
+		for (int i = 0; i < 2; ++i) {
+			uint8x16x4_t c;
+			for (int j = 0; j < 4; ++j) {
+				c.val[j] = vqtbl1q_u8(planes.val[j], idx[i]);
+				alpha[j] = vandq_u8(alpha[j], c.val[j]);
+			}
+			vst4q_u8((u8 *)(dest + done + i * 16), c);
+		}
+	}
+
+	u32 alphaSum = 0;
+	for (int j = 0; j < 4; ++j) {
+		alphaSum |= ReduceAndBytes(alpha[j]) << (j * 8);
+	}
+	*outAlphaSum &= alphaSum;
+	return done;
+}
+#endif
+
+int DeIndexTextureFast(u16 *dest, const u8 *indexed, int length, const u16 *clut, u32 *outAlphaSum) {
+#if defined(_M_SSE)
+	if (cpu_info.bAVX2 && ((uintptr_t)clut & 3) == 0) {
+		return DeIndexTexture8AVX2(dest, indexed, length, clut, outAlphaSum);
+	}
+#endif
+	// NEON has no gather, and 256 entries are too many for table lookups.
+	return 0;
+}
+
+int DeIndexTextureFast(u32 *dest, const u8 *indexed, int length, const u32 *clut, u32 *outAlphaSum) {
+#if defined(_M_SSE)
+	if (cpu_info.bAVX2) {
+		return DeIndexTexture8AVX2(dest, indexed, length, clut, outAlphaSum);
+	}
+#endif
+	return 0;
+}
+
+int DeIndexTexture4Fast(u16 *dest, const u8 *indexed, int length, const u16 *clut, u32 *outAlphaSum) {
+#if defined(_M_SSE)
+	if (cpu_info.bAVX2) {
+		return DeIndexTexture4AVX2(dest, indexed, length, clut, outAlphaSum);
+	} else if (cpu_info.bSSSE3) {
+		return DeIndexTexture4SSSE3(dest, indexed, length, clut, outAlphaSum);
+	}
+#elif PPSSPP_ARCH(ARM64)
+	return DeIndexTexture4NEON(dest, indexed, length, clut, outAlphaSum);
+#endif
+	return 0;
+}
+
+int DeIndexTexture4Fast(u32 *dest, const u8 *indexed, int length, const u32 *clut, u32 *outAlphaSum) {
+#if defined(_M_SSE)
+	if (cpu_info.bAVX2) {
+		return DeIndexTexture4AVX2(dest, indexed, length, clut, outAlphaSum);
+	} else if (cpu_info.bSSSE3) {
+		return DeIndexTexture4SSSE3(dest, indexed, length, clut, outAlphaSum);
+	}
+#elif PPSSPP_ARCH(ARM64)
+	return DeIndexTexture4NEON(dest, indexed, length, clut, outAlphaSum);
+#endif
+	return 0;
+}
+
 // S3TC / DXT Decoder
 class DXTDecoder {
 public:
@@ -107,6 +107,23 @@ inline CheckAlphaResult CheckAlpha32Rect(const u32 *pixelData, int stride, int w
 	return AlphaSumIsFull(alphaSum, fullAlphaMask) ? CHECKALPHA_FULL : CHECKALPHA_ANY;
 }
 
+// SIMD versions of the simple index (no shift, mask or offset) case of DeIndexTexture/DeIndexTexture4,
+// chosen at runtime. They return how many pixels they did (possibly zero), the caller does the rest.
+int DeIndexTextureFast(u16 *dest, const u8 *indexed, int length, const u16 *clut, u32 *outAlphaSum);
+int DeIndexTextureFast(u32 *dest, const u8 *indexed, int length, const u32 *clut, u32 *outAlphaSum);
+int DeIndexTexture4Fast(u16 *dest, const u8 *indexed, int length, const u16 *clut, u32 *outAlphaSum);
+int DeIndexTexture4Fast(u32 *dest, const u8 *indexed, int length, const u32 *clut, u32 *outAlphaSum);
+
+// Other combinations have no fast path.
+template <typename IndexT, typename ClutT>
+inline int DeIndexTextureFast(ClutT *dest, const IndexT *indexed, int length, const ClutT *clut, u32 *outAlphaSum) {
+	return 0;
+}
+template <typename ClutT>
+inline int DeIndexTexture4Fast(ClutT *dest, const u8 *indexed, int length, const ClutT *clut, u32 *outAlphaSum) {
+	return 0;
+}
+
 template <typename IndexT, typename ClutT>
 inline void DeIndexTexture(/*WRITEONLY*/ ClutT *dest, const IndexT *indexed, int length, const ClutT *clut, u32 *outAlphaSum) {
 	// Usually, there is no special offset, mask, or shift.
@@ -116,7 +133,10 @@ inline void DeIndexTexture(/*WRITEONLY*/ ClutT *dest, const IndexT *indexed, int
 
 	if (nakedIndex) {
 		if (sizeof(IndexT) == 1) {
-			for (int i = 0; i < length; ++i) {
+			int done = DeIndexTextureFast(dest, indexed, length, clut, outAlphaSum);
+			dest += done;
+			indexed += done;
+			for (int i = done; i < length; ++i) {
 				ClutT color = clut[*indexed++];
 				alphaSum &= color;
 				*dest++ = color;
@@ -152,6 +172,10 @@ inline void DeIndexTexture4(/*WRITEONLY*/ ClutT *dest, const u8 *indexed, int le
 
 	ClutT alphaSum = (ClutT)(-1);
 	if (nakedIndex) {
+		int done = DeIndexTexture4Fast(dest, indexed, length, clut, outAlphaSum);
+		dest += done;
+		indexed += done / 2;
+		length -= done;
 		while (length >= 2) {
 			u8 index = *indexed++;
 			ClutT color0 = clut[index & 0xf];
@@ -1321,6 +1321,25 @@ void VertexDecoder::DecodeVerts(u8 *decodedptr, const void *verts, const UVScale
 	}
 }
 
+bool VertexDecoder::CanDecodeInParallel() const {
+	// The interpreter keeps its position in mutable members.
+	if (!jitted_ || validateJit)
+		return false;
+	// Through mode UV bounds are read, updated and written back to gstate_c by every call.
+	if (throughmode && tc)
+		return false;
+	// The jits copy the bone matrices into a static array when skinning.
+	if (skinInDecode)
+		return false;
+#if PPSSPP_ARCH(AMD64) || PPSSPP_ARCH(ARM64)
+	// These only ever store zero to gstate_c.vertexFullAlpha, so concurrent calls can't lose a clear.
+	// The other jits AND into it in memory, and RISC-V also morphs through a static matrix.
+	return true;
+#else
+	return false;
+#endif
+}
+
 static float LargestAbsDiff(Vec4f a, Vec4f b, int n) {
 	Vec4f delta = a - b;
 	float largest = 0;
@@ -1524,7 +1543,7 @@ VertexDecoderJitCache::VertexDecoderJitCache()
 }
 
 void VertexDecoderJitCache::Clear() {
-	if (g_Config.iCpuCore == (int)CPUCore::JIT) {
+	if (g_Config.iCpuCore == (int)CPUCore::JIT || g_Config.iCpuCore == (int)CPUCore::JIT_IR) {
 		ClearCodeSpace(0);
 	}
 }
@@ -339,6 +339,8 @@ class VertexDecoder {
 	const DecVtxFormat &GetDecVtxFmt() const { return decFmt; }
 
 	void DecodeVerts(u8 *decoded, const void *verts, const UVScale *uvScaleOffset, int indexLowerBound, int indexUpperBound) const;
+	// Whether DecodeVerts can be called concurrently on separate ranges.
+	bool CanDecodeInParallel() const;
 
 	int VertexSize() const { return size; }  // PSP format size
 
@@ -584,6 +586,36 @@ class VertexDecoderJitCache : public VERTEXDECODER_JIT_BACKEND {
 	void Jit_Color565Morph();
 	void Jit_Color5551Morph();
 
+#if PPSSPP_ARCH(AMD64)
+	// AVX2 versions decoding two vertices at once, see VertexDecoderX86.cpp.
+	void Jit_WeightsU8SkinPaired();
+	void Jit_WeightsU16SkinPaired();
+	void Jit_WeightsFloatSkinPaired();
+
+	void Jit_TcU8MorphToFloatPaired();
+	void Jit_TcU16MorphToFloatPaired();
+	void Jit_TcFloatMorphPaired();
+	void Jit_TcU8PrescaleMorphPaired();
+	void Jit_TcU16PrescaleMorphPaired();
+	void Jit_TcFloatPrescaleMorphPaired();
+
+	void Jit_NormalS8SkinPaired();
+	void Jit_NormalS16SkinPaired();
+	void Jit_NormalFloatSkinPaired();
+
+	void Jit_PosS8SkinPaired();
+	void Jit_PosS16SkinPaired();
+	void Jit_PosFloatSkinPaired();
+
+	void Jit_NormalS8MorphPaired();
+	void Jit_NormalS16MorphPaired();
+	void Jit_NormalFloatMorphPaired();
+
+	void Jit_PosS8MorphPaired();
+	void Jit_PosS16MorphPaired();
+	void Jit_PosFloatMorphPaired();
+#endif
+
 private:
 	bool CompileStep(const VertexDecoder &dec, int i);
 	void Jit_ApplyWeights();
@@ -597,6 +629,17 @@ class VertexDecoderJitCache : public VERTEXDECODER_JIT_BACKEND {
 	void Jit_AnyS16Morph(int srcoff, int dstoff);
 	void Jit_AnyFloatMorph(int srcoff, int dstoff);
 
+#if PPSSPP_ARCH(AMD64)
+	void CompilePairedStep(const VertexDecoder &dec, int i);
+	void Jit_PairedBroadcastConst(Gen::X64Reg dst, const float *value);
+	void Jit_PairedStore(Gen::X64Reg src, int outOff, int count);
+	void Jit_WeightsSkinPaired(int bits);
+	void Jit_AnyToFloatPaired(int srcoff, int bits);
+	void Jit_WriteMatrixMulPaired(int outOff, bool pos);
+	void Jit_AnyMorphPaired(int srcoff, int dstoff, int bits);
+	void Jit_TcAnyMorphPaired(int bits, bool prescale);
+#endif
+
 	const VertexDecoder *dec_ = nullptr;
 #if PPSSPP_ARCH(ARM64)
 	Arm64Gen::ARM64FloatEmitter fp;
@@ -166,9 +166,62 @@ static const JitLookup jitLookup[] = {
 	{&VertexDecoder::Step_Color5551Morph, &VertexDecoderJitCache::Jit_Color5551Morph},
 };
 
+#if PPSSPP_ARCH(AMD64)
+// With AVX2, skinning and morphing decode two vertices per loop iteration. These steps handle
+// both at once, with the first vertex in the low and the second in the high 128 bits of each
+// YMM register. Any other steps in the format still run once per vertex, using jitLookup.
+static const JitLookup jitLookupPaired[] = {
+	{&VertexDecoder::Step_WeightsU8Skin, &VertexDecoderJitCache::Jit_WeightsU8SkinPaired},
+	{&VertexDecoder::Step_WeightsU16Skin, &VertexDecoderJitCache::Jit_WeightsU16SkinPaired},
+	{&VertexDecoder::Step_WeightsFloatSkin, &VertexDecoderJitCache::Jit_WeightsFloatSkinPaired},
+
+	{&VertexDecoder::Step_TcU8MorphToFloat, &VertexDecoderJitCache::Jit_TcU8MorphToFloatPaired},
+	{&VertexDecoder::Step_TcU16MorphToFloat, &VertexDecoderJitCache::Jit_TcU16MorphToFloatPaired},
+	{&VertexDecoder::Step_TcFloatMorph, &VertexDecoderJitCache::Jit_TcFloatMorphPaired},
+	{&VertexDecoder::Step_TcU8PrescaleMorph, &VertexDecoderJitCache::Jit_TcU8PrescaleMorphPaired},
+	{&VertexDecoder::Step_TcU16PrescaleMorph, &VertexDecoderJitCache::Jit_TcU16PrescaleMorphPaired},
+	{&VertexDecoder::Step_TcFloatPrescaleMorph, &VertexDecoderJitCache::Jit_TcFloatPrescaleMorphPaired},
+
+	{&VertexDecoder::Step_NormalS8Skin, &VertexDecoderJitCache::Jit_NormalS8SkinPaired},
+	{&VertexDecoder::Step_NormalS16Skin, &VertexDecoderJitCache::Jit_NormalS16SkinPaired},
+	{&VertexDecoder::Step_NormalFloatSkin, &VertexDecoderJitCache::Jit_NormalFloatSkinPaired},
+
+	{&VertexDecoder::Step_PosS8Skin, &VertexDecoderJitCache::Jit_PosS8SkinPaired},
+	{&VertexDecoder::Step_PosS16Skin, &VertexDecoderJitCache::Jit_PosS16SkinPaired},
+	{&VertexDecoder::Step_PosFloatSkin, &VertexDecoderJitCache::Jit_PosFloatSkinPaired},
+
+	{&VertexDecoder::Step_NormalS8Morph, &VertexDecoderJitCache::Jit_NormalS8MorphPaired},
+	{&VertexDecoder::Step_NormalS16Morph, &VertexDecoderJitCache::Jit_NormalS16MorphPaired},
+	{&VertexDecoder::Step_NormalFloatMorph, &VertexDecoderJitCache::Jit_NormalFloatMorphPaired},
+
+	{&VertexDecoder::Step_PosS8Morph, &VertexDecoderJitCache::Jit_PosS8MorphPaired},
+	{&VertexDecoder::Step_PosS16Morph, &VertexDecoderJitCache::Jit_PosS16MorphPaired},
+	{&VertexDecoder::Step_PosFloatMorph, &VertexDecoderJitCache::Jit_PosFloatMorphPaired},
+};
+
+static bool IsPairedStep(StepFunction func) {
+	for (size_t i = 0; i < ARRAY_SIZE(jitLookupPaired); i++) {
+		if (func == jitLookupPaired[i].func)
+			return true;
+	}
+	return false;
+}
+#endif
+
 JittedVertexDecoder VertexDecoderJitCache::Compile(const VertexDecoder &dec, int32_t *jittedSize) {
 	dec_ = &dec;
-	BeginWrite(4096);
+
+	bool paired = false;
+#if PPSSPP_ARCH(AMD64)
+	if (cpu_info.bAVX2 && (dec.skinInDecode || dec.morphcount > 1)) {
+		for (int i = 0; i < dec.numSteps_; i++) {
+			if (IsPairedStep(dec.steps_[i]))
+				paired = true;
+		}
+	}
+#endif
+
+	BeginWrite(paired ? 8192 : 4096);
 	const u8 *start = this->AlignCode16();
 
 	bool prescaleStep = false;
@@ -271,13 +324,60 @@ JittedVertexDecoder VertexDecoderJitCache::Compile(const VertexDecoder &dec, int
 		}
 	}
 
+	auto compileFailed = [&]() {
+		EndWrite();
+		// Reset the code ptr and return zero to indicate that we failed.
+		ResetCodePtr(GetOffset(start));
+	};
+
 	// Let's not bother with a proper stack frame. We just grab the arguments and go.
+#if PPSSPP_ARCH(AMD64)
+	FixupBranch skipSingle;
+	if (paired) {
+		CMP(32, R(counterReg), Imm8(2));
+		FixupBranch skipPairs = J_CC(CC_L, true);
+
+		// First the unpaired steps (plain SSE) for each of the two vertices, then the paired
+		// steps (AVX2) for both. Keeping them apart avoids SSE/AVX transitions in between.
+		JumpTarget pairLoopStart = NopAlignCode16();
+		for (int v = 0; v < 2; v++) {
+			for (int i = 0; i < dec.numSteps_; i++) {
+				if (!IsPairedStep(dec.steps_[i]) && !CompileStep(dec, i)) {
+					compileFailed();
+					return 0;
+				}
+			}
+			if (v == 0) {
+				ADD(PTRBITS, R(srcReg), Imm32(dec.VertexSize()));
+				ADD(PTRBITS, R(dstReg), Imm32(dec.decFmt.stride));
+			} else {
+				SUB(PTRBITS, R(srcReg), Imm32(dec.VertexSize()));
+				SUB(PTRBITS, R(dstReg), Imm32(dec.decFmt.stride));
+			}
+		}
+		for (int i = 0; i < dec.numSteps_; i++) {
+			if (IsPairedStep(dec.steps_[i]))
+				CompilePairedStep(dec, i);
+		}
+		VZEROUPPER();
+
+		ADD(PTRBITS, R(srcReg), Imm32(dec.VertexSize() * 2));
+		ADD(PTRBITS, R(dstReg), Imm32(dec.decFmt.stride * 2));
+		SUB(32, R(counterReg), Imm8(2));
+		CMP(32, R(counterReg), Imm8(2));
+		J_CC(CC_GE, pairLoopStart, true);
+
+		// An odd vertex left over goes through the regular loop below.
+		SetJumpTarget(skipPairs);
+		TEST(32, R(counterReg), R(counterReg));
+		skipSingle = J_CC(CC_Z, true);
+	}
+#endif
+
 	JumpTarget loopStart = NopAlignCode16();
 	for (int i = 0; i < dec.numSteps_; i++) {
 		if (!CompileStep(dec, i)) {
-			EndWrite();
-			// Reset the code ptr and return zero to indicate that we failed.
-			ResetCodePtr(GetOffset(start));
+			compileFailed();
 			return 0;
 		}
 	}
@@ -287,6 +387,11 @@ JittedVertexDecoder VertexDecoderJitCache::Compile(const VertexDecoder &dec, int
 	SUB(32, R(counterReg), Imm8(1));
 	J_CC(CC_NZ, loopStart, true);
 
+#if PPSSPP_ARCH(AMD64)
+	if (paired)
+		SetJumpTarget(skipSingle);
+#endif
+
 	// Writeback alpha reg
 #if PPSSPP_ARCH(AMD64)
 	if (dec.col) {
@@ -1745,4 +1850,323 @@ bool VertexDecoderJitCache::CompileStep(const VertexDecoder &dec, int step) {
 	return false;
 }
 
+#if PPSSPP_ARCH(AMD64)
+
+// The paired steps must produce exactly the same bits as the single vertex steps above, so
+// they do the same operations in the same order (notably, no FMA.)
+
+void VertexDecoderJitCache::Jit_PairedBroadcastConst(X64Reg dst, const float *value) {
+	if (RipAccessible(value)) {
+		VBROADCASTSS(256, dst, M(value));  // rip accessible
+	} else {
+		MOV(PTRBITS, R(tempReg1), ImmPtr(value));
+		VBROADCASTSS(256, dst, MatR(tempReg1));
+	}
+}
+
+void VertexDecoderJitCache::Jit_PairedStore(X64Reg src, int outOff, int count) {
+	// Exact sized stores, since the second vertex may be the last one in the buffer.
+	VMOVQ(MDisp(dstReg, outOff), src);
+	if (count == 3)
+		VEXTRACTPS(MDisp(dstReg, outOff + 8), src, 2);
+	VEXTRACTF128(R(XMM2), src, 1);
+	VMOVQ(MDisp(dstReg, dec_->decFmt.stride + outOff), XMM2);
+	if (count == 3)
+		VEXTRACTPS(MDisp(dstReg, dec_->decFmt.stride + outOff + 8), XMM2, 2);
+}
+
+void VertexDecoderJitCache::Jit_WeightsSkinPaired(int bits) {
+	const int size = dec_->VertexSize();
+	MOV(PTRBITS, R(tempReg2), ImmPtr(&bones));
+
+	// Weights 0-3 go in YMM8 and 4-7 in YMM9, same as the SSE path does with XMM8/XMM9.
+	if (bits != 32) {
+		for (int v = 0; v < 2; v++) {
+			const OpArg src = MDisp(srcReg, v * size + dec_->weightoff);
+			const OpArg srcHigh = MDisp(srcReg, v * size + dec_->weightoff + (bits == 8 ? 4 : 8));
+			const X64Reg low = v == 0 ? XMM8 : XMM1;
+			const X64Reg high = v == 0 ? XMM9 : XMM2;
+			if (bits == 8) {
+				VMOVD(low, src);
+				VPMOVZXBD(128, low, R(low));
+				if (dec_->nweights > 4) {
+					VMOVD(high, srcHigh);
+					VPMOVZXBD(128, high, R(high));
+				}
+			} else {
+				if (dec_->nweights > 2)
+					VMOVQ(low, src);
+				else
+					VMOVD(low, src);
+				VPMOVZXWD(128, low, R(low));
+				if (dec_->nweights > 4) {
+					if (dec_->nweights > 6)
+						VMOVQ(high, srcHigh);
+					else
+						VMOVD(high, srcHigh);
+					VPMOVZXWD(128, high, R(high));
+				}
+			}
+		}
+		VINSERTF128(YMM8, YMM8, R(XMM1), 1);
+		VCVTDQ2PS(256, YMM8, R(YMM8));
+		if (dec_->nweights > 4) {
+			VINSERTF128(YMM9, YMM9, R(XMM2), 1);
+			VCVTDQ2PS(256, YMM9, R(YMM9));
+		}
+		Jit_PairedBroadcastConst(YMM3, bits == 8 ? by128 : by32768);
+		VMULPS(256, YMM8, YMM8, R(YMM3));
+		if (dec_->nweights > 4)
+			VMULPS(256, YMM9, YMM9, R(YMM3));
+	}
+
+	for (int j = 0; j < dec_->nweights; j++) {
+		if (bits == 32) {
+			VBROADCASTSS(128, XMM1, MDisp(srcReg, dec_->weightoff + j * 4));
+			VBROADCASTSS(128, XMM2, MDisp(srcReg, size + dec_->weightoff + j * 4));
+			VINSERTF128(YMM1, YMM1, R(XMM2), 1);
+		} else {
+			VPERMILPS(256, YMM1, R(j < 4 ? YMM8 : YMM9), _MM_SHUFFLE(j % 4, j % 4, j % 4, j % 4));
+		}
+
+		// Both vertices use the same bones, so each row is simply broadcast to both halves.
+		for (int r = 0; r < 4; r++) {
+			const X64Reg row = (X64Reg)(YMM4 + r);
+			const OpArg bone = MDisp(tempReg2, j * 64 + r * 16);
+			if (j == 0) {
+				VBROADCASTF128(row, bone);
+				VMULPS(256, row, row, R(YMM1));
+			} else {
+				const X64Reg temp = (r & 1) ? YMM3 : YMM2;
+				VBROADCASTF128(temp, bone);
+				VMULPS(256, temp, temp, R(YMM1));
+				VADDPS(256, row, row, R(temp));
+			}
+		}
+	}
+}
+
+void VertexDecoderJitCache::Jit_WeightsU8SkinPaired() {
+	Jit_WeightsSkinPaired(8);
+}
+
+void VertexDecoderJitCache::Jit_WeightsU16SkinPaired() {
+	Jit_WeightsSkinPaired(16);
+}
+
+void VertexDecoderJitCache::Jit_WeightsFloatSkinPaired() {
+	Jit_WeightsSkinPaired(32);
+}
+
+// Loads a signed vector of each vertex into the two halves of YMM3 as floats, like Jit_AnyS8ToFloat etc.
+void VertexDecoderJitCache::Jit_AnyToFloatPaired(int srcoff, int bits) {
+	const OpArg src = MDisp(srcReg, srcoff);
+	const OpArg src2 = MDisp(srcReg, dec_->VertexSize() + srcoff);
+	if (bits == 32) {
+		VMOVUPS(128, XMM3, src);
+		VINSERTF128(YMM3, YMM3, src2, 1);
+		return;
+	}
+
+	if (bits == 8) {
+		VPMOVSXBD(128, XMM1, src);
+		VPMOVSXBD(128, XMM2, src2);
+	} else {
+		VPMOVSXWD(128, XMM1, src);
+		VPMOVSXWD(128, XMM2, src2);
+	}
+	VINSERTF128(YMM1, YMM1, R(XMM2), 1);
+	VCVTDQ2PS(256, YMM3, R(YMM1));
+	Jit_PairedBroadcastConst(YMM2, bits == 8 ? by128 : by32768);
+	VMULPS(256, YMM3, YMM3, R(YMM2));
+}
+
+void VertexDecoderJitCache::Jit_WriteMatrixMulPaired(int outOff, bool pos) {
+	VPERMILPS(256, YMM1, R(YMM3), _MM_SHUFFLE(0, 0, 0, 0));
+	VPERMILPS(256, YMM2, R(YMM3), _MM_SHUFFLE(1, 1, 1, 1));
+	VPERMILPS(256, YMM3, R(YMM3), _MM_SHUFFLE(2, 2, 2, 2));
+	VMULPS(256, YMM1, YMM1, R(YMM4));
+	VMULPS(256, YMM2, YMM2, R(YMM5));
+	VMULPS(256, YMM3, YMM3, R(YMM6));
+	VADDPS(256, YMM1, YMM1, R(YMM2));
+	VADDPS(256, YMM1, YMM1, R(YMM3));
+	if (pos) {
+		VADDPS(256, YMM1, YMM1, R(YMM7));
+	}
+	Jit_PairedStore(YMM1, outOff, 3);
+}
+
+void VertexDecoderJitCache::Jit_NormalS8SkinPaired() {
+	Jit_AnyToFloatPaired(dec_->nrmoff, 8);
+	Jit_WriteMatrixMulPaired(dec_->decFmt.nrmoff, false);
+}
+
+void VertexDecoderJitCache::Jit_NormalS16SkinPaired() {
+	Jit_AnyToFloatPaired(dec_->nrmoff, 16);
+	Jit_WriteMatrixMulPaired(dec_->decFmt.nrmoff, false);
+}
+
+void VertexDecoderJitCache::Jit_NormalFloatSkinPaired() {
+	Jit_AnyToFloatPaired(dec_->nrmoff, 32);
+	Jit_WriteMatrixMulPaired(dec_->decFmt.nrmoff, false);
+}
+
+void VertexDecoderJitCache::Jit_PosS8SkinPaired() {
+	Jit_AnyToFloatPaired(dec_->posoff, 8);
+	Jit_WriteMatrixMulPaired(dec_->decFmt.posoff, true);
+}
+
+void VertexDecoderJitCache::Jit_PosS16SkinPaired() {
+	Jit_AnyToFloatPaired(dec_->posoff, 16);
+	Jit_WriteMatrixMulPaired(dec_->decFmt.posoff, true);
+}
+
+void VertexDecoderJitCache::Jit_PosFloatSkinPaired() {
+	Jit_AnyToFloatPaired(dec_->posoff, 32);
+	Jit_WriteMatrixMulPaired(dec_->decFmt.posoff, true);
+}
+
+void VertexDecoderJitCache::Jit_AnyMorphPaired(int srcoff, int dstoff, int bits) {
+	const int size = dec_->VertexSize();
+	if (bits != 32)
+		Jit_PairedBroadcastConst(YMM5, bits == 8 ? by128 : by32768);
+	MOV(PTRBITS, R(tempReg1), ImmPtr(&gstate_c.morphWeights[0]));
+
+	// Sum into YMM8.
+	for (int n = 0; n < dec_->morphcount; ++n) {
+		const X64Reg reg = n == 0 ? YMM8 : YMM1;
+		const OpArg src = MDisp(srcReg, dec_->onesize_ * n + srcoff);
+		const OpArg src2 = MDisp(srcReg, size + dec_->onesize_ * n + srcoff);
+		if (bits == 32) {
+			VMOVUPS(128, reg, src);
+			VINSERTF128(reg, reg, src2, 1);
+		} else {
+			if (bits == 8) {
+				VPMOVSXBD(128, reg, src);
+				VPMOVSXBD(128, XMM2, src2);
+			} else {
+				VPMOVSXWD(128, reg, src);
+				VPMOVSXWD(128, XMM2, src2);
+			}
+			VINSERTF128(reg, reg, R(XMM2), 1);
+			VCVTDQ2PS(256, reg, R(reg));
+		}
+
+		// The weight is the same for both vertices, with the normalization folded in.
+		VBROADCASTSS(256, YMM3, MDisp(tempReg1, sizeof(float) * n));
+		if (bits != 32)
+			VMULPS(256, YMM3, YMM3, R(YMM5));
+		VMULPS(256, reg, reg, R(YMM3));
+		if (n != 0)
+			VADDPS(256, YMM8, YMM8, R(YMM1));
+	}
+
+	Jit_PairedStore(YMM8, dstoff, 3);
+}
+
+void VertexDecoderJitCache::Jit_NormalS8MorphPaired() {
+	Jit_AnyMorphPaired(dec_->nrmoff, dec_->decFmt.nrmoff, 8);
+}
+
+void VertexDecoderJitCache::Jit_NormalS16MorphPaired() {
+	Jit_AnyMorphPaired(dec_->nrmoff, dec_->decFmt.nrmoff, 16);
+}
+
+void VertexDecoderJitCache::Jit_NormalFloatMorphPaired() {
+	Jit_AnyMorphPaired(dec_->nrmoff, dec_->decFmt.nrmoff, 32);
+}
+
+void VertexDecoderJitCache::Jit_PosS8MorphPaired() {
+	Jit_AnyMorphPaired(dec_->posoff, dec_->decFmt.posoff, 8);
+}
+
+void VertexDecoderJitCache::Jit_PosS16MorphPaired() {
+	Jit_AnyMorphPaired(dec_->posoff, dec_->decFmt.posoff, 16);
+}
+
+void VertexDecoderJitCache::Jit_PosFloatMorphPaired() {
+	Jit_AnyMorphPaired(dec_->posoff, dec_->decFmt.posoff, 32);
+}
+
+void VertexDecoderJitCache::Jit_TcAnyMorphPaired(int bits, bool prescale) {
+	const int size = dec_->VertexSize();
+	MOV(PTRBITS, R(tempReg1), ImmPtr(&gstate_c.morphWeights[0]));
+
+	// Sum into YMM8.
+	for (int n = 0; n < dec_->morphcount; ++n) {
+		const X64Reg reg = n == 0 ? YMM8 : YMM1;
+		for (int v = 0; v < 2; v++) {
+			const X64Reg half = v == 0 ? reg : XMM2;
+			const OpArg src = MDisp(srcReg, v * size + dec_->onesize_ * n + dec_->tcoff);
+			if (bits == 32) {
+				VMOVQ(half, src);
+			} else if (bits == 8) {
+				MOVZX(32, 16, tempReg2, src);
+				VMOVD(half, R(tempReg2));
+				VPMOVZXBD(128, half, R(half));
+			} else {
+				VMOVD(half, src);
+				VPMOVZXWD(128, half, R(half));
+			}
+		}
+		VINSERTF128(reg, reg, R(XMM2), 1);
+		if (bits != 32)
+			VCVTDQ2PS(256, reg, R(reg));
+
+		VBROADCASTSS(256, YMM3, MDisp(tempReg1, sizeof(float) * n));
+		VMULPS(256, reg, reg, R(YMM3));
+		if (n != 0)
+			VADDPS(256, YMM8, YMM8, R(YMM1));
+	}
+
+	if (prescale) {
+		// The scale (which takes into account the normalization) and offset, for both halves.
+		VINSERTF128(YMM9, YMM0, R(fpScaleOffsetReg), 1);
+		VPERMILPS(256, YMM3, R(YMM9), _MM_SHUFFLE(1, 0, 3, 2));
+		VMULPS(256, YMM8, YMM8, R(YMM9));
+		VADDPS(256, YMM8, YMM8, R(YMM3));
+	} else if (bits != 32) {
+		Jit_PairedBroadcastConst(YMM3, bits == 8 ? by128 : by32768);
+		VMULPS(256, YMM8, YMM8, R(YMM3));
+	}
+
+	Jit_PairedStore(YMM8, dec_->decFmt.uvoff, 2);
+}
+
+void VertexDecoderJitCache::Jit_TcU8MorphToFloatPaired() {
+	Jit_TcAnyMorphPaired(8, false);
+}
+
+void VertexDecoderJitCache::Jit_TcU16MorphToFloatPaired() {
+	Jit_TcAnyMorphPaired(16, false);
+}
+
+void VertexDecoderJitCache::Jit_TcFloatMorphPaired() {
+	Jit_TcAnyMorphPaired(32, false);
+}
+
+void VertexDecoderJitCache::Jit_TcU8PrescaleMorphPaired() {
+	Jit_TcAnyMorphPaired(8, true);
+}
+
+void VertexDecoderJitCache::Jit_TcU16PrescaleMorphPaired() {
+	Jit_TcAnyMorphPaired(16, true);
+}
+
+void VertexDecoderJitCache::Jit_TcFloatPrescaleMorphPaired() {
+	Jit_TcAnyMorphPaired(32, true);
+}
+
+void VertexDecoderJitCache::CompilePairedStep(const VertexDecoder &dec, int step) {
+	for (size_t i = 0; i < ARRAY_SIZE(jitLookupPaired); i++) {
+		if (dec.steps_[step] == jitLookupPaired[i].func) {
+			((*this).*jitLookupPaired[i].jitFunc)();
+			return;
+		}
+	}
+	_dbg_assert_msg_(false, "Not a paired step");
+}
+
+#endif
+
 #endif // PPSSPP_ARCH(X86) || PPSSPP_ARCH(AMD64)
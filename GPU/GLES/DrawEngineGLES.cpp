@@ -285,7 +285,7 @@ void DrawEngineGLES::DoFlush() {
 			int vertsToDecode = ComputeNumVertsToDecode();
 			u8 *dest = (u8 *)frameData.pushVertex->Allocate(vertsToDecode * dec_->GetDecVtxFmt().stride, 4, &vertexBuffer, &vertexBufferOffset);
 			// Indices are decoded in here.
-			DecodeVerts(dest);
+			DecodeVertsWithCache(dest);
 		}
 
 		gpuStats.numUncachedVertsDrawn += indexGen.VertexCount();
@@ -342,7 +342,7 @@ void DrawEngineGLES::DoFlush() {
 			lastVType_ |= (1 << 26);
 			dec_ = GetVertexDecoder(lastVType_);
 		}
-		DecodeVerts(decoded_);
+		DecodeVertsWithCache(decoded_);
 
 		bool hasColor = (lastVType_ & GE_VTYPE_COL_MASK) != GE_VTYPE_COL_NONE;
 		if (gstate.isModeThrough()) {
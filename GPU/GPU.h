@@ -82,14 +82,20 @@ struct GPUStatistics {
 		numCachedVertsDrawn = 0;
 		numUncachedVertsDrawn = 0;
 		numTrackedVertexArrays = 0;
+		numDecodedVertexCacheHits = 0;
+		numDecodedVertexCacheMisses = 0;
+		numDecodedVertexCacheEntries = 0;
+		decodedVertexCacheBytes = 0;
 		numTextureInvalidations = 0;
 		numTextureInvalidationsByFramebuffer = 0;
 		numTexturesHashed = 0;
 		numTextureDataBytesHashed = 0;
 		numFlushes = 0;
+		numFlushesAvoided = 0;
 		numBBOXJumps = 0;
 		numPlaneUpdates = 0;
 		numTexturesDecoded = 0;
+		numTexturesPartiallyUpdated = 0;
 		numFramebufferEvaluations = 0;
 		numBlockingReadbacks = 0;
 		numReadbacks = 0;
@@ -115,17 +121,23 @@ struct GPUStatistics {
 	int numListSyncs;
 	int numCachedDrawCalls;
 	int numFlushes;
+	int numFlushesAvoided;
 	int numBBOXJumps;
 	int numPlaneUpdates;
 	int numVertsSubmitted;
 	int numCachedVertsDrawn;
 	int numUncachedVertsDrawn;
 	int numTrackedVertexArrays;
+	int numDecodedVertexCacheHits;
+	int numDecodedVertexCacheMisses;
+	int numDecodedVertexCacheEntries;
+	int decodedVertexCacheBytes;
 	int numTextureInvalidations;
 	int numTextureInvalidationsByFramebuffer;
 	int numTexturesHashed;
 	int numTextureDataBytesHashed;
 	int numTexturesDecoded;
+	int numTexturesPartiallyUpdated;
 	int numFramebufferEvaluations;
 	int numBlockingReadbacks;
 	int numReadbacks;
@@ -512,9 +512,79 @@ void GPUCommonHW::SetDisplayFramebuffer(u32 framebuf, u32 stride, GEBufferFormat
 	framebufferManager_->SetDisplayFramebuffer(framebuf, stride, format);
 }
 
+// Some state is only used while the feature it belongs to is enabled, and enabling that feature
+// flushes by itself. While it's disabled, changes can't affect the draws already queued up, so
+// there's no need to break the batch.
+bool GPUCommonHW::ChangeBreaksBatch(int cmd) {
+	bool relevant;
+	switch (cmd) {
+	case GE_CMD_FOGCOLOR:
+	case GE_CMD_FOG1:
+	case GE_CMD_FOG2:
+		relevant = gstate.isFogEnabled() && !gstate.isModeThrough();
+		break;
+
+	case GE_CMD_ALPHATEST:
+		relevant = gstate.isAlphaTestEnabled();
+		break;
+
+	case GE_CMD_COLORTEST:
+	case GE_CMD_COLORREF:
+	case GE_CMD_COLORTESTMASK:
+		relevant = gstate.isColorTestEnabled();
+		break;
+
+	case GE_CMD_BLENDMODE:
+	case GE_CMD_BLENDFIXEDA:
+	case GE_CMD_BLENDFIXEDB:
+		// Blue-to-alpha looks at the blend factors even with blending off.
+		relevant = gstate.isAlphaBlendEnabled() || gstate_c.blueToAlpha;
+		break;
+
+	case GE_CMD_TEXENVCOLOR:
+		relevant = gstate.isTextureMapEnabled();
+		break;
+
+	case GE_CMD_MORPHWEIGHT0: case GE_CMD_MORPHWEIGHT1: case GE_CMD_MORPHWEIGHT2: case GE_CMD_MORPHWEIGHT3:
+	case GE_CMD_MORPHWEIGHT4: case GE_CMD_MORPHWEIGHT5: case GE_CMD_MORPHWEIGHT6: case GE_CMD_MORPHWEIGHT7:
+		relevant = gstate.getNumMorphWeights() > 1;
+		break;
+
+	// Material ambient is also the fallback vertex color, so it's not in this list.
+	case GE_CMD_MATERIALDIFFUSE:
+	case GE_CMD_MATERIALEMISSIVE:
+	case GE_CMD_MATERIALSPECULAR:
+	case GE_CMD_MATERIALSPECULARCOEF:
+	case GE_CMD_AMBIENTCOLOR:
+	case GE_CMD_AMBIENTALPHA:
+		relevant = gstate.isLightingEnabled() && !gstate.isModeThrough();
+		break;
+
+	default:
+		if (cmd >= GE_CMD_LX0 && cmd <= GE_CMD_LSC3) {
+			int light;
+			if (cmd < GE_CMD_LKS0)
+				light = ((cmd - GE_CMD_LX0) % 12) / 3;  // Position, direction and attenuation, xyz each.
+			else if (cmd < GE_CMD_LAC0)
+				light = (cmd - GE_CMD_LKS0) & 3;  // Spot exponent and cutoff.
+			else
+				light = (cmd - GE_CMD_LAC0) / 3;  // Ambient, diffuse and specular colors.
+			relevant = gstate.isLightingEnabled() && gstate.isLightChanEnabled(light) && !gstate.isModeThrough();
+		} else {
+			relevant = true;
+		}
+		break;
+	}
+
+	if (!relevant) {
+		drawEngineCommon_->NoteFlushAvoided();
+	}
+	return relevant;
+}
+
 void GPUCommonHW::CheckFlushOp(int cmd, u32 diff) {
 	const u8 cmdFlags = cmdInfo_[cmd].flags;
-	if (diff && (cmdFlags & FLAG_FLUSHBEFOREONCHANGE)) {
+	if (diff && (cmdFlags & FLAG_FLUSHBEFOREONCHANGE) && ChangeBreaksBatch(cmd)) {
 		if (dumpThisFrame_) {
 			NOTICE_LOG(G3D, "================ FLUSH ================");
 		}
@@ -833,7 +903,7 @@ void GPUCommonHW::FastRunLoop(DisplayList &list) {
 			}
 		} else {
 			uint64_t flags = info.flags;
-			if (flags & FLAG_FLUSHBEFOREONCHANGE) {
+			if ((flags & FLAG_FLUSHBEFOREONCHANGE) && ChangeBreaksBatch(cmd)) {
 				drawEngineCommon_->DispatchFlush();
 			}
 			gstate.cmdmem[cmd] = op;
@@ -1648,10 +1718,12 @@ size_t GPUCommonHW::FormatGPUStatsCommon(char *buffer, size_t size) {
 	return snprintf(buffer, size,
 		"DL processing time: %0.2f ms, %d drawsync, %d listsync\n"
 		"Draw calls: %d, flushes %d, clears %d, bbox jumps %d (%d updates)\n"
+		"Batching: %0.1f draws per flush, %d flushes avoided (was %0.1f)\n"
 		"Cached draws: %d (tracked: %d)\n"
+		"Decoded vertex cache: %d hits, %d misses (%d entries, %d kB)\n"
 		"Vertices: %d cached: %d uncached: %d\n"
 		"FBOs active: %d (evaluations: %d)\n"
-		"Textures: %d, dec: %d, invalidated: %d, hashed: %d kB\n"
+		"Textures: %d, dec: %d (partial: %d), invalidated: %d, hashed: %d kB\n"
 		"readbacks %d (%d non-block), uploads %d, depal %d\n"
 		"replacer: tracks %d references, %d unique textures\n"
 		"Cpy: depth %d, color %d, reint %d, blend %d, self %d, drawpix %d\n"
@@ -1664,8 +1736,15 @@ size_t GPUCommonHW::FormatGPUStatsCommon(char *buffer, size_t size) {
 		gpuStats.numClears,
 		gpuStats.numBBOXJumps,
 		gpuStats.numPlaneUpdates,
+		gpuStats.numFlushes > 0 ? (float)gpuStats.numDrawCalls / (float)gpuStats.numFlushes : 0.0f,
+		gpuStats.numFlushesAvoided,
+		gpuStats.numFlushes + gpuStats.numFlushesAvoided > 0 ? (float)gpuStats.numDrawCalls / (float)(gpuStats.numFlushes + gpuStats.numFlushesAvoided) : 0.0f,
 		gpuStats.numCachedDrawCalls,
 		gpuStats.numTrackedVertexArrays,
+		gpuStats.numDecodedVertexCacheHits,
+		gpuStats.numDecodedVertexCacheMisses,
+		gpuStats.numDecodedVertexCacheEntries,
+		gpuStats.decodedVertexCacheBytes / 1024,
 		gpuStats.numVertsSubmitted,
 		gpuStats.numCachedVertsDrawn,
 		gpuStats.numUncachedVertsDrawn,
@@ -1673,6 +1752,7 @@ size_t GPUCommonHW::FormatGPUStatsCommon(char *buffer, size_t size) {
 		gpuStats.numFramebufferEvaluations,
 		(int)textureCache_->NumLoadedTextures(),
 		gpuStats.numTexturesDecoded,
+		gpuStats.numTexturesPartiallyUpdated,
 		gpuStats.numTextureInvalidations,
 		gpuStats.numTextureDataBytesHashed / 1024,
 		gpuStats.numBlockingReadbacks,
@@ -71,6 +71,7 @@ class GPUCommonHW : public GPUCommon {
 private:
 	void CheckDepthUsage(VirtualFramebuffer *vfb) override;
 	void CheckFlushOp(int cmd, u32 diff);
+	bool ChangeBreaksBatch(int cmd);
 
 protected:
 	size_t FormatGPUStatsCommon(char *buf, size_t size);
@@ -97,8 +97,8 @@ static inline void DrawBinItem(const BinItem &item, const RasterizerState &state
 
 class DrawBinItemsTask : public Task {
 public:
-	DrawBinItemsTask(BinWaitable *notify, BinManager::BinItemQueue &items, std::atomic<bool> &status, const BinManager::BinStateQueue &states)
-		: notify_(notify), items_(items), status_(status), states_(states) {
+	DrawBinItemsTask(BinWaitable *notify, BinManager::BinItemQueue &items, std::atomic<bool> &status, std::atomic<int64_t> &timeUs, const BinManager::BinStateQueue &states)
+		: notify_(notify), items_(items), status_(status), timeUs_(timeUs), states_(states) {
 	}
 
 	TaskType Type() const override {
@@ -111,10 +111,21 @@ class DrawBinItemsTask : public Task {
 	}
 
 	void Run() override {
-		ProcessItems();
-		status_ = false;
-		// In case of any atomic issues, do another pass.
-		ProcessItems();
+		// The flag may change on another thread, so check it once.
+		const bool collectStats = coreCollectDebugStats;
+		double st = 0.0;
+		if (collectStats)
+			st = time_now_d();
+
+		// Any thread may run us now, so only process items while we hold status_.
+		// If more arrived after we let go and no new task claimed them, take them back.
+		do {
+			ProcessItems();
+			status_ = false;
+		} while (!items_.Empty() && !status_.exchange(true));
+
+		if (collectStats)
+			timeUs_ += (int64_t)((time_now_d() - st) * 1000000.0);
 		notify_->Drain();
 	}
 
@@ -134,6 +145,7 @@ class DrawBinItemsTask : public Task {
 	BinWaitable *notify_;
 	BinManager::BinItemQueue &items_;
 	std::atomic<bool> &status_;
+	std::atomic<int64_t> &timeUs_;
 	const BinManager::BinStateQueue &states_;
 };
 
@@ -148,16 +160,19 @@ BinManager::BinManager() {
 	waitable_ = new BinWaitable();
 	for (auto &s : taskStatus_)
 		s = false;
+	for (auto &t : taskTimeUs_)
+		t = 0;
 
-	int maxInitTasks = std::min(g_threadManager.GetNumLooperThreads(), MAX_POSSIBLE_TASKS);
-	for (int i = 0; i < maxInitTasks; ++i) {
+	numTaskQueues_ = std::min(g_threadManager.GetNumLooperThreads() * MAX_BINS_PER_TASK, MAX_POSSIBLE_TASKS);
+	for (int i = 0; i < numTaskQueues_; ++i) {
 		taskQueues_[i].Setup();
 		for (DrawBinItemsTask *&task : taskLists_[i].tasks)
-			task = new DrawBinItemsTask(waitable_, taskQueues_[i], taskStatus_[i], states_);
+			task = new DrawBinItemsTask(waitable_, taskQueues_[i], taskStatus_[i], taskTimeUs_[i], states_);
 	}
 	states_.Setup();
 	cluts_.Setup();
 	queue_.Setup();
+	ResetDepthTiles();
 }
 
 BinManager::~BinManager() {
@@ -186,7 +201,10 @@ void BinManager::UpdateState() {
 
 	if (lastFlipstats_ != gpuStats.numFlips) {
 		lastFlipstats_ = gpuStats.numFlips;
+		UpdateBinSizing();
 		ResetStats();
+		// SoftGPU also resets these whenever the CPU runs, this is just in case.
+		ResetDepthTiles();
 	}
 
 	const auto &state = State();
@@ -209,6 +227,7 @@ void BinManager::UpdateState() {
 
 		// Okay, now update what's pending.
 		MarkPendingWrites(state);
+		UpdateDepthTilesTarget();
 
 		ClearDirty(SoftDirty::BINNER_RANGE);
 	} else if (pendingOverlap_) {
@@ -391,10 +410,17 @@ void BinManager::AddTriangle(const VertexData &v0, const VertexData &v1, const V
 	if (range.Invalid())
 		return;
 
+	const int zmin = std::min(std::min(v0.screenpos.z, v1.screenpos.z), v2.screenpos.z);
+	const int zmax = std::max(std::max(v0.screenpos.z, v1.screenpos.z), v2.screenpos.z);
+	if (RejectByDepthTiles(range, zmin, zmax))
+		return;
+
 	if (queue_.Full())
 		Drain();
 	queue_.Push(BinItem{ BinItemType::TRIANGLE, stateIndex_, range, v0, v1, v2 });
 	CalculateRasterStateFlags(&states_[stateIndex_], v0, v1, v2);
+	if (State().pixelID.depthWrite)
+		WidenDepthTiles(range, zmin, zmax);
 	Expand(range);
 }
 
@@ -407,6 +433,8 @@ void BinManager::AddClearRect(const VertexData &v0, const VertexData &v1) {
 		Drain();
 	queue_.Push(BinItem{ BinItemType::CLEAR_RECT, stateIndex_, range, v0, v1 });
 	CalculateRasterStateFlags(&states_[stateIndex_], v0, v1, true);
+	if (State().pixelID.DepthClear())
+		ClearDepthTiles(v0, v1, range);
 	Expand(range);
 }
 
@@ -415,10 +443,17 @@ void BinManager::AddRect(const VertexData &v0, const VertexData &v1) {
 	if (range.Invalid())
 		return;
 
+	const int zmin = std::min(v0.screenpos.z, v1.screenpos.z);
+	const int zmax = std::max(v0.screenpos.z, v1.screenpos.z);
+	if (RejectByDepthTiles(range, zmin, zmax))
+		return;
+
 	if (queue_.Full())
 		Drain();
 	queue_.Push(BinItem{ BinItemType::RECT, stateIndex_, range, v0, v1 });
 	CalculateRasterStateFlags(&states_[stateIndex_], v0, v1, true);
+	if (State().pixelID.depthWrite)
+		WidenDepthTiles(range, zmin, zmax);
 	Expand(range);
 }
 
@@ -427,10 +462,17 @@ void BinManager::AddSprite(const VertexData &v0, const VertexData &v1) {
 	if (range.Invalid())
 		return;
 
+	const int zmin = std::min(v0.screenpos.z, v1.screenpos.z);
+	const int zmax = std::max(v0.screenpos.z, v1.screenpos.z);
+	if (RejectByDepthTiles(range, zmin, zmax))
+		return;
+
 	if (queue_.Full())
 		Drain();
 	queue_.Push(BinItem{ BinItemType::SPRITE, stateIndex_, range, v0, v1 });
 	CalculateRasterStateFlags(&states_[stateIndex_], v0, v1, true);
+	if (State().pixelID.depthWrite)
+		WidenDepthTiles(range, zmin, zmax);
 	Expand(range);
 }
 
@@ -443,6 +485,8 @@ void BinManager::AddLine(const VertexData &v0, const VertexData &v1) {
 		Drain();
 	queue_.Push(BinItem{ BinItemType::LINE, stateIndex_, range, v0, v1 });
 	CalculateRasterStateFlags(&states_[stateIndex_], v0, v1, false);
+	if (State().pixelID.depthWrite)
+		WidenDepthTiles(range, std::min(v0.screenpos.z, v1.screenpos.z), std::max(v0.screenpos.z, v1.screenpos.z));
 	Expand(range);
 }
 
@@ -455,6 +499,8 @@ void BinManager::AddPoint(const VertexData &v0) {
 		Drain();
 	queue_.Push(BinItem{ BinItemType::POINT, stateIndex_, range, v0 });
 	CalculateRasterStateFlags(&states_[stateIndex_], v0);
+	if (State().pixelID.depthWrite)
+		WidenDepthTiles(range, v0.screenpos.z, v0.screenpos.z);
 	Expand(range);
 }
 
@@ -478,16 +524,17 @@ void BinManager::Drain(bool flushing) {
 				maxTasks_ = std::min(g_threadManager.GetNumLooperThreads(), MAX_POSSIBLE_TASKS);
 		}
 
+		const int bins = std::min(maxTasks_ == 1 ? 1 : maxTasks_ * binsPerTask_, numTaskQueues_);
 		taskRanges_.clear();
 		if (h2 >= 18 && w2 >= h2 * 4) {
-			int bin_w = std::max(4, (w2 + maxTasks_ - 1) / maxTasks_) * SCREEN_SCALE_FACTOR * 2;
+			int bin_w = std::max(4, (w2 + bins - 1) / bins) * SCREEN_SCALE_FACTOR * 2;
 			taskRanges_.push_back(BinCoords{ tl.x, tl.y, queueRange_.x1 + bin_w - 1, br.y - 1 });
 			for (int x = queueRange_.x1 + bin_w; x <= queueRange_.x2; x += bin_w) {
 				int x2 = x + bin_w > queueRange_.x2 ? br.x : x + bin_w;
 				taskRanges_.push_back(BinCoords{ x, tl.y, x2 - 1, br.y - 1 });
 			}
 		} else if (h2 >= 18 && w2 >= 18) {
-			int bin_h = std::max(4, (h2 + maxTasks_ - 1) / maxTasks_) * SCREEN_SCALE_FACTOR * 2;
+			int bin_h = std::max(4, (h2 + bins - 1) / bins) * SCREEN_SCALE_FACTOR * 2;
 			taskRanges_.push_back(BinCoords{ tl.x, tl.y, br.x - 1, queueRange_.y1 + bin_h - 1 });
 			for (int y = queueRange_.y1 + bin_h; y <= queueRange_.y2; y += bin_h) {
 				int y2 = y + bin_h > queueRange_.y2 ? br.y : y + bin_h;
@@ -532,6 +579,7 @@ void BinManager::Drain(bool flushing) {
 				taskItem = item;
 				taskItem.range = range;
 				taskQueues_[i].PushPeeked();
+				taskPixels_[i] += ((range.x2 - range.x1 + 1) * (range.y2 - range.y1 + 1)) / (SCREEN_SCALE_FACTOR * SCREEN_SCALE_FACTOR);
 			}
 			queue_.SkipNext();
 			if (--max <= 0)
@@ -543,12 +591,12 @@ void BinManager::Drain(bool flushing) {
 			if (taskQueues_[i].Empty())
 				continue;
 			threads++;
-			if (taskStatus_[i])
+			if (taskStatus_[i].exchange(true))
 				continue;
 
+			// Not pinned to a thread, so whichever is idle first picks up the next bin.
 			waitable_->Fill();
-			taskStatus_[i] = true;
-			g_threadManager.EnqueueTaskOnThread(i, taskLists_[i].Next());
+			g_threadManager.EnqueueTask(taskLists_[i].Next());
 			enqueues_++;
 		}
 
@@ -700,12 +748,49 @@ void BinManager::GetStats(char *buffer, size_t bufsize) {
 		"Slowest frame flush: %s (%0.4f)\n"
 		"Slowest recent flush: %s (%0.4f)\n"
 		"Total flush time: %0.4f (%05.2f%%, last 2: %05.2f%%)\n"
-		"Thread enqueues: %d, count %d",
+		"Thread enqueues: %d, count %d\n"
+		"Bins per thread: %d, est. pixels max %d avg %d, time max %0.4f avg %0.4f\n"
+		"Depth tile rejects: %d",
 		slowestFlushReason_, slowestFlushTime_,
 		slowestTotalReason, slowestTotalTime,
 		slowestRecentReason, slowestRecentTime,
 		allTotal, allTotal * (6000.0 / 1.001), recentTotal * (3000.0 / 1.001),
-		enqueues_, mostThreads_);
+		enqueues_, mostThreads_,
+		binsPerTask_, (int)lastPixelsMax_, (int)lastPixelsAvg_, lastTimeMax_, lastTimeAvg_,
+		depthTileRejects_);
+}
+
+void BinManager::UpdateBinSizing() {
+	uint64_t pixelsTotal = 0;
+	int64_t timeTotal = 0;
+	int used = 0;
+	lastPixelsMax_ = 0;
+	lastTimeMax_ = 0.0;
+	for (int i = 0; i < numTaskQueues_; ++i) {
+		const int64_t timeUs = taskTimeUs_[i].exchange(0);
+		if (taskPixels_[i] == 0)
+			continue;
+		used++;
+		pixelsTotal += taskPixels_[i];
+		timeTotal += timeUs;
+		lastPixelsMax_ = std::max(lastPixelsMax_, taskPixels_[i]);
+		lastTimeMax_ = std::max(lastTimeMax_, timeUs / 1000000.0);
+		taskPixels_[i] = 0;
+	}
+	if (used <= 1) {
+		lastPixelsAvg_ = pixelsTotal;
+		lastTimeAvg_ = timeTotal / 1000000.0;
+		return;
+	}
+
+	lastPixelsAvg_ = pixelsTotal / used;
+	lastTimeAvg_ = (timeTotal / used) / 1000000.0;
+
+	// Use smaller bins when one got much more work than the rest last frame, and go back when even.
+	if (lastPixelsMax_ * 2 > lastPixelsAvg_ * 3)
+		binsPerTask_ = std::min(binsPerTask_ * 2, MAX_BINS_PER_TASK);
+	else if (lastPixelsMax_ * 5 < lastPixelsAvg_ * 6)
+		binsPerTask_ = std::max(binsPerTask_ / 2, 1);
 }
 
 void BinManager::ResetStats() {
@@ -715,6 +800,7 @@ void BinManager::ResetStats() {
 	slowestFlushTime_ = 0.0;
 	enqueues_ = 0;
 	mostThreads_ = 0;
+	depthTileRejects_ = 0;
 }
 
 inline BinCoords BinCoords::Intersect(const BinCoords &range) const {
@@ -770,3 +856,165 @@ void BinManager::Expand(const BinCoords &range) {
 			Drain();
 	}
 }
+
+BinCoords BinManager::DepthTileRange(const BinCoords &range) {
+	constexpr int shift = DEPTH_TILE_SHIFT + 4;
+	static_assert(SCREEN_SCALE_FACTOR == 16, "Depth tile shift assumes the scale factor");
+
+	BinCoords tiles;
+	tiles.x1 = std::min(std::max(range.x1, 0) >> shift, DEPTH_TILES_PER_ROW - 1);
+	tiles.y1 = std::min(std::max(range.y1, 0) >> shift, DEPTH_TILES_PER_ROW - 1);
+	tiles.x2 = std::min(std::max(range.x2, 0) >> shift, DEPTH_TILES_PER_ROW - 1);
+	tiles.y2 = std::min(std::max(range.y2, 0) >> shift, DEPTH_TILES_PER_ROW - 1);
+	return tiles;
+}
+
+void BinManager::ResetDepthTiles() {
+	for (DepthTile &tile : depthTiles_) {
+		tile.minz = 0;
+		tile.maxz = 0xFFFF;
+	}
+	depthTilesRowEnd_ = 0;
+}
+
+void BinManager::UpdateDepthTilesTarget() {
+	const uint32_t zaddr = gstate.getDepthBufRawAddress();
+	const uint32_t zstride = gstate.DepthBufStride();
+	if (zaddr != depthTilesAddr_ || zstride != depthTilesStride_) {
+		ResetDepthTiles();
+		depthTilesAddr_ = zaddr;
+		depthTilesStride_ = zstride;
+	}
+
+	const int scissorX2 = std::min(gstate.getScissorX2(), gstate.getRegionX2());
+	const int scissorY2 = std::min(gstate.getScissorY2(), gstate.getRegionY2());
+	const uint32_t colorRows = scissorY2 + 1;
+	const uint32_t depthRows = std::max(depthTilesRowEnd_, ((scissorY2 >> DEPTH_TILE_SHIFT) + 1) << DEPTH_TILE_SHIFT);
+
+	// Tiles map to depth memory by x and y, so drawing past the stride would alias other rows.
+	// Color written into the depth buffer (e.g. to copy or reinterpret it) also can't be tracked.
+	const uint32_t colorStart = gstate.getFrameBufRawAddress();
+	const uint32_t colorEnd = colorStart + gstate.FrameBufStride() * (gstate.FrameBufFormat() == GE_FORMAT_8888 ? 4 : 2) * colorRows;
+	const uint32_t depthEnd = zaddr + zstride * 2 * depthRows;
+	depthTilesBlocked_ = scissorX2 >= (int)zstride || (colorStart < depthEnd && zaddr < colorEnd);
+	if (depthTilesBlocked_)
+		ResetDepthTiles();
+}
+
+void BinManager::InvalidateDepthTiles(uint32_t addr, uint32_t bytes) {
+	if (depthTilesRowEnd_ == 0)
+		return;
+	if (bytes >= 0x00200000) {
+		ResetDepthTiles();
+		return;
+	}
+
+	// Any VRAM mirror may alias the depth buffer.
+	if ((addr & 0x3F800000) != 0x04000000)
+		return;
+	const uint32_t start = addr & 0x001FFFFF;
+	const uint32_t depthEnd = depthTilesAddr_ + depthTilesStride_ * 2 * depthTilesRowEnd_;
+	if (start + bytes > 0x00200000 || (start < depthEnd && depthTilesAddr_ < start + bytes))
+		ResetDepthTiles();
+}
+
+bool BinManager::RejectByDepthTiles(const BinCoords &range, int zmin, int zmax) {
+	const auto &pixelID = State().pixelID;
+	// We can only skip primitives when failing the depth test has no other side effects.
+	if (pixelID.clearMode || !pixelID.earlyZChecks)
+		return false;
+
+	const GEComparison func = pixelID.DepthTestFunc();
+	if (func == GE_COMP_NEVER) {
+		depthTileRejects_++;
+		return true;
+	}
+
+	const BinCoords tiles = DepthTileRange(range);
+	if (((tiles.y2 + 1) << DEPTH_TILE_SHIFT) > depthTilesRowEnd_)
+		return false;
+
+	// Interpolated depth may round a step past the vertex values.
+	zmin = std::max(zmin - 1, 0);
+	zmax = std::min(zmax + 1, 0xFFFF);
+
+	for (int y = tiles.y1; y <= tiles.y2; ++y) {
+		for (int x = tiles.x1; x <= tiles.x2; ++x) {
+			const DepthTile &tile = depthTiles_[y * DEPTH_TILES_PER_ROW + x];
+			bool fails;
+			switch (func) {
+			case GE_COMP_EQUAL: fails = zmax < tile.minz || zmin > tile.maxz; break;
+			case GE_COMP_LESS: fails = zmin >= tile.maxz; break;
+			case GE_COMP_LEQUAL: fails = zmin > tile.maxz; break;
+			case GE_COMP_GREATER: fails = zmax <= tile.minz; break;
+			case GE_COMP_GEQUAL: fails = zmax < tile.minz; break;
+			default: fails = false; break;
+			}
+			if (!fails)
+				return false;
+		}
+	}
+
+	depthTileRejects_++;
+	return true;
+}
+
+void BinManager::WidenDepthTiles(const BinCoords &range, int zmin, int zmax) {
+	const BinCoords tiles = DepthTileRange(range);
+	if ((tiles.y1 << DEPTH_TILE_SHIFT) >= depthTilesRowEnd_)
+		return;
+
+	const uint16_t tileMin = (uint16_t)std::max(zmin - 1, 0);
+	const uint16_t tileMax = (uint16_t)std::min(zmax + 1, 0xFFFF);
+	for (int y = tiles.y1; y <= tiles.y2; ++y) {
+		for (int x = tiles.x1; x <= tiles.x2; ++x) {
+			DepthTile &tile = depthTiles_[y * DEPTH_TILES_PER_ROW + x];
+			tile.minz = std::min(tile.minz, tileMin);
+			tile.maxz = std::max(tile.maxz, tileMax);
+		}
+	}
+}
+
+void BinManager::ClearDepthTiles(const VertexData &v0, const VertexData &v1, const BinCoords &range) {
+	const uint16_t z = v1.screenpos.z;
+	if (depthTilesBlocked_) {
+		WidenDepthTiles(range, z, z);
+		return;
+	}
+
+	// This matches the pixels ClearRectangle() fills.
+	int entireX1 = std::min(v0.screenpos.x, v1.screenpos.x);
+	int entireY1 = std::min(v0.screenpos.y, v1.screenpos.y);
+	int entireX2 = std::max(v0.screenpos.x, v1.screenpos.x) - 1;
+	int entireY2 = std::max(v0.screenpos.y, v1.screenpos.y) - 1;
+	int minX = std::max(entireX1 & ~(SCREEN_SCALE_FACTOR - 1), range.x1) | (SCREEN_SCALE_FACTOR / 2 - 1);
+	int minY = std::max(entireY1 & ~(SCREEN_SCALE_FACTOR - 1), range.y1) | (SCREEN_SCALE_FACTOR / 2 - 1);
+	int maxX = std::min(entireX2, range.x2);
+	int maxY = std::min(entireY2, range.y2);
+	if (minX < entireX1 - 1)
+		minX += SCREEN_SCALE_FACTOR;
+	if (minY < entireY1 - 1)
+		minY += SCREEN_SCALE_FACTOR;
+
+	const DrawingCoords pprime = TransformUnit::ScreenToDrawing(minX, minY);
+	const DrawingCoords pend = TransformUnit::ScreenToDrawing(maxX - SCREEN_SCALE_FACTOR / 2, maxY - SCREEN_SCALE_FACTOR / 2);
+	if (pend.x < pprime.x || pend.y < pprime.y)
+		return;
+
+	constexpr int tileSize = 1 << DEPTH_TILE_SHIFT;
+	const BinCoords tiles = DepthTileRange(range);
+	for (int y = tiles.y1; y <= tiles.y2; ++y) {
+		const bool fullY = y * tileSize >= pprime.y && y * tileSize + tileSize - 1 <= pend.y;
+		for (int x = tiles.x1; x <= tiles.x2; ++x) {
+			DepthTile &tile = depthTiles_[y * DEPTH_TILES_PER_ROW + x];
+			if (fullY && x * tileSize >= pprime.x && x * tileSize + tileSize - 1 <= pend.x) {
+				tile.minz = z;
+				tile.maxz = z;
+				depthTilesRowEnd_ = std::max(depthTilesRowEnd_, (y + 1) * tileSize);
+			} else {
+				tile.minz = std::min(tile.minz, z);
+				tile.maxz = std::max(tile.maxz, z);
+			}
+		}
+	}
+}
@@ -206,6 +206,9 @@ class BinManager {
 	bool HasPendingWrite(uint32_t start, uint32_t stride, uint32_t w, uint32_t h);
 	// Assumes you've also checked for a write (writes are partial so are automatically reads.)
 	bool HasPendingRead(uint32_t start, uint32_t stride, uint32_t w, uint32_t h);
+	// Forgets depth tile bounds for memory written outside of drawing (transfers, memcpy, etc.)
+	void InvalidateDepthTiles(uint32_t addr, uint32_t bytes);
+	void ResetDepthTiles();
 
 	void GetStats(char *buffer, size_t bufsize);
 	void ResetStats();
@@ -234,13 +237,24 @@ class BinManager {
 	static constexpr int QUEUED_STATES = 4096;
 	// These are 1KB each, so half an MB.
 	static constexpr int QUEUED_CLUTS = 512;
-	// About 360 KB, but we have usually 16 or less of them, so 5 MB - 22 MB.
+	// About 360 KB, but we have usually 32 or less of them, so 5 MB - 44 MB.
 	static constexpr int QUEUED_PRIMS = 2048;
+	// When load is uneven, we split into more bins than threads so idle threads can take the rest.
+	static constexpr int MAX_BINS_PER_TASK = 2;
 
 	typedef BinQueue<Rasterizer::RasterizerState, QUEUED_STATES> BinStateQueue;
 	typedef BinQueue<BinClut, QUEUED_CLUTS> BinClutQueue;
 	typedef BinQueue<BinItem, QUEUED_PRIMS> BinItemQueue;
 
+	// Depth bounds are kept per 32x32 tile of drawing space.
+	static constexpr int DEPTH_TILE_SHIFT = 5;
+	static constexpr int DEPTH_TILES_PER_ROW = 1024 >> DEPTH_TILE_SHIFT;
+
+	struct DepthTile {
+		uint16_t minz;
+		uint16_t maxz;
+	};
+
 private:
 	BinStateQueue states_;
 	BinClutQueue cluts_;
@@ -252,11 +266,17 @@ class BinManager {
 	SoftDirty dirty_ = SoftDirty::NONE;
 
 	int maxTasks_ = 1;
+	int binsPerTask_ = 1;
+	int numTaskQueues_ = 0;
 	bool tasksSplit_ = false;
 	std::vector<BinCoords> taskRanges_;
 	BinItemQueue taskQueues_[MAX_POSSIBLE_TASKS];
 	BinTaskList taskLists_[MAX_POSSIBLE_TASKS];
 	std::atomic<bool> taskStatus_[MAX_POSSIBLE_TASKS];
+	// Rough pixels binned and time spent (only with debug stats) per bin, for balancing.
+	// The pixels are bounding box areas summed across bin layouts, so only an estimate.
+	uint64_t taskPixels_[MAX_POSSIBLE_TASKS]{};
+	std::atomic<int64_t> taskTimeUs_[MAX_POSSIBLE_TASKS];
 	BinWaitable *waitable_ = nullptr;
 
 	BinDirtyRange pendingWrites_[2]{};
@@ -273,6 +293,19 @@ class BinManager {
 	int lastFlipstats_ = 0;
 	int enqueues_ = 0;
 	int mostThreads_ = 0;
+	uint64_t lastPixelsMax_ = 0;
+	uint64_t lastPixelsAvg_ = 0;
+	double lastTimeMax_ = 0.0;
+	double lastTimeAvg_ = 0.0;
+
+	// Conservative bounds for the values in the depth buffer, once all queued items are drawn.
+	// Only clears make a tile narrower than [0, 0xFFFF], so only rows up to depthTilesRowEnd_ matter.
+	DepthTile depthTiles_[DEPTH_TILES_PER_ROW * DEPTH_TILES_PER_ROW];
+	uint32_t depthTilesAddr_ = 0;
+	uint32_t depthTilesStride_ = 0;
+	int depthTilesRowEnd_ = 0;
+	bool depthTilesBlocked_ = true;
+	int depthTileRejects_ = 0;
 
 	void MarkPendingReads(const Rasterizer::RasterizerState &state);
 	void MarkPendingWrites(const Rasterizer::RasterizerState &state);
@@ -284,6 +317,12 @@ class BinManager {
 	BinCoords Range(const VertexData &v0, const VertexData &v1);
 	BinCoords Range(const VertexData &v0);
 	void Expand(const BinCoords &range);
+	void UpdateBinSizing();
+	static BinCoords DepthTileRange(const BinCoords &range);
+	void UpdateDepthTilesTarget();
+	bool RejectByDepthTiles(const BinCoords &range, int zmin, int zmax);
+	void WidenDepthTiles(const BinCoords &range, int zmin, int zmax);
+	void ClearDepthTiles(const VertexData &v0, const VertexData &v1, const BinCoords &range);
 
 	friend class DrawBinItemsTask;
 };
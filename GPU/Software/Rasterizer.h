@@ -116,4 +116,7 @@ void ClearRectangle(const VertexData &v0, const VertexData &v1, const BinCoords
 
 bool GetCurrentTexture(GPUDebugBuffer &buffer, int level);
 
+// Interpolates a vertex color at each pixel of a quad like DrawTriangle(), with AVX2 if allowed and available.
+void InterpolateQuadColors(Vec4<int> out[4], const Vec4<int> &c0, const Vec4<int> &c1, const Vec4<int> &c2, const Vec4<int> &w0, const Vec4<int> &w1, const Vec4<int> &w2, const Vec4<float> &wsum_recip, bool allowAVX2);
+
 }  // namespace Rasterizer
@@ -834,6 +834,7 @@ void SoftGPU::Execute_BlockTransferStart(u32 op, u32 diff) {
 	}
 
 	DoBlockTransfer(gstate_c.skipDrawReason);
+	drawEngine_->transformUnit.InvalidateDepthTiles(dst, dstSize + width * bpp);
 
 	// Could theoretically dirty the framebuffer.
 	MarkDirty(dst, dstSize, SoftGPUVRAMDirty::DIRTY | SoftGPUVRAMDirty::REALLY_DIRTY);
@@ -1040,6 +1041,8 @@ void SoftGPU::Execute_ZbufPtr(u32 op, u32 diff) {
 	// We assume depthbuf.data won't change while we're drawing.
 	if (diff) {
 		drawEngine_->transformUnit.Flush("depthbuf");
+		// Also happens when state is reapplied, i.e. after loading a save state.
+		drawEngine_->transformUnit.ResetDepthTiles();
 		depthbuf.data = Memory::GetPointerWrite(gstate.getDepthBufAddress());
 	}
 }
@@ -1256,17 +1259,21 @@ void SoftGPU::Execute_Call(u32 op, u32 diff) {
 void SoftGPU::FinishDeferred() {
 	// Need to flush before going back to CPU, so drawing is appropriately visible.
 	drawEngine_->transformUnit.Flush("finish");
+	// The CPU may store directly to the depth buffer before the list resumes or the next one starts.
+	drawEngine_->transformUnit.ResetDepthTiles();
 }
 
 int SoftGPU::ListSync(int listid, int mode) {
 	// Take this as a cue that we need to finish drawing.
 	drawEngine_->transformUnit.Flush("listsync");
+	drawEngine_->transformUnit.ResetDepthTiles();
 	return GPUCommon::ListSync(listid, mode);
 }
 
 u32 SoftGPU::DrawSync(int mode) {
 	// Take this as a cue that we need to finish drawing.
 	drawEngine_->transformUnit.Flush("drawsync");
+	drawEngine_->transformUnit.ResetDepthTiles();
 	return GPUCommon::DrawSync(mode);
 }
 
@@ -1276,12 +1283,16 @@ void SoftGPU::GetStats(char *buffer, size_t bufsize) {
 
 void SoftGPU::InvalidateCache(u32 addr, int size, GPUInvalidationType type)
 {
-	// Nothing to invalidate.
+	// Only the binner's depth bounds depend on memory contents.
+	if (type == GPU_INVALIDATE_ALL || size < 0)
+		drawEngine_->transformUnit.ResetDepthTiles();
+	else
+		drawEngine_->transformUnit.InvalidateDepthTiles(addr, size);
 }
 
 void SoftGPU::PerformWriteFormattedFromMemory(u32 addr, int size, int width, GEBufferFormat format)
 {
-	// Ignore.
+	InvalidateCache(addr, size, GPU_INVALIDATE_HINT);
 }
 
 bool SoftGPU::PerformMemoryCopy(u32 dest, u32 src, int size, GPUCopyFlag flags) {
@@ -23,6 +23,8 @@
 #include "Common/Math/math_util.h"
 #include "Common/MemoryUtil.h"
 #include "Common/Profiler/Profiler.h"
+#include "Common/Thread/ParallelLoop.h"
+#include "Common/Thread/ThreadManager.h"
 #include "Core/Config.h"
 #include "GPU/GPUState.h"
 #include "GPU/Common/DrawEngineCommon.h"
@@ -45,6 +47,8 @@ TransformUnit::TransformUnit() {
 	if (!decoded_)
 		return;
 	binner_ = new BinManager();
+	carry_.texturecoords = Vec3Packedf(0.0f, 0.0f, 0.0f);
+	carry_.normal = Vec3f(0.0f, 0.0f, 0.0f);
 }
 
 TransformUnit::~TransformUnit() {
@@ -357,28 +361,26 @@ static inline float Dot43(const Vec4f &a, const Vec3f &b) {
 	return Dot(a, Vec4f(b, 1.0f));
 }
 
-ClipVertexData TransformUnit::ReadVertex(const VertexReader &vreader, const TransformState &state) {
+// Called from worker threads for large draws, so this must only touch vreader, state, and carry.
+ClipVertexData TransformUnit::ReadVertex(const VertexReader &vreader, const TransformState &state, VertexCarry &carry) {
 	PROFILE_THIS_SCOPE("read_vert");
-	// If we ever thread this, we'll have to change this.
 	ClipVertexData vertex;
 
 	ModelCoords pos;
 	// VertexDecoder normally scales z, but we want it unscaled.
 	vreader.ReadPosThroughZ16(pos.AsArray());
 
-	static Vec3Packedf lastTC;
 	if (state.readUV) {
 		vreader.ReadUV(vertex.v.texturecoords.AsArray());
 		vertex.v.texturecoords.q() = 0.0f;
-		lastTC = vertex.v.texturecoords;
+		carry.texturecoords = vertex.v.texturecoords;
 	} else {
-		vertex.v.texturecoords = lastTC;
+		vertex.v.texturecoords = carry.texturecoords;
 	}
 
-	static Vec3f lastnormal;
 	if (vreader.hasNormal())
-		vreader.ReadNrm(lastnormal.AsArray());
-	Vec3f normal = lastnormal;
+		vreader.ReadNrm(carry.normal.AsArray());
+	Vec3f normal = carry.normal;
 	if (state.negateNormals)
 		normal = -normal;
 
@@ -498,7 +500,9 @@ class SoftwareVertexReader {
 
 		// If we're only using a subset of verts, it's better to decode with random access (usually.)
 		// However, if we're reusing a lot of verts, we should read and cache them.
-		useCache_ = useIndices_ && vertex_count > (upperBound_ - lowerBound_ + 1);
+		// Large draws are also read up front, so that the transform can be spread over threads.
+		const int rangeCount = upperBound_ - lowerBound_ + 1;
+		useCache_ = useIndices_ ? vertex_count > rangeCount : vertex_count >= MIN_VERTS_PER_TRANSFORM_TASK * 2;
 		if (useCache_ && cached_.size() < upperBound_ - lowerBound_ + 1)
 			cached_.resize(std::max(128, upperBound_ - lowerBound_ + 1));
 	}
@@ -515,23 +519,33 @@ class SoftwareVertexReader {
 		if (!useCache_)
 			return;
 
-		for (int i = 0; i < upperBound_ - lowerBound_ + 1; ++i) {
-			vreader_.Goto(i);
-			cached_[i] = transform_.ReadVertex(vreader_, transformState_);
-		}
+		// Each vertex only depends on the carry when it lacks UVs or normals, and then the carry is constant
+		// for the whole draw. So every range can start from the same carry, and the last range hands it on.
+		const int count = upperBound_ - lowerBound_ + 1;
+		const TransformUnit::VertexCarry startCarry = transform_.carry_;
+		ParallelRangeLoop(&g_threadManager, [&](int l, int h) {
+			VertexReader vreader = vreader_;
+			TransformUnit::VertexCarry carry = startCarry;
+			for (int i = l; i < h; ++i) {
+				vreader.Goto(i);
+				cached_[i] = transform_.ReadVertex(vreader, transformState_, carry);
+			}
+			if (h == count)
+				transform_.carry_ = carry;
+		}, 0, count, MIN_VERTS_PER_TRANSFORM_TASK);
 	}
 
 	inline ClipVertexData Read(int vtx) {
+		if (useCache_)
+			return cached_[useIndices_ ? conv_(vtx) - lowerBound_ : vtx];
+
 		if (useIndices_) {
-			if (useCache_) {
-				return cached_[conv_(vtx) - lowerBound_];
-			}
 			vreader_.Goto(conv_(vtx) - lowerBound_);
 		} else {
 			vreader_.Goto(vtx);
 		}
 
-		return transform_.ReadVertex(vreader_, transformState_);
+		return transform_.ReadVertex(vreader_, transformState_, transform_.carry_);
 	};
 
 protected:
@@ -542,6 +556,8 @@ class SoftwareVertexReader {
 	uint16_t lowerBound_;
 	uint16_t upperBound_;
 	static std::vector<ClipVertexData> cached_;
+	// Below this, the transform isn't worth handing to another thread.
+	static constexpr int MIN_VERTS_PER_TRANSFORM_TASK = 256;
 	bool useIndices_ = false;
 	bool useCache_ = false;
 };
@@ -920,6 +936,14 @@ void TransformUnit::NotifyClutUpdate(const void *src) {
 	binner_->UpdateClut(src);
 }
 
+void TransformUnit::InvalidateDepthTiles(uint32_t addr, uint32_t bytes) {
+	binner_->InvalidateDepthTiles(addr, bytes);
+}
+
+void TransformUnit::ResetDepthTiles() {
+	binner_->ResetDepthTiles();
+}
+
 // TODO: This probably is not the best interface.
 // Also, we should try to merge this into the similar function in DrawEngineCommon.
 bool TransformUnit::GetCurrentSimpleVertices(int count, std::vector<GPUDebugVertex> &vertices, std::vector<u16> &indices) {
@@ -144,6 +144,8 @@ class TransformUnit {
 	void Flush(const char *reason);
 	void FlushIfOverlap(const char *reason, bool modifying, uint32_t addr, uint32_t stride, uint32_t w, uint32_t h);
 	void NotifyClutUpdate(const void *src);
+	void InvalidateDepthTiles(uint32_t addr, uint32_t bytes);
+	void ResetDepthTiles();
 
 	void GetStats(char *buffer, size_t bufsize);
 
@@ -151,7 +153,13 @@ class TransformUnit {
 	SoftDirty GetDirty();
 
 private:
-	ClipVertexData ReadVertex(const VertexReader &vreader, const TransformState &state);
+	// Values carried over from earlier vertices, for vertex formats without UVs or normals.
+	struct VertexCarry {
+		Vec3Packedf texturecoords;
+		Vec3f normal;
+	};
+
+	ClipVertexData ReadVertex(const VertexReader &vreader, const TransformState &state, VertexCarry &carry);
 	void SendTriangle(CullType cullType, const ClipVertexData *verts, int provoking = 2);
 
 	u8 *decoded_ = nullptr;
@@ -162,6 +170,7 @@ class TransformUnit {
 	// This is the index of the next vert in data (or higher, may need modulus.)
 	int data_index_ = 0;
 	GEPrimitiveType prev_prim_ = GE_PRIM_POINTS;
+	VertexCarry carry_;
 	bool hasDraws_ = false;
 	bool isImmDraw_ = false;
 
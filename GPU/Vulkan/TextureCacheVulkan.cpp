@@ -36,6 +36,7 @@
 #include "Common/GPU/Vulkan/VulkanMemory.h"
 
 #include "Core/Config.h"
+#include "Core/Debugger/MemBlockInfo.h"
 #include "Core/MemMap.h"
 #include "Core/System.h"
 
@@ -107,6 +108,77 @@ void main() {
 
 )";
 
+// Decodes CLUT textures directly from the raw PSP texture data, so we only need to upload
+// the indices (4 or 8 bits per pixel in the common case) and the palette.
+const char *decodeShader = R"(
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+
+layout (local_size_x = 8, local_size_y = 8, local_size_z = 1) in;
+
+uniform layout(set = 0, binding = 0, rgba8) writeonly image2D img;
+
+layout(std430, set = 0, binding = 1) readonly buffer Tex {
+	uint data[];
+} tex;
+
+layout(std430, set = 0, binding = 2) readonly buffer Clut {
+	uint data[];
+} clut;
+
+layout(push_constant) uniform Params {
+	uint size;        // width | (height << 16)
+	uint bufw;        // in pixels
+	uint clutformat;  // the raw GE register
+	uint flags;       // bits per index | (swizzled << 8)
+} params;
+
+uint readIndex(uvec2 p, uint bits) {
+	uint bitOffset;
+	if ((params.flags & 0x100u) != 0u) {
+		// Swizzled textures are stored as 16 byte x 8 row blocks.
+		uint blocksPerRow = (params.bufw * bits) >> 7;
+		uint xBits = p.x * bits;
+		uint xByte = xBits >> 3;
+		uint byteOffset = ((p.y >> 3) * blocksPerRow + (xByte >> 4)) * 128u + (p.y & 7u) * 16u + (xByte & 15u);
+		bitOffset = byteOffset * 8u + (xBits & 7u);
+	} else {
+		bitOffset = (p.y * params.bufw + p.x) * bits;
+	}
+	uint word = tex.data[bitOffset >> 5];
+	if (bits == 32u)
+		return word;
+	return (word >> (bitOffset & 31u)) & ((1u << bits) - 1u);
+}
+
+vec4 lookupClut(uint index) {
+	uint palFormat = params.clutformat & 3u;
+	uint shift = (params.clutformat >> 2) & 0x1Fu;
+	uint mask = (params.clutformat >> 8) & 0xFFu;
+	uint start = ((params.clutformat >> 16) & 0x1Fu) << 4;
+	// Same as GPUgstate::transformClutIndex().
+	index = ((index >> shift) & mask) | (start & (palFormat == 3u ? 0xFFu : 0x1FFu));
+
+	if (palFormat == 3u)
+		return unpackUnorm4x8(clut.data[index]);
+
+	uint c = (clut.data[index >> 1] >> ((index & 1u) * 16u)) & 0xFFFFu;
+	if (palFormat == 0u)
+		return vec4(float(c & 0x1Fu) / 31.0, float((c >> 5) & 0x3Fu) / 63.0, float(c >> 11) / 31.0, 1.0);
+	if (palFormat == 1u)
+		return vec4(float(c & 0x1Fu) / 31.0, float((c >> 5) & 0x1Fu) / 31.0, float((c >> 10) & 0x1Fu) / 31.0, float(c >> 15));
+	return vec4(float(c & 0xFu) / 15.0, float((c >> 4) & 0xFu) / 15.0, float((c >> 8) & 0xFu) / 15.0, float(c >> 12) / 15.0);
+}
+
+void main() {
+	uvec2 xy = gl_GlobalInvocationID.xy;
+	if (xy.x >= (params.size & 0xFFFFu) || xy.y >= (params.size >> 16))
+		return;
+	uint bits = params.flags & 0xFFu;
+	imageStore(img, ivec2(xy), lookupClut(readIndex(xy, bits)));
+}
+)";
+
 static int VkFormatBytesPerPixel(VkFormat format) {
 	switch (format) {
 	case VULKAN_8888_FORMAT: return 4;
@@ -222,6 +294,8 @@ void TextureCacheVulkan::DeviceLost() {
 
 	if (uploadCS_ != VK_NULL_HANDLE)
 		vulkan->Delete().QueueDeleteShaderModule(uploadCS_);
+	if (decodeCS_ != VK_NULL_HANDLE)
+		vulkan->Delete().QueueDeleteShaderModule(decodeCS_);
 
 	computeShaderManager_.DeviceLost();
 
@@ -249,6 +323,7 @@ void TextureCacheVulkan::DeviceRestore(Draw::DrawContext *draw) {
 	_assert_(res == VK_SUCCESS);
 
 	CompileScalingShader();
+	CompileDecodeShader();
 
 	computeShaderManager_.DeviceRestore(draw);
 }
@@ -301,6 +376,155 @@ void TextureCacheVulkan::CompileScalingShader() {
 	shaderScaleFactor_ = shaderInfo->scaleFactor;
 }
 
+void TextureCacheVulkan::CompileDecodeShader() {
+	VulkanContext *vulkan = (VulkanContext *)draw_->GetNativeObject(Draw::NativeObject::CONTEXT);
+
+	std::string error;
+	decodeCS_ = CompileShaderModule(vulkan, VK_SHADER_STAGE_COMPUTE_BIT, decodeShader, &error);
+	if (decodeCS_ == VK_NULL_HANDLE) {
+		// Not fatal, we'll just decode on the CPU.
+		ERROR_LOG(G3D, "Failed to compile texture decode shader: %s", error.c_str());
+	}
+}
+
+static int GPUDecodeBitsPerIndex(GETextureFormat format) {
+	switch (format) {
+	case GE_TFMT_CLUT4: return 4;
+	case GE_TFMT_CLUT8: return 8;
+	case GE_TFMT_CLUT16: return 16;
+	case GE_TFMT_CLUT32: return 32;
+	default: return 0;
+	}
+}
+
+static bool IsTextureSwizzledAt(u32 texaddr) {
+	bool swizzled = gstate.isTextureSwizzled();
+	// See DecodeTextureLevel(), the swizzled VRAM mirror flips this.
+	if ((texaddr & 0x00600000) != 0 && Memory::IsVRAMAddress(texaddr) && (texaddr & 0x00200000) == 0x00200000) {
+		swizzled = !swizzled;
+	}
+	return swizzled;
+}
+
+static u32 GPUDecodeSourceSize(int bitsPerIndex, int bufw, int h, bool swizzled) {
+	if (swizzled) {
+		h = (h + 7) & ~7;
+	}
+	return (bufw * h * bitsPerIndex) / 8;
+}
+
+// Offset (in palette entries) of the CLUT used for a mip level, matching DecodeTextureLevel() and ReadIndexedTex().
+static int ClutSharingOffset(GETextureFormat format, int level) {
+	if (format == GE_TFMT_CLUT4) {
+		return gstate.isClutSharedForMipmaps() ? 0 : level * 16;
+	}
+	const bool mipmapShareClut = gstate.isClutSharedForMipmaps() || gstate.getClutLoadBlocks() != 0x40;
+	return mipmapShareClut ? 0 : (level & 1) * 256;
+}
+
+bool TextureCacheVulkan::CanDecodeOnGPU(const TexCacheEntry *entry, const BuildTexturePlan &plan) const {
+	if (!g_Config.bTexGPUDecode || decodeCS_ == VK_NULL_HANDLE)
+		return false;
+	// Non-CLUT textures are the same size raw as decoded, so there's nothing to gain.
+	GETextureFormat format = (GETextureFormat)entry->format;
+	if (!IsClutFormat(format))
+		return false;
+	if (plan.doReplace || plan.saveTexture || plan.scaleFactor > 1 || plan.depth != 1 || plan.decodeToClut8)
+		return false;
+	if (entry->status & TexCacheEntry::STATUS_CLUT_GPU)
+		return false;
+
+	const int bits = GPUDecodeBitsPerIndex(format);
+	for (int i = 0; i < plan.levelsToLoad; i++) {
+		int level = i == 0 ? plan.baseLevelSrc : i;
+		u32 texaddr = gstate.getTextureAddress(level);
+		int w = gstate.getTextureWidth(level);
+		int h = gstate.getTextureHeight(level);
+		int bufw = GetTextureBufw(level, texaddr, format);
+		// Keep it simple, the CPU path handles the odd cases.
+		if (w > bufw || ((bufw * bits) & 127) != 0)
+			return false;
+		if (!Memory::IsValidRange(texaddr, GPUDecodeSourceSize(bits, bufw, h, IsTextureSwizzledAt(texaddr))))
+			return false;
+	}
+	return true;
+}
+
+void TextureCacheVulkan::DecodeTextureLevelOnGPU(VkCommandBuffer cmd, TexCacheEntry *entry, VkImageView view, int srcLevel) {
+	VulkanContext *vulkan = (VulkanContext *)draw_->GetNativeObject(Draw::NativeObject::CONTEXT);
+	VulkanPushPool *pushBuffer = drawEngine_->GetPushBufferForTextureData();
+
+	GETextureFormat format = (GETextureFormat)entry->format;
+	const int w = gstate.getTextureWidth(srcLevel);
+	const int h = gstate.getTextureHeight(srcLevel);
+	const u32 texaddr = gstate.getTextureAddress(srcLevel);
+	const int bufw = GetTextureBufw(srcLevel, texaddr, format);
+	const int bits = GPUDecodeBitsPerIndex(format);
+	const bool swizzled = IsTextureSwizzledAt(texaddr);
+	const u32 srcSize = GPUDecodeSourceSize(bits, bufw, h, swizzled);
+
+	char buf[128];
+	size_t len = snprintf(buf, sizeof(buf), "Tex_%08x_%dx%d_%s", texaddr, w, h, GeTextureFormatToString(format, gstate.getClutPaletteFormat()));
+	NotifyMemInfo(MemBlockFlags::TEXTURE, texaddr, srcSize, buf, len);
+
+	const int storageAlign = (int)vulkan->GetPhysicalDeviceProperties().properties.limits.minStorageBufferOffsetAlignment;
+	VkBuffer texBuf, clutBuf;
+	uint32_t texOffset, clutOffset;
+	texOffset = (uint32_t)pushBuffer->Push(Memory::GetPointerUnchecked(texaddr), srcSize, std::max(16, storageAlign), &texBuf);
+
+	// Even with the start position, a CLUT index can only reach the first 1KB past the sharing offset.
+	const u32 clutEntryBytes = gstate.getClutPaletteFormat() == GE_CMODE_32BIT_ABGR8888 ? 4 : 2;
+	const u8 *clut = (const u8 *)clutBufRaw_ + ClutSharingOffset(format, srcLevel) * clutEntryBytes;
+	clutOffset = (uint32_t)pushBuffer->Push(clut, 1024, std::max(16, storageAlign), &clutBuf);
+
+	VkDescriptorSet descSet = computeShaderManager_.GetDescriptorSet(view, texBuf, texOffset, srcSize, clutBuf, clutOffset, 1024);
+	struct Params { u32 size; u32 bufw; u32 clutformat; u32 flags; } params{
+		(u32)w | ((u32)h << 16), (u32)bufw, gstate.clutformat & 0x00FFFFFF, (u32)bits | (swizzled ? 0x100 : 0),
+	};
+	VK_PROFILE_BEGIN(vulkan, cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, "Compute Decode: %dx%d %s", w, h, GeTextureFormatToString(format));
+	vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, computeShaderManager_.GetPipeline(decodeCS_));
+	vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, computeShaderManager_.GetPipelineLayout(), 0, 1, &descSet, 0, nullptr);
+	vkCmdPushConstants(cmd, computeShaderManager_.GetPipelineLayout(), VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(params), &params);
+	vkCmdDispatch(cmd, (w + 7) / 8, (h + 7) / 8, 1);
+	VK_PROFILE_END(vulkan, cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+
+	entry->SetAlphaStatus(CheckClutAlpha(format, srcLevel), srcLevel);
+}
+
+// We never see the decoded pixels here, so look at every CLUT entry the texture could reach instead.
+// That's a bit more pessimistic than the CPU path, which only checks the entries actually used.
+CheckAlphaResult TextureCacheVulkan::CheckClutAlpha(GETextureFormat format, int level) const {
+	const GEPaletteFormat palFormat = gstate.getClutPaletteFormat();
+	const int clutOffset = ClutSharingOffset(format, level);
+	const int numIndices = format == GE_TFMT_CLUT4 ? 16 : 256;
+	// The wider index formats can reach any value after the shift, so walk the post-shift values instead.
+	// The mask is at most 0xFF, so 256 of those cover everything.
+	const bool wideIndex = format == GE_TFMT_CLUT16 || format == GE_TFMT_CLUT32;
+	const int shift = wideIndex ? gstate.getClutIndexShift() : 0;
+
+	if (palFormat == GE_CMODE_32BIT_ABGR8888) {
+		const u32 *clut = (const u32 *)clutBufRaw_ + clutOffset;
+		for (int i = 0; i < numIndices; ++i) {
+			if ((clut[gstate.transformClutIndex((u32)i << shift)] & 0xFF000000) != 0xFF000000)
+				return CHECKALPHA_ANY;
+		}
+		return CHECKALPHA_FULL;
+	}
+
+	u16 fullAlphaMask;
+	switch (palFormat) {
+	case GE_CMODE_16BIT_ABGR4444: fullAlphaMask = 0xF000; break;
+	case GE_CMODE_16BIT_ABGR5551: fullAlphaMask = 0x8000; break;
+	default: return CHECKALPHA_FULL;
+	}
+	const u16 *clut = (const u16 *)clutBufRaw_ + clutOffset;
+	for (int i = 0; i < numIndices; ++i) {
+		if ((clut[gstate.transformClutIndex((u32)i << shift)] & fullAlphaMask) != fullAlphaMask)
+			return CHECKALPHA_ANY;
+	}
+	return CHECKALPHA_FULL;
+}
+
 void TextureCacheVulkan::ReleaseTexture(TexCacheEntry *entry, bool delete_them) {
 	delete entry->vkTex;
 	entry->vkTex = nullptr;
@@ -434,6 +658,12 @@ void TextureCacheVulkan::BuildTexture(TexCacheEntry *const entry) {
 
 	VkFormat dstFmt = GetDestFormat(GETextureFormat(entry->format), gstate.getClutPaletteFormat());
 
+	// CLUT textures can be uploaded raw and decoded by a compute shader, which writes 8888.
+	bool gpuDecode = CanDecodeOnGPU(entry, plan);
+	if (gpuDecode) {
+		dstFmt = VULKAN_8888_FORMAT;
+	}
+
 	if (plan.scaleFactor > 1) {
 		_dbg_assert_(!plan.doReplace);
 		// Whether hardware or software scaling, this is the dest format.
@@ -493,7 +723,7 @@ void TextureCacheVulkan::BuildTexture(TexCacheEntry *const entry) {
 		}
 	}
 
-	if (computeUpload) {
+	if (computeUpload || gpuDecode) {
 		usage |= VK_IMAGE_USAGE_STORAGE_BIT;
 		imageLayout = VK_IMAGE_LAYOUT_GENERAL;
 	}
@@ -525,6 +755,8 @@ void TextureCacheVulkan::BuildTexture(TexCacheEntry *const entry) {
 		plan.createH /= plan.scaleFactor;
 		plan.scaleFactor = 1;
 		actualFmt = dstFmt;
+		// The retry below doesn't ask for storage, so decode on the CPU.
+		gpuDecode = false;
 
 		allocSuccess = image->CreateDirect(cmdInit, plan.createW, plan.createH, plan.depth, plan.levelsToCreate, actualFmt, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, mapping);
 	}
@@ -585,7 +817,9 @@ void TextureCacheVulkan::BuildTexture(TexCacheEntry *const entry) {
 			} else {
 				data = pushBuffer->Allocate(sz, pushAlignment, &texBuf, &bufferOffset);
 			}
-			LoadVulkanTextureLevel(*entry, (uint8_t *)data, lstride, srcLevel, lfactor, actualFmt);
+			if (lfactor == 1 || !CopyAsyncScaled(*entry, plan, (uint8_t *)data, lstride)) {
+				LoadVulkanTextureLevel(*entry, (uint8_t *)data, lstride, srcLevel, lfactor, actualFmt);
+			}
 			if (plan.saveTexture)
 				bufferOffset = pushBuffer->Push(&saveData[0], sz, pushAlignment, &texBuf);
 		};
@@ -612,6 +846,10 @@ void TextureCacheVulkan::BuildTexture(TexCacheEntry *const entry) {
 				// 3D texturing.
 				loadLevel(uploadSize, i, byteStride, plan.scaleFactor);
 				entry->vkTex->CopyBufferToMipLevel(cmdInit, &copyBatch, 0, mipWidth, mipHeight, i, texBuf, bufferOffset, pixelStride);
+			} else if (gpuDecode) {
+				VkImageView view = entry->vkTex->CreateViewForMip(i);
+				DecodeTextureLevelOnGPU(cmdInit, entry, view, i == 0 ? plan.baseLevelSrc : i);
+				vulkan->Delete().QueueDeleteImageView(view);
 			} else if (computeUpload) {
 				int srcBpp = VkFormatBytesPerPixel(dstFmt);
 				int srcStride = mipUnscaledWidth * srcBpp;
@@ -653,6 +891,10 @@ void TextureCacheVulkan::BuildTexture(TexCacheEntry *const entry) {
 		}
 	}
 
+	if (plan.queueScaleFactor != 0) {
+		QueueAsyncScale(*entry, plan, TexDecodeFlags{});
+	}
+
 	if (!copyBatch.empty()) {
 		VK_PROFILE_BEGIN(vulkan, cmdInit, VK_PIPELINE_STAGE_TRANSFER_BIT, "Copy Upload");
 		// Submit the whole batch of mip uploads.
@@ -660,14 +902,15 @@ void TextureCacheVulkan::BuildTexture(TexCacheEntry *const entry) {
 		VK_PROFILE_END(vulkan, cmdInit, VK_PIPELINE_STAGE_TRANSFER_BIT);
 	}
 
-	VkImageLayout layout = computeUpload ? VK_IMAGE_LAYOUT_GENERAL : VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
-	VkPipelineStageFlags prevStage = computeUpload ? VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT : VK_PIPELINE_STAGE_TRANSFER_BIT;
+	const bool wroteWithCompute = computeUpload || gpuDecode;
+	VkImageLayout layout = wroteWithCompute ? VK_IMAGE_LAYOUT_GENERAL : VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+	VkPipelineStageFlags prevStage = wroteWithCompute ? VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT : VK_PIPELINE_STAGE_TRANSFER_BIT;
 
 	// Generate any additional mipmap levels.
 	// This will transition the whole stack to GENERAL if it wasn't already.
 	if (plan.levelsToLoad < plan.levelsToCreate) {
 		VK_PROFILE_BEGIN(vulkan, cmdInit, VK_PIPELINE_STAGE_TRANSFER_BIT, "Mipgen up to level %d", plan.levelsToCreate);
-		entry->vkTex->GenerateMips(cmdInit, plan.levelsToLoad, computeUpload);
+		entry->vkTex->GenerateMips(cmdInit, plan.levelsToLoad, wroteWithCompute);
 		layout = VK_IMAGE_LAYOUT_GENERAL;
 		prevStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
 		VK_PROFILE_END(vulkan, cmdInit, VK_PIPELINE_STAGE_TRANSFER_BIT);
@@ -686,6 +929,58 @@ void TextureCacheVulkan::BuildTexture(TexCacheEntry *const entry) {
 	}
 }
 
+bool TextureCacheVulkan::UpdateTextureRows(TexCacheEntry *entry, int y0, int y1) {
+	VulkanTexture *vkTex = entry->vkTex;
+	if (!vkTex || vkTex->GetNumMips() != 1) {
+		return false;
+	}
+	const int w = gstate.getTextureWidth(0);
+	const int h = gstate.getTextureHeight(0);
+	if (vkTex->GetWidth() != w || vkTex->GetHeight() != h || y1 > h) {
+		return false;
+	}
+	const VkFormat fmt = vkTex->GetFormat();
+	switch (fmt) {
+	case VULKAN_8888_FORMAT:
+	case VULKAN_4444_FORMAT:
+	case VULKAN_1555_FORMAT:
+	case VULKAN_565_FORMAT:
+		break;
+	default:
+		return false;
+	}
+
+	// The decoders work on whole levels, so decode it all, but only upload and copy the rows that changed.
+	const int bpp = VkFormatBytesPerPixel(fmt);
+	const int stride = w * bpp;
+	tmpTexBufRearrange_.resize((stride * h + 3) / 4);
+	LoadVulkanTextureLevel(*entry, (uint8_t *)tmpTexBufRearrange_.data(), stride, 0, 1, fmt);
+
+	VulkanContext *vulkan = (VulkanContext *)draw_->GetNativeObject(Draw::NativeObject::CONTEXT);
+	VulkanPushPool *pushBuffer = drawEngine_->GetPushBufferForTextureData();
+	int pushAlignment = std::max(16, (int)vulkan->GetPhysicalDeviceProperties().properties.limits.optimalBufferCopyOffsetAlignment);
+	VkBuffer texBuf;
+	uint32_t bufferOffset = (uint32_t)pushBuffer->Push((const uint8_t *)tmpTexBufRearrange_.data() + y0 * stride, stride * (y1 - y0), pushAlignment, &texBuf);
+
+	VkBufferImageCopy region{};
+	region.bufferOffset = bufferOffset;
+	region.bufferRowLength = w;
+	region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	region.imageSubresource.layerCount = 1;
+	region.imageOffset.y = y0;
+	region.imageExtent.width = w;
+	region.imageExtent.height = y1 - y0;
+	region.imageExtent.depth = 1;
+
+	VkCommandBuffer cmdInit = (VkCommandBuffer)draw_->GetNativeObject(Draw::NativeObject::INIT_COMMANDBUFFER);
+	VK_PROFILE_BEGIN(vulkan, cmdInit, VK_PIPELINE_STAGE_TRANSFER_BIT, "Texture rows %d-%d: %08x", y0, y1, entry->addr);
+	vkTex->PrepareForTransferDst(cmdInit, 1);
+	vkCmdCopyBufferToImage(cmdInit, texBuf, vkTex->GetImage(), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+	vkTex->RestoreAfterTransferDst(cmdInit, 1);
+	VK_PROFILE_END(vulkan, cmdInit, VK_PIPELINE_STAGE_TRANSFER_BIT);
+	return true;
+}
+
 VkFormat TextureCacheVulkan::GetDestFormat(GETextureFormat format, GEPaletteFormat clutFormat) const {
 	if (!gstate_c.Use(GPU_USE_16BIT_FORMATS)) {
 		return VK_FORMAT_R8G8B8A8_UNORM;
@@ -99,8 +99,14 @@ class TextureCacheVulkan : public TextureCacheCommon {
 	void UpdateCurrentClut(GEPaletteFormat clutFormat, u32 clutBase, bool clutIndexIsSimple) override;
 
 	void BuildTexture(TexCacheEntry *const entry) override;
+	bool UpdateTextureRows(TexCacheEntry *entry, int y0, int y1) override;
 
 	void CompileScalingShader();
+	void CompileDecodeShader();
+
+	bool CanDecodeOnGPU(const TexCacheEntry *entry, const BuildTexturePlan &plan) const;
+	void DecodeTextureLevelOnGPU(VkCommandBuffer cmd, TexCacheEntry *entry, VkImageView view, int srcLevel);
+	CheckAlphaResult CheckClutAlpha(GETextureFormat format, int level) const;
 
 	VulkanDeviceAllocator *allocator_ = nullptr;
 
@@ -112,6 +118,8 @@ class TextureCacheVulkan : public TextureCacheCommon {
 
 	std::string textureShader_;
 	VkShaderModule uploadCS_ = VK_NULL_HANDLE;
+	// De-indexes and unswizzles CLUT textures straight from the raw PSP data.
+	VkShaderModule decodeCS_ = VK_NULL_HANDLE;
 
 	// Bound state to emulate an API similar to the others
 	VkImageView imageView_ = VK_NULL_HANDLE;
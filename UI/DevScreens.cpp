@@ -398,6 +398,7 @@ static const JitDisableFlag jitDisableFlags[] = {
 	{ MIPSComp::JitDisable::CACHE_POINTERS, "Cached pointers" },
 	{ MIPSComp::JitDisable::REGALLOC_GPR, "GPR Regalloc across instructions" },
 	{ MIPSComp::JitDisable::REGALLOC_FPR, "FPR Regalloc across instructions" },
+	{ MIPSComp::JitDisable::IR_THREADED, "IR interpreter threaded dispatch" },
 };
 
 void JitDebugScreen::CreateViews() {
@@ -1100,6 +1101,10 @@ UI::EventReturn JitCompareScreen::OnShowStats(UI::EventParams &e) {
 	NOTICE_LOG(JIT, "Average Bloat: %0.2f%%", 100 * bcStats.avgBloat);
 	NOTICE_LOG(JIT, "Min Bloat: %0.2f%%  (%08x)", 100 * bcStats.minBloat, bcStats.minBloatBlock);
 	NOTICE_LOG(JIT, "Max Bloat: %0.2f%%  (%08x)", 100 * bcStats.maxBloat, bcStats.maxBloatBlock);
+	if (bcStats.codeMemoryAllocated != 0)
+		NOTICE_LOG(JIT, "Code memory: %d KB used, %d KB allocated", (int)(bcStats.codeMemoryUsed / 1024), (int)(bcStats.codeMemoryAllocated / 1024));
+	if (bcStats.hotThreshold != 0)
+		NOTICE_LOG(JIT, "Hot blocks: %d (after %d runs), %llu hot / %llu cold block runs", bcStats.numHotBlocks, (int)bcStats.hotThreshold, (unsigned long long)bcStats.hotExecutions, (unsigned long long)bcStats.coldExecutions);
 
 	int ctr = 0, sz = (int)bcStats.bloatMap.size();
 	for (auto iter : bcStats.bloatMap) {
@@ -38,6 +38,8 @@
 #include "Core/System.h"
 #include "Core/WebServer.h"
 #include "Core/HLE/sceUtility.h"
+#include "Core/MIPS/IR/IRJit.h"
+#include "Core/MIPS/JitCommon/JitState.h"
 #include "Core/SaveState.h"
 #include "GPU/Common/FramebufferManagerCommon.h"
 #include "Log.h"
@@ -171,6 +173,8 @@ int printUsage(const char *progname, const char *reason)
 	fprintf(stderr, "  -v, --verbose         show the full passed/failed result\n");
 	fprintf(stderr, "  -i                    use the interpreter\n");
 	fprintf(stderr, "  --ir                  use ir interpreter\n");
+	fprintf(stderr, "  --ir-switch           use ir interpreter without threaded dispatch\n");
+	fprintf(stderr, "  --irjit               use the jit with the ir backend\n");
 	fprintf(stderr, "  -j                    use jit (default)\n");
 	fprintf(stderr, "  -c, --compare         compare with output in file.expected\n");
 	fprintf(stderr, "  --bench               run multiple times and output speed\n");
@@ -339,6 +343,7 @@ int main(int argc, const char* argv[])
 	const char *stateToLoad = 0;
 	GPUCore gpuCore = GPUCORE_SOFTWARE;
 	CPUCore cpuCore = CPUCore::JIT;
+	bool irSwitchDispatch = false;
 	int debuggerPort = -1;
 
 	std::vector<std::string> testFilenames;
@@ -368,6 +373,12 @@ int main(int argc, const char* argv[])
 			cpuCore = CPUCore::JIT;
 		else if (!strcmp(argv[i], "--ir"))
 			cpuCore = CPUCore::IR_JIT;
+		else if (!strcmp(argv[i], "--ir-switch")) {
+			cpuCore = CPUCore::IR_JIT;
+			irSwitchDispatch = true;
+		}
+		else if (!strcmp(argv[i], "--irjit"))
+			cpuCore = CPUCore::JIT_IR;
 		else if (!strcmp(argv[i], "-c") || !strcmp(argv[i], "--compare"))
 			testOptions.compare = true;
 		else if (!strcmp(argv[i], "--bench"))
@@ -495,6 +506,13 @@ int main(int argc, const char* argv[])
 	g_Config.sMACAddress = "12:34:56:78:9A:BC";
 	g_Config.iFirmwareVersion = PSP_DEFAULT_FIRMWARE;
 	g_Config.iPSPModel = PSP_MODEL_SLIM;
+	// Tests should always run the frontend.
+	g_Config.bIRCache = false;
+	if (irSwitchDispatch)
+		g_Config.uJitDisableFlags |= (uint32_t)MIPSComp::JitDisable::IR_THREADED;
+	// The IR instruction count is only kept while collecting debug stats.
+	if (testOptions.bench)
+		Core_ForceDebugStats(true);
 	g_Config.iGlobalVolume = VOLUME_FULL;
 	g_Config.iReverbVolume = VOLUME_FULL;
 
@@ -568,6 +586,7 @@ int main(int argc, const char* argv[])
 			double st = time_now_d();
 			double deadline = st + testOptions.timeout;
 			double runs = 0.0;
+			u64 startInstructions = MIPSComp::irInstructionsExecuted;
 			for (int i = 0; i < 100; ++i) {
 				RunAutoTest(headlessHost, coreParameter, testOptions);
 				runs++;
@@ -579,6 +598,10 @@ int main(int argc, const char* argv[])
 
 			std::string testName = GetTestName(coreParameter.fileToStart);
 			printf("  %s - %f seconds average\n", testName.c_str(), (et - st) / runs);
+			if (cpuCore == CPUCore::IR_JIT) {
+				double instructions = (double)(MIPSComp::irInstructionsExecuted - startInstructions);
+				printf("  %s - %f million IR instructions/second (%s dispatch)\n", testName.c_str(), instructions / (et - st) / 1000000.0, irSwitchDispatch ? "switch" : "threaded");
+			}
 		}
 		if (testOptions.compare) {
 			std::string testName = GetTestName(coreParameter.fileToStart);
@@ -17,6 +17,7 @@
 
 #include <cstdio>
 #include <cstring>
+#include "Common/Common.h"
 #include "Core/MIPS/IR/IRInst.h"
 #include "Core/MIPS/IR/IRPassSimplify.h"
 
@@ -166,8 +167,167 @@ static const IRVerification tests[] = {
 		},
 		{ &PropagateConstants },
 	},
+	{
+		"MergeLoadStoreForward",
+		{
+			{ IROp::Store32, { MIPS_REG_A0 }, MIPS_REG_S0, 0, 8 },
+			{ IROp::Load32, { MIPS_REG_V0 }, MIPS_REG_S0, 0, 8 },
+		},
+		{
+			{ IROp::Store32, { MIPS_REG_A0 }, MIPS_REG_S0, 0, 8 },
+			{ IROp::Mov, { MIPS_REG_V0 }, MIPS_REG_A0 },
+		},
+		{ &MergeLoadStore },
+	},
+	{
+		// Different offset, so this is not the value we just stored.
+		"MergeLoadStoreOtherOffset",
+		{
+			{ IROp::Store32, { MIPS_REG_A0 }, MIPS_REG_S0, 0, 8 },
+			{ IROp::Load32, { MIPS_REG_V0 }, MIPS_REG_S0, 0, 12 },
+		},
+		{
+			{ IROp::Store32, { MIPS_REG_A0 }, MIPS_REG_S0, 0, 8 },
+			{ IROp::Load32, { MIPS_REG_V0 }, MIPS_REG_S0, 0, 12 },
+		},
+		{ &MergeLoadStore },
+	},
+	{
+		"MergeVec4Add",
+		{
+			{ IROp::FAdd, { 33 }, 41, 49 },
+			{ IROp::FAdd, { 32 }, 40, 48 },
+			{ IROp::FAdd, { 35 }, 43, 51 },
+			{ IROp::FAdd, { 34 }, 42, 50 },
+		},
+		{
+			{ IROp::Vec4Add, { 32 }, 40, 48 },
+		},
+		{ &MergeVec4Ops },
+	},
+	{
+		// FMul handles inf * 0 specially and Vec4Mul doesn't, so this must stay scalar.
+		"MergeVec4MulStaysScalar",
+		{
+			{ IROp::FMul, { 32 }, 40, 48 },
+			{ IROp::FMul, { 33 }, 41, 49 },
+			{ IROp::FMul, { 34 }, 42, 50 },
+			{ IROp::FMul, { 35 }, 43, 51 },
+		},
+		{
+			{ IROp::FMul, { 32 }, 40, 48 },
+			{ IROp::FMul, { 33 }, 41, 49 },
+			{ IROp::FMul, { 34 }, 42, 50 },
+			{ IROp::FMul, { 35 }, 43, 51 },
+		},
+		{ &MergeVec4Ops },
+	},
+	{
+		"DeadFCmp",
+		{
+			{ IROp::FCmp, { IRFpCompareMode::EqualOrdered }, 0, 1 },
+			{ IROp::FCmp, { IRFpCompareMode::LessOrdered }, 2, 3 },
+			{ IROp::FpCondToReg, { IRTEMP_LHS } },
+		},
+		{
+			{ IROp::FCmp, { IRFpCompareMode::LessOrdered }, 2, 3 },
+			{ IROp::FpCondToReg, { IRTEMP_LHS } },
+		},
+		{ &RemoveDeadCtrlWrites },
+	},
+	{
+		// The exit needs the first result.
+		"FCmpBeforeExit",
+		{
+			{ IROp::FCmp, { IRFpCompareMode::EqualOrdered }, 0, 1 },
+			{ IROp::ExitToConstIfEq, { 0 }, MIPS_REG_A0, MIPS_REG_A1, 0x08800000 },
+			{ IROp::FCmp, { IRFpCompareMode::LessOrdered }, 2, 3 },
+		},
+		{
+			{ IROp::FCmp, { IRFpCompareMode::EqualOrdered }, 0, 1 },
+			{ IROp::ExitToConstIfEq, { 0 }, MIPS_REG_A0, MIPS_REG_A1, 0x08800000 },
+			{ IROp::FCmp, { IRFpCompareMode::LessOrdered }, 2, 3 },
+		},
+		{ &RemoveDeadCtrlWrites },
+	},
 };
 
+// Blocks shaped like what the frontend produces around FPU / VFPU compares and control writes.
+static const std::vector<IRInst> ctrlWriteCorpus[] = {
+	// c.eq.s immediately replaced by c.lt.s, then bc1t.
+	{
+		{ IROp::FCmp, { IRFpCompareMode::EqualOrdered }, 0, 1 },
+		{ IROp::FCmp, { IRFpCompareMode::LessOrdered }, 2, 3 },
+		{ IROp::FpCondToReg, { IRTEMP_LHS } },
+		{ IROp::Downcount, { 0 }, 0, 0, 4 },
+		{ IROp::ExitToConstIfEq, { 0 }, IRTEMP_LHS, 0, 0x08800010 },
+		{ IROp::ExitToConst, { 0 }, 0, 0, 0x08800100 },
+	},
+	// Cleared, then compared.
+	{
+		{ IROp::ZeroFpCond },
+		{ IROp::FAdd, { 4 }, 0, 1 },
+		{ IROp::FCmp, { IRFpCompareMode::LessEqualOrdered }, 4, 2 },
+		{ IROp::ExitToConst, { 0 }, 0, 0, 0x08800200 },
+	},
+	// Prefixes written twice with nothing reading them in between.
+	{
+		{ IROp::SetCtrlVFPU, { 0 }, 0, 0, 0xE4 },
+		{ IROp::SetCtrlVFPU, { 1 }, 0, 0, 0xE4 },
+		{ IROp::Vec4Add, { 32 }, 36, 40 },
+		{ IROp::SetCtrlVFPU, { 0 }, 0, 0, 0x000E4 },
+		{ IROp::SetCtrlVFPU, { 1 }, 0, 0, 0x000E4 },
+		{ IROp::ExitToConst, { 0 }, 0, 0, 0x08800300 },
+	},
+	// vcmp, read by vcmov and bvt.  Nothing is dead.
+	{
+		{ IROp::SetCtrlVFPUReg, { 3 }, MIPS_REG_ZERO },
+		{ IROp::FCmpVfpuBit, { 0x01 }, 32, 36 },
+		{ IROp::FCmpVfpuBit, { 0x11 }, 33, 37 },
+		{ IROp::FCmpVfpuAggregate, { 0x03 } },
+		{ IROp::FCmovVfpuCC, { 40 }, 44, 0x00 },
+		{ IROp::VfpuCtrlToReg, { IRTEMP_LHS }, 3 },
+		{ IROp::ExitToConstIfNeq, { 0 }, IRTEMP_LHS, 0, 0x08800400 },
+		{ IROp::ExitToConst, { 0 }, 0, 0, 0x08800410 },
+	},
+	// ctc1 twice, the first one is still needed for the rounding mode.
+	{
+		{ IROp::FpCtrlFromReg, { 0 }, MIPS_REG_A0 },
+		{ IROp::UpdateRoundingMode },
+		{ IROp::FpCtrlFromReg, { 0 }, MIPS_REG_A1 },
+		{ IROp::UpdateRoundingMode },
+		{ IROp::ExitToConst, { 0 }, 0, 0, 0x08800500 },
+	},
+	// VFPU CC overwritten from a GPR before anything looks at it.
+	{
+		{ IROp::SetCtrlVFPU, { 3 }, 0, 0, 0x3F },
+		{ IROp::SetCtrlVFPUReg, { 3 }, MIPS_REG_A0 },
+		{ IROp::ExitToConst, { 0 }, 0, 0, 0x08800600 },
+	},
+};
+
+static bool TestDeadCtrlWriteCorpus() {
+	IROptions opts{};
+	int total = 0;
+	int removed = 0;
+	for (const auto &block : ctrlWriteCorpus) {
+		IRWriter in, out;
+		for (const auto &inst : block)
+			in.Write(inst);
+		RemoveDeadCtrlWrites(in, out, opts);
+		total += (int)block.size();
+		removed += (int)(block.size() - out.GetInstructions().size());
+	}
+
+	printf("RemoveDeadCtrlWrites: eliminated %d of %d instructions in %d blocks\n", removed, total, (int)ARRAY_SIZE(ctrlWriteCorpus));
+	// c.eq.s, ZeroFpCond, both first prefix writes, and the first CC write.
+	if (removed != 5) {
+		printf("RemoveDeadCtrlWrites FAILED: expected 5 eliminated\n");
+		return false;
+	}
+	return true;
+}
+
 bool TestIRPassSimplify() {
 	InitIR();
 
@@ -176,5 +336,5 @@ bool TestIRPassSimplify() {
 			return false;
 	}
 
-	return true;
+	return TestDeadCtrlWriteCorpus();
 }
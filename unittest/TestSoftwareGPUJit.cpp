@@ -15,11 +15,13 @@
 // Official git repository and contact information can be found at
 // https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
 
+#include "Common/CPUDetect.h"
 #include "Common/Data/Random/Rng.h"
 #include "Common/StringUtils.h"
 #include "Core/Config.h"
 #include "GPU/Software/BinManager.h"
 #include "GPU/Software/DrawPixel.h"
+#include "GPU/Software/Rasterizer.h"
 #include "GPU/Software/Sampler.h"
 #include "GPU/Software/SoftGpu.h"
 
@@ -161,6 +163,44 @@ static bool TestPixelJit() {
 	return successes == count && !HitAnyAsserts();
 }
 
+static bool TestQuadColorsAVX2() {
+	if (!cpu_info.bAVX2)
+		return true;
+
+	GMRng rng;
+	int failures = 0;
+	for (int i = 0; i < 100000; ++i) {
+		Math3D::Vec4<int> c[3];
+		for (int v = 0; v < 3; ++v)
+			c[v] = Math3D::Vec4<int>(rng.R32() & 0xFF, rng.R32() & 0xFF, rng.R32() & 0xFF, rng.R32() & 0xFF);
+		// Edge weights as DrawTriangle() sees them inside a triangle, with their reciprocal sum.
+		Math3D::Vec4<int> w[3];
+		Math3D::Vec4<float> wsum_recip;
+		for (int p = 0; p < 4; ++p) {
+			int sum = 0;
+			for (int v = 0; v < 3; ++v) {
+				w[v][p] = rng.R32() & 0xFFFFF;
+				sum += w[v][p];
+			}
+			wsum_recip[p] = sum == 0 ? 0.0f : 1.0f / (float)sum;
+		}
+
+		Math3D::Vec4<int> expected[4], actual[4];
+		Rasterizer::InterpolateQuadColors(expected, c[0], c[1], c[2], w[0], w[1], w[2], wsum_recip, false);
+		Rasterizer::InterpolateQuadColors(actual, c[0], c[1], c[2], w[0], w[1], w[2], wsum_recip, true);
+		for (int p = 0; p < 4; ++p) {
+			if (!(expected[p] == actual[p])) {
+				if (failures++ < 10)
+					printf("Quad color mismatch: %d,%d,%d,%d vs %d,%d,%d,%d\n", expected[p].r(), expected[p].g(), expected[p].b(), expected[p].a(), actual[p].r(), actual[p].g(), actual[p].b(), actual[p].a());
+			}
+		}
+	}
+
+	if (failures != 0)
+		printf("AVX2 quad colors: %d mismatches\n", failures);
+	return failures == 0;
+}
+
 bool TestSoftwareGPUJit() {
 	g_Config.bSoftwareRenderingJit = true;
 	ResetHitAnyAsserts();
@@ -173,5 +213,9 @@ bool TestSoftwareGPUJit() {
 		return false;
 	}
 
+	if (!TestQuadColorsAVX2()) {
+		return false;
+	}
+
 	return true;
 }
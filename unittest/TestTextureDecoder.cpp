@@ -0,0 +1,225 @@
+// Copyright (c) 2024- PPSSPP Project.
+
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2.0 or later versions.
+
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License 2.0 for more details.
+
+// A copy of the GPL 2.0 should have been included with the program.
+// If not, see http://www.gnu.org/licenses/
+
+// Official git repository and contact information can be found at
+// https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
+
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <vector>
+
+#include "Common/CommonTypes.h"
+#include "Common/CPUDetect.h"
+#include "Common/MemoryUtil.h"
+#include "Common/TimeUtil.h"
+#include "GPU/Common/TextureDecoder.h"
+#include "GPU/ge_constants.h"
+#include "GPU/GPUState.h"
+#include "unittest/UnitTest.h"
+
+// Checks the unswizzle, CLUT and DXT decoders against straightforward per-pixel versions, for every
+// texture format, and prints a rough speed comparison with the SIMD paths on and off.
+
+static const int TEX_W = 512;
+static const int TEX_H = 272;
+
+static double TimeDecode(const std::function<void()> &func) {
+	int count = 0;
+	double st = time_now_d();
+	do {
+		func();
+		count++;
+	} while (time_now_d() - st < 0.05);
+	return (time_now_d() - st) / count;
+}
+
+// Runs func with the SIMD kernels enabled and then with them forced off.
+// The results must match with either setting, and we log both timings.
+static bool RunBothWays(const char *name, const std::function<bool()> &func, const std::function<void()> &bench) {
+	const bool oldAVX2 = cpu_info.bAVX2;
+	const bool oldSSSE3 = cpu_info.bSSSE3;
+
+	bool success = func();
+	double fast = TimeDecode(bench);
+
+	cpu_info.bAVX2 = false;
+	cpu_info.bSSSE3 = false;
+	success = func() && success;
+	double slow = TimeDecode(bench);
+
+	cpu_info.bAVX2 = oldAVX2;
+	cpu_info.bSSSE3 = oldSSSE3;
+
+	printf("%-8s %8.1f us (SIMD), %8.1f us (scalar)\n", name, fast * 1000000.0, slow * 1000000.0);
+	if (!success) {
+		printf("%s: Failed, output does not match reference\n", name);
+	}
+	return success;
+}
+
+static bool TestUnswizzle(const char *name, const std::vector<u8> &src, int bytesPerPixel) {
+	const u32 pitch = TEX_W * bytesPerPixel;
+	const int bxc = pitch / 16;
+	const int byc = TEX_H / 8;
+
+	std::vector<u8> expected(pitch * TEX_H);
+	for (int y = 0; y < TEX_H; ++y) {
+		for (int x = 0; x < (int)pitch; ++x) {
+			expected[y * pitch + x] = src[((y / 8) * bxc + x / 16) * 128 + (y % 8) * 16 + x % 16];
+		}
+	}
+
+	// Aligned like the texture cache's temp buffer, so the AVX2 path is taken.
+	AlignedVector<u32, 32> dest;
+	dest.resize(pitch * TEX_H / 4);
+	auto run = [&]() {
+		DoUnswizzleTex16(src.data(), dest.data(), bxc, byc, pitch);
+	};
+	return RunBothWays(name, [&]() {
+		memset(dest.data(), 0, dest.size() * 4);
+		run();
+		return memcmp(dest.data(), expected.data(), expected.size()) == 0;
+	}, run);
+}
+
+template <typename IndexT, typename ClutT>
+static bool TestDeIndex(const char *name, const std::vector<u8> &src, const ClutT *clut) {
+	const IndexT *indexed = (const IndexT *)src.data();
+	const int length = TEX_W * TEX_H / 4;
+
+	std::vector<ClutT> expected(length);
+	u32 expectedAlpha = 0xFFFFFFFF;
+	for (int i = 0; i < length; ++i) {
+		expected[i] = clut[indexed[i] & 0xFF];
+		expectedAlpha &= expected[i];
+	}
+
+	std::vector<ClutT> dest(length);
+	u32 alphaSum = 0xFFFFFFFF;
+	auto run = [&]() {
+		DeIndexTexture(dest.data(), indexed, length, clut, &alphaSum);
+	};
+	return RunBothWays(name, [&]() {
+		alphaSum = 0xFFFFFFFF;
+		run();
+		return memcmp(dest.data(), expected.data(), length * sizeof(ClutT)) == 0 && alphaSum == expectedAlpha;
+	}, run);
+}
+
+template <typename ClutT>
+static bool TestDeIndex4(const char *name, const std::vector<u8> &src, const ClutT *clut) {
+	const int length = TEX_W * TEX_H;
+
+	std::vector<ClutT> expected(length);
+	u32 expectedAlpha = 0xFFFFFFFF;
+	for (int i = 0; i < length; ++i) {
+		expected[i] = clut[(src[i / 2] >> ((i & 1) * 4)) & 0xF];
+		expectedAlpha &= expected[i];
+	}
+
+	std::vector<ClutT> dest(length);
+	u32 alphaSum = 0xFFFFFFFF;
+	auto run = [&]() {
+		DeIndexTexture4(dest.data(), src.data(), length, clut, &alphaSum);
+	};
+	return RunBothWays(name, [&]() {
+		alphaSum = 0xFFFFFFFF;
+		run();
+		return memcmp(dest.data(), expected.data(), length * sizeof(ClutT)) == 0 && alphaSum == expectedAlpha;
+	}, run);
+}
+
+template <typename BlockT>
+static bool TestDXT(const char *name, const std::vector<u8> &src, void (*decode)(u32 *, const BlockT *, int, int), u32 (*texel)(const BlockT *, int, int)) {
+	const int bw = TEX_W / 4;
+	const int bh = TEX_H / 4;
+	const BlockT *blocks = (const BlockT *)src.data();
+
+	std::vector<u32> expected(TEX_W * TEX_H);
+	for (int y = 0; y < TEX_H; ++y) {
+		for (int x = 0; x < TEX_W; ++x) {
+			expected[y * TEX_W + x] = texel(&blocks[(y / 4) * bw + x / 4], x & 3, y & 3);
+		}
+	}
+
+	std::vector<u32> dest(TEX_W * TEX_H);
+	auto run = [&]() {
+		for (int by = 0; by < bh; ++by) {
+			for (int bx = 0; bx < bw; ++bx) {
+				decode(&dest[by * 4 * TEX_W + bx * 4], &blocks[by * bw + bx], TEX_W, 4);
+			}
+		}
+	};
+	return RunBothWays(name, [&]() {
+		run();
+		return memcmp(dest.data(), expected.data(), expected.size() * 4) == 0;
+	}, run);
+}
+
+static void DecodeDXT1(u32 *dst, const DXT1Block *src, int pitch, int height) {
+	u32 alpha = 0xFFFFFFFF;
+	DecodeDXT1Block(dst, src, pitch, 4, height, &alpha);
+}
+
+static void DecodeDXT3(u32 *dst, const DXT3Block *src, int pitch, int height) {
+	DecodeDXT3Block(dst, src, pitch, 4, height);
+}
+
+static void DecodeDXT5(u32 *dst, const DXT5Block *src, int pitch, int height) {
+	DecodeDXT5Block(dst, src, pitch, 4, height);
+}
+
+bool TestTextureDecoder() {
+	printf("AVX2: %d, SSSE3: %d\n", (int)cpu_info.bAVX2, (int)cpu_info.bSSSE3);
+
+	// Enough for the largest format, 32-bit at TEX_W x TEX_H, plus some slack.
+	std::vector<u8> src(TEX_W * TEX_H * 4 + 64);
+	u32 seed = 0x12345678;
+	for (u8 &b : src) {
+		seed = seed * 1103515245 + 12345;
+		b = (u8)(seed >> 16);
+	}
+
+	// The CLUT buffers are aligned like the ones in the texture cache.
+	alignas(16) u16 clut16[256];
+	alignas(16) u32 clut32[256];
+	for (int i = 0; i < 256; ++i) {
+		seed = seed * 1103515245 + 12345;
+		clut32[i] = (seed >> 8) | 0xF0000000;
+		clut16[i] = (u16)(clut32[i] >> 4) | 0x8000;
+	}
+
+	// Only the simple CLUT mode (no shift, mask, or offset) has SIMD versions.
+	gstate.clutformat = 0xC500FF00 | GE_CMODE_32BIT_ABGR8888;
+
+	bool success = true;
+	success = TestUnswizzle("5650", src, 2) && success;
+	success = TestUnswizzle("5551", src, 2) && success;
+	success = TestUnswizzle("4444", src, 2) && success;
+	success = TestUnswizzle("8888", src, 4) && success;
+
+	success = TestDeIndex4<u16>("CLUT4/16", src, clut16) && success;
+	success = TestDeIndex4<u32>("CLUT4/32", src, clut32) && success;
+	success = TestDeIndex<u8, u16>("CLUT8/16", src, clut16) && success;
+	success = TestDeIndex<u8, u32>("CLUT8/32", src, clut32) && success;
+	success = TestDeIndex<u16_le, u32>("CLUT16", src, clut32) && success;
+	success = TestDeIndex<u32_le, u32>("CLUT32", src, clut32) && success;
+
+	success = TestDXT<DXT1Block>("DXT1", src, &DecodeDXT1, &GetDXT1Texel) && success;
+	success = TestDXT<DXT3Block>("DXT3", src, &DecodeDXT3, &GetDXT3Texel) && success;
+	success = TestDXT<DXT5Block>("DXT5", src, &DecodeDXT5, &GetDXT5Texel) && success;
+
+	return success;
+}
@@ -16,8 +16,10 @@
 // https://github.com/hrydgard/ppsspp and http://www.ppsspp.org/.
 
 #include <math.h>
+#include <vector>
 
 #include "Common/CommonTypes.h"
+#include "Common/CPUDetect.h"
 #include "Common/TimeUtil.h"
 #include "Core/Config.h"
 #include "Core/ConfigValues.h"
@@ -154,6 +156,14 @@ class VertexDecoderTestHarness {
 		AddFloat(z);
 	}
 
+	// Fills the source with floats in [-2, 2), which also make reasonable 8 and 16 bit data.
+	void AddRandomFloats(int count, u32 seed) {
+		for (int i = 0; i < count; ++i) {
+			seed = seed * 1103515245 + 12345;
+			AddFloat((float)((seed >> 8) & 0xFFFF) / 16384.0f - 2.0f);
+		}
+	}
+
 	u8 Get8() {
 		return dst_[dstPos_++];
 	}
@@ -638,6 +648,81 @@ static bool TestVertexFloatSkin() {
 
 // TODO: Morph (col, pos, nrm), weights (no skin), morph + weights?
 
+// With AVX2, skinning and morph formats are decoded two vertices at a time. The result must be
+// exactly the same as the SSE decoder's, and we report the speed of each.
+static bool TestVertexPairedJit() {
+	if (!cpu_info.bAVX2) {
+		printf("Skipping paired vertex decoder tests, no AVX2.\n");
+		return true;
+	}
+
+	// Odd, so the last vertex takes the single vertex path.
+	static const int VERTS = 1001;
+
+	struct PairedTest {
+		const char *name;
+		int vtype;
+		bool skin;
+		u32 texmapmode;
+	};
+	static const PairedTest tests[] = {
+		{ "SkinU8x2", GE_VTYPE_WEIGHT_8BIT | (1 << GE_VTYPE_WEIGHTCOUNT_SHIFT) | GE_VTYPE_POS_8BIT | GE_VTYPE_NRM_8BIT, true, GE_TEXMAP_TEXTURE_COORDS },
+		{ "SkinU8x5", GE_VTYPE_WEIGHT_8BIT | (4 << GE_VTYPE_WEIGHTCOUNT_SHIFT) | GE_VTYPE_POS_16BIT | GE_VTYPE_NRM_8BIT | GE_VTYPE_TC_16BIT | GE_VTYPE_COL_8888, true, GE_TEXMAP_TEXTURE_COORDS },
+		{ "SkinU16x3", GE_VTYPE_WEIGHT_16BIT | (2 << GE_VTYPE_WEIGHTCOUNT_SHIFT) | GE_VTYPE_POS_16BIT | GE_VTYPE_NRM_16BIT | GE_VTYPE_TC_8BIT, true, GE_TEXMAP_TEXTURE_COORDS },
+		{ "SkinU16x6", GE_VTYPE_WEIGHT_16BIT | (5 << GE_VTYPE_WEIGHTCOUNT_SHIFT) | GE_VTYPE_POS_16BIT, true, GE_TEXMAP_TEXTURE_COORDS },
+		{ "SkinU16x8", GE_VTYPE_WEIGHT_16BIT | (7 << GE_VTYPE_WEIGHTCOUNT_SHIFT) | GE_VTYPE_POS_FLOAT | GE_VTYPE_NRM_16BIT, true, GE_TEXMAP_TEXTURE_COORDS },
+		{ "SkinFloatx1", GE_VTYPE_WEIGHT_FLOAT | GE_VTYPE_POS_8BIT, true, GE_TEXMAP_TEXTURE_COORDS },
+		{ "SkinFloatx4", GE_VTYPE_WEIGHT_FLOAT | (3 << GE_VTYPE_WEIGHTCOUNT_SHIFT) | GE_VTYPE_POS_FLOAT | GE_VTYPE_NRM_FLOAT | GE_VTYPE_TC_FLOAT, true, GE_TEXMAP_TEXTURE_COORDS },
+		{ "Morph8x2", (1 << GE_VTYPE_MORPHCOUNT_SHIFT) | GE_VTYPE_POS_8BIT | GE_VTYPE_NRM_8BIT | GE_VTYPE_TC_8BIT, false, GE_TEXMAP_TEXTURE_COORDS },
+		{ "Morph16x3", (2 << GE_VTYPE_MORPHCOUNT_SHIFT) | GE_VTYPE_POS_16BIT | GE_VTYPE_NRM_16BIT | GE_VTYPE_TC_16BIT | GE_VTYPE_COL_565, false, GE_TEXMAP_TEXTURE_COORDS },
+		{ "MorphFloatx4", (3 << GE_VTYPE_MORPHCOUNT_SHIFT) | GE_VTYPE_POS_FLOAT | GE_VTYPE_NRM_FLOAT | GE_VTYPE_TC_FLOAT, false, GE_TEXMAP_TEXTURE_COORDS },
+		{ "MorphTc8x2", (1 << GE_VTYPE_MORPHCOUNT_SHIFT) | GE_VTYPE_POS_16BIT | GE_VTYPE_TC_8BIT, false, GE_TEXMAP_TEXTURE_MATRIX },
+		{ "MorphTc16x2", (1 << GE_VTYPE_MORPHCOUNT_SHIFT) | GE_VTYPE_POS_FLOAT | GE_VTYPE_TC_16BIT | GE_VTYPE_COL_4444, false, GE_TEXMAP_TEXTURE_MATRIX },
+		{ "MorphTcFloatx3", (2 << GE_VTYPE_MORPHCOUNT_SHIFT) | GE_VTYPE_POS_8BIT | GE_VTYPE_TC_FLOAT | GE_VTYPE_WEIGHT_8BIT | (1 << GE_VTYPE_WEIGHTCOUNT_SHIFT), false, GE_TEXMAP_TEXTURE_MATRIX },
+	};
+
+	for (int i = 0; i < 8 * 12; ++i) {
+		gstate.boneMatrix[i] = (float)((i * 7) % 13 - 6) * 0.25f;
+	}
+	for (int i = 0; i < 8; ++i) {
+		gstate_c.morphWeights[i] = 1.0f / (float)(i + 2);
+	}
+	gstate_c.uv.uScale = 0.5f;
+	gstate_c.uv.vScale = 2.0f;
+	gstate_c.uv.uOff = 0.25f;
+	gstate_c.uv.vOff = -0.125f;
+
+	bool pass = true;
+	for (const PairedTest &test : tests) {
+		VertexDecoderTestHarness dec;
+		VertexDecoderOptions opts{};
+		opts.applySkinInDecode = test.skin;
+		dec.SetOptions(opts);
+		dec.AddRandomFloats(VERTS * 64, test.vtype);
+		gstate.texmapmode = test.texmapmode;
+
+		cpu_info.bAVX2 = false;
+		dec.Execute(test.vtype, VERTS - 1, true);
+		const u8 *data = (const u8 *)dec.GetData();
+		const size_t size = VERTS * dec.GetDstStride();
+		std::vector<u8> expected(data, data + size);
+		double sse = dec.ExecuteTimed(test.vtype, VERTS - 1, true);
+
+		cpu_info.bAVX2 = true;
+		memset(dec.GetData(), 0, size);
+		dec.Execute(test.vtype, VERTS - 1, true);
+		if (memcmp(dec.GetData(), expected.data(), size) != 0) {
+			printf("TestVertexPairedJit-%s: Failed, AVX2 output differs from SSE\n", test.name);
+			pass = false;
+		}
+		double avx2 = dec.ExecuteTimed(test.vtype, VERTS - 1, true);
+		printf("TestVertexPairedJit-%s: AVX2 was %fx the speed of SSE.\n", test.name, avx2 / sse);
+	}
+	gstate.texmapmode = GE_TEXMAP_TEXTURE_COORDS;
+
+	return pass;
+}
+
 typedef bool (*VertexTestFunc)();
 
 static VertexTestFunc vertdecTestFuncs[] = {
@@ -657,6 +742,8 @@ static VertexTestFunc vertdecTestFuncs[] = {
 	&TestVertex8Skin,
 	&TestVertex16Skin,
 	&TestVertexFloatSkin,
+
+	&TestVertexPairedJit,
 };
 
 bool TestVertexJit() {
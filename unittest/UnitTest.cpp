@@ -993,6 +993,7 @@ bool TestShaderGenerators();
 bool TestSoftwareGPUJit();
 bool TestIRPassSimplify();
 bool TestThreadManager();
+bool TestTextureDecoder();
 bool TestVFS();
 
 TestItem availableTests[] = {
@@ -1026,6 +1027,7 @@ TestItem availableTests[] = {
 	TEST_ITEM(Path),
 	TEST_ITEM(AndroidContentURI),
 	TEST_ITEM(ThreadManager),
+	TEST_ITEM(TextureDecoder),
 	TEST_ITEM(WrapText),
 	TEST_ITEM(TinySet),
 	TEST_ITEM(FastVec),